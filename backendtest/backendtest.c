@@ -244,8 +244,25 @@ struct UIState
 {
   struct FG_GraphicsInterface* graphics;
   struct FG_GraphicsDesktopBridge* bridge;
+  struct FG_DesktopInterface* desktop;
 };
 
+// Tears the window down from inside its own message, which the desktop has to survive until it's done delivering it.
+void close_window(struct UIState* state, FG_Window* w, MockElement* e)
+{
+  struct FG_GraphicsInterface* b = state->graphics;
+  if(e->close)
+    return;
+
+  e->close = true;
+  TEST((*b->destroyResource)(b, w->context, e->image) == 0);
+  TEST((*b->destroyPipelineState)(b, w->context, e->pipeline) == 0);
+  e->pipeline = 0;
+  TEST((*state->bridge->destroyContext)(state->bridge, w) == 0);
+  TEST(w->context == NULL);
+  TEST((*state->desktop->destroyWindow)(state->desktop, w) == 0);
+}
+
 // The behavior function simply processes all window messages from the host OS.
 FG_Result behavior(FG_Window* w, FG_Msg* msg, void* ui_context, uintptr_t window_id)
 {
@@ -262,7 +279,9 @@ FG_Result behavior(FG_Window* w, FG_Msg* msg, void* ui_context, uintptr_t window
     void* commands                 = (*b->createCommandList)(b, w->context, false);
     assert(commands);
 
-    (*state->bridge->beginDraw)(state->bridge, w, NULL);
+    // Only the damaged part of the window is redrawn and presented.
+    FG_Rect area = msg->draw.area;
+    (*state->bridge->beginDraw)(state->bridge, w, &area);
     if(e->mesh_pipeline && (e->caps.features & FG_Feature_Mesh_Shader) != 0)
       test_mesh(b, w->context, commands, e);
 
@@ -274,6 +293,8 @@ FG_Result behavior(FG_Window* w, FG_Msg* msg, void* ui_context, uintptr_t window
     values[1].resource = e->image;
 
     (*b->setPipelineState)(b, commands, e->pipeline);
+    if(e->caps.features & FG_Feature_Vertex_Binding)
+      TEST((*b->setVertexBuffers)(b, commands, 0, &e->vertices, 0, 1) == 0);
     (*b->setShaderConstants)(b, commands, params, values, 2);
     (*b->draw)(b, commands, 4, 0, 0, 0);
     (*b->execute)(b, w->context, commands);
@@ -290,16 +311,17 @@ FG_Result behavior(FG_Window* w, FG_Msg* msg, void* ui_context, uintptr_t window
     FG_Result r = { e->close ? FG_WindowFlag_Closed : 0 };
     return r;
   }
-  if(msg->kind == FG_Event_Kind_SetWindowFlags)
+  if(msg->kind == FG_Event_Kind_SetWindowFlags && (msg->setWindowFlags.flags & FG_WindowFlag_Closed) != 0)
   {
-    e->close = e->close || ((msg->setWindowFlags.flags & FG_WindowFlag_Closed) != 0);
+    close_window((struct UIState*)ui_context, w, e);
   }
   // We normally close when any keypress happens, but we don't want to close if the user is trying to take a screenshot.
   if((msg->kind == FG_Event_Kind_KeyDown && msg->keyDown.key != FG_Keys_LMENU && msg->keyDown.scancode != 84 &&
       msg->keyDown.scancode != 88) ||
      msg->kind == FG_Event_Kind_MouseDown)
   {
-    e->close = true;
+    // Input is coalesced, so this arrives while the desktop is flushing the window's input queue.
+    close_window((struct UIState*)ui_context, w, e);
   }
 
   FG_Result r = { -1 };
@@ -354,10 +376,33 @@ void test_compute(struct FG_GraphicsInterface* b, FG_Window* w)
                                                { "outblock", 0, 0, 1, FG_Shader_Type_Buffer } };
   TEST((*b->setPipelineState)(b, commands, compute_pipeline) == 0);
   TEST((*b->setShaderConstants)(b, commands, params, values, 3) == 0);
+
+  // A second pass, with its group count read from a buffer, multiplies the output of the first back into the input
+  // buffer. It only sees the first pass's results because declaring the read of outbuf puts a barrier between them.
+  FG_DispatchIndirectArgs args      = { (uint32_t)groupsize.x, 1, 1 };
+  FG_Resource argbuf                = (*b->createBuffer)(b, w->context, &args, sizeof(args), FG_Usage_Storage_Buffer);
+  const FG_ResourceAccess access[2] = { { CopiedInbuf, FG_BarrierFlag_Storage_Buffer, false },
+                                        { CopiedOutbuf, FG_BarrierFlag_Storage_Buffer, true } };
+  const FG_ResourceAccess second[2] = { { CopiedOutbuf, FG_BarrierFlag_Storage_Buffer, false },
+                                        { CopiedInbuf, FG_BarrierFlag_Storage_Buffer, true } };
+  FG_ShaderValue swapped[3];
+  swapped[0].i32      = values[0].i32;
+  swapped[1].resource = CopiedOutbuf;
+  swapped[2].resource = CopiedInbuf;
+  TEST((*b->declareAccess)(b, commands, access, 2) == 0);
   TEST((*b->dispatch)(b, commands) == 0);
+  TEST((*b->setShaderConstants)(b, commands, params, swapped, 3) == 0);
+  TEST((*b->declareAccess)(b, commands, second, 2) == 0);
+  TEST((*b->dispatchIndirect)(b, commands, argbuf, 0) == 0);
   TEST((*b->syncPoint)(b, commands, FG_BarrierFlag_Storage_Buffer) == 0);
   TEST((*b->execute)(b, w->context, commands) == 0);
 
+  FG_Fence fence = (*b->createFence)(b, w->context);
+  TEST(fence != 0);
+  TEST((*b->waitFence)(b, w->context, fence, UINT64_MAX) == 0);
+  TEST((*b->queryFence)(b, w->context, fence) == 0);
+  TEST((*b->destroyFence)(b, w->context, fence) == 0);
+
   int* readbuf = (int*)(*b->mapResource)(b, w->context, CopiedOutbuf, 0, 0, FG_Usage_Storage_Buffer, FG_AccessFlag_Read);
   TEST(readbuf != NULL);
 
@@ -365,21 +410,290 @@ void test_compute(struct FG_GraphicsInterface* b, FG_Window* w)
   {
     TEST(readbuf[i] == initvals[i] * values[0].i32);
   }
+  TEST((*b->unmapResource)(b, w->context, CopiedOutbuf, FG_Usage_Storage_Buffer) == 0);
+
+  // Had the second pass run without the barrier, it could have read zeros or a partial first pass.
+  readbuf = (int*)(*b->mapResource)(b, w->context, CopiedInbuf, 0, 0, FG_Usage_Storage_Buffer, FG_AccessFlag_Read);
+  TEST(readbuf != NULL);
+
+  for(int i = 0; i < GROUPSIZE; ++i)
+  {
+    TEST(readbuf[i] == initvals[i] * values[0].i32 * values[0].i32);
+  }
+  TEST((*b->unmapResource)(b, w->context, CopiedInbuf, FG_Usage_Storage_Buffer) == 0);
 
   (*b->destroyCommandList)(b, w->context, commands);
-  TEST((*b->unmapResource)(b, w->context, CopiedOutbuf, FG_Usage_Storage_Buffer) == 0);
   TEST((*b->destroyResource)(b, w->context, outbuf) == 0);
   TEST((*b->destroyResource)(b, w->context, inbuf) == 0);
+  TEST((*b->destroyResource)(b, w->context, argbuf) == 0);
   TEST((*b->destroyPipelineState)(b, w->context, compute_pipeline) == 0);
 }
 
+// Mips are generated and premultiplied on the CPU before they're uploaded, so a compute shader reads every level back
+// as it was built. An 8x2 image goes through the SIMD paths of both kernels, and its smallest levels through plain C.
+void test_image_kernels(struct FG_GraphicsInterface* b, FG_Context* context)
+{
+  const char* shader_cs = "#version 430\n"
+                          "layout(local_size_x=1) in;\n"
+
+                          "layout(binding=0) uniform sampler2D tex;\n"
+                          "layout(std430, binding=0) buffer outblock { vec4 texels[4]; ivec4 sizes[4]; };\n"
+
+                          "void main() {\n"
+                          "   for(int i = 0; i < 4; ++i) {\n"
+                          "     texels[i] = texelFetch(tex, ivec2(0), i);\n"
+                          "     sizes[i] = ivec4(textureSize(tex, i), textureQueryLevels(tex), 0);\n"
+                          "   }\n"
+                          "}\n";
+
+  typedef struct
+  {
+    float texels[4][4];
+    int sizes[4][4];
+  } Levels;
+
+  FG_Vec3i one       = { 1, 1, 1 };
+  FG_Vec2i size      = { 8, 2 };
+  FG_Sampler mipmaps = { FG_Filter_Min_Mag_Mip_Point };
+  mipmaps.max_lod    = 16.0f;
+  uint8_t image[8 * 2 * 4];
+
+  uintptr_t pipeline =
+    (*b->createComputePipeline)(b, context, (*b->compileShader)(b, context, FG_ShaderStage_Compute, shader_cs), one, 0);
+  FG_Resource outbuf = (*b->createBuffer)(b, context, NULL, sizeof(Levels), FG_Usage_Storage_Buffer);
+  TEST(pipeline != 0 && outbuf != 0);
+
+  static const FG_ShaderParameter params[] = { { 0, 0, 0, 0, FG_Shader_Type_Texture },
+                                               { "outblock", 0, 0, 0, FG_Shader_Type_Buffer } };
+
+  // Odd cases are sRGB, which has to be filtered in linear space, and the last two are premultiplied.
+  for(int i = 0; i < 4; ++i)
+  {
+    const bool srgb        = (i & 1) != 0;
+    const bool premultiply = i >= 2;
+
+    // A checkerboard of black and full red averages to half red in every smaller level. Filtering the sRGB bytes
+    // directly would read back as about 0.21 instead. Premultiplying full red by half alpha also gives half red.
+    for(int p = 0; p < size.x * size.y; ++p)
+    {
+      image[p * 4 + 0] = premultiply ? 255 : (((p % size.x) ^ (p / size.x)) & 1) ? 255 : 0;
+      image[p * 4 + 1] = 0;
+      image[p * 4 + 2] = 0;
+      image[p * 4 + 3] = premultiply ? 128 : 255;
+    }
+
+    FG_Resource texture = (*b->createTexture)(b, context, size, FG_Usage_Texture2D,
+                                              srgb ? FG_PixelFormat_R8G8B8A8_UNorm_SRGB : FG_PixelFormat_R8G8B8A8_UNorm,
+                                              &mipmaps, image, 0, premultiply ? FG_TextureFlag_Premultiply : 0);
+    TEST(texture != 0);
+
+    FG_ShaderValue values[2];
+    values[0].resource = texture;
+    values[1].resource = outbuf;
+    void* commands     = (*b->createCommandList)(b, context, false);
+    TEST((*b->setPipelineState)(b, commands, pipeline) == 0);
+    TEST((*b->setShaderConstants)(b, commands, params, values, 2) == 0);
+    TEST((*b->dispatch)(b, commands) == 0);
+    TEST((*b->syncPoint)(b, commands, FG_BarrierFlag_Buffer) == 0);
+    TEST((*b->execute)(b, context, commands) == 0);
+    (*b->destroyCommandList)(b, context, commands);
+
+    Levels* levels = (Levels*)(*b->mapResource)(b, context, outbuf, 0, 0, FG_Usage_Storage_Buffer, FG_AccessFlag_Read);
+    TEST(levels != NULL);
+    if(levels)
+    {
+      // MipSize clamps each axis to 1 separately, so the chain goes 8x2, 4x1, 2x1 and 1x1.
+      for(int l = 0; l < 4; ++l)
+      {
+        TEST(levels->sizes[l][0] == (size.x >> l) && levels->sizes[l][1] == (l > 0 ? 1 : 2));
+        TEST(levels->sizes[l][2] == 4);
+        TEST(fabsf(levels->texels[l][3] - (premultiply ? 128 / 255.0f : 1.0f)) < 0.005f);
+        if(l > 0 || premultiply)
+        {
+          TEST(fabsf(levels->texels[l][0] - 0.5f) < 0.02f);
+        }
+        else
+        {
+          TEST(levels->texels[l][0] == 0.0f);
+        }
+        TEST(levels->texels[l][1] == 0.0f && levels->texels[l][2] == 0.0f);
+      }
+      TEST((*b->unmapResource)(b, context, outbuf, FG_Usage_Storage_Buffer) == 0);
+    }
+    TEST((*b->destroyResource)(b, context, texture) == 0);
+  }
+
+  TEST((*b->destroyResource)(b, context, outbuf) == 0);
+  TEST((*b->destroyPipelineState)(b, context, pipeline) == 0);
+}
+
+// GL reports arrays as "name[0]", which is how callers often name them too, even though only the base name is stored.
+void test_uniform_arrays(struct FG_GraphicsInterface* b, FG_Context* context)
+{
+  const char* shader_cs = "#version 430\n"
+                          "layout(local_size_x=1) in;\n"
+
+                          "uniform int scale[2];\n"
+                          "layout(std430, binding=0) buffer outblock { int result[]; };\n"
+
+                          "void main() { result[0] = scale[0] + scale[1]; }\n";
+
+  FG_Vec3i one       = { 1, 1, 1 };
+  int zero[1]        = { 0 };
+  uintptr_t pipeline =
+    (*b->createComputePipeline)(b, context, (*b->compileShader)(b, context, FG_ShaderStage_Compute, shader_cs), one, 0);
+  FG_Resource outbuf = (*b->createBuffer)(b, context, zero, sizeof(zero), FG_Usage_Storage_Buffer);
+  TEST(pipeline != 0 && outbuf != 0);
+
+  static const FG_ShaderParameter params[] = { { "outblock", 0, 0, 0, FG_Shader_Type_Buffer },
+                                               { "scale[0]", 1, 0, 0, FG_Shader_Type_Int } };
+  uintptr_t prepared = (*b->prepareShaderParameters)(b, context, pipeline, params + 1, 1);
+  TEST(prepared != 0);
+
+  // The first pass sets the array by name, the second through the prepared parameters.
+  for(int i = 0; i < 2; ++i)
+  {
+    FG_ShaderValue values[2];
+    values[0].resource = outbuf;
+    values[1].i32      = 7 + i;
+    void* commands     = (*b->createCommandList)(b, context, false);
+    TEST((*b->setPipelineState)(b, commands, pipeline) == 0);
+    TEST((*b->setShaderConstants)(b, commands, params, values, i == 0 ? 2 : 1) == 0);
+    if(i > 0)
+    {
+      TEST((*b->setPreparedShaderConstants)(b, commands, prepared, values + 1) == 0);
+    }
+    TEST((*b->dispatch)(b, commands) == 0);
+    TEST((*b->syncPoint)(b, commands, FG_BarrierFlag_Buffer) == 0);
+    TEST((*b->execute)(b, context, commands) == 0);
+    (*b->destroyCommandList)(b, context, commands);
+
+    int* result = (int*)(*b->mapResource)(b, context, outbuf, 0, 0, FG_Usage_Storage_Buffer, FG_AccessFlag_Read);
+    TEST(result != NULL);
+    if(result)
+    {
+      TEST(result[0] == values[1].i32);
+      TEST((*b->unmapResource)(b, context, outbuf, FG_Usage_Storage_Buffer) == 0);
+    }
+  }
+
+  TEST((*b->destroyShaderParameters)(b, context, prepared) == 0);
+  TEST((*b->destroyResource)(b, context, outbuf) == 0);
+  TEST((*b->destroyPipelineState)(b, context, pipeline) == 0);
+}
+
+struct LoadTest
+{
+  struct FG_GraphicsInterface* graphics;
+  FG_Resource buffer;
+};
+
+// Runs on the bridge's loader thread, with its own context.
+void load_buffer(void* user, FG_Context* context)
+{
+  struct LoadTest* load = (struct LoadTest*)user;
+  float data[4]         = { 0.f, 1.f, 2.f, 3.f };
+  load->buffer = (*load->graphics->createBuffer)(load->graphics, context, data, sizeof(data), FG_Usage_Vertex_Data);
+}
+
+// Runs in finishLoads, with the window's context, once the GPU is done with the load.
+void finish_buffer(void* user, FG_Context* context)
+{
+  struct LoadTest* load = (struct LoadTest*)user;
+  TEST(load->buffer != 0);
+  TEST((*load->graphics->destroyResource)(load->graphics, context, load->buffer) == 0);
+  load->buffer = 0;
+}
+
+// Runs in finishReadbacks once the GPU has copied the pixel into the staging buffer.
+void read_pixel(void* user, const void* data, uint32_t bytes)
+{
+  TEST(data != NULL && bytes == 4);
+  if(data)
+    memcpy(user, data, 4);
+}
+
+// Texture containers are written out at test time, so streaming doesn't depend on any asset. Fields are little-endian,
+// like every machine this runs on.
+size_t put_u32(uint8_t* out, size_t at, uint32_t v)
+{
+  memcpy(out + at, &v, sizeof(v));
+  return at + sizeof(v);
+}
+
+// A single-level KTX2 file of 8-bit RGBA texels, which are left out if pixels is NULL.
+size_t make_ktx2(uint8_t* out, uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+  static const uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+  const uint64_t bytes                = (uint64_t)width * height * 4;
+  size_t at                           = sizeof(identifier);
+  memcpy(out, identifier, sizeof(identifier));
+  at = put_u32(out, at, 37); // VK_FORMAT_R8G8B8A8_UNORM
+  at = put_u32(out, at, 1);
+  at = put_u32(out, at, width);
+  at = put_u32(out, at, height);
+  at = put_u32(out, at, 0);
+  at = put_u32(out, at, 0);
+  at = put_u32(out, at, 1); // faceCount
+  at = put_u32(out, at, 1); // levelCount
+  for(int i = 0; i < 9; ++i) // No supercompression, or any of the optional blocks
+    at = put_u32(out, at, 0);
+  at = put_u32(out, at, 104); // The one level follows its index entry
+  at = put_u32(out, at, 0);
+  for(int i = 0; i < 2; ++i)
+  {
+    at = put_u32(out, at, (uint32_t)bytes);
+    at = put_u32(out, at, (uint32_t)(bytes >> 32));
+  }
+  if(pixels)
+  {
+    memcpy(out + at, pixels, (size_t)bytes);
+    at += (size_t)bytes;
+  }
+  return at;
+}
+
+// A single-level DDS file with a legacy header describing 8-bit RGBA by its channel masks.
+size_t make_dds(uint8_t* out, uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+  memset(out, 0, 128);
+  memcpy(out, "DDS ", 4);
+  put_u32(out, 4, 124);
+  put_u32(out, 8, 0x100F); // Caps, height, width, pitch and pixel format are set
+  put_u32(out, 12, height);
+  put_u32(out, 16, width);
+  put_u32(out, 20, width * 4);
+  put_u32(out, 28, 1);
+  put_u32(out, 76, 32);
+  put_u32(out, 80, 0x41); // DDPF_RGB | DDPF_ALPHAPIXELS
+  put_u32(out, 88, 32);
+  put_u32(out, 92, 0x000000FF);
+  put_u32(out, 96, 0x0000FF00);
+  put_u32(out, 100, 0x00FF0000);
+  put_u32(out, 104, 0xFF000000);
+  put_u32(out, 108, 0x1000); // DDSCAPS_TEXTURE
+  if(!pixels)
+    return 128;
+  memcpy(out + 128, pixels, (size_t)width * height * 4);
+  return 128 + (size_t)width * height * 4;
+}
+
+bool write_file(const char* path, const uint8_t* data, size_t bytes)
+{
+  FILE* f = fopen(path, "wb");
+  if(!f)
+    return false;
+  bool written = fwrite(data, 1, bytes, f) == bytes;
+  return fclose(f) == 0 && written;
+}
+
 int main(int argc, char* argv[])
 {
   struct FG_GraphicsInterface* b          = BACKEND(NULL, FakeLog);
   struct FG_DesktopInterface* desktop     = fgGLFW(NULL, FakeLog, behavior);
   struct FG_GraphicsDesktopBridge* bridge = BRIDGE(b, NULL, FakeLog);
   
-  struct UIState state = { b, bridge };
+  struct UIState state = { b, bridge, desktop };
 
   if(!b)
   {
@@ -448,6 +762,14 @@ int main(int argc, char* argv[])
   FG_Window* w = (*desktop->createWindow)(desktop, (uintptr_t)(&e), NULL, &pos, &dim, "Feather Test", e.flags);
   TEST(w != NULL);
   TEST(!(*bridge->emplaceContext)(bridge, w, FG_PixelFormat_R8G8B8A8_Typeless));
+  TEST((*bridge->setFramePacing)(bridge, w, -1, false) == 0);
+  FG_PresentTiming timing;
+  TEST((*bridge->getPresentTiming)(bridge, w, &timing) == 0);
+  TEST(timing.refresh_interval > 0.0);
+  TEST((*bridge->waitForFrame)(bridge, w) == 0);
+
+  struct LoadTest load = { b, 0 };
+  TEST((*bridge->queueLoad)(bridge, w, &load_buffer, &finish_buffer, &load) == 0);
 
   if(!w)
   {
@@ -458,7 +780,11 @@ int main(int argc, char* argv[])
   e.caps = (*b->getCaps)(b);
 
   if(e.caps.features & FG_Feature_Compute_Shader)
+  {
     test_compute(b, w);
+    test_image_kernels(b, w->context);
+    test_uniform_arrays(b, w->context);
+  }
 
   FG_Vec2i fakedim = { 200, 200 };
   void* fakedata   = malloc(fakedim.x * (size_t)fakedim.y * 4);
@@ -466,7 +792,13 @@ int main(int argc, char* argv[])
 
   FG_Sampler sampler = { FG_Filter_Min_Mag_Mip_Linear };
   e.image    = (*b->createTexture)(b, w->context, fakedim, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless, &sampler,
-                                fakedata, 0);
+                                fakedata, 0, 0);
+
+  // Brighten the top left quarter of the image after the fact, which goes through the staging buffer.
+  FG_Vec2i origin = { 0, 0 };
+  FG_Vec2i corner = { fakedim.x / 2, fakedim.y / 2 };
+  memset(fakedata, 255, corner.x * (size_t)corner.y * 4);
+  TEST((*b->updateTexture)(b, w->context, e.image, 0, origin, corner, FG_PixelFormat_R8G8B8A8_Typeless, fakedata) == 0);
   e.vertices = (*b->createBuffer)(b, w->context, verts, sizeof(verts), FG_Usage_Vertex_Data);
   int vertstride = sizeof(verts[0]);
 
@@ -482,7 +814,8 @@ int main(int argc, char* argv[])
                    FG_Pipeline_Flag_Scissor_Enable; // | FG_PIPELINE_FLAG_RENDERTARGET_SRGB_ENABLE
 
   FG_Resource RenderTarget0 =
-    (*b->createTexture)(b, w->context, WindowDim, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless, &sampler, NULL, 0);
+    (*b->createTexture)(b, w->context, WindowDim, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless, &sampler, NULL,
+                        0, 0);
   FG_Resource rts[1]      = { RenderTarget0 };
   FG_Resource framebuffer = (*b->createRenderTarget)(b, w->context, 0, rts, 1, 0);
   e.pipeline = (*b->createPipelineState)(b, w->context, &pipeline, framebuffer, &Premultiply_Blend, &e.vertices,
@@ -493,7 +826,8 @@ int main(int argc, char* argv[])
   behavior(w, &drawmsg, &state, (uintptr_t)(&e));
 
   FG_Resource CopiedTexture =
-    (*b->createTexture)(b, w->context, WindowDim, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless, &sampler, NULL, 0);
+    (*b->createTexture)(b, w->context, WindowDim, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless, &sampler, NULL,
+                        0, 0);
   void* commands = (*b->createCommandList)(b, w->context, false);
 
   FG_Vec3i vec3zero   = { 0 };
@@ -502,6 +836,14 @@ int main(int argc, char* argv[])
   (*b->execute)(b, w->context, commands);
   (*b->destroyCommandList)(b, w->context, commands);
 
+  // The window's backbuffer is the default framebuffer, which has nothing to attach. What it holds after a swap is
+  // undefined, so only the readback itself is checked.
+  FG_Vec2i windowpixel  = { 1, 1 };
+  uint8_t windowrgba[4] = { 0 };
+  TEST((*b->readTexture)(b, w->context, 0, origin, windowpixel, FG_PixelFormat_R8G8B8A8_Typeless, read_pixel,
+                         windowrgba) == 0);
+  TEST((*b->finishReadbacks)(b, w->context, true) == 1);
+
   if(e.caps.features & FG_Feature_Mesh_Shader)
     e.mesh_pipeline = load_mesh(b, w);
 
@@ -538,12 +880,227 @@ int main(int argc, char* argv[])
   }
 
   TEST((*desktop->getClipboard)(desktop, w, FG_Clipboard_Wave, hold, 10) == 0)
-  while((*desktop->processMessages)(desktop, NULL, &state) != 0 && e.close == false)
-    ;
+  TEST((*desktop->getCoalescedEvents)(desktop, w, NULL, 0) == 0);
+  TEST((*desktop->setInputCoalescing)(desktop, w, true) == 0);
+  TEST((*desktop->wakeMessages)(desktop) == 0);
+  TEST((*desktop->waitMessages)(desktop, NULL, &state, -1.0) != 0);
+
+  // Nothing here animates, so the loop sleeps until the window has something to handle or a load has finished. The
+  // window destroys itself once it's closed, after which waitMessages reports that no windows are left.
+  while((*desktop->waitMessages)(desktop, NULL, &state, -1.0) != 0 && e.close == false)
+    (*bridge->finishLoads)(bridge, w);
+  TEST(e.close);
+  TEST((*desktop->processMessages)(desktop, NULL, &state) == 0);
+
+  // A headless context doesn't need the window, but it does leave itself current, so it comes after everything else.
+  if(e.caps.features & FG_Feature_Headless)
+  {
+    FG_Vec2i size        = { 64, 64 };
+    FG_Context* headless = (*b->createContext)(b, size, FG_PixelFormat_R8G8B8A8_Typeless);
+    TEST(headless != NULL);
+    void* commands   = (*b->createCommandList)(b, headless, false);
+    FG_Color16 color = { 0 };
+    FG_Vec2i origin  = { 0, 0 };
+    FG_Vec2i pixel   = { 1, 1 };
+    uint8_t rgba[4]  = { 0 };
+    color.r          = 0xFFFF;
+    color.a          = 0xFFFF;
+    TEST((*b->beginDraw)(b, headless, NULL) == 0);
+    TEST((*b->beginRegion)(b, commands, NULL) != 0);
+    TEST((*b->beginRegion)(b, commands, "clear") == 0);
+    TEST((*b->clear)(b, commands, FG_ClearFlag_Color | FG_ClearFlag_Depth, color, 0, 1.0f, 0, NULL) == 0);
+    TEST((*b->endRegion)(b, commands) == 0);
+    TEST((*b->execute)(b, headless, commands) == 0);
+    TEST((*b->readTexture)(b, headless, 0, origin, pixel, FG_PixelFormat_R8G8B8A8_Typeless, read_pixel, rgba) == 0);
+    TEST((*b->finishReadbacks)(b, headless, true) == 1);
+    TEST(rgba[0] == 0xFF && rgba[1] == 0 && rgba[3] == 0xFF);
+
+    // Timings only come back a few frames later, and not at all without timer queries, but whatever does come back
+    // carries the region's name.
+    FG_FrameStats stats = { 0 };
+    for(int i = 0; i < 4; ++i)
+    {
+      TEST((*b->endDraw)(b, headless) == 0);
+      TEST((*b->beginDraw)(b, headless, NULL) == 0);
+      TEST((*b->beginRegion)(b, commands, "clear") == 0);
+      TEST((*b->clear)(b, commands, FG_ClearFlag_Color, color, 0, 1.0f, 0, NULL) == 0);
+      TEST((*b->endRegion)(b, commands) == 0);
+      TEST((*b->execute)(b, headless, commands) == 0);
+    }
+    TEST((*b->getFrameStats)(b, headless, &stats) == 0);
+    TEST(stats.n_regions <= 1);
+    if(stats.n_regions == 1)
+    {
+      TEST(stats.regions[0].name != NULL && strcmp(stats.regions[0].name, "clear") == 0);
+    }
+
+    // Clearing rects only touches the pixels inside them, whether they go through scissored glClears or, once there are
+    // enough of them, a single draw. Right and bottom edges are exclusive.
+    FG_Rect boxes[4]     = { { { 8, 8, 16, 16 } }, { { 40, 8, 48, 16 } }, { { 8, 40, 16, 48 } }, { { 40, 40, 48, 48 } } };
+    FG_Vec2i probes[4]   = { { 8, 8 }, { 15, 15 }, { 16, 15 }, { 7, 8 } };
+    FG_Color16 opaque    = { 0 };
+    FG_Color16 green     = { 0 };
+    uint8_t probed[4][4] = { { 0 } };
+    opaque.a             = 0xFFFF;
+    green.g              = 0xFFFF;
+    green.a              = 0xFFFF;
+    for(int n = 1; n <= 4; n += 3)
+    {
+      TEST((*b->clear)(b, commands, FG_ClearFlag_Color, opaque, 0, 1.0f, 0, NULL) == 0);
+      TEST((*b->clear)(b, commands, FG_ClearFlag_Color, green, 0, 1.0f, n, boxes) == 0);
+      TEST((*b->execute)(b, headless, commands) == 0);
+      for(int i = 0; i < 4; ++i)
+      {
+        TEST((*b->readTexture)(b, headless, 0, probes[i], pixel, FG_PixelFormat_R8G8B8A8_Typeless, read_pixel,
+                               probed[i]) == 0);
+      }
+      TEST((*b->finishReadbacks)(b, headless, true) == 4);
+      for(int i = 0; i < 4; ++i)
+      {
+        TEST(probed[i][0] == 0 && probed[i][1] == (i < 2 ? 0xFF : 0) && probed[i][3] == 0xFF);
+      }
+    }
+
+    // A released transient target comes back from the pool the next time the same kind is asked for.
+    FG_Sampler linear   = { FG_Filter_Min_Mag_Mip_Linear };
+    FG_Resource texture = 0;
+    FG_Resource target  = (*b->acquireRenderTarget)(b, headless, pixel, FG_PixelFormat_R8G8B8A8_Typeless, 0,
+                                                    FG_ClearFlag_Depth, &linear, &texture);
+    TEST(target != 0 && texture != 0);
+    TEST((*b->releaseRenderTarget)(b, headless, target) == 0);
+    TEST((*b->acquireRenderTarget)(b, headless, pixel, FG_PixelFormat_R8G8B8A8_Typeless, 0, FG_ClearFlag_Depth,
+                                   &linear, &texture) == target);
+    TEST((*b->releaseRenderTarget)(b, headless, target) == 0);
+
+    // A multisampled target gets a different one, and its sampler is ignored instead of failing to apply.
+    FG_Resource msaa = (*b->acquireRenderTarget)(b, headless, pixel, FG_PixelFormat_R8G8B8A8_Typeless, 4,
+                                                 FG_ClearFlag_Depth, &linear, &texture);
+    TEST(msaa != 0 && msaa != target && texture != 0);
+    TEST((*b->releaseRenderTarget)(b, headless, msaa) == 0);
+
+    // The pool still holds the target, so its color texture and depth renderbuffer are both counted.
+    FG_MemoryReport memory = { 0 };
+    TEST((*b->getMemoryReport)(b, headless, &memory) == 0);
+    TEST(memory.n_textures > 0 && memory.texture_bytes > 0 && memory.n_renderbuffers > 0);
+    TEST(memory.renderbuffer_bytes > 0 && memory.budget == 0);
+
+    // Only a buffer with immutable storage can stay mapped, and anything written through the mapping is visible without
+    // unmapping it.
+    int written[4] = { 1, 2, 3, 4 };
+    FG_Resource mutablebuf = (*b->createBuffer)(b, headless, written, sizeof(written), FG_Usage_Storage_Buffer);
+    uint32_t access        = FG_AccessFlag_Read | FG_AccessFlag_Write | FG_AccessFlag_Persistent;
+    FG_Resource persistent = (*b->createImmutableBuffer)(b, headless, NULL, sizeof(written), FG_Usage_Storage_Buffer,
+                                                         access);
+    TEST(mutablebuf != 0 && persistent != 0);
+    TEST((*b->mapResource)(b, headless, mutablebuf, 0, 0, FG_Usage_Storage_Buffer,
+                           FG_AccessFlag_Write | FG_AccessFlag_Persistent) == NULL);
+    int* mapped = (int*)(*b->mapResource)(b, headless, persistent, 0, 0, FG_Usage_Storage_Buffer, access);
+    TEST(mapped != NULL);
+    if(mapped)
+    {
+      memcpy(mapped, written, sizeof(written));
+      TEST(mapped[3] == 4);
+      TEST((*b->unmapResource)(b, headless, persistent, FG_Usage_Storage_Buffer) == 0);
+    }
+    TEST((*b->destroyResource)(b, headless, mutablebuf) == 0);
+    TEST((*b->destroyResource)(b, headless, persistent) == 0);
+
+    // A destroyed handle is rejected, even once GL has handed its name to a new buffer, as long as handles are wide
+    // enough to carry a generation.
+    TEST((*b->destroyResource)(b, headless, mutablebuf) != 0);
+    TEST((*b->readBuffer)(b, headless, mutablebuf, 0, 0, read_pixel, rgba) != 0);
+    FG_Resource reused = (*b->createBuffer)(b, headless, written, sizeof(written), FG_Usage_Storage_Buffer);
+    TEST(reused != 0);
+    if(sizeof(FG_Resource) > sizeof(uint32_t))
+    {
+      TEST(reused != mutablebuf);
+      TEST((*b->mapResource)(b, headless, mutablebuf, 0, 0, FG_Usage_Storage_Buffer, FG_AccessFlag_Read) == NULL);
+    }
+    TEST((*b->destroyResource)(b, headless, reused) == 0);
+
+    // A 2x1 texture streamed out of either container reads back what was written into it, and a width no driver can
+    // allocate is rejected before anything is sized from it.
+    const uint8_t texels[8] = { 0x10, 0x20, 0x30, 0xFF, 0x40, 0x50, 0x60, 0xFF };
+    const char* paths[2]    = { "backendtest.ktx2", "backendtest.dds" };
+    FG_Vec2i second         = { 1, 0 };
+    uint8_t fixture[256];
+    for(int i = 0; i < 2; ++i)
+    {
+      size_t len           = i == 0 ? make_ktx2(fixture, 2, 1, texels) : make_dds(fixture, 2, 1, texels);
+      FG_Resource streamed = 0;
+      uint32_t remaining   = 1;
+      TEST(write_file(paths[i], fixture, len));
+      uintptr_t stream = (*b->openTextureStream)(b, headless, paths[i], &linear, &streamed);
+      TEST(stream != 0 && streamed != 0);
+      TEST((*b->streamTexture)(b, headless, stream, 0, &remaining) == 0 && remaining == 0);
+      TEST((*b->closeTextureStream)(b, stream) == 0);
+      TEST((*b->readTexture)(b, headless, streamed, second, pixel, FG_PixelFormat_R8G8B8A8_Typeless, read_pixel,
+                             rgba) == 0);
+      TEST((*b->finishReadbacks)(b, headless, true) == 1);
+      TEST(rgba[0] == 0x40 && rgba[1] == 0x50 && rgba[2] == 0x60);
+      TEST((*b->destroyResource)(b, headless, streamed) == 0);
+
+      len = i == 0 ? make_ktx2(fixture, 0x80000000u, 1, NULL) : make_dds(fixture, 0x80000000u, 1, NULL);
+      TEST(write_file(paths[i], fixture, len));
+      TEST((*b->openTextureStream)(b, headless, paths[i], &linear, &streamed) == 0);
+      remove(paths[i]);
+    }
 
-  TEST((*b->destroyResource)(b, w->context, e.image) == 0);
-  TEST((*b->destroyPipelineState)(b, w->context, e.pipeline) == 0);
-  TEST((*desktop->destroyWindow)(desktop, w) == 0);
+    TEST((*b->setErrorCheck)(b, FG_ErrorCheck_Always) == 0);
+    TEST((*b->setErrorCheck)(b, (enum FG_ErrorCheck)(FG_ErrorCheck_Off + 1)) != 0);
+
+    // Filling the only page and evicting it in the next frame leaves white texels where the new region's padding goes,
+    // which have to be cleared.
+    FG_Vec2i pagesize     = { 4, 4 };
+    FG_Vec2i full         = { 3, 3 };
+    FG_Vec2i padding      = { 1, 0 };
+    uint8_t white[3 * 3 * 4];
+    uint8_t black[4]      = { 0 };
+    FG_AtlasRegion region = { 0 };
+    memset(white, 0xFF, sizeof(white));
+    uintptr_t atlas = (*b->createAtlas)(b, headless, pagesize, FG_PixelFormat_R8G8B8A8_Typeless, 1);
+    TEST(atlas != 0);
+    TEST((*b->insertAtlasRegion)(b, headless, atlas, 1, full, white, &region) == 0);
+    TEST((*b->endDraw)(b, headless) == 0);
+    TEST((*b->beginDraw)(b, headless, NULL) == 0);
+    TEST((*b->insertAtlasRegion)(b, headless, atlas, 2, pixel, black, &region) == 0);
+    TEST(region.uv.left == 0 && region.uv.top == 0);
+    memset(rgba, 0xFF, sizeof(rgba));
+    TEST((*b->readTexture)(b, headless, region.texture, padding, pixel, FG_PixelFormat_R8G8B8A8_Typeless, read_pixel,
+                           rgba) == 0);
+    TEST((*b->finishReadbacks)(b, headless, true) == 1);
+    TEST(rgba[0] == 0 && rgba[3] == 0);
+    TEST((*b->destroyAtlas)(b, headless, atlas) == 0);
+    TEST((*b->endDraw)(b, headless) == 0);
+    TEST((*b->destroyCommandList)(b, headless, commands) == 0);
+
+    // Unshared contexts hand out the same shader names, so an identical request on another context must not get back
+    // a pipeline whose VAO belongs to the first one.
+    FG_Context* contexts[2]   = { headless, (*b->createContext)(b, size, FG_PixelFormat_R8G8B8A8_Typeless) };
+    uintptr_t pipelines[2]    = { 0 };
+    FG_PipelineState shared   = { 0 };
+    shared.members            = FG_Pipeline_Member_PS | FG_Pipeline_Member_VS | FG_Pipeline_Member_Primitive;
+    shared.primitive          = FG_Primitive_Triangle_Strip;
+    TEST(contexts[1] != NULL);
+    for(int i = 0; i < 2; ++i)
+    {
+      TEST((*b->beginDraw)(b, contexts[i], NULL) == 0);
+      shared.shaders[FG_ShaderStage_Pixel]  = (*b->compileShader)(b, contexts[i], FG_ShaderStage_Pixel, shader_fs);
+      shared.shaders[FG_ShaderStage_Vertex] = (*b->compileShader)(b, contexts[i], FG_ShaderStage_Vertex, shader_vs);
+      pipelines[i] = (*b->createPipelineState)(b, contexts[i], &shared, 0, &Premultiply_Blend, 0, 0, 0, 0, 0, 0, 0);
+      TEST(pipelines[i] != 0);
+      TEST((*b->endDraw)(b, contexts[i]) == 0);
+    }
+    TEST(pipelines[0] != pipelines[1]);
+    for(int i = 0; i < 2; ++i)
+    {
+      TEST((*b->beginDraw)(b, contexts[i], NULL) == 0);
+      TEST((*b->destroyPipelineState)(b, contexts[i], pipelines[i]) == 0);
+      TEST((*b->endDraw)(b, contexts[i]) == 0);
+    }
+    TEST((*b->destroyContext)(b, contexts[1]) == 0);
+    TEST((*b->destroyContext)(b, headless) == 0);
+  }
   (*bridge->destroy)(bridge);
   (*desktop->destroy)(desktop);
   (*b->destroy)(b);
@@ -3,8 +3,52 @@
 using import struct
 using import .event
 
+let C =
+    include
+        """"#include <pthread.h>
+
 struct Event
 
+let MAX_SPARE_EVENTS = 4096:u32 # Enough for a frame's worth of in-flight promises, without hoarding after a spike
+
+struct EventPort
+    """"Where a loop sleeps once it runs out of events, and what other threads poke after posting it one. Holds a mutex,
+        which can't be moved once it's in use, so call `init` on a port only after putting it where it will stay.
+    _lock : C.typedef.pthread_mutex_t
+    _signal : C.typedef.pthread_cond_t
+    _woken : bool = false
+
+    fn init (self)
+        C.extern.pthread_mutex_init (& self._lock) null
+        C.extern.pthread_cond_init (& self._signal) null
+        self._woken = false
+
+    fn __drop (self)
+        C.extern.pthread_cond_destroy (& self._signal)
+        C.extern.pthread_mutex_destroy (& self._lock)
+
+    fn wake (self)
+        """"Wakes whatever is sleeping in `wait`, or makes the next call return at once if nothing is yet. Safe to call
+            from any thread.
+        C.extern.pthread_mutex_lock (& self._lock)
+        self._woken = true
+        C.extern.pthread_cond_signal (& self._signal)
+        C.extern.pthread_mutex_unlock (& self._lock)
+
+    fn wait (self)
+        """"Sleeps until someone calls `wake`. A wake that happened since the last wait counts, so posting between a
+            loop finding nothing to do and going to sleep can't be missed.
+        C.extern.pthread_mutex_lock (& self._lock)
+        while (not self._woken)
+            C.extern.pthread_cond_wait (& self._signal) (& self._lock)
+        self._woken = false
+        C.extern.pthread_mutex_unlock (& self._lock)
+
+    fn set-runnable (self runnable)
+        # Whatever sleeps here, like a UI toolkit waiting for input, should go back to running the loop.
+        if runnable
+            'wake self
+
 let insertionPoint = (mutable@ (mutable@ Event))
 
 struct EventLoop
@@ -15,6 +59,48 @@ struct EventLoop
     _depth-first-insert-point : insertionPoint
     _breadth-first-insert-point : insertionPoint
     _currently-firing : (mutable@ Event)
+    _port : (mutable@ EventPort)
+    _posted : (mutable@ Event) # Pushed onto by any thread, only ever taken all at once by the one running the loop
+    _spare-events : (mutable@ Event) # Fired events kept for reuse, linked through _posted-next
+    _spare-count : u32 = 0
+
+    fn __drop (self)
+        local event = self._spare-events
+        while (event != null)
+            let next = event._posted-next
+            free event
+            event = next
+        self._spare-events = null
+        self._spare-count = 0
+
+    fn new-event (self fire-impl)
+        """"Allocates an event for this loop that calls `fire-impl` when it fires, reusing one that already fired if
+            there is one, so a loop that keeps about as many events in flight from frame to frame stops allocating.
+            Only call this from the thread running the loop, other threads allocate through their own loops and post.
+            This is how events handed to `post` and LoopPool.spawn should be made, since firing recycles them.
+        let event =
+            if (self._spare-events != null)
+                let event = self._spare-events
+                self._spare-events = event._posted-next
+                self._spare-count -= 1
+                event
+            else
+                malloc Event
+        store
+            Event
+                _fire-impl = fire-impl
+                _loop = &self
+            event
+        event
+
+    fn recycle-event (self event)
+        # Each event is its own allocation, so one recycled by a loop other than the one that made it is still fine.
+        if (self._spare-count < MAX_SPARE_EVENTS)
+            event._posted-next = self._spare-events
+            self._spare-events = event
+            self._spare-count += 1
+        else
+            free event
 
     fn running? (self)
         self._running
@@ -50,35 +136,98 @@ struct EventLoop
 
     fn run (self max-turn-count)
         self._running = true
+        'take-posted self
         for x in (range max-turn-count)
             if (not ('turn self))
-                break;
+                # Picking up what other threads posted while this ran saves a trip through the port.
+                if (not ('take-posted self))
+                    break;
 
         self._running = false
         'set-runnable self ('runnable? self)
 
     fn runnable? (self)
-        self.head != null
+        self._head != null
 
     fn set-runnable (self runnable)
         if (runnable != self._last-runnable-state)
-            #TODO: if there is a port, update the port
+            if (self._port != null)
+                'set-runnable (@ self._port) runnable
         self._last-runnable-state = runnable
 
-
-
-global thread-local-event-loop : (@ EventLoop) # need to actually make this thread-local at some point
-
+    fn post (self event)
+        """"Arms `event` on this loop from any thread, breadth-first, the next time the loop runs, and wakes the loop's
+            port if it's asleep. This is the only way to hand a loop work from a thread that isn't running it. The event
+            must not be armed already.
+        event._loop = &self
+        # A lock-free stack, so posting never waits on the loop or on other posters. A stale head only costs one more
+        # round, because the exchange fails and hands back the current one.
+        local head = (deref self._posted)
+        loop ()
+            event._posted-next = head
+            let old ok = (cmpxchg (& self._posted) head event)
+            if ok
+                break;
+            head = old
+        if (self._port != null)
+            'wake (@ self._port)
+
+    fn take-posted (self)
+        """"Arms everything other threads have posted, in the order they posted it. Returns true if there was anything.
+        local event = (atomicrmw xchg (& self._posted) (nullof (mutable@ Event)))
+        # The stack comes out newest first.
+        local ordered = (nullof (mutable@ Event))
+        while (event != null)
+            let next = event._posted-next
+            event._posted-next = ordered
+            ordered = event
+            event = next
+        let any? = (ordered != null)
+        while (ordered != null)
+            let next = ordered._posted-next
+            ordered._posted-next = null
+            'arm-breadth-first (@ ordered)
+            ordered = next
+        any?
+
+    fn wait (self)
+        """"Sleeps on the loop's port until another thread posts something, and arms it. Returns false at once if the
+            loop has no port, because then nothing could ever wake it.
+        if (self._port == null)
+            return false
+        loop ()
+            if ('take-posted self)
+                break true
+            'wait (@ self._port)
+
+global event-loop-tls-key : C.typedef.pthread_key_t
+global event-loop-key-state : u32 # 0 until a thread starts creating the key, 1 while it does, 2 once it exists
+
+fn event-loop-key ()
+    # Creates the key the first time any thread asks for it, without needing a lock to make sure only one does.
+    loop ()
+        let state = (atomicrmw or (& event-loop-key-state) 0:u32)
+        if (state == 2:u32)
+            break (deref event-loop-tls-key)
+        if (state == 0:u32)
+            let _ ok = (cmpxchg (& event-loop-key-state) 0:u32 1:u32)
+            if ok
+                C.extern.pthread_key_create (& event-loop-tls-key) null
+                atomicrmw xchg (& event-loop-key-state) 2:u32
+
+fn current-event-loop ()
+    """"The loop a WaitScope bound to the calling thread, or null. Every thread has its own.
+    (C.extern.pthread_getspecific (event-loop-key)) as (mutable@ EventLoop)
 
 type WaitScope :: Nothing
-    fn __typecall(eventloop)
-        if (thread-local-event-loop != null)
+    fn __typecall (cls eventloop)
+        if ((current-event-loop) != null)
             error "WaitScope constructed while an event loop is already bound"
         else
-            thread-local-event-loop = eventloop
+            C.extern.pthread_setspecific (event-loop-key) ((& eventloop) as voidstar)
             (bitcast none this-type)
-    fn __drop(self)
-        thread-local-event-loop = null
+    fn __drop (self)
+        C.extern.pthread_setspecific (event-loop-key) null
 
 struct Event
     _fire-impl : (Capture (Capture.function (@ this-type)))
@@ -86,6 +235,7 @@ struct Event
     _next : (mutable@ Event)
     _prev : (mutable@ (mutable@ Event))
     _firing : bool = false
+    _posted-next : (mutable@ Event)
 
     _live : u32 = magic-live-value
     _source-location : Anchor
@@ -105,7 +255,11 @@ struct Event
         self._fire-impl (& self)
         drop self._fire-impl
         self._live = 0
-        free self
+        # Events only fire on the thread running their loop, so its spare list needs no locking.
+        if (self._loop != null)
+            'recycle-event (@ self._loop) (& self)
+        else
+            free (& self)
 
     fn arm-depth-first (self)
         """"Enqueue this event so that `fire()` will be called from the event loop soon.
@@ -122,8 +276,9 @@ struct Event
 
             To use breadth-first scheduling instead,
             use `armBreadthFirst()`.
-        if (and (ptrcmp!= thread-local-event-loop self._loop) (ptrcmp!= thread-local-event-loop null))
-            report "FATAL: Event armed from different thread than it was created in. You must use Executor to queue events cross-thread."
+        let current = (current-event-loop)
+        if (and (ptrcmp!= current self._loop) (ptrcmp!= current null))
+            report "FATAL: Event armed from different thread than it was created in. You must use EventLoop.post to queue events cross-thread."
             abort;
         elseif (!= self._live magic-live-value)
             report "ASSERTION FAILURE: tried to arm Event after it was destroyed" # should log event source location?
@@ -146,8 +301,9 @@ struct Event
 
     fn arm-breadth-first (self)
         """"Like `armDepthFirst()` except that the event is placed at the end of the queue.
-        if (and (ptrcmp!= thread-local-event-loop self._loop) (ptrcmp!= thread-local-event-loop null))
-            report "FATAL: Event armed from different thread than it was created in. You must use Executor to queue events cross-thread."
+        let current = (current-event-loop)
+        if (and (ptrcmp!= current self._loop) (ptrcmp!= current null))
+            report "FATAL: Event armed from different thread than it was created in. You must use EventLoop.post to queue events cross-thread."
             abort;
         elseif (!= self._live magic-live-value)
             report "ASSERTION FAILURE: tried to arm Event after it was destroyed" # should log event source location?
@@ -168,8 +324,9 @@ struct Event
 
     fn arm-last (self)
         """"Enqueues this event to happen after all other events have run to completion and there is really nothing left to do except wait for I/O.
-        if (and (ptrcmp!= thread-local-event-loop self._loop) (ptrcmp!= thread-local-event-loop null))
-            report "FATAL: Event armed from different thread than it was created in. You must use Executor to queue events cross-thread."
+        let current = (current-event-loop)
+        if (and (ptrcmp!= current self._loop) (ptrcmp!= current null))
+            report "FATAL: Event armed from different thread than it was created in. You must use EventLoop.post to queue events cross-thread."
             abort;
         elseif (!= self._live magic-live-value)
             report "ASSERTION FAILURE: tried to arm Event after it was destroyed" # should log event source location?
@@ -207,7 +364,8 @@ struct Event
             cancel it.
             (Destroying the event does this implicitly.)
         if (ptrcmp!= self._prev null)
-            if (and (ptrcmp!= thread-local-event-loop self._loop) (ptrcmp!= thread-local-event-loop null))
+            let current = (current-event-loop)
+            if (and (ptrcmp!= current self._loop) (ptrcmp!= current null))
                 report "FATAL: Promise destroyed from a different thread than it was created in."
                 abort;
             else
@@ -0,0 +1,78 @@
+using import struct
+using import .eventloop
+using import .looppool
+
+let C =
+    include
+        """"#include <pthread.h>
+            #include <unistd.h>
+
+let POSTS = 64:u32
+let STOLEN = 64:u32
+
+global posted-fired : u32
+global stolen-fired : u32
+global blocker-state : u32 # 1 once the blocking task is running, 2 once it saw every other task finish
+
+fn count (counter)
+    atomicrmw add counter 1:u32
+    ;
+
+fn load (counter)
+    atomicrmw or counter 0:u32
+
+struct post-job plain
+    target : (mutable@ EventLoop)
+    count : u32
+
+fn poster (arg)
+    let job = (@ (arg as (mutable@ post-job)))
+    # Events are allocated from the posting thread's own loop, never from the one they're posted to.
+    local own = (EventLoop)
+    for i in (range job.count)
+        'post (@ job.target)
+            'new-event own (capture "count-posted" {} (event) (count (& posted-fired)))
+    nullof voidstar
+let poster-main = (static-typify poster voidstar)
+
+fn posts-from-another-thread ()
+    local port : EventPort
+    'init port
+    local l = (EventLoop)
+    l._port = (& port)
+    local s = (WaitScope l)
+
+    local job = (post-job (& l) POSTS)
+    local thread : C.typedef.pthread_t
+    C.extern.pthread_create (& thread) null poster-main ((& job) as voidstar)
+    while ((load (& posted-fired)) < POSTS)
+        # Sleeps on the port until the other thread posts, instead of giving up once the loop runs dry.
+        if (not ('runnable? l))
+            assert ('wait l)
+        'run l 1000
+    C.extern.pthread_join thread null
+    assert ((load (& posted-fired)) == POSTS)
+
+fn block-until-stolen ()
+    atomicrmw xchg (& blocker-state) 1:u32
+    while ((load (& stolen-fired)) < STOLEN)
+        C.extern.usleep 100
+    atomicrmw xchg (& blocker-state) 2:u32
+
+fn steals-across-workers ()
+    local own = (EventLoop)
+    local pool : LoopPool
+    'start pool 2
+    # The first task ties up its worker until every later one has run, and half of those are spawned onto that same
+    # worker, so they only ever run if the other worker steals them.
+    'spawn pool ('new-event own (capture "block-worker" {} (event) (block-until-stolen)))
+    while ((load (& blocker-state)) == 0:u32)
+        C.extern.usleep 1000
+    for i in (range STOLEN)
+        'spawn pool ('new-event own (capture "count-stolen" {} (event) (count (& stolen-fired))))
+    while ((load (& blocker-state)) != 2:u32)
+        C.extern.usleep 1000
+    assert ((load (& stolen-fired)) == STOLEN)
+
+posts-from-another-thread;
+steals-across-workers;
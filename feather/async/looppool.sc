@@ -0,0 +1,155 @@
+""""A pool of threads that each run their own event loop, for promise chains that don't depend on each other
+
+using import struct
+using import .eventloop
+
+let C =
+    include
+        """"#include <pthread.h>
+            #include <unistd.h>
+
+let TURNS_PER_CHECK = 1000 # Turns a worker runs its loop for before looking for new tasks or a request to stop
+
+# Unclaimed tasks are kept on lock-free stacks of Events. Anyone may push, and anyone may pop, but only by taking the
+# whole stack at once, which is a single exchange and so can't suffer from ABA the way popping one at a time would.
+fn push-tasks (stack first last)
+    local head = (deref (@ stack))
+    loop ()
+        last._posted-next = head
+        let old ok = (cmpxchg stack head first)
+        if ok
+            break;
+        head = old
+
+fn take-tasks (stack)
+    atomicrmw xchg stack (nullof (mutable@ Event))
+
+struct LoopWorker
+    loop : EventLoop
+    port : EventPort
+    tasks : (mutable@ Event) # Spawned onto this worker but not started yet, so any worker may still steal them
+    thread : C.typedef.pthread_t
+    workers : (mutable@ LoopWorker)
+    count : u32
+    index : u32
+    stopping : (mutable@ u32)
+
+    fn claim (self)
+        """"Takes one task for this worker's loop, from its own stack or else from the first sibling that has any.
+            Whatever else came with it goes back onto this worker's stack, and the next worker is woken to come steal
+            it, so a burst of spawns onto one worker still spreads across the pool.
+        local task = (take-tasks (& self.tasks))
+        for i in (range 1:u32 self.count)
+            if (task != null)
+                break;
+            let victim = (self.workers @ ((self.index + i) % self.count))
+            task = (take-tasks (& victim.tasks))
+        if (task == null)
+            return false
+
+        let rest = task._posted-next
+        if (rest != null)
+            local last = rest
+            while (last._posted-next != null)
+                last = last._posted-next
+            push-tasks (& self.tasks) rest last
+            let neighbour = (self.workers @ ((self.index + 1) % self.count))
+            'wake neighbour.port
+
+        task._posted-next = null
+        task._loop = (& self.loop)
+        'arm-breadth-first (@ task)
+        true
+
+fn stopping? (flag)
+    (atomicrmw or flag 0:u32) != 0:u32
+
+let worker-main =
+    static-typify
+        fn "loop-worker" (arg)
+            let worker = (@ (arg as (mutable@ LoopWorker)))
+            local scope = (WaitScope worker.loop)
+            loop ()
+                if (stopping? worker.stopping)
+                    break;
+                # What other threads posted to this loop wakes the same port as a spawn does, so it has to be armed here
+                # or the worker would go straight back to sleep on it.
+                'take-posted worker.loop
+                # Chains already running on this loop go first, new tasks are only claimed once the loop is idle.
+                if (not ('runnable? worker.loop))
+                    if (not ('claim worker))
+                        'wait worker.port
+                        continue;
+                'run worker.loop TURNS_PER_CHECK
+            nullof voidstar
+        voidstar
+
+fn cpu-count ()
+    let n = (C.extern.sysconf C.const._SC_NPROCESSORS_ONLN)
+    ? (n > 0) (n as u32) 1:u32
+
+struct LoopPool
+    """"Runs independent promise chains on several threads at once. Each thread has its own event loop, and a chain
+        stays on the loop that started it, because events can only be armed from the thread that runs their loop.
+        Tasks are handed out round robin, and a worker that runs out of work steals whatever another hasn't started.
+    _workers : (mutable@ LoopWorker)
+    _count : u32
+    _next : u32
+    _stopping : u32
+
+    fn start (self threads)
+        """"Starts `threads` workers, or one per core if it's zero. Like EventPort, the pool must not move afterwards,
+            since the workers point back into it.
+        let threads = (? (threads > 0) (threads as u32) (cpu-count))
+        self._workers = (malloc-array LoopWorker threads)
+        self._count = threads
+        self._next = 0
+        self._stopping = 0
+        # Everything is set up before the first thread starts, so no worker can steal from one that isn't there yet.
+        for i in (range threads)
+            let worker = (self._workers @ i)
+            store
+                LoopWorker
+                    loop = (EventLoop)
+                    workers = self._workers
+                    count = threads
+                    index = i
+                    stopping = (& self._stopping)
+                & worker
+            'init worker.port
+            worker.loop._port = (& worker.port)
+        for i in (range threads)
+            let worker = (self._workers @ i)
+            C.extern.pthread_create (& worker.thread) null worker-main ((& worker) as voidstar)
+
+    fn spawn (self event)
+        """"Queues `event`, which must not be armed yet, to fire on whichever worker gets to it first. Safe to call from
+            any thread, including from inside a task.
+        let i = ((atomicrmw add (& self._next) 1:u32) % self._count)
+        let worker = (self._workers @ i)
+        push-tasks (& worker.tasks) event event
+        'wake worker.port
+
+    fn __drop (self)
+        if (self._workers != null)
+            atomicrmw xchg (& self._stopping) 1:u32
+            for i in (range self._count)
+                let worker = (self._workers @ i)
+                'wake worker.port
+            for i in (range self._count)
+                let worker = (self._workers @ i)
+                C.extern.pthread_join worker.thread null
+            # Tasks nobody started are dropped unrun, chains still waiting on a loop are abandoned with it.
+            for i in (range self._count)
+                let worker = (self._workers @ i)
+                local task = (take-tasks (& worker.tasks))
+                while (task != null)
+                    let next = task._posted-next
+                    drop (@ task)
+                    free task
+                    task = next
+                drop worker
+            free self._workers
+            self._workers = null
+
+locals;
@@ -24,3 +24,15 @@ fn can-wait()
     assert (v == 8)
 
 can-wait;
+
+fn reuses-fired-events ()
+    local l = (EventLoop)
+    local s = (WaitScope l)
+    # The first frame allocates every event, and each one after that takes them back off the spare list.
+    for frame in (range 4)
+        for i in (range 16)
+            'arm-breadth-first (@ ('new-event l (capture "do-nothing" {} (event) none)))
+        'run l 1000
+        assert (l._spare-count == 16:u32)
+
+reuses-fired-events;
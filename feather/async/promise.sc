@@ -133,11 +133,11 @@ type Promise
                 let state = (storagecast self)
 
             fn wait (self)
-                let el = thread-local-event-loop
-                # TODO: add support for waiting on an event provider
+                let el = (@ (current-event-loop))
                 vvv bind res
                 loop ()
-                    if (not ('runnable? el))
+                    # Another thread may still post what resolves the promise, if there's a port for it to wake.
+                    if (and (not ('runnable? el)) (not ('wait el)))
                         break (error "tried to wait for a promise but ran out of events before it was resolved")
                     'run el 1000
                     let state = (storagecast self)
@@ -289,6 +289,20 @@ do
                 vtab.processMessages vtab window.window (& app)
                 app
 
+            fn wait-messages (self app window timeout)
+                viewing self
+                let vtab = (storagecast self)
+                vtab.waitMessages vtab window.window (& app) (timeout as f64)
+                app
+
+            fn wake-messages (self)
+                let vtab = (storagecast self)
+                vtab.wakeMessages vtab
+
+            fn message-sync-object (self window)
+                let vtab = (storagecast self)
+                vtab.getMessageSyncObject vtab window.window
+
             fn... destroy
             case (self, w : Window)
                 let vtab = (storagecast self)
@@ -18,6 +18,12 @@ type opengl-executor < rendering-executor : opengl-data
             cls
 
     inline upload-buffer (self buff)
+        # A deferred map is computed in one fused pass first, so only its result is uploaded instead of every operand.
+        let buff =
+            static-if (('strip-qualifiers (typeof buff)) < deferred-map)
+                'materialize buff
+            else
+                buff
         let data = (storagecast self)
         let glresult = ('create-buffer data.backend data.context ('raw-pointer buff) ('length buff) Usage.Storage_Buffer)
         if (glresult == null)
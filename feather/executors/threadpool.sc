@@ -0,0 +1,244 @@
+""""A CPU executor that materializes maps on every core
+
+using import struct
+using import ..kernels
+
+let C =
+    include
+        """"#include <pthread.h>
+            #include <unistd.h>
+
+let CACHE_LINE = 64
+let VECTOR_BYTES = 32 # One AVX register
+let CHUNK_LINES = 64 # Cache lines of output per chunk, enough that taking a chunk costs nothing next to computing it
+
+@@ memo
+inline map-job (T)
+    """"Shared by every worker materializing one deferred map. Chunks are handed out by bumping next, so a worker that
+        runs ahead just takes more of them and nobody waits on anyone until the last chunk is done.
+    struct (.. "(map-job " (tostring T) ")")
+        source : (@ T)
+        output : (mutable@ T.element)
+        count : usize
+        chunk : usize
+        next : usize
+
+@@ memo
+inline map-worker (T)
+    let job-type = (map-job T)
+    # Blocks of width elements fill one vector register, and their constant trip count lets LLVM unroll them into
+    # SSE/AVX instructions instead of vectorizing a loop it can't see the length of.
+    let width = (max 1 (VECTOR_BYTES // (sizeof T.element)))
+    static-typify
+        fn "map-worker" (arg)
+            let job = (@ (arg as (mutable@ job-type)))
+            let source = (@ job.source)
+            let output = job.output
+            loop ()
+                let start = ((atomicrmw add (& job.next) job.chunk) as usize)
+                if (start >= job.count)
+                    break;
+                let end = (min (start + job.chunk) job.count)
+                local i = start
+                while ((i + width) <= end)
+                    for j in (range width)
+                        (output @ (i + j)) = (element-at source (i + j))
+                    i += width
+                while (i < end)
+                    (output @ i) = (element-at source i)
+                    i += 1
+            nullof voidstar
+        voidstar
+
+global cpus : u32 # 0 until cpu-count first asks, threads that race to ask just store the same answer
+
+fn cpu-count ()
+    """"Cores online, asked of the system only once.
+    let cached = (atomicrmw or (& cpus) 0:u32)
+    if (cached != 0:u32)
+        return cached
+    let n = (C.extern.sysconf C.const._SC_NPROCESSORS_ONLN)
+    let n = (? (n > 0) (n as u32) 1:u32)
+    atomicrmw xchg (& cpus) n
+    n
+
+struct pool-batch
+    """"One call to worker-pool.run, which each helper claims in turn until none are left to claim it.
+    job : (pointer (function voidstar voidstar))
+    arg : voidstar
+    unclaimed : u32
+    running : u32 # Helpers that claimed it or still may, the caller waits until this is 0
+    next : (mutable@ pool-batch)
+
+struct worker-pool
+    """"Threads that are started once and sleep until there's work for them, so splitting a job across cores costs
+        a broadcast instead of creating and joining a thread per core every time. Like the pthread objects inside
+        it, a pool must not move once `start` has been called.
+    _lock : C.typedef.pthread_mutex_t
+    _signal : C.typedef.pthread_cond_t # A batch was queued, or the pool is stopping
+    _done : C.typedef.pthread_cond_t # A helper returned from its share of a batch
+    _threads : (mutable@ C.typedef.pthread_t)
+    _count : u32
+    _stopping : bool
+    _queued : (mutable@ pool-batch)
+
+    fn worker (arg)
+        let self = (@ (arg as (mutable@ this-type)))
+        C.extern.pthread_mutex_lock (& self._lock)
+        loop ()
+            while (and (self._queued == null) (not self._stopping))
+                C.extern.pthread_cond_wait (& self._signal) (& self._lock)
+            if (self._queued == null)
+                break;
+            let batch = self._queued
+            batch.unclaimed -= 1
+            if (batch.unclaimed == 0)
+                self._queued = batch.next
+            C.extern.pthread_mutex_unlock (& self._lock)
+
+            batch.job batch.arg
+
+            C.extern.pthread_mutex_lock (& self._lock)
+            batch.running -= 1
+            if (batch.running == 0)
+                C.extern.pthread_cond_broadcast (& self._done)
+        C.extern.pthread_mutex_unlock (& self._lock)
+        nullof voidstar
+
+    fn start (self threads)
+        """"Starts up to `threads` workers, and returns how many did start.
+        C.extern.pthread_mutex_init (& self._lock) null
+        C.extern.pthread_cond_init (& self._signal) null
+        C.extern.pthread_cond_init (& self._done) null
+        self._queued = null
+        self._stopping = false
+        self._threads = (malloc-array C.typedef.pthread_t (max (threads as u32) 1:u32))
+        self._count = 0
+        let entry = (static-typify this-type.worker voidstar)
+        for i in (range (threads as u32))
+            if ((C.extern.pthread_create (& (self._threads @ i)) null entry ((& self) as voidstar)) != 0)
+                break;
+            self._count += 1
+        deref self._count
+
+    fn run (self job arg helpers)
+        """"Calls `job` with `arg` on the calling thread and on up to `helpers` workers, and returns once every call
+            that started has returned. Workers still busy with other batches by the time the caller's own call
+            returns are never waited for, so `job` has to split its work among however many calls turn up, like
+            taking chunks off a shared counter does.
+        let helpers = (min (helpers as u32) (deref self._count))
+        local batch =
+            pool-batch
+                job = job
+                arg = arg
+                unclaimed = helpers
+                running = helpers
+                next = null
+        if (helpers > 0)
+            C.extern.pthread_mutex_lock (& self._lock)
+            batch.next = self._queued
+            self._queued = &batch
+            C.extern.pthread_cond_broadcast (& self._signal)
+            C.extern.pthread_mutex_unlock (& self._lock)
+
+        job arg
+
+        if (helpers > 0)
+            C.extern.pthread_mutex_lock (& self._lock)
+            # Every share nobody claimed yet was done by the caller, so they're taken back instead of waited for.
+            if (batch.unclaimed > 0)
+                local link = (& self._queued)
+                while ((@ link) != &batch)
+                    let node = (@ link)
+                    link = (& node.next)
+                (@ link) = batch.next
+                batch.running -= batch.unclaimed
+                batch.unclaimed = 0
+            while (batch.running > 0)
+                C.extern.pthread_cond_wait (& self._done) (& self._lock)
+            C.extern.pthread_mutex_unlock (& self._lock)
+
+    fn __drop (self)
+        if (self._threads != null)
+            C.extern.pthread_mutex_lock (& self._lock)
+            self._stopping = true
+            C.extern.pthread_cond_broadcast (& self._signal)
+            C.extern.pthread_mutex_unlock (& self._lock)
+            for i in (range self._count)
+                C.extern.pthread_join (self._threads @ i) null
+            free self._threads
+            self._threads = null
+            C.extern.pthread_cond_destroy (& self._done)
+            C.extern.pthread_cond_destroy (& self._signal)
+            C.extern.pthread_mutex_destroy (& self._lock)
+
+global pool : worker-pool
+global pool-state : u32 # 0 until a thread begins starting the pool, 1 while it does, 2 once it runs
+
+fn shared-pool ()
+    """"The pool every threadpool-executor and canvas shares, with a worker for every core but the calling one. The
+        first call starts it, without needing a lock to make sure only one does.
+    loop ()
+        let state = (atomicrmw or (& pool-state) 0:u32)
+        if (state == 2:u32)
+            break (& pool)
+        if (state == 0:u32)
+            let _ ok = (cmpxchg (& pool-state) 0:u32 1:u32)
+            if ok
+                'start pool ((cpu-count) - 1)
+                atomicrmw xchg (& pool-state) 2:u32
+
+type threadpool-executor < executor : (tuple u32)
+    """"Runs kernels on a pool of threads. Like processor-executor, map is lazy and fuses chained maps, and buffers
+        live in ordinary memory, so uploading and downloading never copy. Only materializing a deferred map does any
+        work, which is split into chunks whole cache lines long, so no two threads ever write the same line. Every
+        executor shares the workers of shared-pool, `threads` only limits how many of them one map uses.
+    inline __typecall (cls threads)
+        let threads =
+            static-if (none? threads) (cpu-count)
+            else (threads as u32)
+        bitcast (tupleof threads) cls
+
+    inline threads (self)
+        (storagecast self) @ 0
+
+    inline upload-buffer (self buff)
+        buff
+
+    inline new-buffer (self typ size initializer)
+        ((buffer typ) size initializer)
+
+    inline map (self kernel args...)
+        deferred-map kernel args...
+
+    inline download-buffer (self buff)
+        let T = ('strip-qualifiers (typeof buff))
+        static-if (T < deferred-map)
+            'materialize-on self buff
+        else
+            buff
+
+    inline materialize-on (self buff)
+        let T = ('strip-qualifiers (typeof buff))
+        let element = T.element
+        local source = buff
+        let count = (countof source)
+        let output = (malloc-array element count)
+        let line = (max 1 (CACHE_LINE // (sizeof element)))
+        local job =
+            (map-job T)
+                source = &source
+                output = output
+                count = count
+                chunk = (line * CHUNK_LINES)
+                next = 0
+        let worker = (map-worker T)
+
+        # Small maps aren't worth waking threads for, and the calling thread always works on its own share.
+        let chunks = ((count + job.chunk - 1) // job.chunk)
+        let helpers = (max 1:u32 (min ('threads self) (chunks as u32))) - 1
+        'run (@ (shared-pool)) worker (&job as voidstar) helpers
+
+        bitcast (tupleof output count) (buffer element)
+
+locals;
@@ -1,3 +1,7 @@
 using import .gltf
 
-load-glb-from-path (module-dir .. "/assets/Box.glb")
+let glb = (load-glb-from-path (module-dir .. "/assets/Box.glb"))
+assert ((countof glb.accessors) > 0)
+for accessor in glb.accessors
+    if (accessor.view != NO_VIEW)
+        assert (('offset-of glb accessor) < glb.bin-length)
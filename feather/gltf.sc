@@ -1,53 +1,200 @@
-
 using import .json
-using import itertools
+using import struct
 using import Array
 using import String
-using import glm
-import C.stdio
 
+let C =
+    include
+        """"#include <fcntl.h>
+            #include <sys/mman.h>
+            #include <sys/stat.h>
+            #include <unistd.h>
+            #include "feather/graphics_interface.h"
+
+let GLB_MAGIC = 0x46546c67:u32
+let GLB_JSON = 0x4e4f534a:u32
+let GLB_BIN = 0x004e4942:u32
+let NO_VIEW = -1:u32 # Sparse accessors without a bufferView are all zeros until their sparse values are applied
+
+struct glb-buffer-view plain
+    buffer : u32
+    offset : u32
+    length : u32
+    stride : u32 # 0 if the elements are tightly packed
+
+struct glb-accessor plain
+    view : u32
+    offset : u32 # From the start of the view
+    component-type : u32 # A GL enum, like GL_FLOAT
+    count : u32
+    components : u32 # 1 for SCALAR up to 16 for MAT4
+
+fn accessor-components (kind)
+    if ('equals? kind "SCALAR") 1:u32
+    elseif ('equals? kind "VEC2") 2:u32
+    elseif ('equals? kind "VEC3") 3:u32
+    elseif ('equals? kind "VEC4") 4:u32
+    elseif ('equals? kind "MAT2") 4:u32
+    elseif ('equals? kind "MAT3") 9:u32
+    elseif ('equals? kind "MAT4") 16:u32
+    else (error "unknown glTF accessor type")
+
+fn component-size (component-type)
+    switch component-type
+    case 5120:u32 1:u32 # BYTE
+    case 5121:u32 1:u32 # UNSIGNED_BYTE
+    case 5122:u32 2:u32 # SHORT
+    case 5123:u32 2:u32 # UNSIGNED_SHORT
+    case 5125:u32 4:u32 # UNSIGNED_INT
+    case 5126:u32 4:u32 # FLOAT
+    default (error "unknown glTF accessor componentType")
+
+struct glb-file
+    """"A GLB file mapped into memory. The JSON chunk is parsed in place, and the BIN chunk is never copied on the CPU
+        at all: `upload` hands the mapped pages straight to the graphics backend. Views and accessors are kept as
+        offsets into the BIN chunk, which are also offsets into the GPU buffer it was uploaded to.
+    _map : voidstar
+    _size : usize
+    json : (@ i8)
+    json-length : u32
+    bin : (@ u8)
+    bin-length : u32
+    views : (GrowingArray glb-buffer-view)
+    accessors : (GrowingArray glb-accessor)
+
+    fn __drop (self)
+        if (self._map != null)
+            C.extern.munmap self._map self._size
+        self._map = null
+
+    fn offset-of (self accessor)
+        """"Where the first element of accessor starts, from the start of the BIN chunk. Only meaningful for accessors
+            whose view is in buffer 0, the one stored in the GLB itself.
+        let view = (self.views @ accessor.view)
+        view.offset + accessor.offset
+
+    fn upload (self gfx context)
+        """"Creates one GPU buffer holding the whole BIN chunk, which every view in buffer 0 is a range of. The data is
+            copied once, from the mapped file into the buffer, so the pages only need to be resident while that runs.
+        if (self.bin-length == 0)
+            error "GLB file has no BIN chunk"
+        let buffer =
+            gfx.createBuffer gfx context (self.bin as voidstar) self.bin-length C.const.FG_Usage_Vertex_Data
+        if (buffer == 0)
+            error "failed to create a GPU buffer for the GLB BIN chunk"
+        # Nothing reads the BIN chunk on the CPU again, so its pages can be dropped now instead of when the file is.
+        # madvise only takes whole pages, and the ones the chunk shares with the JSON or the end of the file are kept.
+        let page = ((C.extern.sysconf C.const._SC_PAGESIZE) as usize)
+        let start = (ptrtoint self.bin usize)
+        let first = ((start + page - 1) // page * page)
+        let last = ((start + (self.bin-length as usize)) // page * page)
+        # If madvise fails, the pages just stay resident until the file is unmapped, which isn't worth failing over.
+        if (first < last)
+            C.extern.madvise (inttoptr first voidstar) (last - first) C.define.MADV_DONTNEED
+        buffer
+
+    fn parse (self)
+        local reader = (json-reader self.json self.json-length)
+        'each-field reader
+            inline (key)
+                if ('equals? key "bufferViews")
+                    'each-element reader
+                        inline ()
+                            local view = (glb-buffer-view 0 0 0 0)
+                            'each-field reader
+                                inline (key)
+                                    if ('equals? key "buffer") (view.buffer = ('number reader) as u32)
+                                    elseif ('equals? key "byteOffset") (view.offset = ('number reader) as u32)
+                                    elseif ('equals? key "byteLength") (view.length = ('number reader) as u32)
+                                    elseif ('equals? key "byteStride") (view.stride = ('number reader) as u32)
+                                    else ('skip reader)
+                            'append self.views view
+                elseif ('equals? key "accessors")
+                    'each-element reader
+                        inline ()
+                            local accessor = (glb-accessor NO_VIEW 0 0 0 1)
+                            'each-field reader
+                                inline (key)
+                                    if ('equals? key "bufferView") (accessor.view = ('number reader) as u32)
+                                    elseif ('equals? key "byteOffset") (accessor.offset = ('number reader) as u32)
+                                    elseif ('equals? key "componentType")
+                                        accessor.component-type = ('number reader) as u32
+                                    elseif ('equals? key "count") (accessor.count = ('number reader) as u32)
+                                    elseif ('equals? key "type")
+                                        accessor.components = (accessor-components ('string reader))
+                                    else ('skip reader)
+                            'append self.accessors accessor
+                else
+                    'skip reader
+        # Everything is added up in 64 bits, so offsets and lengths near 4 GiB can't wrap around and pass.
+        for view in self.views
+            if (and (view.buffer == 0) (((view.offset as u64) + (view.length as u64)) > (self.bin-length as u64)))
+                error "glTF bufferView reaches past the end of the BIN chunk"
+        for accessor in self.accessors
+            if (accessor.view != NO_VIEW)
+                if (accessor.view >= (countof self.views))
+                    error "glTF accessor refers to a bufferView that doesn't exist"
+                let view = (self.views @ accessor.view)
+                let element = ((accessor.components as u64) * ((component-size accessor.component-type) as u64))
+                let stride = (? (view.stride != 0) (view.stride as u64) element)
+                # The last element only has to fit itself, not a whole stride.
+                if (accessor.count > 0)
+                    let end =
+                        (accessor.offset as u64) + ((accessor.count as u64) - 1:u64) * stride + element
+                    if (end > (view.length as u64))
+                        error "glTF accessor reaches past the end of its bufferView"
 
 fn load-glb-from-path (path)
-    let stream =
-        C.stdio.fopen path "r"
-    local header = ((array u32 3))
-    C.stdio.fread (header as (mutable@ u32)) 4 3 stream
-    print (header @ 0) (header @ 1) (header @ 2) # load bearing print
-    if ((header @ 0) != 0x46546c67)
+    """"Maps a GLB file and parses its JSON chunk in place. The file stays mapped until the glb-file is dropped.
+    let fd = (C.extern.open (path as rawstring) C.define.O_RDONLY)
+    if (fd < 0)
+        error "unable to open GLB file"
+    local info : C.struct.stat
+    if ((C.extern.fstat fd &info) != 0)
+        C.extern.close fd
+        error "unable to get the size of GLB file"
+    let size = (info.st_size as usize)
+    if (size < 12)
+        C.extern.close fd
+        error "file is too small to be a GLB"
+    let map = (C.extern.mmap null size C.define.PROT_READ C.define.MAP_PRIVATE fd 0)
+    # The mapping keeps the file alive by itself.
+    C.extern.close fd
+    if ((ptrtoint map intptr) == -1)
+        error "unable to map GLB file"
+
+    local glb =
+        glb-file
+            _map = map
+            _size = size
+    let base = (map as (@ u8))
+    inline read-u32 (offset)
+        @ ((& (base @ offset)) as (@ u32))
+    if ((read-u32 0) != GLB_MAGIC)
         error "file does not start with the right magic number"
-    if ((header @ 1) != 2)
+    if ((read-u32 4) != 2)
         error "file contains unsupported gltf version"
-    let buffsize = ((header @ 2) - 12)
-    local buff = (malloc-array u8 buffsize)
-    C.stdio.fread buff 1 buffsize stream
-    inline offset-ptr (ptr offset)
-        inttoptr
-            +
-                ptrtoint ptr intptr
-                offset
-            (typeof ptr)
-    inline read-u32 (buff offset)
-        @
-            inttoptr
-                +
-                    ptrtoint buff intptr
-                    offset
-                (@ u32)
-    local chunks = ((GrowingArray (tuple (@ void) u32 u32)))
-    loop (offset = 0:u32)
-        if (offset >= buffsize)
-            break;
-        let chunksize = (read-u32 buff offset)
-        'emplace-append chunks (offset-ptr buff (offset + 8)) (read-u32 buff (offset + 4)) chunksize
-        repeat (offset + chunksize + 8)
-    for chunk in chunks
-        let base kind len = (unpack chunk)
-        if (kind == 0x4e4f534a) # JSON chunk
-            let str = (String (base as (@ i8)) len)
-            print str
-
-
+    let total = (min ((read-u32 8) as usize) size)
 
+    loop (offset = 12:usize)
+        if ((offset + 8) > total)
+            break;
+        let length = (read-u32 offset)
+        let kind = (read-u32 (offset + 4))
+        let start = (offset + 8)
+        if ((start + length) > total)
+            error "GLB chunk reaches past the end of the file"
+        if (kind == GLB_JSON)
+            glb.json = ((& (base @ start)) as (@ i8))
+            glb.json-length = length
+        elseif (and (kind == GLB_BIN) (glb.bin == null))
+            glb.bin = (& (base @ start))
+            glb.bin-length = length
+        repeat (start + length)
 
+    if (glb.json == null)
+        error "GLB file has no JSON chunk"
+    'parse glb
+    glb
 
 locals;
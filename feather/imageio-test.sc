@@ -0,0 +1,57 @@
+import .imageio
+using import struct
+
+let C =
+    include
+        """"#include <stdlib.h>
+            #include <unistd.h>
+
+let WIDTH HEIGHT = 4:u32 2:u32
+
+# The image is written out first, so the test doesn't depend on any asset.
+let img = (imageio.image WIDTH HEIGHT 4)
+img.pixel_format = imageio.raw.const.SAIL_PIXEL_FORMAT_BPP32_RGBA
+let pixels = (img.pixels as (mutable@ u8))
+for i in (range (WIDTH * HEIGHT * 4))
+    (pixels @ i) = (i as u8)
+imageio.save-into-file "output/imageio-test.png" img
+
+struct decoded plain
+    status : imageio.raw.enum.SailStatus
+    width : u32
+    height : u32
+    sample : u8 # The second row's sixth byte, which was written as its offset in the image
+    calls : u32
+
+fn on-decoded (user result)
+    let out = (@ (user as (mutable@ decoded)))
+    out.status = result.status
+    out.width = result.width
+    out.height = result.height
+    if (result.pixels != null)
+        out.sample = (result.pixels @ (result.stride + 5))
+    out.calls += 1
+let callback = (static-typify on-decoded voidstar (mutable@ imageio.decode-result))
+
+local decoder : imageio.decoder
+'start decoder 2 null null
+
+# Once into memory SAIL allocates, and once into rows twice as far apart as the image's.
+local into-image = (decoded imageio.raw.const.SAIL_OK 0 0 0 0)
+local into-target = (decoded imageio.raw.const.SAIL_OK 0 0 0 0)
+let stride = (WIDTH * 8)
+let target = (malloc-array u8 (stride * HEIGHT))
+'decode decoder "output/imageio-test.png" 0 null 0 0 callback (&into-image as voidstar)
+'decode decoder "output/imageio-test.png" 0 target stride (stride * HEIGHT) callback (&into-target as voidstar)
+while (('pending decoder) > 0)
+    'finish decoder
+    C.extern.usleep 1000
+
+inline check (result)
+    assert (result.calls == 1)
+    assert (result.status == imageio.raw.const.SAIL_OK)
+    assert (and (result.width == WIDTH) (result.height == HEIGHT))
+    assert (result.sample == ((WIDTH * 4 + 5) as u8))
+check into-image
+check into-target
+free target
@@ -1,11 +1,20 @@
 
 
+using import struct
+using import String
+
 let sail =
     include
         """"
             #include <stddef.h>
             #include <sail/sail.h>
 
+let C =
+    include
+        """"#include <pthread.h>
+            #include <string.h>
+            #include <unistd.h>
+
 load-library "libsail.so"
 load-library "libsail-common.so"
 
@@ -99,6 +108,247 @@ do
                 ":"
                 repr (typeof self)
 
+    struct decode-result
+        """"What a decode hands its callback. If the request had a target, the pixels were written there and image is
+            null. Otherwise image holds them, and is destroyed after the callback returns unless the callback takes
+            it by setting image to null.
+        status : sail.enum.SailStatus
+        width : u32
+        height : u32
+        pixel-format : sail.enum.SailPixelFormat
+        pixels : (@ u8)
+        stride : u32
+        image : (mutable@ sail.struct.sail_image)
+
+    let decode-callback = (pointer (function void voidstar (mutable@ decode-result)))
+
+    struct decode-job
+        path : String
+        max-size : u32
+        target : (mutable@ u8)
+        target-stride : u32
+        target-bytes : usize
+        callback : decode-callback
+        user : voidstar
+        result : decode-result
+        next : (mutable@ decode-job)
+
+    fn downscale (img max-size)
+        # Box filters down by the smallest whole factor that fits max-size. Only images of whole 8-bit channels
+        # without a palette qualify, anything else comes back at full size.
+        let largest = (max img.width img.height)
+        if (or (max-size == 0) (largest <= max-size) (img.palette != null) (img.width == 0)
+            ((img.bytes_per_line % img.width) != 0))
+            return img
+        let bpp = (img.bytes_per_line // img.width)
+        if (bpp > 4)
+            return img
+        let factor = ((largest + max-size - 1) // max-size)
+        let width = (max 1:u32 (img.width // factor))
+        let height = (max 1:u32 (img.height // factor))
+        local small : (mutable@ sail.struct.sail_image)
+        if ((sail.extern.sail_alloc_image &small) != sail.const.SAIL_OK)
+            return img
+        local buff : (@ void)
+        if ((sail.extern.sail_malloc (* (width as u64) height bpp) &buff) != sail.const.SAIL_OK)
+            sail.extern.sail_destroy_image small
+            return img
+        small.pixels = buff
+        small.width = width
+        small.height = height
+        small.bytes_per_line = (width * bpp)
+        small.pixel_format = img.pixel_format
+        let src = (img.pixels as (@ u8))
+        let dest = (buff as (mutable@ u8))
+        let area = (factor * factor)
+        for y in (range height)
+            for x in (range width)
+                for c in (range bpp)
+                    local sum = 0:u32
+                    for dy in (range factor)
+                        let row = ((y * factor + dy) * img.bytes_per_line)
+                        for dx in (range factor)
+                            sum += ((src @ (row + (x * factor + dx) * bpp + c)) as u32)
+                    (dest @ ((y * width + x) * bpp + c)) = ((sum // area) as u8)
+        sail.extern.sail_destroy_image img
+        small
+
+    fn run-decode (job)
+        local img : (mutable@ sail.struct.sail_image)
+        let res = (sail.extern.sail_load_from_file (job.path as rawstring) &img)
+        job.result.status = res
+        if (res != sail.const.SAIL_OK)
+            return;
+        let img = (downscale img job.max-size)
+        job.result.width = img.width
+        job.result.height = img.height
+        job.result.pixel-format = img.pixel_format
+        if (job.target == null)
+            job.result.pixels = (img.pixels as (@ u8))
+            job.result.stride = img.bytes_per_line
+            job.result.image = img
+            return;
+        # Writing into the caller's buffer, which may be mapped staging memory, is the only copy the pixels make.
+        let row = img.bytes_per_line
+        if (or (job.target-stride < row) (((img.height as usize) * job.target-stride) > job.target-bytes))
+            job.result.status = sail.const.SAIL_ERROR_INVALID_ARGUMENT
+        else
+            for y in (range img.height)
+                C.extern.memcpy (& (job.target @ (y * job.target-stride)))
+                    & ((img.pixels as (@ u8)) @ (y * row))
+                    row
+            job.result.pixels = job.target
+            job.result.stride = job.target-stride
+        sail.extern.sail_destroy_image img
+
+    struct decoder
+        """"Decodes image files on a pool of worker threads, so a screen full of images isn't decoded one file after
+            another on the thread that asked for them. `finish` calls back every decode that has completed, on the
+            thread that calls it, in the order they completed. Like the pthread objects inside it, a decoder must
+            not move once `start` has been called.
+        _lock : C.typedef.pthread_mutex_t
+        _signal : C.typedef.pthread_cond_t
+        _threads : (mutable@ C.typedef.pthread_t)
+        _count : u32
+        _stopping : bool
+        _queued : (mutable@ decode-job)
+        _queued-tail : (mutable@ (mutable@ decode-job))
+        _done : (mutable@ decode-job)
+        _pending : u32
+        _wake : (pointer (function void voidstar))
+        _wake-user : voidstar
+
+        fn worker (arg)
+            let self = (@ (arg as (mutable@ this-type)))
+            C.extern.pthread_mutex_lock (& self._lock)
+            loop ()
+                while (and (self._queued == null) (not self._stopping))
+                    C.extern.pthread_cond_wait (& self._signal) (& self._lock)
+                if (self._queued == null)
+                    break;
+                let job = self._queued
+                self._queued = job.next
+                if (self._queued == null)
+                    self._queued-tail = (& self._queued)
+                C.extern.pthread_mutex_unlock (& self._lock)
+
+                run-decode (@ job)
+
+                C.extern.pthread_mutex_lock (& self._lock)
+                job.next = self._done
+                self._done = job
+                if (self._wake != null)
+                    self._wake self._wake-user
+            C.extern.pthread_mutex_unlock (& self._lock)
+            nullof voidstar
+
+        fn start (self threads wake wake-user)
+            """"Starts `threads` workers, or one per core if it's zero, and returns how many did start. If none did,
+                `decode` decodes on the calling thread instead. `wake`, if not null, is called with `wake-user`
+                whenever a decode completes, for instance to wake an EventPort the owner sleeps on.
+            let threads =
+                if (threads > 0) (threads as u32)
+                else
+                    let n = (C.extern.sysconf C.const._SC_NPROCESSORS_ONLN)
+                    ? (n > 0) (n as u32) 1:u32
+            C.extern.pthread_mutex_init (& self._lock) null
+            C.extern.pthread_cond_init (& self._signal) null
+            self._queued = null
+            self._queued-tail = (& self._queued)
+            self._done = null
+            self._pending = 0
+            self._stopping = false
+            self._wake = wake
+            self._wake-user = wake-user
+            self._threads = (malloc-array C.typedef.pthread_t threads)
+            self._count = 0
+            let entry = (static-typify this-type.worker voidstar)
+            for i in (range threads)
+                if ((C.extern.pthread_create (& (self._threads @ i)) null entry ((& self) as voidstar)) != 0)
+                    break;
+                self._count += 1
+            deref self._count
+
+        fn decode (self path max-size target target-stride target-bytes callback user)
+            """"Queues `path` to be decoded. A `max-size` other than 0 shrinks images whose longest side is larger, for
+                thumbnails. If `target` isn't null, rows are written `target-stride` bytes apart into the
+                `target-bytes` it points to, which has to stay valid until the callback runs.
+            let job = (malloc decode-job)
+            store
+                decode-job
+                    path = (String (path as rawstring))
+                    max-size = (max-size as u32)
+                    target = target
+                    target-stride = (target-stride as u32)
+                    target-bytes = (target-bytes as usize)
+                    callback = callback
+                    user = user
+                job
+            if (self._count == 0)
+                # Nothing would ever take the job off the queue, so it's decoded right away, and called back by the
+                # next finish like any other.
+                run-decode (@ job)
+                C.extern.pthread_mutex_lock (& self._lock)
+                job.next = self._done
+                self._done = job
+                self._pending += 1
+                if (self._wake != null)
+                    self._wake self._wake-user
+                C.extern.pthread_mutex_unlock (& self._lock)
+                return;
+            C.extern.pthread_mutex_lock (& self._lock)
+            (@ self._queued-tail) = job
+            self._queued-tail = (& job.next)
+            self._pending += 1
+            C.extern.pthread_cond_signal (& self._signal)
+            C.extern.pthread_mutex_unlock (& self._lock)
+
+        fn pending (self)
+            """"Decodes queued or running whose callback hasn't been called yet.
+            deref self._pending
+
+        fn finish (self)
+            """"Calls back every decode that has completed, and returns how many it called.
+            C.extern.pthread_mutex_lock (& self._lock)
+            local job = self._done
+            self._done = null
+            C.extern.pthread_mutex_unlock (& self._lock)
+
+            # Completed jobs are pushed newest first.
+            local ordered = (nullof (mutable@ decode-job))
+            while (job != null)
+                let next = job.next
+                job.next = ordered
+                ordered = job
+                job = next
+            local count = 0
+            while (ordered != null)
+                let next = ordered.next
+                ordered.callback ordered.user (& ordered.result)
+                if (ordered.result.image != null)
+                    sail.extern.sail_destroy_image ordered.result.image
+                drop (@ ordered)
+                free ordered
+                ordered = next
+                count += 1
+            self._pending -= (count as u32)
+            count
+
+        fn __drop (self)
+            if (self._threads != null)
+                C.extern.pthread_mutex_lock (& self._lock)
+                self._stopping = true
+                C.extern.pthread_cond_broadcast (& self._signal)
+                C.extern.pthread_mutex_unlock (& self._lock)
+                for i in (range self._count)
+                    C.extern.pthread_join (self._threads @ i) null
+                free self._threads
+                self._threads = null
+                # Workers stop only once the queue is empty, so every job is done and only needs calling back.
+                'finish self
+                C.extern.pthread_cond_destroy (& self._signal)
+                C.extern.pthread_mutex_destroy (& self._lock)
+
     let raw = sail
     # load-from-memory :=
 
@@ -27,3 +27,22 @@ case {"foo" : (f as array) }
     print f
 default
     print "not found"
+
+let doc = "{\"foo\" : [ 1, 2, 3 ], \"bar\" : { \"baz\" : \"a\\nb\" }}"
+local reader = (json-reader doc (countof doc))
+local sum = 0.0
+'each-field reader
+    inline (key)
+        if ('equals? key "foo")
+            'each-element reader
+                inline ()
+                    sum += ('number reader)
+        else
+            'skip reader
+assert (sum == 6.0)
+
+# A surrogate pair becomes one 4 byte character, and a high surrogate followed by any other escape stays on its own.
+let escapes = "\"\\u00e9\\ud83d\\ude00\\ud83d\\n\""
+local reader = (json-reader escapes (countof escapes))
+let str = ('to-string ('string reader))
+assert ((countof str) == 10)
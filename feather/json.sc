@@ -192,9 +192,330 @@ fn gen-json-matcher (failfunc expr scope params)
     else
         error "json match pattern element must be a symbol, a constant string, a json list pattern, or a json object pattern"
 
+let cstd =
+    include
+        """"
+            #include <stdlib.h>
+            #include <string.h>
+
+let MAX_JSON_DEPTH = 64
+
+# The bytes the reader looks for, as they appear in the (@ i8) it reads from.
+let json-quote json-backslash json-comma json-colon = 34:i8 92:i8 44:i8 58:i8
+let json-lbracket json-rbracket json-lbrace json-rbrace = 91:i8 93:i8 123:i8 125:i8
+let json-u = 117:i8 # Starts \u, the only escape longer than one character
+
+inline json-hex-digit (c)
+    """"The value of the hex digit c, or 16 if it isn't one.
+    let c = (c as u32)
+    let lower = (c | 32:u32)
+    if ((c >= 48:u32) and (c <= 57:u32)) (c - 48:u32)
+    elseif ((lower >= 97:u32) and (lower <= 102:u32)) (lower - 87:u32)
+    else 16:u32
+
+struct json-slice plain
+    """"A string or key exactly as it appears in the document, without the quotes. Nothing is copied until something
+        asks for a String, and a slice that has no escapes compares against names without allocating at all.
+    data : (@ i8)
+    count : usize
+    escaped? : bool
+
+    fn equals? (self name)
+        let name = (name as string)
+        let len = (countof name)
+        if self.escaped?
+            let str = ('to-string self)
+            and ((countof str) == len) ((cstd.extern.memcmp (str as rawstring) (name as rawstring) len) == 0)
+        else
+            and (self.count == len) ((cstd.extern.memcmp self.data (name as rawstring) len) == 0)
+
+    fn to-string (self)
+        """"Copies the slice into a String, resolving escapes.
+        if (not self.escaped?)
+            return (String self.data self.count)
+        local str = (String)
+        inline hex4 (at)
+            # The reader already checked that every \u is followed by four hex digits.
+            local value = 0:u32
+            for i in (range 4)
+                value = ((value << 4) | (json-hex-digit (self.data @ (at + i))))
+            deref value
+        inline append-utf8 (cp)
+            if (cp < 0x80:u32)
+                'append str (cp as i8)
+            elseif (cp < 0x800:u32)
+                'append str ((0xC0:u32 | (cp >> 6)) as i8)
+                'append str ((0x80:u32 | (cp & 0x3F:u32)) as i8)
+            elseif (cp < 0x10000:u32)
+                'append str ((0xE0:u32 | (cp >> 12)) as i8)
+                'append str ((0x80:u32 | ((cp >> 6) & 0x3F:u32)) as i8)
+                'append str ((0x80:u32 | (cp & 0x3F:u32)) as i8)
+            else
+                'append str ((0xF0:u32 | (cp >> 18)) as i8)
+                'append str ((0x80:u32 | ((cp >> 12) & 0x3F:u32)) as i8)
+                'append str ((0x80:u32 | ((cp >> 6) & 0x3F:u32)) as i8)
+                'append str ((0x80:u32 | (cp & 0x3F:u32)) as i8)
+        local i = 0:usize
+        while (i < self.count)
+            let c = (self.data @ i)
+            if (c != json-backslash)
+                'append str c
+                i += 1
+                continue;
+            # The reader already made sure no escape runs past the end of the slice.
+            let e = (self.data @ (i + 1))
+            i += 2
+            switch (e as u8)
+            case 98:u8 ('append str 8:i8) # \b
+            case 102:u8 ('append str 12:i8) # \f
+            case 110:u8 ('append str 10:i8) # \n
+            case 114:u8 ('append str 13:i8) # \r
+            case 116:u8 ('append str 9:i8) # \t
+            case 117:u8 # \u, which takes two of them for characters outside the basic plane
+                local cp = (hex4 i)
+                i += 4
+                let high? = ((cp & 0xFC00:u32) == 0xD800:u32)
+                if (and high? ((i + 6) <= self.count) ((self.data @ i) == json-backslash)
+                    ((self.data @ (i + 1)) == json-u))
+                    let low = (hex4 (i + 2))
+                    if ((low & 0xFC00:u32) == 0xDC00:u32)
+                        cp = (0x10000:u32 + ((cp - 0xD800:u32) << 10) + (low - 0xDC00:u32))
+                        i += 6
+                append-utf8 cp
+            default ('append str e) # \" \\ \/
+        str
+
+enum json-event
+    object-begin
+    object-end
+    array-begin
+    array-end
+    key : json-slice
+    string : json-slice
+    number : f64
+    boolean : bool
+    null
+    end
+
+struct json-reader
+    """"Pulls a JSON document apart one token at a time, straight out of the memory it was given, which has to stay
+        alive for as long as the reader and any json-slice it hands out. No tree is built, so a caller that skips
+        what it doesn't need only ever allocates for the strings it turns into Strings.
+    _data : (@ i8)
+    _end : usize
+    _pos : usize = 0
+    _stack : (array bool MAX_JSON_DEPTH) # True where the container at that depth is an object
+    _depth : usize = 0
+    _after-value : bool = false # A complete value was just read, so a comma or the end of its container comes next
+    _after-key : bool = false
+
+    inline __typecall (cls data count)
+        super-type.__typecall cls
+            _data = (data as (@ i8))
+            _end = (count as usize)
+
+    fn skip-space (self)
+        while (self._pos < self._end)
+            switch ((self._data @ self._pos) as u8)
+            case 32:u8 ()
+            case 9:u8 ()
+            case 10:u8 ()
+            case 13:u8 ()
+            default (break)
+            self._pos += 1
+
+    fn peek (self)
+        if (self._pos >= self._end)
+            error "unexpected end of JSON document"
+        self._data @ self._pos
+
+    fn expect (self word)
+        let word = (word as string)
+        let len = (countof word)
+        if (or ((self._pos + len) > self._end)
+            ((cstd.extern.memcmp (& (self._data @ self._pos)) (word as rawstring) len) != 0))
+            error "invalid literal in JSON document"
+        self._pos += len
+
+    fn scan-string (self)
+        # The opening quote is at _pos.
+        let start = (self._pos + 1)
+        local i = start
+        local escaped? = false
+        loop ()
+            if (i >= self._end)
+                error "unterminated JSON string"
+            let c = (self._data @ i)
+            if (c == json-quote)
+                break;
+            if (c == json-backslash)
+                escaped? = true
+                if ((i + 1) >= self._end)
+                    error "unterminated JSON string"
+                # to-string reads the four hex digits of a \u without checking them again.
+                if ((self._data @ (i + 1)) == json-u)
+                    if ((i + 6) > self._end)
+                        error "invalid \\u escape in JSON string"
+                    for k in (range 2 6)
+                        if ((json-hex-digit (self._data @ (i + k))) > 15:u32)
+                            error "invalid \\u escape in JSON string"
+                    i += 4
+                i += 1
+            i += 1
+        self._pos = (i + 1)
+        json-slice (& (self._data @ start)) (i - start) escaped?
+
+    fn scan-number (self)
+        let start = self._pos
+        while (self._pos < self._end)
+            switch ((self._data @ self._pos) as u8)
+            pass 43:u8 # +
+            pass 45:u8 # -
+            pass 46:u8 # .
+            pass 69:u8 # E
+            pass 101:u8 # e
+            do ()
+            default
+                let c = ((self._data @ self._pos) as u8)
+                if (or (c < 48:u8) (c > 57:u8))
+                    break;
+            self._pos += 1
+        # strtod needs a terminator, which the document in place doesn't have, so the digits are copied out first.
+        let len = (self._pos - start)
+        if (or (len == 0) (len >= 64))
+            error "invalid number in JSON document"
+        local digits = ((array i8 64))
+        cstd.extern.memcpy (& (digits @ 0)) (& (self._data @ start)) len
+        (digits @ len) = 0:i8
+        local rest = (nullof (mutable@ i8))
+        let value = (cstd.extern.strtod (& (digits @ 0)) &rest)
+        if (rest != (& (digits @ len)))
+            error "invalid number in JSON document"
+        value
+
+    fn push (self object?)
+        if (self._depth >= MAX_JSON_DEPTH)
+            error "JSON document nested too deeply"
+        (self._stack @ self._depth) = object?
+        self._depth += 1
+        self._after-value = false
+
+    fn next (self)
+        """"Reads the next token. Objects come out as object-begin, then a key followed by its value for each field,
+            then object-end. The whole document is followed by end.
+        'skip-space self
+        if (self._depth == 0)
+            if self._after-value
+                if (self._pos < self._end)
+                    error "trailing characters after JSON document"
+                return (json-event.end)
+        elseif (not self._after-key)
+            let object? = (self._stack @ (self._depth - 1))
+            local c = ('peek self)
+            if (c == (? object? json-rbrace json-rbracket))
+                self._pos += 1
+                self._depth -= 1
+                self._after-value = true
+                return (? object? (json-event.object-end) (json-event.array-end))
+            if self._after-value
+                if (c != json-comma)
+                    error "expected a comma in JSON document"
+                self._pos += 1
+                'skip-space self
+                c = ('peek self)
+            if object?
+                if (c != json-quote)
+                    error "expected a key in JSON object"
+                let key = ('scan-string self)
+                'skip-space self
+                if (('peek self) != json-colon)
+                    error "expected a colon after key in JSON object"
+                self._pos += 1
+                self._after-key = true
+                self._after-value = false
+                return (json-event.key key)
+
+        self._after-key = false
+        let c = ('peek self)
+        if (c == json-lbrace)
+            self._pos += 1
+            'push self true
+            (json-event.object-begin)
+        elseif (c == json-lbracket)
+            self._pos += 1
+            'push self false
+            (json-event.array-begin)
+        else
+            self._after-value = true
+            if (c == json-quote)
+                json-event.string ('scan-string self)
+            elseif (c == 116:i8) # t
+                'expect self "true"
+                json-event.boolean true
+            elseif (c == 102:i8) # f
+                'expect self "false"
+                json-event.boolean false
+            elseif (c == 110:i8) # n
+                'expect self "null"
+                (json-event.null)
+            else
+                json-event.number ('scan-number self)
+
+    fn skip (self)
+        """"Reads and throws away the next value, along with everything inside it.
+        let depth = self._depth
+        loop ()
+            'next self
+            if (self._depth <= depth)
+                break;
+
+    fn at-end? (self)
+        """"True if the next token closes the innermost container, so loops over arrays know when to stop.
+        'skip-space self
+        and (self._depth > 0) (not self._after-key) (self._pos < self._end)
+            (self._data @ self._pos) == (? (self._stack @ (self._depth - 1)) json-rbrace json-rbracket)
+
+    fn number (self)
+        dispatch ('next self)
+        case number (n) n
+        default (error "expected a number in JSON document")
+
+    fn string (self)
+        dispatch ('next self)
+        case string (s) s
+        default (error "expected a string in JSON document")
+
+    fn boolean (self)
+        dispatch ('next self)
+        case boolean (b) b
+        default (error "expected a boolean in JSON document")
+
+    inline each-field (self f)
+        """"Reads an object, calling `(f key)` for each field, which has to read or skip the field's value.
+        dispatch ('next self)
+        case object-begin () ()
+        default (error "expected an object in JSON document")
+        loop ()
+            dispatch ('next self)
+            case key (k)
+                f k
+            case object-end ()
+                break;
+            default
+                error "expected a key in JSON object"
+
+    inline each-element (self f)
+        """"Reads an array, calling `(f)` once for each element, which has to read or skip it.
+        dispatch ('next self)
+        case array-begin () ()
+        default (error "expected an array in JSON document")
+        while (not ('at-end? self))
+            f;
+        'next self
+
 run-stage;
 do
-    let json json-object json-array
+    let json json-object json-array json-slice json-event json-reader
 
     fn parse(str)
         let cj =
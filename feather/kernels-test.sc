@@ -0,0 +1,36 @@
+using import .kernels
+
+# There's no kernel sugar yet, so these are written out as the types it would generate: the uniforms, what each call
+# returns, and the call itself, which takes the uniforms before the varyings.
+type doubled : (tuple)
+    let uniforms = '()
+    let return-type = f32
+    inline __typecall (cls)
+        bitcast (tupleof) cls
+    inline __call (self x)
+        x * 2.0
+
+type offset : (tuple)
+    let uniforms = '(by)
+    let return-type = f32
+    inline __typecall (cls)
+        bitcast (tupleof) cls
+    inline __call (self by x)
+        x + by
+
+let ex = (processor-executor)
+let COUNT = 8:usize
+
+# The outer map owns the inner one, which owns xs, so all three are dropped together once chained is.
+let xs =
+    'new-buffer ex f32 COUNT
+        inline (i)
+            i as f32
+let chained = ('map ex (offset) 1.0 ('map ex (doubled) xs))
+assert ((deferred-count chained) == COUNT)
+for i in (range COUNT)
+    assert ((element-at chained i) == ((i as f32) * 2.0 + 1.0))
+
+let result = ('download-buffer ex chained)
+assert ((countof result) == COUNT)
+assert ((result @ 3) == 7.0)
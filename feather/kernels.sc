@@ -97,6 +97,10 @@ type buffer
         assert (idx < size) "index out of bounds"
         base @ idx
 
+    inline __countof (self)
+        let base size = (unpack (storagecast self))
+        size
+
     inline __drop (self)
         returning void
         let base size = (unpack (storagecast self))
@@ -179,29 +183,115 @@ type rendering-executor < executor
 
 
 
-#type processor-executor < executor
-    spice upload-buffer (self buff)
-        buff
-    spice download-buffer (self buff)
+type deferred-map
+    """"The result of a map that hasn't been computed yet. It only holds the kernel and its arguments, and element i
+        is computed when it's read by calling the kernel on element i of every varying. A varying that is itself a
+        deferred map is expanded the same way, so a chain of element-wise maps turns into one nested expression per
+        element, which runs as a single loop with no intermediate buffers once the chain is materialized. A deferred map
+        owns its arguments, so the maps it was chained onto and any buffer moved into it are dropped along with it.
+
+spice element-at (value i)
+    """"Element i of a buffer, or of a deferred map, whose kernel is called on element i of each of its varyings. The
+        storage of a deferred map is the kernel followed by its uniforms and then its varyings.
+    let T = ('strip-qualifiers ('typeof value))
+    if (T < deferred-map)
+        let n-uniforms = (('@ T 'n-uniforms) as i32)
+        let n-fields = ('element-count ('storage T))
+        let storage = `(storagecast value)
+        let call = (sc_call_new `(storage @ 0))
+        for k in (range 1 n-fields)
+            sc_call_append_argument call
+                if (k <= n-uniforms)
+                    `(storage @ k)
+                else
+                    `(element-at (storage @ k) i)
+        call
+    else
+        `(value @ i)
+
+spice deferred-count (value)
+    """"A deferred map has as many elements as its shortest varying.
+    let T = ('strip-qualifiers ('typeof value))
+    let n-uniforms = (('@ T 'n-uniforms) as i32)
+    let n-fields = ('element-count ('storage T))
+    if (n-fields <= (n-uniforms + 1))
+        error "a kernel has to be mapped over at least one varying"
+    let storage = `(storagecast value)
+    fold (count = `(countof (storage @ (n-uniforms + 1)))) for k in (range (n-uniforms + 2) n-fields)
+        `(min count (countof (storage @ k)))
+
+spice drop-operands (value)
+    """"Drops the kernel, uniforms and varyings held in the storage of a deferred map, which its storage being a plain
+        tuple otherwise wouldn't.
+    let T = ('strip-qualifiers ('typeof value))
+    let n-fields = ('element-count ('storage T))
+    let storage = `(storagecast value)
+    let block = (sc_expression_new)
+    for k in (range n-fields)
+        sc_expression_append block `(__drop (storage @ k))
+    sc_expression_append block `()
+    block
+
+run-stage;
+
+type+ deferred-map
+    @@ memo
+    inline make-type (kernel-type ST)
+        type (.. "(deferred-map " (tostring kernel-type) ")") < this-type : ST
+            let kernel-type
+            let n-uniforms = (countof kernel-type.uniforms)
+            let element = kernel-type.return-type
+
+            inline materialize (self)
+                """"Computes every element into a new buffer, in one pass no matter how many maps were fused.
+                (buffer element) (countof self)
+                    inline (i)
+                        element-at self i
+
+            inline __countof (self)
+                deferred-count self
+
+            inline __@ (self idx)
+                element-at self (idx as usize)
+
+            inline __drop (self)
+                returning void
+                drop-operands self
+                _;
+
+            # Passing a deferred map where a buffer is expected is a boundary nothing can be fused across.
+            inline __imply (cls T)
+                static-if (T == (buffer element))
+                    inline (self)
+                        'materialize self
+
+    inline __typecall (cls kernel args...)
+        static-if (cls == this-type)
+            let ST = (tuple (typeof kernel) (va-map typeof args...))
+            bitcast (tupleof kernel args...) (make-type (typeof kernel) ST)
+        else
+            error "deferred-map types are only made by mapping a kernel"
+
+type processor-executor < executor : (tuple)
+    """"Runs kernels on the CPU. map is lazy, so consecutive maps are fused and nothing is computed until the result
+        is downloaded or used as a buffer.
+    inline __typecall (cls)
+        bitcast (tupleof) cls
+
+    inline upload-buffer (self buff)
         buff
+
+    inline download-buffer (self buff)
+        static-if (('strip-qualifiers (typeof buff)) < deferred-map)
+            'materialize buff
+        else
+            buff
+
     inline new-buffer (self typ size initializer)
         ((buffer typ) size initializer)
-    spice map (self kernel args...)
-        let kernel-type = ('typeof kernel)
-        let n-uniforms = (countof kernel-type.uniforms)
-        let arg-uniforms... = (lslice args... n-uniforms)
-        let arg-varyings... = (rslice args... n-uniforms)
-        let output-type = (buffer kernel-type.return-type)
-        spice-quote
-            let sizes... = (va-map countof arg-varyings...)
-            let result-size = (min sizes...)
-            let output =
-                output-type result-size
-                    inline (i)
-                        let arg-elems... = (va-map (inline (buff) buff @ i) arg-varyings...)
-                        kernel arg-uniforms... arg-elems...
-            output
 
+    inline map (self kernel args...)
+        deferred-map kernel args...
 
 # Executors:
     single threaded CPU executor
@@ -227,22 +317,4 @@ type rendering-executor < executor
     pipelines may be invoked on device data in a renderpass
 
 
-#run-stage;
-#TESTS
-#fn test()
-    let ex = (processor-executor)
-    let xs =
-        'new-buffer ex f32 128
-            inline (i)
-                i * 2
-    let ys =
-        'new-buffer ex f32 128
-            inline (i)
-                i * 3
-    kernel saxpy (x : f32, y : f32) {a : f32}
-        a * x + y
-    let res =
-        'map ex saxpy 0.5 xs ys
-    'download-buffer ex res
-
 locals;
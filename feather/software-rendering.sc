@@ -1,10 +1,46 @@
 
 using import glm
 import .imageio
+import .executors.threadpool
 using import Array
 using import enum
 using import struct
 
+let C =
+    include
+        """"#include <string.h>
+
+let RGBA8 = (vector u8 4)
+let SRGB_STEPS = 4096 # Fine enough that every step of linear light maps to less than one step of an 8-bit channel
+
+# Textures hold linear light, and images hold 8-bit sRGB, so every conversion goes through these tables instead of
+# calling pow for every channel of every pixel.
+global srgb-decode-lut : (array f32 256)
+global srgb-encode-lut : (array u8 SRGB_STEPS)
+global srgb-luts-state : u32 # 0 until a thread starts building the tables, 1 while it does, 2 once they're ready
+
+fn srgb-luts ()
+    # Textures can be converted on any thread, so the first one to get here builds the tables and the rest wait for it.
+    loop ()
+        let state = (atomicrmw or (& srgb-luts-state) 0:u32)
+        if (state == 2:u32)
+            break;
+        if (state == 0:u32)
+            let _ ok = (cmpxchg (& srgb-luts-state) 0:u32 1:u32)
+            if ok
+                for i in (range 256)
+                    let c = ((i as f32) / 255)
+                    (srgb-decode-lut @ i) =
+                        ? (c <= 0.04045) (c / 12.92) (pow ((c + 0.055) / 1.055) 2.4)
+                for i in (range SRGB_STEPS)
+                    let c = ((i as f32) / ((SRGB_STEPS - 1) as f32))
+                    let e =
+                        ? (c <= 0.0031308) (c * 12.92) (1.055 * (pow c (1.0 / 2.4)) - 0.055)
+                    (srgb-encode-lut @ i) = ((e * 255 + 0.5) as u8)
+                atomicrmw xchg (& srgb-luts-state) 2:u32
+
+inline image-row (img y)
+    inttoptr (+ (ptrtoint img.pixels intptr) (* y img.bytes_per_line)) (mutable@ RGBA8)
 
 type texture < Struct
 
@@ -13,28 +49,44 @@ inline mkTex (element)
     struct ("(texture " .. (tostring element) .. ")") < texture
         texels : (@ element)
         size : uvec2
+        sail-owned? : bool = false # Texels taken over from a SAIL image, which has its own allocator
 
         inline __drop(self)
-            free self.texels
+            if self.sail-owned?
+                imageio.raw.extern.sail_free (bitcast self.texels voidstar)
+            else
+                free self.texels
 
         fn to-image (self)
+            """"Copies the texture into a new RGBA8 image. vec4 texels are linear and get encoded to sRGB, while RGBA8
+                texels are already in the image's format, so each row is copied as is.
             returning imageio.image
-            static-if (element != vec4)
+            static-if ((element != vec4) and (element != RGBA8))
                 error "pixel format NYI"
 
-            let img = (imageio.image (@ self.size 0) (@ self.size 1) 4)
+            let width height = (@ self.size 0) (@ self.size 1)
+            let img = (imageio.image width height 4)
             img.pixel_format = imageio.raw.const.SAIL_PIXEL_FORMAT_BPP32_RGBA
-            img.gamma = 1
-            for i in (range (img.width * img.height))
-                # TODO: gamma correction
-                let pixel =
-                    (@ self.texels i) * (vec4 255)
-                (@ (inttoptr (+ (ptrtoint img.pixels intptr) (* i 4)) (mutable@ (vector u8 4))) 0) =
-                    vectorof u8
-                        (@ pixel 0) as u8
-                        (@ pixel 1) as u8
-                        (@ pixel 2) as u8
-                        (@ pixel 3) as u8
+            static-if (element == RGBA8)
+                for y in (range height)
+                    C.extern.memcpy (image-row img y) (& (self.texels @ (y * width))) (width * 4)
+            else
+                srgb-luts;
+                let steps = (vec4 ((SRGB_STEPS - 1) as f32))
+                for y in (range height)
+                    let row = (image-row img y)
+                    let texels = (& (self.texels @ (y * width)))
+                    for x in (range width)
+                        # Clamping and scaling all four channels at once leaves only the table lookups per channel.
+                        let texel = (clamp (texels @ x) (vec4 0) (vec4 1))
+                        let pixel = (texel * steps + (vec4 0.5))
+                        (row @ x) =
+                            vectorof u8
+                                srgb-encode-lut @ ((@ pixel 0) as u32)
+                                srgb-encode-lut @ ((@ pixel 1) as u32)
+                                srgb-encode-lut @ ((@ pixel 2) as u32)
+                                # Alpha is coverage, not light, so it's stored linearly
+                                ((@ texel 3) * 255.0 + 0.5) as u8
             img
 
 spice lerp (a b x)
@@ -74,82 +126,202 @@ inline barycentric-2d (p a b c)
         v
         w
 
+let TILE = 16:u32 # Pixels along each side of a tile
+let PARALLEL_TILES = 16:u32 # Triangles covering fewer tiles than this aren't worth waking threads for
+let FAR = 100000000000:f32
+
+inline edge (a b p)
+    """"Twice the signed area of the triangle a b p, which is linear in p, so it can be stepped across a row of pixels.
+    (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x)
+
+inline splat4 (s)
+    vectorof f32 s s s s
+
 run-stage;
 
 struct canvas
     pixels : (mutable@ vec3)
     zbuff : (mutable@ f32)
+    tilez : (mutable@ f32) # Farthest depth in each tile, so tiles a triangle is entirely behind are skipped whole
     size : uvec2
+    tiles : uvec2
 
     fn clear (self color)
         for i in (range (self.size.x * self.size.y))
             (self.pixels @ i) = color
-            (self.zbuff @ i) = 100000000000
+            (self.zbuff @ i) = FAR
+        for i in (range (self.tiles.x * self.tiles.y))
+            (self.tilez @ i) = FAR
 
     inline _write-pixel (self pos col z)
         let offs = (pos.x + pos.y * self.size.x)
         (self.pixels @ offs) = col
         (self.zbuff @ offs) = z
 
-    inline triangle (self a b c fragment-shader)
-        #inline loop-region (y-top y-bottom x-start x-stop slope-start slope-stop)
-            for y in (range (round y-top) (round y-bottom))
-                for x in (range (round (x-start + slope-start * (y - y-start))) (round (x-stop + slope-stop * (y - y-start))))
-                    fragment-shader
-        # do this the bad way at first.
-        for y in (range self.size.y)
-            for x in (range self.size.x)
-                let u v w =
-                    barycentric-2d (vec2 x y) a.pos.xy b.pos.xy c.pos.xy
-                if
-                    and
-                        u <= 1
-                        u >= 0
-                        v <= 1
-                        v >= 0
-                        w <= 1
-                        w >= 0
-                    let point =
-                        lerp
-                            lerp
-                                a
-                                b
-                                v / (v + u)
-                            c
-                            w
-                    if ( (@ self.zbuff (x + self.size.x * y)) > point.pos.z)
-                        let col = (fragment-shader point)
-                        # ('@ self.tex x y) = (vec4 (col imply vec3) point.pos.z)
-                        # _write-pixel self (uvec2 x y) (vec3 1 1 1) 0
-                        _write-pixel self (uvec2 x y) col point.pos.z
     inline stencil
 
+inline raster-tile (cnv a b c area zmin tile fragment-shader)
+    """"Rasterizes the part of a triangle inside one tile. Edge functions and depth are evaluated for four pixels at
+        once, and only pixels that pass both are shaded. Tiles never overlap, so any number of them can be rasterized
+        at the same time.
+    let t = (tile.x + tile.y * cnv.tiles.x)
+    if (zmin < (cnv.tilez @ t))
+        let x0 y0 = (tile.x * TILE) (tile.y * TILE)
+        let x1 y1 = (min (x0 + TILE) cnv.size.x) (min (y0 + TILE) cnv.size.y)
+        let pa pb pc = a.pos b.pos c.pos
+        let zero = (splat4 0.0)
+        let steps = (vectorof f32 0 1 2 3)
+        local wrote = false
+        for y in (range y0 y1)
+            let py = (splat4 (y as f32))
+            for x in (range x0 x1 4)
+                let px = ((splat4 (x as f32)) + steps)
+                inline edge4 (p q)
+                    -
+                        (splat4 ((q.x - p.x) / area)) * (py - (splat4 p.y))
+                        (splat4 ((q.y - p.y) / area)) * (px - (splat4 p.x))
+                # Dividing by the signed area makes the weights positive inside, whichever way the triangle winds.
+                let u v w = (edge4 pb pc) (edge4 pc pa) (edge4 pa pb)
+                let z = (u * (splat4 pa.z) + v * (splat4 pb.z) + w * (splat4 pc.z))
+                let offs = (x + y * cnv.size.x)
+                # Lanes past the edge of the tile reread its last pixel instead of running off the end of the row.
+                let depth =
+                    vectorof f32
+                        va-map
+                            inline (i)
+                                cnv.zbuff @ (offs + (min (i as u32) (x1 - x - 1)))
+                            va-range 4
+                let mask = ((u >= zero) & (v >= zero) & (w >= zero) & (px < (splat4 (x1 as f32))) & (z < depth))
+                for lane in (range 4)
+                    if (extractelement mask lane)
+                        let bu bv bw = (extractelement u lane) (extractelement v lane) (extractelement w lane)
+                        let point =
+                            lerp
+                                lerp
+                                    a
+                                    b
+                                    ? ((bu + bv) > 0) (bv / (bu + bv)) 0.0
+                                c
+                                bw
+                        '_write-pixel cnv (uvec2 (x + lane) y) (fragment-shader point) point.pos.z
+                        wrote = true
+
+        # Depth only ever gets nearer, so the tile's farthest depth only has to be found again if something was drawn.
+        if wrote
+            local far = 0:f32
+            for y in (range y0 y1)
+                for x in (range x0 x1)
+                    far = (max far (cnv.zbuff @ (x + y * cnv.size.x)))
+            (cnv.tilez @ t) = far
 
+@@ memo
+inline raster-job (V)
+    """"One triangle, shared by every thread rasterizing its tiles. Tiles are handed out by bumping next.
+    struct (.. "(raster-job " (tostring V) ")")
+        target : canvas
+        a : V
+        b : V
+        c : V
+        area : f32
+        zmin : f32
+        first : uvec2 # The tile at the top left of the triangle's bounding box
+        span : u32 # Tiles across the bounding box
+        count : u32
+        next : u32
+
+@@ memo
+inline raster-worker (V fragment-shader)
+    let job-type = (raster-job V)
+    static-typify
+        fn "raster-worker" (arg)
+            let job = (@ (arg as (mutable@ job-type)))
+            loop ()
+                let i = ((atomicrmw add (& job.next) 1:u32) as u32)
+                if (i >= job.count)
+                    break;
+                let tile = (uvec2 (job.first.x + i % job.span) (job.first.y + i // job.span))
+                raster-tile job.target job.a job.b job.c job.area job.zmin tile fragment-shader
+            nullof voidstar
+        voidstar
+
+type+ canvas
+    inline triangle (self a b c fragment-shader)
+        """"Draws a triangle by rasterizing every tile its bounding box touches. Tiles are spread across threads once a
+            triangle covers enough of them.
+        let area = (edge a.pos b.pos c.pos)
+        let lo-x = (max 0.0 (floor (min a.pos.x (min b.pos.x c.pos.x))))
+        let lo-y = (max 0.0 (floor (min a.pos.y (min b.pos.y c.pos.y))))
+        let hi-x = (min ((self.size.x - 1) as f32) (ceil (max a.pos.x (max b.pos.x c.pos.x))))
+        let hi-y = (min ((self.size.y - 1) as f32) (ceil (max a.pos.y (max b.pos.y c.pos.y))))
+        # Degenerate triangles, and triangles entirely off the canvas, cover nothing.
+        if ((area != 0) and (lo-x <= hi-x) and (lo-y <= hi-y))
+            let first = (uvec2 ((lo-x as u32) // TILE) ((lo-y as u32) // TILE))
+            let last = (uvec2 ((hi-x as u32) // TILE) ((hi-y as u32) // TILE))
+            let span = (last.x - first.x + 1)
+            local job =
+                (raster-job (typeof a))
+                    target = self
+                    a = a
+                    b = b
+                    c = c
+                    area = area
+                    zmin = (min a.pos.z (min b.pos.z c.pos.z))
+                    first = first
+                    span = span
+                    count = (span * (last.y - first.y + 1))
+                    next = 0
+            let worker = (raster-worker (typeof a) fragment-shader)
+
+            # The calling thread always rasterizes tiles too, so small triangles never touch another thread.
+            let helpers =
+                ? (job.count >= PARALLEL_TILES) ((min (threadpool.cpu-count) job.count) - 1) 0:u32
+            'run (@ (threadpool.shared-pool)) worker (&job as voidstar) helpers
 
 type+ texture
     fn from-image (img)
+        """"Decodes an RGBA8 image into a texture of linear vec4 texels, one row at a time.
         if (img.pixel_format != imageio.raw.const.SAIL_PIXEL_FORMAT_BPP32_RGBA)
             error "pixel format NYI"
+        srgb-luts;
         (mkTex vec4)
             size = (uvec2 img.width img.height)
             texels =
                 do
                     let data = (malloc-array vec4 (img.width * img.height))
-                    for x in (range img.width)
-                        for y in (range img.height)
-                            let pixel =
-                                @ (inttoptr (+ (ptrtoint img.pixels intptr) (* y img.bytes_per_line) (* x 4)) (@ (vector u8 4))) 0
-                            let fpixel =
+                    for y in (range img.height)
+                        let row = (image-row img y)
+                        let texels = (& (data @ (y * img.width)))
+                        for x in (range img.width)
+                            let pixel = (row @ x)
+                            (texels @ x) =
                                 vec4
-                                    @ pixel 0
-                                    @ pixel 1
-                                    @ pixel 2
-                                    @ pixel 3
-                            # TODO: gamma correction
-                            (@ data (x + (img.width * y))) =
-                                fpixel / (vec4 255)
+                                    srgb-decode-lut @ (@ pixel 0)
+                                    srgb-decode-lut @ (@ pixel 1)
+                                    srgb-decode-lut @ (@ pixel 2)
+                                    ((@ pixel 3) as f32) / 255.0
+                    data
 
+    fn from-image-raw (img)
+        """"Wraps an RGBA8 image in a texture of RGBA8 texels without converting them. If the rows are tightly packed
+            the texture takes over the image's pixels, leaving the image empty, so nothing is copied at all. Pixels it
+            took over are given back to SAIL's allocator when the texture is dropped.
+        if (img.pixel_format != imageio.raw.const.SAIL_PIXEL_FORMAT_BPP32_RGBA)
+            error "pixel format NYI"
+        let adopt? = (img.bytes_per_line == (img.width * 4))
+        (mkTex RGBA8)
+            size = (uvec2 img.width img.height)
+            sail-owned? = adopt?
+            texels =
+                if adopt?
+                    let data = (img.pixels as (mutable@ RGBA8))
+                    img.pixels = null
+                    data
+                else
+                    let data = (malloc-array RGBA8 (img.width * img.height))
+                    for y in (range img.height)
+                        C.extern.memcpy (& (data @ (y * img.width))) (image-row img y) (img.width * 4)
                     data
+
     inline from-shader (width height typ f)
         (mkTex typ)
             size = (uvec2 width height)
@@ -175,12 +347,17 @@ type+ texture
         let size = (width * height)
         let pixels = (malloc-array vec3 size)
         let zbuff = (malloc-array f32 size)
+        let tiles = (uvec2 ((width + TILE - 1) // TILE) ((height + TILE - 1) // TILE))
+        let tilez = (malloc-array f32 (tiles.x * tiles.y))
         let cnv =
             canvas
                 pixels = pixels
                 zbuff = zbuff
+                tilez = tilez
                 size = (uvec2 width height)
+                tiles = tiles
         draw cnv
+        free tilez
         free zbuff
         (mkTex vec3)
             texels = pixels
@@ -3,6 +3,10 @@
 
 #include "platform.hpp"
 #include "ProviderGLFW.hpp"
+#ifndef FG_PLATFORM_WIN32
+  #define GLFW_EXPOSE_NATIVE_X11
+  #include "GLFW/glfw3native.h"
+#endif
 #include <cfloat>
 #include <cmath>
 #include <cstring>
@@ -18,6 +22,9 @@ const float Provider::BASE_DPI    = 96.0f;
 
 FG_Result Provider::Behavior(WindowGL* w, const FG_Msg& msg)
 {
+  // A destroyed window might only be waiting for _pump to delete it, and the behavior has already let go of it.
+  if(w->_closing)
+    return FG_Result{ -1 };
   return (*_behavior)(w, const_cast<FG_Msg*>(&msg), _uictx, w->window_id);
 }
 
@@ -118,7 +125,18 @@ int Provider::DestroyWindow(FG_DesktopInterface* self, FG_Window* window)
     return ERR_MISSING_PARAMETER;
 
   _lasterr = 0; // We set this to capture GLFW errors, which are seperate from OpenGL errors (for right now)
-  delete static_cast<WindowGL*>(window);
+  auto w   = static_cast<WindowGL*>(window);
+
+  // Behaviors destroy windows from their own messages, and whatever delivered the message still uses the window after
+  // the behavior returns, so it's only hidden until _pump is done with it.
+  if(static_cast<Provider*>(self)->_pumping > 0)
+  {
+    w->_closing = true;
+    if(w->GetWindow())
+      glfwHideWindow(w->GetWindow());
+  }
+  else
+    delete w;
   return _lasterr;
 }
 
@@ -303,27 +321,98 @@ int Provider::ClearClipboard(FG_DesktopInterface* self, FG_Window* window, FG_Cl
 #endif
 }
 
+int Provider::_pump(FG_Window* window, void* ui_state, double timeout)
+{
+  _uictx   = ui_state;
+  _lasterr = 0;
+  ++_pumping;
+  if(timeout == 0.0)
+    glfwPollEvents();
+  else if(timeout < 0.0)
+    glfwWaitEvents();
+  else
+    glfwWaitEventsTimeout(timeout);
+
+  if(_lasterr == 0)
+  {
+    if(!window)
+      window = _windows;
+    if(window)
+      static_cast<WindowGL*>(window)->PollJoysticks();
+
+    // Windows destroyed by the behavior stay in the list until _reap, so walking it is safe.
+    for(auto w = _windows; w != nullptr; w = w->_next)
+      w->FlushInput();
+  }
+
+  --_pumping;
+  _reap();
+  _uictx = nullptr;
+  return _lasterr != 0 ? _lasterr : _windows != nullptr;
+}
+
+void Provider::_reap()
+{
+  if(_pumping > 0)
+    return;
+
+  for(auto w = _windows; w != nullptr;)
+  {
+    auto next = w->_next;
+    if(w->_closing)
+      delete w;
+    w = next;
+  }
+}
+
 int Provider::ProcessMessages(FG_DesktopInterface* self, FG_Window* window, void* ui_state)
 {
-  auto backend    = static_cast<Provider*>(self);
-  backend->_uictx = ui_state;
-  _lasterr        = 0;
-  glfwPollEvents();
-  if(_lasterr != 0)
-    return _lasterr;
+  return static_cast<Provider*>(self)->_pump(window, ui_state, 0.0);
+}
 
-  if(!window)
-    window = backend->_windows;
-  if(window)
-    static_cast<WindowGL*>(window)->PollJoysticks();
+int Provider::WaitMessages(FG_DesktopInterface* self, FG_Window* window, void* ui_state, double timeout)
+{
+  return static_cast<Provider*>(self)->_pump(window, ui_state, timeout);
+}
 
-  backend->_uictx = nullptr;
-  return backend->_windows != nullptr;
+int Provider::WakeMessages(FG_DesktopInterface* self)
+{
+  // This is the only GLFW function besides the time functions that can be called from any thread.
+  glfwPostEmptyEvent();
+  return ERR_SUCCESS;
 }
+
 int Provider::GetMessageSyncObject(FG_DesktopInterface* self, FG_Window* window)
 {
-  auto backend = static_cast<Provider*>(self);
+#ifdef FG_PLATFORM_WIN32
+  // A thread's message queue has no handle of its own, waitMessages is the only way to sleep on it.
   return ERR_NOT_IMPLEMENTED;
+#else
+  // Xlib may have already read events off the connection by the time this is polled, so processMessages has to run
+  // once before waiting on it, and every time it becomes readable. wakeMessages also goes through the connection.
+  _lasterr     = 0;
+  auto display = glfwGetX11Display();
+  if(_lasterr != 0)
+    return _lasterr;
+  if(!display)
+    return ERR_INVALID_CALL;
+  return ConnectionNumber(display);
+#endif
+}
+
+int Provider::SetInputCoalescing(FG_DesktopInterface* self, FG_Window* window, bool enable)
+{
+  if(!window)
+    return ERR_MISSING_PARAMETER;
+  static_cast<WindowGL*>(window)->SetCoalescing(enable);
+  return ERR_SUCCESS;
+}
+
+uint32_t Provider::GetCoalescedEvents(FG_DesktopInterface* self, FG_Window* window, FG_Msg* target, uint32_t count)
+{
+  if(!window)
+    return 0;
+  return static_cast<WindowGL*>(window)->GetCoalesced(target, count);
 }
 
 int Provider::SetCursorImpl(FG_DesktopInterface* self, FG_Window* window, FG_Cursor cursor)
@@ -472,7 +561,7 @@ long long GetRegistryValueW(HKEY__* hKeyRoot, const wchar_t* szKey, const wchar_
 #endif
 
 Provider::Provider(void* log_context, FG_Log log, FG_Behavior behavior) :
-  _logctx(log_context), _log(log), _behavior(behavior), _windows(nullptr), _uictx(nullptr)
+  _logctx(log_context), _log(log), _behavior(behavior), _windows(nullptr), _uictx(nullptr), _pumping(0)
 {
   createWindow         = &CreateWindowImpl;
   setWindow            = &SetWindow;
@@ -483,7 +572,11 @@ Provider::Provider(void* log_context, FG_Log log, FG_Behavior behavior) :
   checkClipboard       = &CheckClipboard;
   clearClipboard       = &ClearClipboard;
   processMessages      = &ProcessMessages;
+  waitMessages         = &WaitMessages;
+  wakeMessages         = &WakeMessages;
   getMessageSyncObject = &GetMessageSyncObject;
+  setInputCoalescing   = &SetInputCoalescing;
+  getCoalescedEvents   = &GetCoalescedEvents;
   setCursor            = &SetCursorImpl;
   getDisplayIndex      = &GetDisplayIndex;
   getDisplay           = &GetDisplay;
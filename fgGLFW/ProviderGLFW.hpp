@@ -69,7 +69,11 @@ namespace GLFW {
     static bool CheckClipboard(FG_DesktopInterface* self, FG_Window* window, enum FG_Clipboard kind);
     static int ClearClipboard(FG_DesktopInterface* self, FG_Window* window, enum FG_Clipboard kind);
     static int ProcessMessages(FG_DesktopInterface* self, FG_Window* window, void* ui_state);
+    static int WaitMessages(FG_DesktopInterface* self, FG_Window* window, void* ui_state, double timeout);
+    static int WakeMessages(FG_DesktopInterface* self);
     static int GetMessageSyncObject(FG_DesktopInterface* self, FG_Window* window);
+    static int SetInputCoalescing(FG_DesktopInterface* self, FG_Window* window, bool enable);
+    static uint32_t GetCoalescedEvents(FG_DesktopInterface* self, FG_Window* window, FG_Msg* target, uint32_t count);
     static int SetCursorImpl(FG_DesktopInterface* self, FG_Window* window, enum FG_Cursor cursor);
     static int GetDisplayIndex(FG_DesktopInterface* self, unsigned int index, FG_Display* out);
     static int GetDisplay(FG_DesktopInterface* self, uintptr_t handle, FG_Display* out);
@@ -94,8 +98,14 @@ namespace GLFW {
     static Provider* _singleton;
 
   protected:
+    // Runs GLFW's event loop once, waiting up to timeout seconds for an event first, or forever if it's negative.
+    int _pump(FG_Window* window, void* ui_state, double timeout);
+    // Deletes the windows destroyed while _pump was delivering messages.
+    void _reap();
+
     FG_Log _log;
     FG_Behavior _behavior;
+    uint32_t _pumping; // Windows destroyed while this is non-zero might still be in use, so they're only marked
   };
 }
 
@@ -10,10 +10,12 @@
   #include "GLFW/glfw3native.h"
 #else
   #define GLFW_EXPOSE_NATIVE_X11
+  #define GLFW_EXPOSE_NATIVE_GLX
   #include "GLFW/glfw3native.h"
 #endif
 
 #include "ProviderGLFW.hpp"
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 
@@ -151,7 +153,16 @@ void WindowGL::FillKeyMap()
 
 WindowGL::WindowGL(Provider* backend, GLFWmonitor* display, uintptr_t window_id, FG_Vec2* pos, FG_Vec2* dim, uint64_t flags,
                    const char* caption) :
-  _next(nullptr), _prev(nullptr), _joysticks(0), _backend(backend)
+  _next(nullptr),
+  _prev(nullptr),
+  _joysticks(0),
+  _backend(backend),
+  _damage({ 0, 0, 0, 0 }),
+  _damagefull(true),
+  _coalesce(false),
+  _closing(false),
+  _coalesced(nullptr),
+  _ncoalesced(0)
 {
   FillKeyMap();
   if(flags & FG_WindowFlag_No_Caption)
@@ -171,8 +182,10 @@ WindowGL::WindowGL(Provider* backend, GLFWmonitor* display, uintptr_t window_id,
   //  glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
   //#endif
 
-  _window =
-    glfwCreateWindow(!dim ? 0 : static_cast<int>(dim->x), !dim ? 0 : static_cast<int>(dim->y), caption, nullptr, nullptr);
+  // Every window shares objects with the ones that already exist, so resources can be used by any of them, or loaded
+  // for all of them on a background context.
+  _window = glfwCreateWindow(!dim ? 0 : static_cast<int>(dim->x), !dim ? 0 : static_cast<int>(dim->y), caption,
+                             nullptr, backend->_windows ? backend->_windows->_window : nullptr);
 
   if(_window)
   {
@@ -234,10 +247,119 @@ void WindowGL::DirtyRect(const FG_Rect* area)
     InvalidateRect(hWnd, &rect, FALSE);
   }
 #else
-  // TODO inject draw message into queue
+  // X11 expose events don't carry the rect we asked for by the time GLFW reports them, so it's accumulated here and
+  // picked up by RefreshCallback.
+  if(!area)
+    _damagefull = true;
+  else if(_damage.right <= _damage.left || _damage.bottom <= _damage.top)
+    _damage = *area;
+  else
+  {
+    _damage.left   = std::min(_damage.left, area->left);
+    _damage.top    = std::min(_damage.top, area->top);
+    _damage.right  = std::max(_damage.right, area->right);
+    _damage.bottom = std::max(_damage.bottom, area->bottom);
+  }
 #endif
 }
 
+bool WindowGL::Merge(FG_Msg& last, const FG_Msg& msg)
+{
+  if(last.kind != msg.kind)
+    return false;
+
+  switch(msg.kind)
+  {
+  case FG_Event_Kind_MouseMove:
+    if(last.mouseMove.all != msg.mouseMove.all || last.mouseMove.modkeys != msg.mouseMove.modkeys)
+      return false;
+    last.mouseMove = msg.mouseMove;
+    return true;
+  case FG_Event_Kind_MouseScroll:
+    // Scroll deltas are relative, so they add up instead of replacing each other.
+    last.mouseScroll.x = msg.mouseScroll.x;
+    last.mouseScroll.y = msg.mouseScroll.y;
+    last.mouseScroll.delta += msg.mouseScroll.delta;
+    last.mouseScroll.hdelta += msg.mouseScroll.hdelta;
+    return true;
+  case FG_Event_Kind_JoyAxis:
+    if(last.joyAxis.index != msg.joyAxis.index || last.joyAxis.axis != msg.joyAxis.axis)
+      return false;
+    last.joyAxis = msg.joyAxis;
+    return true;
+  }
+  return false;
+}
+
+void WindowGL::Post(const FG_Msg& msg)
+{
+  if(!_coalesce)
+  {
+    _backend->Behavior(this, msg);
+    return;
+  }
+
+  // Only the newest queued message can be merged into, anything older would move the event past others.
+  bool mergeable = msg.kind == FG_Event_Kind_MouseMove || msg.kind == FG_Event_Kind_MouseScroll ||
+                   msg.kind == FG_Event_Kind_JoyAxis;
+  if(!mergeable)
+    _queue.push_back(QueuedMsg{ msg, 0, 0 });
+  else if(_queue.empty() || !Merge(_queue.back().msg, msg))
+    _queue.push_back(QueuedMsg{ msg, static_cast<uint32_t>(_history.size()), 0 });
+
+  if(mergeable && _history.size() < MAXHISTORY)
+  {
+    _history.push_back(msg);
+    ++_queue.back().count;
+  }
+}
+
+void WindowGL::FlushInput()
+{
+  if(_queue.empty())
+    return;
+
+  // Behaviors can post more input while this runs, which starts a new queue instead of touching this one.
+  std::vector<QueuedMsg> queue;
+  std::vector<FG_Msg> history;
+  queue.swap(_queue);
+  history.swap(_history);
+
+  for(auto& q : queue)
+  {
+    if(_closing)
+      break;
+    _coalesced  = q.count ? history.data() + q.first : nullptr;
+    _ncoalesced = q.count;
+    _backend->Behavior(this, q.msg);
+  }
+  _coalesced  = nullptr;
+  _ncoalesced = 0;
+
+  // Keep the storage around, so a steady stream of input doesn't allocate every frame.
+  if(_queue.empty())
+  {
+    queue.clear();
+    history.clear();
+    _queue.swap(queue);
+    _history.swap(history);
+  }
+}
+
+void WindowGL::SetCoalescing(bool enable)
+{
+  if(!enable)
+    FlushInput();
+  _coalesce = enable;
+}
+
+uint32_t WindowGL::GetCoalesced(FG_Msg* target, uint32_t count) const
+{
+  if(target)
+    std::copy_n(_coalesced, std::min(count, _ncoalesced), target);
+  return _ncoalesced;
+}
+
 uint8_t WindowGL::GetModKeys(int mods)
 {
   uint8_t m = 0;
@@ -267,7 +389,7 @@ void WindowGL::KeyCallback(GLFWwindow* window, int key, int scancode, int action
   if(action == GLFW_REPEAT)
     evt.keyUp.modkeys |= FG_ModKey_Held;
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 void WindowGL::CharCallback(GLFWwindow* window, unsigned int key)
@@ -277,7 +399,7 @@ void WindowGL::CharCallback(GLFWwindow* window, unsigned int key)
   evt.keyChar.unicode = key;
   evt.keyChar.modkeys = 0;
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 void WindowGL::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
@@ -292,7 +414,7 @@ void WindowGL::MouseButtonCallback(GLFWwindow* window, int button, int action, i
   evt.mouseOn.x = static_cast<float>(x);
   evt.mouseOn.y = static_cast<float>(y);
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 void WindowGL::MousePosCallback(GLFWwindow* window, double x, double y)
@@ -302,7 +424,7 @@ void WindowGL::MousePosCallback(GLFWwindow* window, double x, double y)
   evt.mouseMove.x = static_cast<float>(x);
   evt.mouseMove.y = static_cast<float>(y);
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 // Hooks the mouse event for a mouse entering or exiting the window
@@ -315,7 +437,7 @@ void WindowGL::EnterCallback(GLFWwindow* window, int entered)
   evt.mouseOn.x = static_cast<float>(x);
   evt.mouseOn.y = static_cast<float>(y);
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 // Hooks mouse wheel scroll (both dimensions)
@@ -330,7 +452,7 @@ void WindowGL::ScrollCallback(GLFWwindow* window, double xdelta, double ydelta)
   evt.mouseOn.x = static_cast<float>(x);
   evt.mouseOn.y = static_cast<float>(y);
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 // TODO: Should handle drag and drop somehow
@@ -347,7 +469,9 @@ void WindowGL::DropCallback(GLFWwindow* window, int count, const char* paths[])
     evt.drop.count  = static_cast<uint32_t>(strlen(paths[0]));
   }
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  // The paths are only valid during this callback, so this can't wait in the queue.
+  self->FlushInput();
+  self->_backend->Behavior(self, evt);
 }
 
 void WindowGL::FocusCallback(GLFWwindow* window, int focused)
@@ -355,12 +479,14 @@ void WindowGL::FocusCallback(GLFWwindow* window, int focused)
   auto self  = reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window));
   FG_Msg evt = { static_cast<uint16_t>(focused ? FG_Event_Kind_GotFocus : FG_Event_Kind_LostFocus) };
 
-  self->_backend->Behavior(reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window)), evt);
+  self->Post(evt);
 }
 
 void WindowGL::CloseCallback(GLFWwindow* window)
 {
-  auto self                = reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window));
+  auto self = reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window));
+  self->FlushInput();
+
   FG_Msg msg               = { FG_Event_Kind_SetWindowFlags };
   msg.setWindowFlags.flags = self->_backend->Behavior(self, FG_Msg{ FG_Event_Kind_GetWindowFlags }).getWindowFlags |
                              FG_WindowFlag_Closed;
@@ -375,7 +501,9 @@ void WindowGL::SizeCallback(GLFWwindow* window, int width, int height)
   FG_Msg msg             = { FG_Event_Kind_SetWindowRect };
   msg.setWindowRect.rect = { 0, 0, static_cast<float>(width), static_cast<float>(height) };
 
-  auto self = reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window));
+  auto self         = reinterpret_cast<WindowGL*>(glfwGetWindowUserPointer(window));
+  self->_damagefull = true; // The backbuffer was reallocated, so none of it can be kept
+  self->FlushInput();
   self->_backend->Behavior(self, msg);
 }
 
@@ -393,12 +521,31 @@ void WindowGL::RefreshCallback(GLFWwindow* window)
   // Assertions can also call our paint method outside of our queue processing, so ignore those
   if(!self->_backend->_uictx)
     return;
+
+  // Windows already merged every InvalidateRect since the last paint into rcPaint.
+  self->_damagefull = false;
+  self->_damage     = { static_cast<float>(ps.rcPaint.left), static_cast<float>(ps.rcPaint.top),
+                        static_cast<float>(ps.rcPaint.right), static_cast<float>(ps.rcPaint.bottom) };
 #endif
 
   FG_Msg msg    = { FG_Event_Kind_Draw };
   auto dim      = self->GetSize();
   msg.draw.area = { 0, 0, static_cast<float>(dim.x), static_cast<float>(dim.y) };
 
+  // A refresh with no damage recorded redraws everything. X11 can't tell an expose we asked for from one caused by the
+  // window being uncovered, so once one expose has drawn the damage, any others still on their way do the same.
+  if(!self->_damagefull && self->_damage.right > self->_damage.left && self->_damage.bottom > self->_damage.top)
+  {
+    msg.draw.area.left   = std::max(self->_damage.left, 0.0f);
+    msg.draw.area.top    = std::max(self->_damage.top, 0.0f);
+    msg.draw.area.right  = std::min(self->_damage.right, msg.draw.area.right);
+    msg.draw.area.bottom = std::min(self->_damage.bottom, msg.draw.area.bottom);
+  }
+  self->_damage     = { 0, 0, 0, 0 };
+  self->_damagefull = false;
+
+  // Draw with every input that arrived before this already applied.
+  self->FlushInput();
   self->_backend->Behavior(self, msg);
 }
 FG_Vec2i WindowGL::GetSize() const
@@ -476,7 +623,7 @@ void WindowGL::PollJoysticks()
             evt.kind = ((info.dwButtons & k) != 0) ? FG_Event_Kind_JoyButtonDown : FG_Event_Kind_JoyButtonUp;
             evt.joyButtonDown.button = j;
             evt.joyButtonDown.index  = i;
-            _backend->Behavior(this, evt);
+            Post(evt);
           }
         }
       }
@@ -496,7 +643,7 @@ void WindowGL::PollJoysticks()
             evt.joyAxis.axis  = j;
             evt.joyAxis.index = i;
             evt.joyAxis.value = TranslateJoyAxis(evt.joyAxis.axis, evt.joyAxis.index);
-            _backend->Behavior(this, evt);
+            Post(evt);
           }
         }
       }
@@ -532,9 +679,48 @@ int WindowGL::MakeCurrent()
   return Provider::_lasterr;
 }
 
-int WindowGL::SwapBuffers()
+#ifndef FG_PLATFORM_WIN32
+// GLX_MESA_copy_sub_buffer copies part of the backbuffer to the front without swapping, so the rest of the
+// backbuffer keeps what was drawn into it and the next partial frame can draw over it again. Has to be called with a
+// context current.
+typedef void (*PFN_glXCopySubBufferMESA)(Display*, GLXDrawable, int, int, int, int);
+static PFN_glXCopySubBufferMESA LoadCopySubBuffer()
+{
+  static PFN_glXCopySubBufferMESA CopySubBuffer = nullptr;
+  static bool loaded                            = false;
+  if(!loaded)
+  {
+    loaded = true;
+    if(glfwExtensionSupported("GLX_MESA_copy_sub_buffer"))
+      CopySubBuffer = reinterpret_cast<PFN_glXCopySubBufferMESA>(glfwGetProcAddress("glXCopySubBufferMESA"));
+  }
+  return CopySubBuffer;
+}
+#endif
+
+bool WindowGL::PartialPresent()
+{
+#ifndef FG_PLATFORM_WIN32
+  return LoadCopySubBuffer() != nullptr;
+#else
+  return false;
+#endif
+}
+
+int WindowGL::SwapBuffers(const FG_Rect* damage)
 {
   Provider::_lasterr = 0;
+#ifndef FG_PLATFORM_WIN32
+  if(auto CopySubBuffer = damage ? LoadCopySubBuffer() : nullptr)
+  {
+    auto dim = GetSize();
+    int x    = static_cast<int>(floorf(damage->left));
+    int y    = static_cast<int>(floorf(dim.y - damage->bottom)); // GLX has its origin at the bottom left
+    CopySubBuffer(glfwGetX11Display(), glfwGetGLXWindow(_window), x, y,
+                  static_cast<int>(ceilf(damage->right)) - x, static_cast<int>(ceilf(dim.y - damage->top)) - y);
+    return Provider::_lasterr;
+  }
+#endif
   glfwSwapBuffers(_window);
   return Provider::_lasterr;
 }
@@ -556,6 +742,7 @@ int WindowGL::Invalidate(FG_Rect* area)
     return InvalidateRect(hWnd, &rect, FALSE) ? 0 : -1;
   }
 #else
+  DirtyRect(area);
   if(!area)
     XClearArea(glfwGetX11Display(), glfwGetX11Window(_window), 0, 0, 0, 0, True);
   else
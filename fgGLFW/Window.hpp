@@ -7,6 +7,7 @@
 #include "feather/desktop_interface.h"
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
+#include <vector>
 
 namespace GLFW {
   class Provider;
@@ -17,14 +18,27 @@ namespace GLFW {
              const char* caption);
     ~WindowGL();
     static uint8_t GetModKeys(int mods);
+    // Adds r to the area the next Draw message asks to redraw, or the whole window if r is null.
     void DirtyRect(const FG_Rect* r);
     uint8_t ScanJoysticks();
     void PollJoysticks();
     int Invalidate(FG_Rect* area);
+    // Delivers an input event right away, or queues it if input coalescing is on.
+    void Post(const FG_Msg& msg);
+    // Delivers everything Post queued. Has to be called before any event that isn't queued, to keep them in order.
+    void FlushInput();
+    void SetCoalescing(bool enable);
+    uint32_t GetCoalesced(FG_Msg* target, uint32_t count) const;
     inline GLFWwindow* GetWindow() { return _window; }
     FG_COMPILER_DLLEXPORT FG_Vec2i GetSize() const;
     FG_COMPILER_DLLEXPORT int MakeCurrent();
-    FG_COMPILER_DLLEXPORT int SwapBuffers();
+    // True if SwapBuffers can present only the damage and keep the rest of the backbuffer. Otherwise a swap leaves
+    // the backbuffer undefined, so every frame has to draw all of it. Has to be called with the context current.
+    FG_COMPILER_DLLEXPORT bool PartialPresent();
+    // If damage is given, only that part of the backbuffer is presented when the platform can do so without
+    // destroying the rest of it. Otherwise this is a normal swap. A partial present ignores the swap interval and can
+    // tear, so only pass damage when the interval is 0.
+    FG_COMPILER_DLLEXPORT int SwapBuffers(const FG_Rect* damage = nullptr);
 #ifdef FG_PLATFORM_WIN32
     double TranslateJoyAxis(uint8_t axis, uint8_t index) const;
 #endif
@@ -42,8 +56,16 @@ namespace GLFW {
     static void JoystickCallback(int jid, int e);
 
     static uint8_t KeyMap[512];
-    static constexpr uint8_t MAXJOY  = 16;
-    static constexpr uint8_t MAXAXIS = 6;
+    static constexpr uint8_t MAXJOY    = 16;
+    static constexpr uint8_t MAXAXIS   = 6;
+    static constexpr size_t MAXHISTORY = 1024; // Events merged past this are still applied, but not kept in the history
+
+    struct QueuedMsg
+    {
+      FG_Msg msg;
+      uint32_t first; // Index of the first event in _history this was merged from
+      uint32_t count; // 0 if this kind of event is never merged
+    };
 
     struct JoyCaps
     {
@@ -59,12 +81,22 @@ namespace GLFW {
     WindowGL* _next; // GLFW doesn't let us detect when it destroys a window so we have to do it ourselves.
     WindowGL* _prev;
     uint32_t _joysticks;
+    FG_Rect _damage; // Bounding box of everything invalidated since the last Draw message
+    bool _damagefull;
+    bool _coalesce;
+    bool _closing; // Set by destroyWindow while messages are being delivered, _pump deletes the window afterwards
+    std::vector<QueuedMsg> _queue;
+    std::vector<FG_Msg> _history;
+    const FG_Msg* _coalesced; // Events the message currently being delivered was merged from
+    uint32_t _ncoalesced;
 #ifdef FG_PLATFORM_WIN32
     JoyCaps _joycaps[MAXJOY];
     uint32_t _allbuttons[MAXJOY];
     uint32_t _alljoyaxis[MAXJOY][MAXAXIS];
 #endif
     static void FillKeyMap();
+    // Folds msg into last if both are part of the same motion, where only the latest position or value matters.
+    static bool Merge(FG_Msg& last, const FG_Msg& msg);
   };
 }
 
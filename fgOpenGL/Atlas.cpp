@@ -0,0 +1,201 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "Atlas.hpp"
+#include "ProviderGL.hpp"
+#include <algorithm>
+
+using namespace GL;
+
+const Atlas::Region* Atlas::find(uint64_t key, uint64_t frame) noexcept
+{
+  auto i = _regions.find(key);
+  if(i == _regions.end())
+    return nullptr;
+
+  _pages[i->second.page].lastused = frame;
+  return &i->second;
+}
+
+GLExpected<Atlas::Region> Atlas::insert(Context* ctx, uint64_t key, FG_Vec2i size, const void* data) noexcept
+{
+  if(auto r = find(key, ctx->Frame()))
+    return *r;
+
+  const FG_Vec2i padded = { size.x + PADDING, size.y + PADDING };
+  if(size.x <= 0 || size.y <= 0 || padded.x > _pagesize.x || padded.y > _pagesize.y)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Atlas region must be non-empty and fit inside a page");
+
+  // Pages that were released to meet the memory budget are only brought back once every other page is full.
+  FG_Vec2i pos   = { 0, 0 };
+  uint32_t index = 0;
+  while(index < _pages.size() && (_pages[index].texture.empty() || !_pack(_pages[index], padded, pos)))
+    ++index;
+
+  if(index == _pages.size())
+  {
+    const auto live = std::count_if(_pages.begin(), _pages.end(), [](const Page& p) { return !p.texture.empty(); });
+
+    // Over the budget, an old page is emptied instead of recreating a released one or adding one, unless every page
+    // was used this frame. Otherwise the page trim just released would be allocated again on the next insert.
+    if(static_cast<size_t>(live) >= _maxpages || ResourceTable::over_budget(_format.image_bytes(_pagesize)))
+    {
+      auto e = _evict(ctx->Frame());
+      if(e.has_value())
+        index = e.value();
+      else if(static_cast<size_t>(live) >= _maxpages)
+        return std::move(e.error());
+    }
+
+    if(index == _pages.size())
+    {
+      index = 0;
+      while(index < _pages.size() && !_pages[index].texture.empty())
+        ++index;
+    }
+
+    if(index == _pages.size())
+      _pages.push_back(Page{ Owned<Texture>(), {}, {}, 0 });
+    if(_pages[index].texture.empty())
+    {
+      RETURN_ERROR(_allocate(_pages[index]));
+    }
+
+    if(!_pack(_pages[index], padded, pos))
+      return CUSTOM_ERROR(ERR_INVALID_CALL, "Region doesn't fit on an empty atlas page");
+  }
+
+  // Evicted regions leave their texels behind, and linear filtering at the edges of the new region would blend them in,
+  // so its padding is cleared first. The texels left of and above pos can only be padding or unused space as well.
+  const FG_Vec2i clearpos  = { std::max(pos.x - PADDING, 0), std::max(pos.y - PADDING, 0) };
+  const FG_Vec2i clearsize = { pos.x + padded.x - clearpos.x, pos.y + padded.y - clearpos.y };
+  if(_zeros.size() < _format.image_bytes(clearsize))
+    _zeros.resize(_format.image_bytes(clearsize));
+  RETURN_ERROR(ctx->UpdateTexture(_pages[index].texture, 0, clearpos, clearsize, _format, _zeros.data()));
+  RETURN_ERROR(ctx->UpdateTexture(_pages[index].texture, 0, pos, size, _format, data));
+
+  Region region = { index, FG_Rect{ static_cast<float>(pos.x), static_cast<float>(pos.y),
+                                    static_cast<float>(pos.x + size.x), static_cast<float>(pos.y + size.y) } };
+  _pages[index].keys.push_back(key);
+  _pages[index].lastused = ctx->Frame();
+  _regions[key]          = region;
+  return region;
+}
+
+bool Atlas::_pack(Page& page, FG_Vec2i size, FG_Vec2i& pos) const noexcept
+{
+  auto& nodes    = page.skyline;
+  size_t best    = nodes.size();
+  int bestbottom = _pagesize.y + 1;
+  int bestwidth  = 0;
+
+  for(size_t i = 0; i < nodes.size(); ++i)
+  {
+    if(nodes[i].x + size.x > _pagesize.x)
+      break;
+
+    // The region rests on the highest node it spans.
+    int y         = 0;
+    int remaining = size.x;
+    for(size_t j = i; remaining > 0; ++j)
+    {
+      y = std::max(y, nodes[j].y);
+      remaining -= nodes[j].width;
+    }
+
+    if(y + size.y <= _pagesize.y &&
+       (y + size.y < bestbottom || (y + size.y == bestbottom && nodes[i].width < bestwidth)))
+    {
+      best       = i;
+      bestbottom = y + size.y;
+      bestwidth  = nodes[i].width;
+      pos        = { nodes[i].x, y };
+    }
+  }
+
+  if(best == nodes.size())
+    return false;
+
+  nodes.insert(nodes.begin() + best, Node{ pos.x, pos.y + size.y, size.x });
+
+  // Cut away whatever part of the following nodes is now underneath the new one.
+  for(size_t i = best + 1; i < nodes.size();)
+  {
+    const int end = nodes[i - 1].x + nodes[i - 1].width;
+    if(nodes[i].x >= end)
+      break;
+
+    const int overlap = end - nodes[i].x;
+    if(nodes[i].width <= overlap)
+      nodes.erase(nodes.begin() + i);
+    else
+    {
+      nodes[i].x += overlap;
+      nodes[i].width -= overlap;
+      break;
+    }
+  }
+
+  for(size_t i = 0; i + 1 < nodes.size();)
+  {
+    if(nodes[i].y == nodes[i + 1].y)
+    {
+      nodes[i].width += nodes[i + 1].width;
+      nodes.erase(nodes.begin() + i + 1);
+    }
+    else
+      ++i;
+  }
+
+  return true;
+}
+
+void Atlas::_reset(Page& page) noexcept
+{
+  for(auto key : page.keys)
+    _regions.erase(key);
+  page.keys.clear();
+  page.skyline.assign(1, Node{ 0, 0, _pagesize.x });
+}
+
+GLExpected<void> Atlas::trim(uint64_t frame) noexcept
+{
+  // Released pages keep their slot, so the pages of every region that's left keep their index.
+  while(ResourceTable::over_budget())
+  {
+    auto e = _evict(frame);
+    if(!e.has_value())
+      break;
+    // The slot is empty even if the deletion failed, so the page is simply recreated later.
+    RETURN_ERROR(_pages[e.value()].texture.reset());
+  }
+  return {};
+}
+
+GLExpected<void> Atlas::_allocate(Page& page) noexcept
+{
+  _reset(page);
+  FG_Sampler sampler = { 0 };
+  sampler.filter     = FG_Filter_Min_Mag_Linear_Mip_Point;
+  if(auto e = Texture::create2D(GL_TEXTURE_2D, _format, _pagesize, sampler))
+    page.texture = std::move(e.value());
+  else
+    return std::move(e.error());
+  return {};
+}
+
+GLExpected<uint32_t> Atlas::_evict(uint64_t frame) noexcept
+{
+  uint32_t oldest = static_cast<uint32_t>(_pages.size());
+  for(uint32_t i = 0; i < _pages.size(); ++i)
+    if(!_pages[i].texture.empty() && _pages[i].lastused < frame &&
+       (oldest == _pages.size() || _pages[i].lastused < _pages[oldest].lastused))
+      oldest = i;
+
+  if(oldest == _pages.size())
+    return CUSTOM_ERROR(ERR_ATLAS_FULL, "Every atlas page is in use this frame");
+
+  // The old texels are left in place, they're simply overwritten along with the padding as new regions are packed.
+  _reset(_pages[oldest]);
+  return oldest;
+}
@@ -0,0 +1,79 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__ATLAS_H
+#define GL__ATLAS_H
+
+#include "Texture.hpp"
+#include "feather/graphics_interface.h"
+#include <vector>
+#include <unordered_map>
+
+namespace GL {
+  struct Context;
+
+  // Packs many small images, like glyphs and icons, into a few large texture pages, so quads drawn from them can share
+  // a texture and end up in the same batch. Each page is packed with a skyline, and once every page is full the page
+  // that was used least recently is emptied as a whole. Pages used during the current frame are never evicted, since
+  // command lists recorded this frame may still refer to them. Over the memory budget, the atlas stops growing and
+  // empties pages instead, and trim deletes the textures of old pages until the budget is met, which are recreated
+  // once every other page is full again.
+  struct Atlas
+  {
+    struct Region
+    {
+      uint32_t page;
+      FG_Rect uv; // In texels, like FG_Quad::uv
+    };
+
+    Atlas(FG_Vec2i pagesize, Format format, uint32_t maxpages) noexcept :
+      _pagesize(pagesize), _format(format), _maxpages(maxpages ? maxpages : 1)
+    {}
+    Atlas(const Atlas&)            = delete;
+    Atlas& operator=(const Atlas&) = delete;
+
+    // Returns nullptr if key isn't in the atlas. Otherwise marks its page as used during frame.
+    const Region* find(uint64_t key, uint64_t frame) noexcept;
+    // Packs size texels of data under key, uploading them through ctx, and marks the page as used. If key is already in
+    // the atlas, its old region is returned instead.
+    GLExpected<Region> insert(Context* ctx, uint64_t key, FG_Vec2i size, const void* data) noexcept;
+    inline FG_Resource texture(uint32_t page) const noexcept { return _pages[page].texture; }
+    // Releases the textures of pages that weren't used during frame, least recently used first, while the memory
+    // budget is exceeded. Everything on them is forgotten, just like when a page is evicted.
+    GLExpected<void> trim(uint64_t frame) noexcept;
+
+    static constexpr int PADDING = 1; // Keeps linear filtering from bleeding between neighbours
+
+  protected:
+    struct Node
+    {
+      int x;
+      int y; // Height of the skyline from x to x + width
+      int width;
+    };
+
+    struct Page
+    {
+      Owned<Texture> texture;
+      std::vector<Node> skyline;
+      std::vector<uint64_t> keys; // Everything that has to be forgotten when this page is evicted
+      uint64_t lastused;
+    };
+
+    // Finds the lowest spot that fits size, then raises the skyline over it. Returns false if the page is too full.
+    bool _pack(Page& page, FG_Vec2i size, FG_Vec2i& pos) const noexcept;
+    void _reset(Page& page) noexcept;
+    // Empties page and gives it a new texture.
+    GLExpected<void> _allocate(Page& page) noexcept;
+    GLExpected<uint32_t> _evict(uint64_t frame) noexcept;
+
+    FG_Vec2i _pagesize;
+    Format _format;
+    uint32_t _maxpages;
+    std::vector<Page> _pages;
+    std::unordered_map<uint64_t, Region> _regions;
+    std::vector<uint8_t> _zeros; // Uploaded over the padded rect of every new region
+  };
+}
+
+#endif
@@ -4,16 +4,19 @@
 #ifndef GL__BUFFER_H
 #define GL__BUFFER_H
 
-#include "Ref.hpp"
+#include "ResourceTable.hpp"
 
 namespace GL {
   struct Buffer : Ref
   {
-    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) { glDeleteBuffers(1, &i); };
+    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) {
+      ResourceTable::erase(REF_BUFFER, i);
+      glDeleteBuffers(1, &i);
+    };
 
     explicit constexpr Buffer() noexcept : Ref() {}
     explicit constexpr Buffer(GLuint buffer) noexcept : Ref(buffer) {}
-    explicit constexpr Buffer(FG_Resource buffer) noexcept : Ref(static_cast<GLuint>(buffer))
+    explicit constexpr Buffer(FG_Resource buffer) noexcept : Ref(static_cast<GLuint>(buffer & REF_MASK))
     {
 #ifdef _DEBUG
       if(_ref != 0)
@@ -30,20 +33,27 @@ namespace GL {
     }
 
     Buffer& operator=(const Buffer&) = default;
-    inline operator FG_Resource() const noexcept { return _ref | REF_BUFFER; }
+    inline operator FG_Resource() const noexcept { return ResourceTable::handle(REF_BUFFER, _ref); }
 
-    static bool validate(FG_Resource res) noexcept
-    {
-      return ((res & REF_BUFFER) != 0) && (glIsBuffer(static_cast<GLuint>(res & REF_MASK)) == GL_TRUE);
-    }
-    static GLExpected<Owned<Buffer>> create(GLenum target, const void* data, GLsizeiptr bytes)
+    static bool validate(FG_Resource res) noexcept { return ResourceTable::validate(REF_BUFFER, res); }
+    // Nonzero storage flags allocate immutable storage with glBufferStorage, which can be mapped persistently but never
+    // reallocated.
+    static GLExpected<Owned<Buffer>> create(GLenum target, const void* data, GLsizeiptr bytes, GLbitfield storage = 0)
     {
       GLuint fbgl;
       RETURN_ERROR(CALLGL(glGenBuffers, 1, &fbgl));
       Owned<Buffer> fb(fbgl);
+      ResourceTable::insert(REF_BUFFER, fbgl, ResourceInfo{ target, 0, { 0, 0 }, bytes });
       if(auto r = fb.bind(target))
       {
-        RETURN_ERROR(CALLGL(glBufferData, target, bytes, data, !data ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW));
+        if(storage)
+        {
+          RETURN_ERROR(CALLGL(glBufferStorage, target, bytes, data, storage));
+        }
+        else
+        {
+          RETURN_ERROR(CALLGL(glBufferData, target, bytes, data, !data ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW));
+        }
       }
       else
         return std::move(r.error());
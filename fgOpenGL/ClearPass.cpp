@@ -0,0 +1,130 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ClearPass.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace GL;
+
+namespace {
+  const char* const CLEAR_VS = "#version 110\n"
+                               "attribute vec2 vPos;\n"
+                               "uniform float depth;\n"
+                               "void main()\n"
+                               "{\n"
+                               "  gl_Position = vec4(vPos, depth * 2.0 - 1.0, 1.0);\n"
+                               "}\n";
+  const char* const CLEAR_FS = "#version 110\n"
+                               "uniform vec4 color;\n"
+                               "void main()\n"
+                               "{\n"
+                               "  gl_FragColor = color;\n"
+                               "}\n";
+
+  constexpr GLuint POSITION = 0;
+}
+
+ClearPass::~ClearPass()
+{
+#ifndef USE_EMULATED_VAOS
+  if(_vao)
+    glDeleteVertexArrays(1, &_vao);
+#endif
+}
+
+GLExpected<bool> ClearPass::prepare()
+{
+  if(_failed)
+    return false;
+  if(!_program.empty())
+    return true;
+
+  // The sources are fixed, so a failure here means the driver can't run them at all and the caller falls back to
+  // glClear for good. Compiling asynchronously skips the per-shader status queries, the link status covers both.
+  auto vs = ShaderObject::create(CLEAR_VS, GL_VERTEX_SHADER, nullptr, true);
+  if(vs.has_error())
+    return std::move(vs.error());
+  auto fs = ShaderObject::create(CLEAR_FS, GL_FRAGMENT_SHADER, nullptr, true);
+  if(fs.has_error())
+    return std::move(fs.error());
+  auto program = ProgramObject::create();
+  if(program.has_error())
+    return std::move(program.error());
+
+  RETURN_ERROR(program.value().attach(vs.value()));
+  RETURN_ERROR(program.value().attach(fs.value()));
+  RETURN_ERROR(CALLGL(glBindAttribLocation, program.value(), POSITION, "vPos"));
+  RETURN_ERROR(program.value().link());
+
+  GLint status = GL_FALSE;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program.value(), GL_LINK_STATUS, &status));
+  if(status != GL_TRUE)
+  {
+    _failed = true;
+    return false;
+  }
+
+  auto color = CALLGL(glGetUniformLocation, program.value(), "color");
+  if(color.has_error())
+    return std::move(color.error());
+  auto depth = CALLGL(glGetUniformLocation, program.value(), "depth");
+  if(depth.has_error())
+    return std::move(depth.error());
+
+#ifndef USE_EMULATED_VAOS
+  RETURN_ERROR(CALLGL(glGenVertexArrays, 1, &_vao));
+#endif
+  RETURN_ERROR(_ring.create(GL_ARRAY_BUFFER, RING_SIZE, sizeof(float)));
+
+  _program = std::move(program.value());
+  _color   = color.value();
+  _depth   = depth.value();
+  return true;
+}
+
+GLExpected<void> ClearPass::draw(std::span<const std::array<GLint, 4>> boxes, const std::array<GLint, 4>& bounds,
+                                 const std::array<float, 4>& color, float depth)
+{
+  RETURN_ERROR(CALLGL(glUniform4fv, _color, 1, color.data()));
+  RETURN_ERROR(CALLGL(glUniform1f, _depth, depth));
+#ifndef USE_EMULATED_VAOS
+  RETURN_ERROR(CALLGL(glBindVertexArray, _vao));
+#endif
+  RETURN_ERROR(CALLGL(glEnableVertexAttribArray, POSITION));
+
+  // Vertices are in normalized device coordinates of the bounds, so nothing the caller asked for is ever clipped.
+  const float sx = 2.0f / bounds[2];
+  const float sy = 2.0f / bounds[3];
+  std::vector<float> vertices;
+  vertices.reserve(std::min(boxes.size(), MAX_RECTS) * 12);
+  while(!boxes.empty())
+  {
+    auto chunk = boxes.first(std::min(boxes.size(), MAX_RECTS));
+    boxes      = boxes.subspan(chunk.size());
+
+    vertices.clear();
+    for(auto& box : chunk)
+    {
+      float l = (box[0] - bounds[0]) * sx - 1.0f;
+      float b = (box[1] - bounds[1]) * sy - 1.0f;
+      float r = l + box[2] * sx;
+      float t = b + box[3] * sy;
+      vertices.insert(vertices.end(), { l, b, r, b, l, t, r, b, r, t, l, t });
+    }
+
+    auto offset = _ring.write(vertices.data(), vertices.size() * sizeof(float));
+    if(offset.has_error())
+      return std::move(offset.error());
+
+    RETURN_ERROR(CALLGL(glBindBuffer, GL_ARRAY_BUFFER, _ring.buffer()));
+    RETURN_ERROR(CALLGL(glVertexAttribPointer, POSITION, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                        reinterpret_cast<void*>(offset.value())));
+    RETURN_ERROR(CALLGL(glDrawArrays, GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size() / 2)));
+  }
+
+#ifdef USE_EMULATED_VAOS
+  RETURN_ERROR(CALLGL(glDisableVertexAttribArray, POSITION));
+#endif
+  return {};
+}
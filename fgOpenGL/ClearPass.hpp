@@ -0,0 +1,47 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__CLEAR_PASS_H
+#define GL__CLEAR_PASS_H
+
+#include "RingBuffer.hpp"
+#include "ProgramObject.hpp"
+#include <array>
+#include <span>
+
+namespace GL {
+  // Clears any number of rects with a single draw, instead of one glScissor and glClear per rect. Every rect becomes two
+  // triangles drawn by a tiny built-in program, which writes the clear color to every draw buffer and the clear depth
+  // through gl_Position. Stencil is written by whoever draws it setting up a GL_REPLACE stencil test, and like glClear,
+  // the color, depth and stencil write masks still apply.
+  struct ClearPass
+  {
+    ClearPass() noexcept : _vao(0), _color(-1), _depth(-1), _failed(false) {}
+    ~ClearPass();
+    ClearPass(const ClearPass&)            = delete;
+    ClearPass& operator=(const ClearPass&) = delete;
+
+    // Builds the program on first use. Returns false if it can't be built, in which case glClear has to be used instead.
+    GLExpected<bool> prepare();
+    // Draws boxes, given as x, y, width and height in pixels, assuming the viewport was set to bounds. program() has to
+    // be bound. The pass's own vertex array is left bound.
+    GLExpected<void> draw(std::span<const std::array<GLint, 4>> boxes, const std::array<GLint, 4>& bounds,
+                          const std::array<float, 4>& color, float depth);
+
+    inline const ProgramObject& program() const noexcept { return _program; }
+
+    static constexpr size_t MIN_RECTS     = 4; // Below this, a few scissored glClears are cheaper than a draw
+    static constexpr size_t MAX_RECTS     = 256; // Per write into the ring, larger clears take several draws
+    static constexpr GLsizeiptr RING_SIZE = 1 << 16;
+
+  protected:
+    Owned<ProgramObject> _program;
+    RingBuffer _ring;
+    GLuint _vao;
+    GLint _color;
+    GLint _depth;
+    bool _failed;
+  };
+}
+
+#endif
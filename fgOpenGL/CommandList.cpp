@@ -0,0 +1,560 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "CommandList.hpp"
+#include "ProviderGL.hpp"
+#include "PipelineState.hpp"
+#include "ProgramObject.hpp"
+#include <cstring>
+
+using namespace GL;
+
+namespace {
+  struct ClearCmd : CommandList::Command
+  {
+    uint8_t clearbits;
+    uint8_t stencil;
+    FG_Color16 RGBA;
+    float depth;
+    uint32_t count; // followed by FG_Rect[count]
+  };
+
+  struct CopyResourceCmd : CommandList::Command
+  {
+    FG_Resource src;
+    FG_Resource dest;
+    FG_Vec3i size;
+    int level;
+  };
+
+  struct CopySubresourceCmd : CommandList::Command
+  {
+    FG_Resource src;
+    FG_Resource dest;
+    unsigned long srcoffset;
+    unsigned long destoffset;
+    unsigned long bytes;
+  };
+
+  struct CopyResourceRegionCmd : CommandList::Command
+  {
+    FG_Resource src;
+    FG_Resource dest;
+    int level;
+    FG_Vec3i srcoffset;
+    FG_Vec3i destoffset;
+    FG_Vec3i size;
+  };
+
+  struct DrawArraysCmd : CommandList::Command
+  {
+    uint32_t vertexcount;
+    uint32_t instancecount;
+    uint32_t startvertex;
+    uint32_t startinstance;
+  };
+
+  struct DrawIndexedCmd : CommandList::Command
+  {
+    uint32_t indexcount;
+    uint32_t instancecount;
+    uint32_t startindex;
+    int startvertex;
+    uint32_t startinstance;
+  };
+
+  struct DrawMeshCmd : CommandList::Command
+  {
+    uint32_t first;
+    uint32_t count;
+  };
+
+  struct DrawIndirectCmd : CommandList::Command
+  {
+    FG_Resource buffer;
+    uint32_t offset;
+    uint32_t count;
+    uint32_t stride;
+    bool indexed;
+  };
+
+  struct DispatchCmd : CommandList::Command
+  {
+    FG_Vec3i groups;
+    bool pipeline; // Set to use the pipeline's work groups instead
+  };
+
+  struct DispatchIndirectCmd : CommandList::Command
+  {
+    FG_Resource buffer;
+    uint32_t offset;
+  };
+
+  struct QuadsCmd : CommandList::Command
+  {
+    FG_Resource texture;
+    uint32_t count; // followed by FG_Quad[count]
+  };
+
+  struct BarrierCmd : CommandList::Command
+  {
+    GLbitfield flags;
+  };
+
+  struct RegionCmd : CommandList::Command
+  {
+    const char* name;
+  };
+
+  struct PipelineCmd : CommandList::Command
+  {
+    uintptr_t state;
+  };
+
+  struct VertexBuffersCmd : CommandList::Command
+  {
+    uint32_t first;
+    uint32_t count; // followed by FG_Resource[count], then uint32_t[count] offsets
+  };
+
+  struct ArrayCmd : CommandList::Command
+  {
+    uint32_t count; // followed by count elements of whatever the command operates on
+  };
+
+  // Followed by FG_ShaderValue[n] and uint32_t[n] offsets to any deep-copied values, where n is the number of slots.
+  struct PreparedCmd : CommandList::Command
+  {
+    const PreparedUniforms* prepared;
+  };
+
+  // Shader constants are deep-copied, because names and array values are pointers that only need to stay valid for the
+  // duration of the setShaderConstants call. name and data are byte offsets from the start of the command, or 0.
+  struct PackedUniform
+  {
+    FG_ShaderParameter param;
+    FG_ShaderValue value;
+    uint32_t name;
+    uint32_t data;
+  };
+
+  // Returns how many bytes an FG_ShaderValue points to, or 0 if the value is stored inline. This must agree with the
+  // way Context::SetShaderUniforms interprets values.
+  size_t UniformBytes(const FG_ShaderParameter& param)
+  {
+    if(param.type == FG_Shader_Type_Buffer || param.type == FG_Shader_Type_Texture)
+      return 0;
+
+    switch(ShaderObject::get_type(param))
+    {
+    case 0: return 0; // Invalid types are rejected when the command is replayed
+    case GL_DOUBLE:
+    case GL_HALF_FLOAT:
+    case GL_FLOAT:
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+      if(param.count <= 1)
+        return 0;
+    }
+
+    size_t components = static_cast<size_t>(!param.count ? 1 : param.count) * (!param.length ? 1 : param.length) *
+                        (param.width > 1 ? param.width : 1);
+    return components * (param.type == FG_Shader_Type_Double ? sizeof(double) : sizeof(float));
+  }
+}
+
+void CommandList::Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth, std::span<const FG_Rect> rects)
+{
+  auto cmd       = _push<ClearCmd>(Op::Clear, rects.size_bytes());
+  cmd->clearbits = clearbits;
+  cmd->RGBA      = RGBA;
+  cmd->stencil   = stencil;
+  cmd->depth     = depth;
+  cmd->count     = static_cast<uint32_t>(rects.size());
+  if(!rects.empty())
+    memcpy(_payload<FG_Rect>(cmd), rects.data(), rects.size_bytes());
+}
+
+void CommandList::CopyResource(FG_Resource src, FG_Resource dest, FG_Vec3i size, int level)
+{
+  auto cmd   = _push<CopyResourceCmd>(Op::CopyResource);
+  cmd->src   = src;
+  cmd->dest  = dest;
+  cmd->size  = size;
+  cmd->level = level;
+}
+
+void CommandList::CopySubresource(FG_Resource src, FG_Resource dest, unsigned long srcoffset, unsigned long destoffset,
+                                  unsigned long bytes)
+{
+  auto cmd        = _push<CopySubresourceCmd>(Op::CopySubresource);
+  cmd->src        = src;
+  cmd->dest       = dest;
+  cmd->srcoffset  = srcoffset;
+  cmd->destoffset = destoffset;
+  cmd->bytes      = bytes;
+}
+
+void CommandList::CopyResourceRegion(FG_Resource src, FG_Resource dest, int level, FG_Vec3i srcoffset,
+                                     FG_Vec3i destoffset, FG_Vec3i size)
+{
+  auto cmd        = _push<CopyResourceRegionCmd>(Op::CopyResourceRegion);
+  cmd->src        = src;
+  cmd->dest       = dest;
+  cmd->level      = level;
+  cmd->srcoffset  = srcoffset;
+  cmd->destoffset = destoffset;
+  cmd->size       = size;
+}
+
+void CommandList::DrawArrays(uint32_t vertexcount, uint32_t instancecount, uint32_t startvertex, uint32_t startinstance)
+{
+  auto cmd           = _push<DrawArraysCmd>(Op::DrawArrays);
+  cmd->vertexcount   = vertexcount;
+  cmd->instancecount = instancecount;
+  cmd->startvertex   = startvertex;
+  cmd->startinstance = startinstance;
+}
+
+void CommandList::DrawIndexed(uint32_t indexcount, uint32_t instancecount, uint32_t startindex, int startvertex,
+                              uint32_t startinstance)
+{
+  auto cmd           = _push<DrawIndexedCmd>(Op::DrawIndexed);
+  cmd->indexcount    = indexcount;
+  cmd->instancecount = instancecount;
+  cmd->startindex    = startindex;
+  cmd->startvertex   = startvertex;
+  cmd->startinstance = startinstance;
+}
+
+void CommandList::DrawMesh(uint32_t first, uint32_t count)
+{
+  auto cmd   = _push<DrawMeshCmd>(Op::DrawMesh);
+  cmd->first = first;
+  cmd->count = count;
+}
+
+void CommandList::DrawIndirect(FG_Resource buffer, uint32_t offset, uint32_t count, uint32_t stride, bool indexed)
+{
+  auto cmd     = _push<DrawIndirectCmd>(Op::DrawIndirect);
+  cmd->buffer  = buffer;
+  cmd->offset  = offset;
+  cmd->count   = count;
+  cmd->stride  = stride;
+  cmd->indexed = indexed;
+}
+
+void CommandList::DrawQuads(FG_Resource texture, std::span<const FG_Quad> quads)
+{
+  auto cmd     = _push<QuadsCmd>(Op::DrawQuads, quads.size_bytes());
+  cmd->texture = texture;
+  cmd->count   = static_cast<uint32_t>(quads.size());
+  memcpy(_payload<FG_Quad>(cmd), quads.data(), quads.size_bytes());
+}
+
+void CommandList::Dispatch(const FG_Vec3i* groups)
+{
+  auto cmd      = _push<DispatchCmd>(Op::Dispatch);
+  cmd->groups   = groups ? *groups : FG_Vec3i{ 0, 0, 0 };
+  cmd->pipeline = !groups;
+}
+
+void CommandList::DispatchIndirect(FG_Resource buffer, uint32_t offset)
+{
+  auto cmd    = _push<DispatchIndirectCmd>(Op::DispatchIndirect);
+  cmd->buffer = buffer;
+  cmd->offset = offset;
+}
+
+void CommandList::DeclareAccess(std::span<const FG_ResourceAccess> accesses)
+{
+  auto cmd   = _push<ArrayCmd>(Op::DeclareAccess, accesses.size_bytes());
+  cmd->count = static_cast<uint32_t>(accesses.size());
+  if(!accesses.empty())
+    memcpy(_payload<FG_ResourceAccess>(cmd), accesses.data(), accesses.size_bytes());
+}
+
+void CommandList::Barrier(GLbitfield barrier_flags) { _push<BarrierCmd>(Op::Barrier)->flags = barrier_flags; }
+
+void CommandList::BeginRegion(const char* name) { _push<RegionCmd>(Op::BeginRegion)->name = name; }
+
+void CommandList::EndRegion() { _push<Command>(Op::EndRegion); }
+
+void CommandList::SetPipelineState(uintptr_t state) { _push<PipelineCmd>(Op::SetPipelineState)->state = state; }
+
+void CommandList::SetVertexBuffers(uint32_t first, std::span<const FG_Resource> buffers, const uint32_t* offsets)
+{
+  auto cmd   = _push<VertexBuffersCmd>(Op::SetVertexBuffers, buffers.size_bytes() + buffers.size() * sizeof(uint32_t));
+  cmd->first = first;
+  cmd->count = static_cast<uint32_t>(buffers.size());
+  if(!buffers.empty())
+  {
+    auto payload = _payload<FG_Resource>(cmd);
+    memcpy(payload, buffers.data(), buffers.size_bytes());
+    if(offsets)
+      memcpy(payload + buffers.size(), offsets, buffers.size() * sizeof(uint32_t));
+    else
+      memset(payload + buffers.size(), 0, buffers.size() * sizeof(uint32_t));
+  }
+}
+
+void CommandList::SetViewports(std::span<const FG_Viewport> viewports)
+{
+  auto cmd   = _push<ArrayCmd>(Op::SetViewports, viewports.size_bytes());
+  cmd->count = static_cast<uint32_t>(viewports.size());
+  if(!viewports.empty())
+    memcpy(_payload<FG_Viewport>(cmd), viewports.data(), viewports.size_bytes());
+}
+
+void CommandList::SetScissors(std::span<const FG_Rect> rects)
+{
+  auto cmd   = _push<ArrayCmd>(Op::SetScissors, rects.size_bytes());
+  cmd->count = static_cast<uint32_t>(rects.size());
+  if(!rects.empty())
+    memcpy(_payload<FG_Rect>(cmd), rects.data(), rects.size_bytes());
+}
+
+void CommandList::SetShaderConstants(const FG_ShaderParameter* uniforms, const FG_ShaderValue* values, uint32_t count)
+{
+  // Measure everything first so the command can be reserved in one piece.
+  size_t payload = _align(sizeof(PackedUniform) * count);
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    if(uniforms[i].name)
+      payload += strlen(uniforms[i].name) + 1;
+    payload = _align(payload) + UniformBytes(uniforms[i]);
+  }
+
+  auto cmd     = _push<ArrayCmd>(Op::SetShaderConstants, payload);
+  cmd->count   = count;
+  auto base    = reinterpret_cast<std::byte*>(cmd);
+  auto packed  = _payload<PackedUniform>(cmd);
+  size_t extra = _align(sizeof(ArrayCmd)) + _align(sizeof(PackedUniform) * count);
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    packed[i].param      = uniforms[i];
+    packed[i].param.name = nullptr;
+    packed[i].value      = values[i];
+    packed[i].name       = 0;
+    packed[i].data       = 0;
+
+    if(uniforms[i].name)
+    {
+      size_t len = strlen(uniforms[i].name) + 1;
+      memcpy(base + extra, uniforms[i].name, len);
+      packed[i].name = static_cast<uint32_t>(extra);
+      extra += len;
+    }
+
+    extra = _align(extra);
+    if(size_t bytes = UniformBytes(uniforms[i]); bytes > 0 && values[i].pf32 != nullptr)
+    {
+      memcpy(base + extra, values[i].pf32, bytes);
+      packed[i].data = static_cast<uint32_t>(extra);
+      extra += bytes;
+    }
+  }
+}
+
+void CommandList::SetPreparedConstants(const PreparedUniforms* prepared, const FG_ShaderValue* values)
+{
+  const size_t count   = prepared->slots.size();
+  const size_t offsets = _align(sizeof(PreparedCmd)) + _align(sizeof(FG_ShaderValue) * count);
+  size_t payload       = _align(_align(sizeof(FG_ShaderValue) * count) + sizeof(uint32_t) * count);
+  for(auto& slot : prepared->slots)
+    payload += _align(UniformBytes(slot.param));
+
+  auto cmd      = _push<PreparedCmd>(Op::SetPreparedConstants, payload);
+  cmd->prepared = prepared;
+  auto base     = reinterpret_cast<std::byte*>(cmd);
+  auto packed   = _payload<FG_ShaderValue>(cmd);
+  auto data     = reinterpret_cast<uint32_t*>(base + offsets);
+  size_t extra  = _align(offsets + sizeof(uint32_t) * count);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    packed[i] = values[i];
+    data[i]   = 0;
+    if(size_t bytes = UniformBytes(prepared->slots[i].param); bytes > 0 && values[i].pf32 != nullptr)
+    {
+      memcpy(base + extra, values[i].pf32, bytes);
+      data[i] = static_cast<uint32_t>(extra);
+      extra += _align(bytes);
+    }
+  }
+}
+
+GLExpected<void> CommandList::Execute(Context* ctx)
+{
+  // Calls made outside of any command list aren't checked at this level either, so whatever they left in the error
+  // flags would be blamed on this list. Each glGetError() only clears one flag, and a lost context may never clear.
+  if(ErrorCheckLevel == ErrorCheck::ERRORCHECK_COMMAND_LIST)
+  {
+    for(int i = 0; i < MAX_STALE_ERRORS; ++i)
+    {
+      if(glGetError() == GL_NO_ERROR)
+        break;
+    }
+  }
+
+  auto e = _replay(ctx);
+  if(!_bundle)
+    Reset();
+  if(e.has_error())
+    return std::move(e.error());
+
+  // When individual calls aren't checked, this single poll catches anything the replay left in the error flag.
+  GL_CHECKPOINT(ErrorCheck::ERRORCHECK_COMMAND_LIST, "CommandList::Execute");
+  return {};
+}
+
+GLExpected<void> CommandList::_replay(Context* ctx)
+{
+  std::byte* end = _arena.data() + _arena.size();
+  for(std::byte* cur = _arena.data(); cur < end; cur += reinterpret_cast<Command*>(cur)->stride)
+  {
+    // Queued quads have to be drawn before anything that could change the state they depend on.
+    if(reinterpret_cast<Command*>(cur)->op != Op::DrawQuads)
+    {
+      RETURN_ERROR(ctx->FlushQuads());
+    }
+
+    switch(reinterpret_cast<Command*>(cur)->op)
+    {
+    case Op::Clear:
+    {
+      auto cmd = reinterpret_cast<ClearCmd*>(cur);
+      RETURN_ERROR(ctx->Clear(cmd->clearbits, cmd->RGBA, cmd->stencil, cmd->depth,
+                              std::span<const FG_Rect>(_payload<FG_Rect>(cmd), cmd->count)));
+      break;
+    }
+    case Op::CopyResource:
+    {
+      auto cmd = reinterpret_cast<CopyResourceCmd*>(cur);
+      RETURN_ERROR(ctx->CopyResource(cmd->src, cmd->dest, cmd->size, cmd->level));
+      break;
+    }
+    case Op::CopySubresource:
+    {
+      auto cmd = reinterpret_cast<CopySubresourceCmd*>(cur);
+      RETURN_ERROR(ctx->CopySubresource(cmd->src, cmd->dest, cmd->srcoffset, cmd->destoffset, cmd->bytes));
+      break;
+    }
+    case Op::CopyResourceRegion:
+    {
+      auto cmd = reinterpret_cast<CopyResourceRegionCmd*>(cur);
+      RETURN_ERROR(
+        ctx->CopyResourceRegion(cmd->src, cmd->dest, cmd->level, cmd->srcoffset, cmd->destoffset, cmd->size));
+      break;
+    }
+    case Op::DrawArrays:
+    {
+      auto cmd = reinterpret_cast<DrawArraysCmd*>(cur);
+      RETURN_ERROR(ctx->DrawArrays(cmd->vertexcount, cmd->instancecount, cmd->startvertex, cmd->startinstance));
+      break;
+    }
+    case Op::DrawIndexed:
+    {
+      auto cmd = reinterpret_cast<DrawIndexedCmd*>(cur);
+      RETURN_ERROR(
+        ctx->DrawIndexed(cmd->indexcount, cmd->instancecount, cmd->startindex, cmd->startvertex, cmd->startinstance));
+      break;
+    }
+    case Op::DrawMesh:
+    {
+      auto cmd = reinterpret_cast<DrawMeshCmd*>(cur);
+      RETURN_ERROR(ctx->DrawMesh(cmd->first, cmd->count));
+      break;
+    }
+    case Op::DrawIndirect:
+    {
+      auto cmd = reinterpret_cast<DrawIndirectCmd*>(cur);
+      RETURN_ERROR(ctx->DrawIndirect(cmd->buffer, cmd->offset, cmd->count, cmd->stride, cmd->indexed));
+      break;
+    }
+    case Op::DrawQuads:
+    {
+      auto cmd = reinterpret_cast<QuadsCmd*>(cur);
+      RETURN_ERROR(ctx->DrawQuads(cmd->texture, std::span<const FG_Quad>(_payload<FG_Quad>(cmd), cmd->count)));
+      break;
+    }
+    case Op::Dispatch:
+    {
+      auto cmd = reinterpret_cast<DispatchCmd*>(cur);
+      RETURN_ERROR(ctx->Dispatch(cmd->pipeline ? nullptr : &cmd->groups));
+      break;
+    }
+    case Op::DispatchIndirect:
+    {
+      auto cmd = reinterpret_cast<DispatchIndirectCmd*>(cur);
+      RETURN_ERROR(ctx->DispatchIndirect(cmd->buffer, cmd->offset));
+      break;
+    }
+    case Op::DeclareAccess:
+    {
+      auto cmd = reinterpret_cast<ArrayCmd*>(cur);
+      RETURN_ERROR(
+        ctx->DeclareAccess(std::span<const FG_ResourceAccess>(_payload<FG_ResourceAccess>(cmd), cmd->count)));
+      break;
+    }
+    case Op::Barrier: RETURN_ERROR(ctx->Barrier(reinterpret_cast<BarrierCmd*>(cur)->flags)); break;
+    case Op::BeginRegion: RETURN_ERROR(ctx->BeginRegion(reinterpret_cast<RegionCmd*>(cur)->name)); break;
+    case Op::EndRegion: RETURN_ERROR(ctx->EndRegion()); break;
+    case Op::SetPipelineState: RETURN_ERROR(ctx->ApplyPipelineState(reinterpret_cast<PipelineCmd*>(cur)->state)); break;
+    case Op::SetVertexBuffers:
+    {
+      auto cmd     = reinterpret_cast<VertexBuffersCmd*>(cur);
+      auto buffers = _payload<FG_Resource>(cmd);
+      RETURN_ERROR(ctx->SetVertexBuffers(cmd->first, std::span<const FG_Resource>(buffers, cmd->count),
+                                         reinterpret_cast<const uint32_t*>(buffers + cmd->count)));
+      break;
+    }
+    case Op::SetViewports:
+    {
+      auto cmd = reinterpret_cast<ArrayCmd*>(cur);
+      RETURN_ERROR(ctx->SetViewports(std::span<const FG_Viewport>(_payload<FG_Viewport>(cmd), cmd->count)));
+      break;
+    }
+    case Op::SetScissors:
+    {
+      auto cmd = reinterpret_cast<ArrayCmd*>(cur);
+      RETURN_ERROR(ctx->SetScissors(std::span<const FG_Rect>(_payload<FG_Rect>(cmd), cmd->count)));
+      break;
+    }
+    case Op::SetShaderConstants:
+    {
+      auto cmd    = reinterpret_cast<ArrayCmd*>(cur);
+      auto packed = _payload<PackedUniform>(cmd);
+      for(uint32_t i = 0; i < cmd->count; ++i)
+      {
+        FG_ShaderParameter param = packed[i].param;
+        FG_ShaderValue value     = packed[i].value;
+        if(packed[i].name)
+          param.name = reinterpret_cast<const char*>(cur + packed[i].name);
+        if(packed[i].data)
+          value.pf32 = reinterpret_cast<float*>(cur + packed[i].data);
+        RETURN_ERROR(ctx->SetShaderUniforms(&param, &value, 1));
+      }
+      break;
+    }
+    case Op::SetPreparedConstants:
+    {
+      auto cmd    = reinterpret_cast<PreparedCmd*>(cur);
+      auto count  = cmd->prepared->slots.size();
+      auto values = _payload<FG_ShaderValue>(cmd);
+      auto data   = reinterpret_cast<uint32_t*>(cur + _align(sizeof(PreparedCmd)) + _align(sizeof(FG_ShaderValue) * count));
+
+      // Deep-copied values are stored as offsets, because the arena may have moved since they were recorded.
+      for(size_t i = 0; i < count; ++i)
+        if(data[i])
+          values[i].pf32 = reinterpret_cast<float*>(cur + data[i]);
+      RETURN_ERROR(ctx->SetPreparedUniforms(*cmd->prepared, values));
+      break;
+    }
+    default: return CUSTOM_ERROR(ERR_UNKNOWN_COMMAND_CATEGORY, "Corrupt command list");
+    }
+  }
+
+  return ctx->FlushQuads();
+}
@@ -0,0 +1,122 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__COMMAND_LIST_H
+#define GL__COMMAND_LIST_H
+
+#include "GLError.hpp"
+#include "feather/graphics_interface.h"
+#include <vector>
+#include <span>
+#include <cstddef>
+
+namespace GL {
+  struct Context;
+  struct PreparedUniforms;
+
+  // A deferred command list. Recording only packs commands into a flat byte arena and never touches OpenGL, so a list
+  // can be built on any thread. Execute() then replays the stream against a Context on the thread that owns it.
+  // Different lists can be recorded concurrently, but a single list must only be used by one thread at a time. A bundle
+  // is encoded once and keeps its commands, so it can be executed any number of times.
+  struct CommandList
+  {
+    enum class Op : uint8_t
+    {
+      Clear,
+      CopyResource,
+      CopySubresource,
+      CopyResourceRegion,
+      DrawArrays,
+      DrawIndexed,
+      DrawMesh,
+      DrawIndirect,
+      DrawQuads,
+      Dispatch,
+      DispatchIndirect,
+      DeclareAccess,
+      Barrier,
+      BeginRegion,
+      EndRegion,
+      SetPipelineState,
+      SetVertexBuffers,
+      SetViewports,
+      SetScissors,
+      SetShaderConstants,
+      SetPreparedConstants,
+    };
+
+    // Every command begins with this header. stride is the distance to the next command, including any payload.
+    struct Command
+    {
+      Op op;
+      uint32_t stride;
+    };
+
+    explicit CommandList(bool bundle) noexcept : _bundle(bundle) {}
+    ~CommandList() {}
+
+    void Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth, std::span<const FG_Rect> rects);
+    void CopyResource(FG_Resource src, FG_Resource dest, FG_Vec3i size, int level);
+    void CopySubresource(FG_Resource src, FG_Resource dest, unsigned long srcoffset, unsigned long destoffset,
+                         unsigned long bytes);
+    void CopyResourceRegion(FG_Resource src, FG_Resource dest, int level, FG_Vec3i srcoffset, FG_Vec3i destoffset,
+                            FG_Vec3i size);
+    void DrawArrays(uint32_t vertexcount, uint32_t instancecount, uint32_t startvertex, uint32_t startinstance);
+    void DrawIndexed(uint32_t indexcount, uint32_t instancecount, uint32_t startindex, int startvertex,
+                     uint32_t startinstance);
+    void DrawMesh(uint32_t first, uint32_t count);
+    void DrawIndirect(FG_Resource buffer, uint32_t offset, uint32_t count, uint32_t stride, bool indexed);
+    void DrawQuads(FG_Resource texture, std::span<const FG_Quad> quads);
+    // Dispatches groups work groups, or the count the compute pipeline was created with if groups is null.
+    void Dispatch(const FG_Vec3i* groups);
+    void DispatchIndirect(FG_Resource buffer, uint32_t offset);
+    void DeclareAccess(std::span<const FG_ResourceAccess> accesses);
+    void Barrier(GLbitfield barrier_flags);
+    // name is only referenced, like FrameTimer::push, so it must outlive the frame stats it shows up in.
+    void BeginRegion(const char* name);
+    void EndRegion();
+    void SetPipelineState(uintptr_t state);
+    void SetVertexBuffers(uint32_t first, std::span<const FG_Resource> buffers, const uint32_t* offsets);
+    void SetViewports(std::span<const FG_Viewport> viewports);
+    void SetScissors(std::span<const FG_Rect> rects);
+    void SetShaderConstants(const FG_ShaderParameter* uniforms, const FG_ShaderValue* values, uint32_t count);
+    // prepared is only referenced, so it must stay alive until the list has been executed for the last time.
+    void SetPreparedConstants(const PreparedUniforms* prepared, const FG_ShaderValue* values);
+
+    // Replays every recorded command against ctx. Unless this is a bundle, the list is reset afterwards.
+    GLExpected<void> Execute(Context* ctx);
+    // Throws away all recorded commands but keeps the arena's memory, so steady-state recording doesn't allocate.
+    inline void Reset() noexcept { _arena.clear(); }
+    inline bool IsBundle() const noexcept { return _bundle; }
+    inline bool Empty() const noexcept { return _arena.empty(); }
+
+    static constexpr size_t ALIGNMENT     = alignof(std::max_align_t);
+    static constexpr int MAX_STALE_ERRORS = 16; // Error flags Execute() clears before replaying, at most
+
+  protected:
+    static constexpr size_t _align(size_t n) noexcept { return (n + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+    // Reserves space for a command of type T followed by payload bytes. The returned pointer is only valid until the
+    // next call to _push, because the arena may have to grow.
+    template<class T> T* _push(Op op, size_t payload = 0)
+    {
+      static_assert(std::is_trivially_copyable_v<T>);
+      const size_t offset = _arena.size();
+      const size_t stride = _align(_align(sizeof(T)) + payload);
+      _arena.resize(offset + stride);
+      auto cmd    = reinterpret_cast<T*>(_arena.data() + offset);
+      cmd->op     = op;
+      cmd->stride = static_cast<uint32_t>(stride);
+      return cmd;
+    }
+    template<class P, class T> static inline P* _payload(T* cmd) noexcept
+    {
+      return reinterpret_cast<P*>(reinterpret_cast<std::byte*>(cmd) + _align(sizeof(T)));
+    }
+    GLExpected<void> _replay(Context* ctx);
+
+    std::vector<std::byte> _arena;
+    bool _bundle;
+  };
+}
+
+#endif
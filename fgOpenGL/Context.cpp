@@ -8,9 +8,12 @@
 #include "Buffer.hpp"
 #include "Texture.hpp"
 #include "Renderbuffer.hpp"
+#include "PipelineState.hpp"
+#include "Atlas.hpp"
 #include <algorithm>
 #include <cassert>
 #include <cfloat>
+#include <climits>
 #include <cstring>
 
 #define kh_pair_hash_func(key) \
@@ -18,6 +21,53 @@
 
 using namespace GL;
 
+namespace {
+  // Describes how a uniform type is laid out as columns of rows components each.
+  bool UniformShape(GLenum type, int& columns, int& rows, int& bytes)
+  {
+    columns = 1;
+    bytes   = 4;
+    switch(type)
+    {
+    case GL_FLOAT:
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_BOOL: rows = 1; return true;
+    case GL_FLOAT_VEC2:
+    case GL_INT_VEC2:
+    case GL_UNSIGNED_INT_VEC2:
+    case GL_BOOL_VEC2: rows = 2; return true;
+    case GL_FLOAT_VEC3:
+    case GL_INT_VEC3:
+    case GL_UNSIGNED_INT_VEC3:
+    case GL_BOOL_VEC3: rows = 3; return true;
+    case GL_FLOAT_VEC4:
+    case GL_INT_VEC4:
+    case GL_UNSIGNED_INT_VEC4:
+    case GL_BOOL_VEC4: rows = 4; return true;
+    case GL_FLOAT_MAT2: columns = 2, rows = 2; return true;
+    case GL_FLOAT_MAT2x3: columns = 2, rows = 3; return true;
+    case GL_FLOAT_MAT2x4: columns = 2, rows = 4; return true;
+    case GL_FLOAT_MAT3x2: columns = 3, rows = 2; return true;
+    case GL_FLOAT_MAT3: columns = 3, rows = 3; return true;
+    case GL_FLOAT_MAT3x4: columns = 3, rows = 4; return true;
+    case GL_FLOAT_MAT4x2: columns = 4, rows = 2; return true;
+    case GL_FLOAT_MAT4x3: columns = 4, rows = 3; return true;
+    case GL_FLOAT_MAT4: columns = 4, rows = 4; return true;
+    case GL_DOUBLE: rows = 1, bytes = 8; return true;
+    }
+    return false;
+  }
+
+  // The left, bottom, right and top pixel edges of a scissor rect, rounded the same way CallWithRect rounds them.
+  std::array<GLint, 4> PixelBox(const FG_Rect& r)
+  {
+    GLint x = FastTruncate(::floorf(r.left));
+    GLint y = FastTruncate(::floorf(r.top));
+    return { x, y, x + FastTruncate(::ceilf(r.right - r.left)), y + FastTruncate(::ceilf(r.bottom - r.top)) };
+  }
+}
+
 // Feather uses a premultiplied compositing pipeline:
 // https://apoorvaj.io/alpha-compositing-opengl-blending-and-premultiplied-alpha/
 const FG_Blend Context::Premultiply_Blend = {
@@ -45,10 +95,18 @@ const FG_Blend Context::Default_Blend = {
   FG_Blend_Operand_Zero, FG_Blend_Op_Add,       0b1111,
 };
 
-Context::Context(FG_Vec2 dim) :
+Context::Context(FG_Vec2 dim, std::unique_ptr<Headless> headless) :
+  _headless(std::move(headless)),
   _lastblend(Default_Blend),
   _program(nullptr),
+  _uniforms(nullptr),
+  _boundblocks(nullptr),
   _dim(dim),
+  _damaged(false),
+  _lastviewport({ 0, 0, dim.x, dim.y }),
+  _lastclearcolor({ 0, 0, 0, 0 }),
+  _lastcleardepth(1.0f),
+  _lastclearstencil(0),
   _indextype(0),
   _lastcull(0),
   _lastfill(0),
@@ -56,12 +114,42 @@ Context::Context(FG_Vec2 dim) :
   _lastflags(0),
   _primitive(0),
   _statestore({ 0 }),
-  _workgroup({ 0, 0, 0 })
+  _workgroup({ 0, 0, 0 }),
+  _lastprogram(~0U),
+  _lastvao(~0U),
+  _lastindices(~0U),
+  _strides({ 0 }),
+  _bindingcount(0),
+  _lastframebuffer(~0U),
+  _lastdepthfunc(GL_LESS),
+  _laststencil({ GL_ALWAYS, 0, ~0U, ~0U, GL_KEEP, GL_KEEP, GL_KEEP }),
+  _lastbias({ 0, 0 }),
+  _stalestate(0),
+  _stats{},
+  _framestats{},
+  _frame(0)
 {}
-Context::~Context() {}
+Context::~Context()
+{
+  // Everything the context owns is deleted after this, which needs a headless context to be current.
+  if(_headless)
+  {
+    if(auto e = _headless->makeCurrent(); e.has_error())
+      e.log(_headless->backend());
+  }
+}
 
 GLExpected<void> Context::BeginDraw(const FG_Rect* area)
 {
+  // Nothing else makes a headless context current, and it may be drawn from whichever thread has it.
+  if(_headless)
+    RETURN_ERROR(_headless->makeCurrent());
+
+  // We may be sharing this context with another engine, which won't have told us what it bound.
+  InvalidateBindings();
+  _stats = { 0 };
+  RETURN_ERROR(_timer.begin());
+
   GLint box[4] = { 0 };
   RETURN_ERROR(CALLGL(glGetIntegerv, GL_SCISSOR_BOX, box));
   _lastscissor = {
@@ -70,36 +158,392 @@ GLExpected<void> Context::BeginDraw(const FG_Rect* area)
     static_cast<float>(box[2] + box[0]),
     static_cast<float>(box[3] + box[1]),
   };
+  RETURN_ERROR(CALLGL(glGetIntegerv, GL_VIEWPORT, box));
+  _lastviewport = {
+    static_cast<float>(box[0]),
+    static_cast<float>(box[1]),
+    static_cast<float>(box[2] + box[0]),
+    static_cast<float>(box[3] + box[1]),
+  };
+  _viewportarray.clear();
+
+  _damaged = false;
+  if(area)
+  {
+    _damage = { std::max(area->left, 0.0f), std::max(area->top, 0.0f), std::min(area->right, _dim.x),
+                std::min(area->bottom, _dim.y) };
+    _damaged = _damage.left > 0 || _damage.top > 0 || _damage.right < _dim.x || _damage.bottom < _dim.y;
+  }
+
+  if(_damaged)
+  {
+    // The scissor box has its origin at the bottom left. Scissoring stays on for every pipeline until EndDraw, so
+    // nothing outside the damage is touched even by pipelines that don't ask for it.
+    _lastscissor = _damageScissor();
+    RETURN_ERROR(CALLGL(glEnable, GL_SCISSOR_TEST));
+    _lastflags |= FG_Pipeline_Flag_Scissor_Enable;
+  }
   return SetScissors({ &_lastscissor, 1 });
 }
 
-GLExpected<void> Context::EndDraw() { return {}; }
+GLExpected<void> Context::EndDraw()
+{
+  if(_damaged)
+  {
+    _damaged = false;
+    RETURN_ERROR(CALLGL(glDisable, GL_SCISSOR_TEST));
+    _lastflags &= ~FG_Pipeline_Flag_Scissor_Enable;
+  }
+
+  RETURN_ERROR(_timer.end());
+  _targets.trim(_frame);
+  _pruneWrites();
+  _framestats           = _stats;
+  _framestats.gpu_time  = _timer.gpu_time();
+  _framestats.n_regions = static_cast<uint32_t>(_timer.regions().size());
+  _framestats.regions   = _timer.regions().data();
+  const uint64_t frame  = _frame++;
+
+  // Trimming only releases memory, so the frame is already finished if it fails.
+  for(auto atlas : _atlases)
+  {
+    RETURN_ERROR(atlas->trim(frame));
+  }
+  return {};
+}
+
+GLExpected<void> Context::BeginRegion(const char* name) { return _timer.push(name); }
+GLExpected<void> Context::EndRegion() { return _timer.pop(); }
+
 GLExpected<void> Context::Resize(FG_Vec2 dim)
 {
+  if(_headless)
+  {
+    RETURN_ERROR(_headless->resize(FG_Vec2i{ static_cast<int>(dim.x), static_cast<int>(dim.y) }));
+    _lastframebuffer = ~0U;
+  }
+
   _dim         = dim;
   _lastscissor = { 0, 0, _dim.x, _dim.y };
   return SetScissors({ &_lastscissor, 1 });
 }
 
-GLExpected<void> Context::Dispatch() { return CALLGL(glDispatchCompute, _workgroup.x, _workgroup.y, _workgroup.z); }
+GLExpected<void> Context::Dispatch(const FG_Vec3i* groups)
+{
+  const FG_Vec3i count = groups ? *groups : _workgroup;
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  return CALLGL(glDispatchCompute, count.x, count.y, count.z);
+}
+
+GLExpected<void> Context::DispatchIndirect(FG_Resource buffer, uint32_t offset)
+{
+  auto info = ResourceTable::find(REF_BUFFER, buffer);
+  if(!info)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Indirect dispatches need a valid buffer of work group counts");
+  if((offset % 4) != 0 || offset + GLsizeiptr(sizeof(FG_DispatchIndirectArgs)) > info->bytes)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Work group counts must be 4-byte aligned and inside the buffer");
+  if(!glDispatchComputeIndirect)
+    return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "Indirect dispatches need OpenGL 4.3 or GL_ARB_compute_shader");
+
+  // The counts are usually written by the dispatch right before this one.
+  if(auto bits = _uncovered(buffer, GL_COMMAND_BARRIER_BIT))
+  {
+    RETURN_ERROR(Barrier(bits));
+  }
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_DISPATCH_INDIRECT_BUFFER, static_cast<GLuint>(buffer & REF_MASK)));
+  return CALLGL(glDispatchComputeIndirect, static_cast<GLintptr>(offset));
+}
+
+GLExpected<void> Context::DeclareAccess(std::span<const FG_ResourceAccess> accesses)
+{
+  // Barriers are global, so one that covers every read at once is all it takes. A shader writing over another
+  // shader's incoherent write also has to wait for it, through whichever path the earlier write went.
+  GLbitfield bits = 0;
+  for(auto& access : accesses)
+    bits |= _uncovered(access.resource, BarrierBits(access.flags) | (access.write ? SHADER_WRITE_BARRIERS : 0));
+  if(bits)
+  {
+    RETURN_ERROR(Barrier(bits));
+  }
+
+  for(auto& access : accesses)
+  {
+    if(!access.write)
+      continue;
+    auto write = std::find_if(_writes.begin(), _writes.end(),
+                              [&](const ShaderWrite& w) { return w.resource == access.resource; });
+    if(write != _writes.end())
+    {
+      write->covered = 0;
+      write->pending = true;
+    }
+    else
+    {
+      // Compute-only work never reaches EndDraw, so the list is also pruned whenever it would have to grow.
+      if(_writes.size() == _writes.capacity())
+        _pruneWrites();
+      _writes.push_back(ShaderWrite{ access.resource, 0, true });
+    }
+  }
+  return {};
+}
 
-GLExpected<void> Context::Barrier(GLbitfield barrier_flags) { return CALLGL(glMemoryBarrier, barrier_flags); }
+void Context::_pruneWrites() noexcept
+{
+  // Writes to resources that were deleted since can't be read anymore, so they don't need barriers either. Barriers
+  // only ever cover bits that some FG_BarrierFlags value maps to, so that is what a fully covered write has.
+  const GLbitfield all = BarrierBits(~0U);
+  std::erase_if(_writes, [all](const ShaderWrite& w) {
+    return (w.covered & all) == all || !ResourceTable::validate(ResourceTable::type(w.resource), w.resource);
+  });
+}
 
-GLExpected<void> Context::ApplyProgram(const ProgramObject& program)
+GLExpected<void> Context::Barrier(GLbitfield barrier_flags)
 {
-  RETURN_ERROR(CALLGL(glUseProgram, program));
-  _program = &program;
+  RETURN_ERROR(CALLGL(glMemoryBarrier, barrier_flags));
+  for(auto& write : _writes)
+  {
+    if(!write.pending)
+      write.covered |= barrier_flags;
+  }
   return {};
 }
 
-GLExpected<void> Context::Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth, std::span<FG_Rect> rects)
+GLbitfield Context::_uncovered(FG_Resource resource, GLbitfield bits) const noexcept
+{
+  for(auto& write : _writes)
+  {
+    if(write.resource == resource)
+      return bits & ~write.covered;
+  }
+  return 0;
+}
+
+GLExpected<void> Context::ApplyProgram(const ProgramObject& program, UniformTable* uniforms)
 {
-  RETURN_ERROR(CALLGL(glClearDepth, depth));
-  RETURN_ERROR(CALLGL(glClearStencil, stencil));
+  if(_changed(_lastprogram != program))
+  {
+    RETURN_ERROR(CALLGL(glUseProgram, program));
+    _lastprogram = program;
+  }
+  _program  = &program;
+  _uniforms = uniforms;
+  return {};
+}
+
+GLExpected<void> Context::ApplyVertexArray(VertexArrayObject& vao)
+{
+  _bindingcount = 0;
+#ifndef USE_EMULATED_VAOS
+  if(_changed(_lastvao != vao.id()))
+  {
+    RETURN_ERROR(vao.bind());
+    _lastvao     = vao.id();
+    _lastindices = ~0U;
+    _lastbindings.fill(VertexBinding{ ~0U, 0, 0 });
+  }
+  return {};
+#else
+  return vao.bind();
+#endif
+}
+
+GLExpected<void> Context::ApplyVertexBuffers(std::span<const VertexBinding> bindings)
+{
+  if(bindings.size() > _lastbindings.size())
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Too many vertex buffer bindings");
+
+  _bindingcount = static_cast<uint32_t>(bindings.size());
+  for(size_t i = 0; i < bindings.size(); ++i)
+  {
+    _strides[i] = bindings[i].stride;
+    if(_changed(_lastbindings[i] != bindings[i]))
+    {
+      RETURN_ERROR(CALLGL(glBindVertexBuffer, static_cast<GLuint>(i), bindings[i].buffer, bindings[i].offset,
+                          bindings[i].stride));
+      _lastbindings[i] = bindings[i];
+    }
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyIndexBuffer(GLuint indices)
+{
+  if(_changed(_lastindices != indices))
+  {
+    RETURN_ERROR(CALLGL(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, indices));
+    _lastindices = indices;
+  }
+  return {};
+}
 
+GLExpected<void> Context::SetVertexBuffers(uint32_t first, std::span<const FG_Resource> buffers, const uint32_t* offsets)
+{
+  // Pipelines that couldn't share a VAO have their buffers baked into their own, so there's nothing to rebind.
+  if(!_bindingcount)
+    return CUSTOM_ERROR(ERR_INVALID_CALL, "The current pipeline state doesn't use separate vertex buffer bindings");
+  if(first + buffers.size() > _bindingcount)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "The current pipeline state has fewer vertex buffers");
+
+  for(size_t i = 0; i < buffers.size(); ++i)
+  {
+    if(buffers[i] && !Buffer::validate(buffers[i]))
+      return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Vertex buffers must be buffers");
+
+    const size_t index = first + i;
+    VertexBinding b    = { Buffer(buffers[i]), static_cast<GLintptr>(offsets ? offsets[i] : 0), _strides[index] };
+    if(_changed(_lastbindings[index] != b))
+    {
+      RETURN_ERROR(CALLGL(glBindVertexBuffer, static_cast<GLuint>(index), b.buffer, b.offset, b.stride));
+      _lastbindings[index] = b;
+    }
+  }
+  return {};
+}
+
+GLExpected<VertexArrayObject*> Context::FindVertexLayout(const VertexLayout& layout)
+{
+  const size_t count = _layouts.size();
+  auto e             = _layouts.get(layout);
+
+  // Building a new VAO leaves nothing bound.
+  if(_layouts.size() != count)
+    _lastvao = ~0U;
+  return e;
+}
+
+GLExpected<void> Context::ApplyFramebuffer(GLuint framebuffer)
+{
+  if(!framebuffer && _headless)
+    framebuffer = _headless->framebuffer();
+  if(_changed(_lastframebuffer != framebuffer))
+  {
+    RETURN_ERROR(CALLGL(glBindFramebuffer, GL_FRAMEBUFFER, framebuffer));
+    _lastframebuffer = framebuffer;
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyDepthFunc(GLenum func)
+{
+  if(_changed(_stale(STALE_DEPTH_FUNC) || _lastdepthfunc != func))
+  {
+    RETURN_ERROR(CALLGL(glDepthFunc, func));
+    _lastdepthfunc = func;
+    _stalestate &= ~STALE_DEPTH_FUNC;
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyStencilOp(GLenum fail, GLenum depthfail, GLenum pass)
+{
+  if(_changed(_stale(STALE_STENCIL_OP) || _laststencil.fail != fail || _laststencil.depthfail != depthfail ||
+              _laststencil.pass != pass))
+  {
+    RETURN_ERROR(CALLGL(glStencilOp, fail, depthfail, pass));
+    _laststencil.fail      = fail;
+    _laststencil.depthfail = depthfail;
+    _laststencil.pass      = pass;
+    _stalestate &= ~STALE_STENCIL_OP;
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyStencilMask(GLuint mask)
+{
+  if(_changed(_stale(STALE_STENCIL_MASK) || _laststencil.writemask != mask))
+  {
+    RETURN_ERROR(CALLGL(glStencilMask, mask));
+    _laststencil.writemask = mask;
+    _stalestate &= ~STALE_STENCIL_MASK;
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+  if(_changed(_stale(STALE_STENCIL_FUNC) || _laststencil.func != func || _laststencil.ref != ref ||
+              _laststencil.readmask != mask))
+  {
+    RETURN_ERROR(CALLGL(glStencilFunc, func, ref, mask));
+    _laststencil.func     = func;
+    _laststencil.ref      = ref;
+    _laststencil.readmask = mask;
+    _stalestate &= ~STALE_STENCIL_FUNC;
+  }
+  return {};
+}
+
+GLExpected<void> Context::ApplyDepthBias(float slope, float bias)
+{
+  if(_changed(_stale(STALE_DEPTH_BIAS) || _lastbias[0] != slope || _lastbias[1] != bias))
+  {
+    RETURN_ERROR(CALLGL(glPolygonOffset, slope, bias));
+    _lastbias = { slope, bias };
+    _stalestate &= ~STALE_DEPTH_BIAS;
+  }
+  return {};
+}
+
+void Context::InvalidateBindings() noexcept
+{
+  // 0 is a valid binding, so use an ID no object can have to force the next Apply* call through.
+  _lastprogram     = ~0U;
+  _lastvao         = ~0U;
+  _lastindices     = ~0U;
+  _lastframebuffer = ~0U;
+  _lastbindings.fill(VertexBinding{ ~0U, 0, 0 });
+  _boundblocks     = nullptr;
+  _samplers.invalidate();
+
+  // The cached render state stays as it is, since pipelines fall back to it for anything they don't specify.
+  _stalestate = STALE_ALL;
+}
+
+GLExpected<void> Context::ApplyPipelineState(uintptr_t state)
+{
+  if(!state)
+  {
+    _program  = nullptr;
+    _uniforms = nullptr;
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Pipeline state cannot be null");
+  }
+
+  if(reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG)
+    return reinterpret_cast<ComputePipelineState*>(state)->apply(this);
+  return reinterpret_cast<PipelineState*>(state)->apply(this);
+}
+
+GLExpected<void> Context::_applyClearValues(GLbitfield flags, const std::array<float, 4>& color, uint8_t stencil,
+                                            float depth)
+{
+  // Only the values this clear actually uses are set, and only if they differ from the last ones.
+  if((flags & GL_COLOR_BUFFER_BIT) && _changed(_lastclearcolor != color))
+  {
+    RETURN_ERROR(CALLGL(glClearColor, color[0], color[1], color[2], color[3]));
+    _lastclearcolor = color;
+  }
+  if((flags & GL_DEPTH_BUFFER_BIT) && _changed(_lastcleardepth != depth))
+  {
+    RETURN_ERROR(CALLGL(glClearDepth, depth));
+    _lastcleardepth = depth;
+  }
+  if((flags & GL_STENCIL_BUFFER_BIT) && _changed(_lastclearstencil != stencil))
+  {
+    RETURN_ERROR(CALLGL(glClearStencil, stencil));
+    _lastclearstencil = stencil;
+  }
+  return {};
+}
+
+GLExpected<void> Context::Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth,
+                                std::span<const FG_Rect> rects)
+{
   std::array<float, 4> colors;
   Context::ColorFloats(RGBA, colors, false);
-  RETURN_ERROR(CALLGL(glClearColor, colors[0], colors[1], colors[2], colors[3]));
 
   GLbitfield flags = 0;
   if(clearbits & FG_ClearFlag_Color)
@@ -113,86 +557,416 @@ GLExpected<void> Context::Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t sten
 
   if(rects.empty())
   {
-    RETURN_ERROR(CALLGL(glClear, flags));
+    RETURN_ERROR(_applyClearValues(flags, colors, stencil, depth));
+    return CALLGL(glClear, flags);
   }
 
+  // Neither path below is limited by the current scissor box, so the rects are clipped to the damage here instead.
+  std::vector<std::array<GLint, 4>> boxes;
+  boxes.reserve(rects.size());
+  std::array<GLint, 4> bounds = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
   for(auto& r : rects)
   {
-    RETURN_ERROR(CallWithRect(r, glScissor, "glScissor"));
+    auto box = PixelBox(r);
+    if(_damaged)
+    {
+      auto damage = PixelBox(_damageScissor());
+      box         = { std::max(box[0], damage[0]), std::max(box[1], damage[1]), std::min(box[2], damage[2]),
+                      std::min(box[3], damage[3]) };
+    }
+    if(box[2] <= box[0] || box[3] <= box[1])
+      continue;
+
+    bounds = { std::min(bounds[0], box[0]), std::min(bounds[1], box[1]), std::max(bounds[2], box[2]),
+               std::max(bounds[3], box[3]) };
+    boxes.push_back({ box[0], box[1], box[2] - box[0], box[3] - box[1] });
+  }
+  if(boxes.empty())
+    return {};
+
+  // A single draw can't touch the accumulation buffer, which only glClear can clear.
+  if(boxes.size() >= ClearPass::MIN_RECTS && !(flags & GL_ACCUM_BUFFER_BIT))
+  {
+    auto ready = _clearpass.prepare();
+    if(ready.has_error())
+      return std::move(ready.error());
+    if(ready.value())
+      return _drawClear(flags, boxes, { bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1] }, colors,
+                        stencil, depth);
+  }
+
+  RETURN_ERROR(_applyClearValues(flags, colors, stencil, depth));
+
+  // glClear ignores the scissor box unless the scissor test is on.
+  const bool scissored = (_lastflags & FG_Pipeline_Flag_Scissor_Enable) != 0;
+  if(!scissored)
+  {
+    RETURN_ERROR(CALLGL(glEnable, GL_SCISSOR_TEST));
+  }
+  for(auto& box : boxes)
+  {
+    RETURN_ERROR(CALLGL(glScissor, box[0], box[1], box[2], box[3]));
     RETURN_ERROR(CALLGL(glClear, flags));
   }
+  if(!scissored)
+  {
+    RETURN_ERROR(CALLGL(glDisable, GL_SCISSOR_TEST));
+  }
+  return _restoreScissors();
+}
 
-  RETURN_ERROR(CallWithRect(_lastscissor, glScissor, "glScissor"));
-  return {};
+GLExpected<void> Context::_drawClear(GLbitfield flags, std::span<const std::array<GLint, 4>> boxes,
+                                     const std::array<GLint, 4>& bounds, const std::array<float, 4>& color,
+                                     uint8_t stencil, float depth)
+{
+  // Depth is written by an always passing depth test and stencil by an always passing stencil test, and everything
+  // the draw needs is put back through the shadow state afterwards, so nothing is read back from the driver.
+  const auto lastflags   = _lastflags;
+  const auto lastblend   = _lastblend;
+  const auto lastcull    = _lastcull;
+  const auto lastfill    = _lastfill;
+  const auto lastdepth   = _lastdepthfunc;
+  const auto laststencil = _laststencil;
+  const auto program     = _program;
+  const auto uniforms    = _uniforms;
+
+  // Like glClear, the draw still honors the color, depth and stencil write masks and sRGB conversion.
+  uint16_t clearflags = lastflags & (FG_Pipeline_Flag_RenderTarget_SRGB_Enable | FG_Pipeline_Flag_Multisample_Enable |
+                                     FG_Pipeline_Flag_Depth_Write_Enable | FG_Pipeline_Flag_Scissor_Enable);
+  if(flags & GL_DEPTH_BUFFER_BIT)
+    clearflags |= FG_Pipeline_Flag_Depth_Enable;
+  if(flags & GL_STENCIL_BUFFER_BIT)
+    clearflags |= FG_Pipeline_Flag_Stencil_Enable;
+
+  FG_Blend blend = lastblend;
+  if(!(flags & GL_COLOR_BUFFER_BIT))
+    blend.rendertarget_write_mask = 0;
+
+  RETURN_ERROR(ApplyFlags(clearflags));
+  RETURN_ERROR(ApplyBlend(blend));
+  RETURN_ERROR(ApplyCull(FG_Cull_Mode_None));
+  RETURN_ERROR(ApplyFill(FG_Fill_Mode_Fill));
+  RETURN_ERROR(ApplyDepthFunc(GL_ALWAYS));
+  if(flags & GL_STENCIL_BUFFER_BIT)
+  {
+    RETURN_ERROR(ApplyStencilFunc(GL_ALWAYS, stencil, ~0U));
+    RETURN_ERROR(ApplyStencilOp(GL_REPLACE, GL_REPLACE, GL_REPLACE));
+  }
+
+  // The viewport covers exactly the bounds of every rect, so the scissor box only has to cover them as well.
+  RETURN_ERROR(CALLGL(glViewport, bounds[0], bounds[1], bounds[2], bounds[3]));
+  if(clearflags & FG_Pipeline_Flag_Scissor_Enable)
+  {
+    RETURN_ERROR(CALLGL(glScissor, bounds[0], bounds[1], bounds[2], bounds[3]));
+  }
+
+  RETURN_ERROR(ApplyProgram(_clearpass.program()));
+  ++_stats.draws;
+  _stats.bytes_uploaded += boxes.size() * 12 * sizeof(float);
+  RETURN_ERROR(_clearpass.draw(boxes, bounds, color, depth));
+
+  if(program)
+  {
+    RETURN_ERROR(ApplyProgram(*program, uniforms));
+  }
+  else
+    _program = nullptr;
+#ifndef USE_EMULATED_VAOS
+  if(_lastvao != ~0U)
+  {
+    RETURN_ERROR(CALLGL(glBindVertexArray, _lastvao));
+  }
+#endif
+
+  RETURN_ERROR(_restoreViewports());
+  RETURN_ERROR(_restoreScissors());
+  RETURN_ERROR(ApplyFlags(lastflags));
+  RETURN_ERROR(ApplyBlend(lastblend));
+  RETURN_ERROR(ApplyCull(lastcull));
+  RETURN_ERROR(ApplyFill(lastfill));
+  RETURN_ERROR(ApplyDepthFunc(lastdepth));
+  RETURN_ERROR(ApplyStencilFunc(laststencil.func, laststencil.ref, laststencil.readmask));
+  return ApplyStencilOp(laststencil.fail, laststencil.depthfail, laststencil.pass);
 }
 
-GLExpected<void> Context::SetViewports(std::span<FG_Viewport> viewports)
+GLExpected<void> Context::_restoreScissors()
 {
-  if(viewports.size() > 0)
+  // glScissor overwrites every scissor rect, not only the first.
+  if(!_scissorarray.empty())
+    return _applyScissorArray();
+  return CallWithRect(_lastscissor, glScissor, "glScissor");
+}
+
+GLExpected<void> Context::_restoreViewports()
+{
+  if(!_viewportarray.empty())
+    return CALLGL(glViewportArrayv, 0, static_cast<GLsizei>(_viewportarray.size() / 4), _viewportarray.data());
+  return CallWithRect(_lastviewport, glViewport, "glViewport");
+}
+
+GLExpected<void> Context::SetViewports(std::span<const FG_Viewport> viewports)
+{
+  if(viewports.size() == 1)
   {
     FG_Rect r = { viewports[0].pos.x, viewports[0].pos.y, viewports[0].pos.x + viewports[0].dim.x,
                   viewports[0].pos.y + viewports[0].dim.y };
+    _lastviewport = r;
+    _viewportarray.clear();
     RETURN_ERROR(CallWithRect(r, glViewport, "glViewport"));
   }
+  else if(viewports.size() > 1)
+  {
+    if(!glViewportArrayv)
+      return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "Multiple viewports need OpenGL 4.1 or GL_ARB_viewport_array");
+
+    // Rounded the same way as a single viewport, so moving a pane into an array doesn't shift it by a pixel.
+    std::vector<GLfloat> v;
+    v.reserve(viewports.size() * 4);
+    for(auto& viewport : viewports)
+    {
+      v.push_back(::floorf(viewport.pos.x));
+      v.push_back(::floorf(viewport.pos.y));
+      v.push_back(::ceilf(viewport.dim.x));
+      v.push_back(::ceilf(viewport.dim.y));
+    }
+    RETURN_ERROR(CALLGL(glViewportArrayv, 0, static_cast<GLsizei>(viewports.size()), v.data()));
+    _lastviewport  = { v[0], v[1], v[0] + v[2], v[1] + v[3] };
+    _viewportarray = std::move(v);
+  }
   return {};
 }
-GLExpected<void> Context::SetScissors(std::span<FG_Rect> rects)
+GLExpected<void> Context::SetScissors(std::span<const FG_Rect> rects)
 {
-  if(rects.size() > 0)
+  if(rects.size() == 1)
   {
     _lastscissor = rects[0];
+    _scissorarray.clear();
     RETURN_ERROR(CallWithRect(rects[0], glScissor, "glScissor"));
   }
+  else if(rects.size() > 1)
+  {
+    if(!glScissorArrayv)
+      return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "Multiple scissors need OpenGL 4.1 or GL_ARB_viewport_array");
+
+    _lastscissor = rects[0];
+    _scissorarray.assign(rects.begin(), rects.end());
+    RETURN_ERROR(_applyScissorArray());
+  }
   return {};
 }
+GLExpected<void> Context::_applyScissorArray()
+{
+  std::vector<GLint> v;
+  v.reserve(_scissorarray.size() * 4);
+  for(auto& r : _scissorarray)
+  {
+    v.push_back(FastTruncate(::floorf(r.left)));
+    v.push_back(FastTruncate(::floorf(r.top)));
+    v.push_back(FastTruncate(::ceilf(r.right - r.left)));
+    v.push_back(FastTruncate(::ceilf(r.bottom - r.top)));
+  }
+  return CALLGL(glScissorArrayv, 0, static_cast<GLsizei>(_scissorarray.size()), v.data());
+}
 GLExpected<void> Context::SetShaderUniforms(const FG_ShaderParameter* uniforms, const FG_ShaderValue* values,
                                             uint32_t count)
 {
+  if(!_program)
+    return CUSTOM_ERROR(ERR_INVALID_CALL, "Shader constants must be set after a pipeline state");
+
   for(uint32_t i = 0; i < count; ++i)
   {
-    if(uniforms[i].type == FG_Shader_Type_Buffer)
-    {
-      RETURN_ERROR(_program->set_buffer(values[i].resource, uniforms[i].count, uniforms[i].width, uniforms[i].length));
-      continue;
-    }
+    auto type    = ShaderObject::get_type(uniforms[i]);
+    GLint loc    = -1;
+    bool texture = type >= GL_TEXTURE0 && type <= GL_TEXTURE31;
 
-    auto type      = ShaderObject::get_type(uniforms[i]);
-    uint32_t count = !uniforms[i].count ? 1 : uniforms[i].count;
-
-    switch(type)
+    if(uniforms[i].type != FG_Shader_Type_Buffer)
     {
-    case GL_DOUBLE:
-    case GL_HALF_FLOAT: // we assume you pass in a proper float to fill this
-    case GL_FLOAT:
-    case GL_INT:
-    case GL_UNSIGNED_INT:
-      if(count == 1)
+      // Only programs that weren't created through a pipeline state have to ask the driver.
+      if(!uniforms[i].name)
       {
-        RETURN_ERROR(_program->set_uniform(uniforms[i].name, type, &values[i].f32, count));
-        break;
+        if(!texture) // Names are optional for textures
+          return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "name cannot be null");
       }
-      // Otherwise fallthrough because the value couldn't be stored directly
-    default:
-      if(type >= GL_TEXTURE0 && type <= GL_TEXTURE31)
+      else if(_uniforms)
       {
-        RETURN_ERROR(_program->set_texture(uniforms[i].name, type, static_cast<GLuint>(values[i].resource)));
+        auto u = _uniforms->find(uniforms[i].name);
+        if(u && u->block >= 0)
+        {
+          RETURN_ERROR(_setBlockMember(*u, uniforms[i], type, values[i]));
+          continue;
+        }
+        loc = u ? u->location : -1;
       }
+      else if(auto e = CALLGL(glGetUniformLocation, *_program, uniforms[i].name))
+        loc = e.value();
       else
+        return std::move(e.error());
+    }
+
+    RETURN_ERROR(_setUniform(uniforms[i], type, loc, values[i]));
+  }
+  return {};
+}
+
+GLExpected<void> Context::SetPreparedUniforms(const PreparedUniforms& prepared, const FG_ShaderValue* values)
+{
+  if(!_program || _uniforms != prepared.table)
+    return CUSTOM_ERROR(ERR_INVALID_CALL, "Prepared shader parameters belong to a different pipeline state");
+
+  for(size_t i = 0; i < prepared.slots.size(); ++i)
+  {
+    auto& slot = prepared.slots[i];
+    if(slot.uniform && slot.uniform->block >= 0)
+    {
+      RETURN_ERROR(_setBlockMember(*slot.uniform, slot.param, slot.type, values[i]));
+    }
+    else
+    {
+      RETURN_ERROR(_setUniform(slot.param, slot.type, slot.location, values[i]));
+    }
+  }
+  return {};
+}
+
+GLExpected<void> Context::_setUniform(const FG_ShaderParameter& param, GLenum type, GLint location,
+                                      const FG_ShaderValue& value)
+{
+  if(param.type == FG_Shader_Type_Buffer)
+    return _program->set_buffer(value.resource, param.count, param.width, param.length);
+
+  ++_stats.uniform_uploads;
+  uint32_t count = !param.count ? 1 : param.count;
+
+  switch(type)
+  {
+  case GL_DOUBLE:
+  case GL_HALF_FLOAT: // we assume you pass in a proper float to fill this
+  case GL_FLOAT:
+  case GL_INT:
+  case GL_UNSIGNED_INT:
+    if(count == 1)
+      return _program->set_uniform(location, type, &value.f32, count);
+    // Otherwise fallthrough because the value couldn't be stored directly
+  default:
+    if(type >= GL_TEXTURE0 && type <= GL_TEXTURE31)
+    {
+      RETURN_ERROR(_program->set_texture(location, type, static_cast<GLuint>(value.resource)));
+      return _samplers.bind(location > 0 ? location - 1 : type - GL_TEXTURE0, static_cast<GLuint>(value.resource));
+    }
+    return _program->set_uniform(location, type, value.pf32, count);
+  }
+}
+
+GLExpected<void> Context::_setBlockMember(const UniformTable::Uniform& u, const FG_ShaderParameter& param, GLenum type,
+                                          const FG_ShaderValue& value)
+{
+  int columns, rows, bytes;
+  if(!UniformShape(u.type, columns, rows, bytes))
+    return CUSTOM_ERROR(ERR_INVALID_ENUM, "Unsupported uniform block member type");
+
+  uint32_t count = !param.count ? 1 : param.count;
+  if(count > static_cast<uint32_t>(u.size))
+    count = u.size;
+
+  // Same rule as _setUniform for which values are stored inline
+  bool scalar = type == GL_DOUBLE || type == GL_HALF_FLOAT || type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT;
+  bool inline_value  = scalar && count == 1;
+  const size_t chunk = static_cast<size_t>(rows) * bytes;
+  const size_t size  = param.type == FG_Shader_Type_Double ? sizeof(double) : sizeof(float);
+  const size_t available =
+    inline_value ? size : count * size * (!param.length ? 1 : param.length) * (param.width > 1 ? param.width : 1);
+
+  if(chunk * columns * count > available)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Shader parameter is smaller than the uniform block member");
+  if(!inline_value && !value.pf32)
+    return CUSTOM_ERROR(ERR_NULL, "Shader value pointer cannot be null");
+
+  // Pack the tightly packed, column-major source into whatever layout the block actually uses.
+  auto& block = _uniforms->blocks[u.block];
+  auto in     = inline_value ? reinterpret_cast<const std::byte*>(&value) : reinterpret_cast<const std::byte*>(value.pf32);
+  for(uint32_t e = 0; e < count; ++e)
+  {
+    for(int c = 0; c < columns; ++c)
+    {
+      size_t at = u.offset + static_cast<size_t>(e) * u.arraystride + static_cast<size_t>(c) * u.matrixstride;
+      if(at + chunk > block.data.size())
+        return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Uniform block member is out of bounds");
+      memcpy(block.data.data() + at, in, chunk);
+      in += chunk;
+    }
+  }
+
+  block.dirty = true;
+  return {};
+}
+
+GLExpected<void> Context::_flushUniformBlocks()
+{
+  if(!_uniforms || _uniforms->blocks.empty())
+    return {};
+
+  if(!_uniformring.is_valid())
+  {
+    GLint alignment = 1;
+    RETURN_ERROR(CALLGL(glGetIntegerv, GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    RETURN_ERROR(_uniformring.create(GL_UNIFORM_BUFFER, UNIFORM_RING_SIZE, alignment));
+  }
+
+  // If the ring wraps while we're writing, blocks written before that point now live in orphaned storage, so start over.
+  bool rebind = _boundblocks != _uniforms;
+  for(int pass = 0;; ++pass)
+  {
+    auto generation = _uniformring.generation();
+    for(auto& block : _uniforms->blocks)
+    {
+      if(block.dirty || block.ring != &_uniformring || block.generation != _uniformring.generation())
       {
-        RETURN_ERROR(_program->set_uniform(uniforms[i].name, type, values[i].pf32, count));
+        auto offset = _uniformring.write(block.data.data(), block.data.size());
+        if(offset.has_error())
+          return std::move(offset.error());
+        ++_stats.uniform_uploads;
+        _stats.bytes_uploaded += block.data.size();
+        block.offset     = offset.value();
+        block.generation = _uniformring.generation();
+        block.ring       = &_uniformring;
+        block.dirty      = false;
       }
-      break;
+      else if(!rebind)
+        continue;
+
+      RETURN_ERROR(CALLGL(glBindBufferRange, GL_UNIFORM_BUFFER, block.binding, _uniformring.buffer(), block.offset,
+                          block.data.size()));
     }
+
+    if(generation == _uniformring.generation())
+      break;
+    if(pass > 0)
+      return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Uniform blocks don't fit in the uniform ring buffer");
+    rebind = true;
   }
+
+  _boundblocks = _uniforms;
   return {};
 }
 
 GLExpected<void> Context::DrawArrays(uint32_t vertexcount, uint32_t instancecount, uint32_t startvertex,
                                      uint32_t startinstance)
 {
-  if(instancecount > 0)
+  if(startinstance != 0 && !glDrawArraysInstancedBaseInstance)
+    return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "A start instance needs OpenGL 4.2 or GL_ARB_base_instance");
+
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  ++_stats.draws;
+
+  if(startinstance != 0)
+  {
+    RETURN_ERROR(CALLGL(glDrawArraysInstancedBaseInstance, _primitive, startvertex, vertexcount,
+                        std::max(instancecount, 1U), startinstance));
+  }
+  else if(instancecount > 0)
   {
-    RETURN_ERROR(CALLGL(glDrawArraysInstanced, _primitive, startinstance, vertexcount, instancecount));
+    RETURN_ERROR(CALLGL(glDrawArraysInstanced, _primitive, startvertex, vertexcount, instancecount));
   }
   else
   {
@@ -204,20 +978,186 @@ GLExpected<void> Context::DrawArrays(uint32_t vertexcount, uint32_t instancecoun
 GLExpected<void> Context::DrawIndexed(GLsizei indexcount, GLsizei instancecount, uint32_t startindex, int startvertex,
                                       uint32_t startinstance)
 {
-  if(instancecount > 0)
-  {
-    // GLenum mode, GLsizei count, GLenum type, const void *indices,GLsizei instancecount
+  if(startinstance != 0 && !glDrawElementsInstancedBaseVertexBaseInstance)
+    return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "A start instance needs OpenGL 4.2 or GL_ARB_base_instance");
+
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  ++_stats.draws;
+
+  // The index pointer is a byte offset into the bound element buffer, and startvertex is added to every index read
+  // from it, so many meshes can be packed into the same pair of buffers.
+  size_t indexsize = (_indextype == GL_UNSIGNED_BYTE) ? 1 : (_indextype == GL_UNSIGNED_SHORT) ? 2 : 4;
+  auto indices     = reinterpret_cast<const void*>(static_cast<uintptr_t>(startindex) * indexsize);
 
-    RETURN_ERROR(CALLGL(glDrawElementsInstanced, _primitive, indexcount, _indextype, nullptr, instancecount));
+  if(startinstance != 0)
+  {
+    RETURN_ERROR(CALLGL(glDrawElementsInstancedBaseVertexBaseInstance, _primitive, indexcount, _indextype, indices,
+                        std::max(instancecount, 1), startvertex, startinstance));
+  }
+  else if(instancecount > 0)
+  {
+    if(startvertex != 0)
+    {
+      RETURN_ERROR(CALLGL(glDrawElementsInstancedBaseVertex, _primitive, indexcount, _indextype, indices, instancecount,
+                          startvertex));
+    }
+    else
+    {
+      RETURN_ERROR(CALLGL(glDrawElementsInstanced, _primitive, indexcount, _indextype, indices, instancecount));
+    }
+  }
+  else if(startvertex != 0)
+  {
+    RETURN_ERROR(CALLGL(glDrawElementsBaseVertex, _primitive, indexcount, _indextype, indices, startvertex));
   }
   else
   {
-    RETURN_ERROR(CALLGL(glDrawElements, _primitive, indexcount, _indextype, nullptr));
+    RETURN_ERROR(CALLGL(glDrawElements, _primitive, indexcount, _indextype, indices));
   }
 
   return {};
 }
-GLExpected<void> Context::DrawMesh(uint32_t start, uint32_t count) { return CALLGL(glDrawMeshTasksNV, start, count); }
+GLExpected<void> Context::DrawIndirect(FG_Resource buffer, uint32_t offset, uint32_t count, uint32_t stride,
+                                       bool indexed)
+{
+  if(count == 0)
+    return {};
+
+  const GLsizeiptr record = indexed ? sizeof(FG_DrawIndexedIndirectArgs) : sizeof(FG_DrawIndirectArgs);
+  if(stride == 0)
+    stride = static_cast<uint32_t>(record);
+
+  // Reading past the end of the buffer is undefined, so the whole range is checked against the size it was created with.
+  auto info = ResourceTable::find(REF_BUFFER, buffer);
+  if(!info)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Indirect draws need a valid buffer of draw records");
+  if(stride < record || (offset % 4) != 0 || (stride % 4) != 0)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Draw records must be 4-byte aligned and can't overlap");
+  if(offset + GLsizeiptr(count - 1) * stride + record > info->bytes)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Draw records extend past the end of the buffer");
+
+  if(indexed ? !glDrawElementsIndirect : !glDrawArraysIndirect)
+    return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "Indirect draws need OpenGL 4.0 or GL_ARB_draw_indirect");
+
+  // A culling pass may have just written the records.
+  if(auto bits = _uncovered(buffer, GL_COMMAND_BARRIER_BIT))
+  {
+    RETURN_ERROR(Barrier(bits));
+  }
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_DRAW_INDIRECT_BUFFER, static_cast<GLuint>(buffer & REF_MASK)));
+
+  // The indirect pointer is an offset into the bound GL_DRAW_INDIRECT_BUFFER.
+  auto records = reinterpret_cast<const void*>(static_cast<uintptr_t>(offset));
+  if(indexed && glMultiDrawElementsIndirect)
+  {
+    ++_stats.draws;
+    return CALLGL(glMultiDrawElementsIndirect, _primitive, _indextype, records, count, stride);
+  }
+  if(!indexed && glMultiDrawArraysIndirect)
+  {
+    ++_stats.draws;
+    return CALLGL(glMultiDrawArraysIndirect, _primitive, records, count, stride);
+  }
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    auto cur = reinterpret_cast<const void*>(static_cast<uintptr_t>(offset) + uintptr_t(i) * stride);
+    if(indexed)
+    {
+      RETURN_ERROR(CALLGL(glDrawElementsIndirect, _primitive, _indextype, cur));
+    }
+    else
+    {
+      RETURN_ERROR(CALLGL(glDrawArraysIndirect, _primitive, cur));
+    }
+  }
+  _stats.draws += count;
+  return {};
+}
+GLExpected<void> Context::DrawMesh(uint32_t start, uint32_t count)
+{
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  ++_stats.draws;
+  return CALLGL(glDrawMeshTasksNV, start, count);
+}
+
+GLExpected<void> Context::DrawQuads(FG_Resource texture, std::span<const FG_Quad> quads)
+{
+  while(!quads.empty())
+  {
+    if(_quads.full() || (!_quads.empty() && _quads.texture() != texture))
+    {
+      RETURN_ERROR(FlushQuads());
+    }
+
+    if(_quads.empty())
+    {
+      // UVs are given in texels, so the texture size is needed before any vertices can be built.
+      FG_Vec2 size = { 1, 1 };
+      if(auto info = ResourceTable::find(REF_TEXTURE, texture))
+        size = { static_cast<float>(info->size.x), static_cast<float>(info->size.y) };
+      else if(texture)
+      {
+        GLint w = 0, h = 0;
+        RETURN_ERROR(CALLGL(glActiveTexture, GL_TEXTURE0));
+        RETURN_ERROR(CALLGL(glBindTexture, GL_TEXTURE_2D, static_cast<GLuint>(texture & REF_MASK)));
+        RETURN_ERROR(CALLGL(glGetTexLevelParameteriv, GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w));
+        RETURN_ERROR(CALLGL(glGetTexLevelParameteriv, GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h));
+        size = { static_cast<float>(w), static_cast<float>(h) };
+      }
+      _quads.begin(texture, size);
+    }
+
+    quads = quads.subspan(_quads.append(quads));
+  }
+  return {};
+}
+
+GLExpected<void> Context::FlushQuads()
+{
+  if(_quads.empty())
+    return {};
+  if(!_program)
+    return CUSTOM_ERROR(ERR_INVALID_CALL, "Quads can't be drawn without a pipeline state");
+
+  RETURN_ERROR(_flushUniformBlocks());
+  _issueWrites();
+  if(_quads.texture())
+  {
+    RETURN_ERROR(CALLGL(glActiveTexture, GL_TEXTURE0));
+    RETURN_ERROR(CALLGL(glBindTexture, GL_TEXTURE_2D, static_cast<GLuint>(_quads.texture() & REF_MASK)));
+    RETURN_ERROR(_samplers.bind(0, static_cast<GLuint>(_quads.texture() & REF_MASK)));
+  }
+
+  ++_stats.draws;
+  _stats.bytes_uploaded += _quads.bytes();
+  RETURN_ERROR(_quads.draw(*_program));
+
+  // Put the pipeline's vertex array back, so later draws still see their own vertex buffers. Emulated vertex arrays
+  // have nothing to put back, so there the pipeline state has to be set again before drawing anything else.
+#ifndef USE_EMULATED_VAOS
+  if(_lastvao != ~0U)
+  {
+    RETURN_ERROR(CALLGL(glBindVertexArray, _lastvao));
+  }
+#endif
+  return {};
+}
+
+GL::GLExpected<void> Context::CopyResource(FG_Resource src, FG_Resource dest, FG_Vec3i size, int level)
+{
+  if(Buffer::validate(src) && Buffer::validate(dest))
+    return CopySubresource(src, dest, 0, 0, size.x);
+  else if((Texture::validate(src) && Texture::validate(dest)) ||
+          (Renderbuffer::validate(src) && Renderbuffer::validate(dest)))
+    return CopyResourceRegion(src, dest, level, FG_Vec3i{ 0, 0, 0 }, FG_Vec3i{ 0, 0, 0 }, size);
+
+  return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Mismatched src / dest resources");
+}
 
 GL::GLExpected<void> Context::CopySubresource(FG_Resource src, FG_Resource dest, unsigned long srcoffset,
                                               unsigned long destoffset, unsigned long bytes)
@@ -278,6 +1218,96 @@ GL::GLExpected<void> Context::CopyResourceRegion(FG_Resource src, FG_Resource de
   return {};
 }
 
+GLExpected<void> Context::UpdateTexture(FG_Resource texture, GLint level, FG_Vec2i offset, FG_Vec2i size,
+                                        const Format& format, const void* data)
+{
+  if(!Texture::validate(texture))
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Can only update textures");
+
+  const GLsizeiptr bytes = static_cast<GLsizeiptr>(format.image_bytes(size));
+  if(bytes <= 0 || !data)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Nothing to upload, or format has no client memory layout");
+
+  RETURN_ERROR(CALLGL(glBindTexture, GL_TEXTURE_2D, Texture(texture)));
+  RETURN_ERROR(CALLGL(glPixelStorei, GL_UNPACK_ALIGNMENT, 1)); // Rows are tightly packed
+
+  // Copying into the staging ring lets the driver do the actual transfer whenever the GPU gets to it, instead of
+  // stalling here until it has copied data out of client memory. Uploads that don't fit go through the slow path.
+  const void* pixels = data;
+  if(bytes <= UNPACK_RING_SIZE)
+  {
+    if(!_unpackring.is_valid())
+    {
+      RETURN_ERROR(_unpackring.create(GL_PIXEL_UNPACK_BUFFER, UNPACK_RING_SIZE, 16));
+    }
+
+    auto written = _unpackring.write(data, bytes);
+    if(written.has_error())
+      return std::move(written.error());
+
+    RETURN_ERROR(CALLGL(glBindBuffer, GL_PIXEL_UNPACK_BUFFER, _unpackring.buffer()));
+    pixels = reinterpret_cast<const void*>(written.value());
+  }
+
+  // Compressed regions have to start on a block boundary, and can only end off one at the edge of the level.
+  if(format.compressed())
+  {
+    RETURN_ERROR(CALLGL(glCompressedTexSubImage2D, GL_TEXTURE_2D, level, offset.x, offset.y, size.x, size.y,
+                        format.internalformat, static_cast<GLsizei>(bytes), pixels));
+  }
+  else
+  {
+    RETURN_ERROR(CALLGL(glTexSubImage2D, GL_TEXTURE_2D, level, offset.x, offset.y, size.x, size.y, format.components,
+                        format.type, pixels));
+  }
+  _stats.bytes_uploaded += bytes;
+
+  if(pixels != data)
+  {
+    RETURN_ERROR(CALLGL(glBindBuffer, GL_PIXEL_UNPACK_BUFFER, 0));
+  }
+  RETURN_ERROR(CALLGL(glPixelStorei, GL_UNPACK_ALIGNMENT, 4));
+  return {};
+}
+
+GLExpected<void> Context::ReadBuffer(FG_Resource buffer, GLintptr offset, GLsizeiptr bytes, FG_ReadbackCallback callback,
+                                     void* user)
+{
+  return _readbacks.read_buffer(buffer, offset, bytes, callback, user);
+}
+
+GLExpected<void> Context::ReadPixels(FG_Resource source, FG_Vec2i offset, FG_Vec2i size, const Format& format,
+                                     FG_ReadbackCallback callback, void* user)
+{
+  RETURN_ERROR(FlushQuads());
+  auto e = _readbacks.read_pixels(source, _headless ? _headless->framebuffer() : 0, offset, size, format, callback, user);
+
+  // Only the read binding was changed, so putting it back keeps the cached draw binding valid.
+  if(_lastframebuffer != ~0U)
+  {
+    RETURN_ERROR(CALLGL(glBindFramebuffer, GL_READ_FRAMEBUFFER, _lastframebuffer));
+  }
+  if(e.has_error())
+    return std::move(e.error());
+  return {};
+}
+
+GLExpected<FG_Resource> Context::AcquireTarget(FG_Vec2i size, const Format& format, int samples, int attachments,
+                                               const FG_Sampler& sampler, SamplerCache* samplers, FG_Resource& texture)
+{
+  // Creating a target binds a texture and a framebuffer behind the cache's back.
+  InvalidateBindings();
+  return _targets.acquire(size, format, samples, attachments, sampler, _frame, samplers, texture);
+}
+
+GLExpected<void> Context::ReleaseTarget(FG_Resource framebuffer)
+{
+  // Quads still waiting in the batch may be drawing into the target, and have to land before it's invalidated.
+  RETURN_ERROR(FlushQuads());
+  _lastframebuffer = ~0U;
+  return _targets.release(framebuffer);
+}
+
 int Context::GetBytes(GLenum type)
 {
   switch(type)
@@ -318,29 +1348,31 @@ GLExpected<void> Context::FlipFlag(int diff, int flags, int flag, int option)
 
 GLExpected<void> Context::ApplyBlendFactor(const std::array<float, 4>& factor)
 {
-  if(_lastfactor != factor)
+  if(_changed(_stale(STALE_FACTOR) || _lastfactor != factor))
   {
     RETURN_ERROR(CALLGL(glBlendColor, factor[0], factor[1], factor[2], factor[3]));
     _lastfactor = factor;
+    _stalestate &= ~STALE_FACTOR;
   }
   return {};
 }
 
 GLExpected<void> Context::ApplyBlend(const FG_Blend& blend, bool force)
 {
-  if(force || memcmp(&blend, &_lastblend, sizeof(FG_Blend)) != 0)
+  if(_changed(force || _stale(STALE_BLEND) || memcmp(&blend, &_lastblend, sizeof(FG_Blend)) != 0))
   {
     RETURN_ERROR(CALLGL(glBlendFuncSeparate, BlendMapping[blend.src_blend], BlendMapping[blend.dest_blend],
                         BlendMapping[blend.src_blend_alpha], BlendMapping[blend.dest_blend_alpha]));
     RETURN_ERROR(CALLGL(glBlendEquationSeparate, BlendOpMapping[blend.blend_op], BlendOpMapping[blend.blend_op_alpha]));
 
-    if(_lastblend.rendertarget_write_mask != blend.rendertarget_write_mask)
+    if(_stale(STALE_BLEND) || _lastblend.rendertarget_write_mask != blend.rendertarget_write_mask)
     {
       RETURN_ERROR(CALLGL(glColorMask, blend.rendertarget_write_mask & 0b0001, blend.rendertarget_write_mask & 0b0010,
                           blend.rendertarget_write_mask & 0b0100, blend.rendertarget_write_mask & 0b1000));
     }
 
     _lastblend = blend;
+    _stalestate &= ~STALE_BLEND;
   }
 
   return {};
@@ -348,7 +1380,7 @@ GLExpected<void> Context::ApplyBlend(const FG_Blend& blend, bool force)
 
 GLExpected<void> Context::ApplyFill(uint8_t fill)
 {
-  if(_lastfill != fill)
+  if(_changed(_stale(STALE_FILL) || _lastfill != fill))
   {
     switch(fill)
     {
@@ -357,13 +1389,14 @@ GLExpected<void> Context::ApplyFill(uint8_t fill)
     case FG_Fill_Mode_Point: RETURN_ERROR(CALLGL(glPolygonMode, GL_FRONT_AND_BACK, GL_POINT)); break;
     }
     _lastfill = fill;
+    _stalestate &= ~STALE_FILL;
   }
   return {};
 }
 
 GLExpected<void> Context::ApplyCull(uint8_t cull)
 {
-  if(_lastcull != cull)
+  if(_changed(_stale(STALE_CULL) || _lastcull != cull))
   {
     if(cull == FG_Cull_Mode_None)
     {
@@ -377,12 +1410,19 @@ GLExpected<void> Context::ApplyCull(uint8_t cull)
     }
 
     _lastcull = cull;
+    _stalestate &= ~STALE_CULL;
   }
   return {};
 }
 GLExpected<void> Context::ApplyFlags(uint16_t flags)
 {
-  auto diff = _lastflags ^ flags;
+  if(_damaged)
+    flags |= FG_Pipeline_Flag_Scissor_Enable;
+
+  // Every flag is set again if they're stale, not just the ones that differ from the cache.
+  auto diff = _stale(STALE_FLAGS) ? 0xFFFF : _lastflags ^ flags;
+  if(!_changed(diff != 0))
+    return {};
   RETURN_ERROR(FlipFlag(diff, flags, FG_Pipeline_Flag_RenderTarget_SRGB_Enable, GL_FRAMEBUFFER_SRGB));
   RETURN_ERROR(FlipFlag(diff, flags, FG_Pipeline_Flag_Depth_Enable, GL_DEPTH_TEST));
   RETURN_ERROR(FlipFlag(diff, flags, FG_Pipeline_Flag_Stencil_Enable, GL_STENCIL_TEST));
@@ -402,6 +1442,7 @@ GLExpected<void> Context::ApplyFlags(uint16_t flags)
   }
 
   _lastflags = flags;
+  _stalestate &= ~STALE_FLAGS;
   return {};
 }
 
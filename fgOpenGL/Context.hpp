@@ -8,6 +8,17 @@
 #include "glad/glad.h"
 #include "feather/graphics_interface.h"
 #include "ShaderObject.hpp"
+#include "ProgramObject.hpp"
+#include "RingBuffer.hpp"
+#include "QuadBatch.hpp"
+#include "FrameTimer.hpp"
+#include "Format.hpp"
+#include "SamplerCache.hpp"
+#include "VertexLayoutCache.hpp"
+#include "ClearPass.hpp"
+#include "Headless.hpp"
+#include "ReadbackQueue.hpp"
+#include "TargetPool.hpp"
 #include <math.h>
 #include <vector>
 #include <array>
@@ -18,7 +29,8 @@
 
 namespace GL {
   class Provider;
-  struct ProgramObject;
+  class VertexArrayObject;
+  struct Atlas;
 
   enum class GLCaps
   {
@@ -47,35 +59,103 @@ namespace GL {
   // A context may or may not have an associated OS window, for use inside other 3D engines.
   struct Context
   {
-    FG_COMPILER_DLLEXPORT explicit Context(FG_Vec2 dim);
+    // A headless context draws into the framebuffer of headless wherever a window would use its default framebuffer.
+    FG_COMPILER_DLLEXPORT explicit Context(FG_Vec2 dim, std::unique_ptr<Headless> headless = nullptr);
     ~Context();
+    // If area is given, in window coordinates with the origin at the top left, everything until EndDraw is scissored to
+    // it, so only the part of the window that actually changed is redrawn.
     FG_COMPILER_DLLEXPORT GLExpected<void> BeginDraw(const FG_Rect* area);
     FG_COMPILER_DLLEXPORT GLExpected<void> EndDraw();
+    // The area the current frame is restricted to, or nullptr if it covers the whole window. Only valid until EndDraw.
+    inline const FG_Rect* Damage() const noexcept { return _damaged ? &_damage : nullptr; }
+    inline bool IsHeadless() const noexcept { return _headless != nullptr; }
     FG_COMPILER_DLLEXPORT GLExpected<void> Resize(FG_Vec2 dim);
+    // Times everything the GPU does until the matching EndRegion. name must be a string that outlives the context.
+    FG_COMPILER_DLLEXPORT GLExpected<void> BeginRegion(const char* name);
+    FG_COMPILER_DLLEXPORT GLExpected<void> EndRegion();
+    inline const FG_FrameStats& GetFrameStats() const noexcept { return _framestats; }
+    // Number of frames that have ended, used to tell which resources could still be referenced by the current one.
+    inline uint64_t Frame() const noexcept { return _frame; }
+    // Returns the VAO shared by every pipeline with this vertex layout, creating it if this is the first one.
+    GLExpected<VertexArrayObject*> FindVertexLayout(const VertexLayout& layout);
     GLExpected<void> DrawArrays(uint32_t vertexcount, uint32_t instancecount, uint32_t startvertex, uint32_t startinstance);
     GLExpected<void> DrawIndexed(GLsizei indexcount, GLsizei instancecount, uint32_t startindex, int startvertex,
                                  uint32_t startinstance);
     GLExpected<void> DrawMesh(uint32_t start, uint32_t count);
-    GLExpected<void> Dispatch();
+    // Draws count records from buffer with a single glMultiDraw*Indirect if the driver has it, or one indirect draw per
+    // record otherwise. A stride of 0 means the records are tightly packed.
+    GLExpected<void> DrawIndirect(FG_Resource buffer, uint32_t offset, uint32_t count, uint32_t stride, bool indexed);
+    // Queues quads into the batch, which is only drawn once FlushQuads is called or the texture changes.
+    GLExpected<void> DrawQuads(FG_Resource texture, std::span<const FG_Quad> quads);
+    GLExpected<void> FlushQuads();
+    // Dispatches groups work groups, or the count set by the compute pipeline if groups is null.
+    GLExpected<void> Dispatch(const FG_Vec3i* groups);
+    GLExpected<void> DispatchIndirect(FG_Resource buffer, uint32_t offset);
+    // Issues one barrier for every way a resource in accesses is read that hasn't been covered since a shader last
+    // wrote it, then marks the ones that are written.
+    GLExpected<void> DeclareAccess(std::span<const FG_ResourceAccess> accesses);
     GLExpected<void> Barrier(GLbitfield barrier_flags);
     GLExpected<void> SetShaderUniforms(const FG_ShaderParameter* uniforms, const FG_ShaderValue* values, uint32_t count);
+    GLExpected<void> SetPreparedUniforms(const PreparedUniforms& prepared, const FG_ShaderValue* values);
+    GLExpected<void> CopyResource(FG_Resource src, FG_Resource dest, FG_Vec3i size, int level);
     GLExpected<void> CopySubresource(FG_Resource src, FG_Resource dest, unsigned long srcoffset, unsigned long destoffset,
                                      unsigned long bytes);
     GLExpected<void> CopyResourceRegion(FG_Resource src, FG_Resource dest, int level, FG_Vec3i srcoffset,
                                         FG_Vec3i destoffset, FG_Vec3i size);
+    // Uploads tightly packed pixels in format to a region of texture. data is copied into a staging buffer before this
+    // returns, so the caller can reuse it immediately.
+    GLExpected<void> UpdateTexture(FG_Resource texture, GLint level, FG_Vec2i offset, FG_Vec2i size, const Format& format,
+                                   const void* data);
+    GLExpected<void> ReadBuffer(FG_Resource buffer, GLintptr offset, GLsizeiptr bytes, FG_ReadbackCallback callback,
+                                void* user);
+    // Reads from the backbuffer if source is 0. Pending quads are drawn first, so they show up in what is read.
+    GLExpected<void> ReadPixels(FG_Resource source, FG_Vec2i offset, FG_Vec2i size, const Format& format,
+                                FG_ReadbackCallback callback, void* user);
+    inline GLExpected<int> FinishReadbacks(bool wait) { return _readbacks.finish(wait); }
+    // Render targets for transient passes come from a pool, and go back to it with their contents invalidated. Targets
+    // that stay unused for a few frames are deleted by EndDraw.
+    GLExpected<FG_Resource> AcquireTarget(FG_Vec2i size, const Format& format, int samples, int attachments,
+                                          const FG_Sampler& sampler, SamplerCache* samplers, FG_Resource& texture);
+    GLExpected<void> ReleaseTarget(FG_Resource framebuffer);
+    // Atlases that were created through this context are trimmed by EndDraw while the memory budget is exceeded, until
+    // they're removed again.
+    inline void AddAtlas(Atlas* atlas) { _atlases.push_back(atlas); }
+    inline void RemoveAtlas(Atlas* atlas) noexcept { std::erase(_atlases, atlas); }
     GLExpected<void> ApplyBlendFactor(const std::array<float, 4>& factor);
     GLExpected<void> ApplyBlend(const FG_Blend& blend, bool force = false);
     GLExpected<void> ApplyFlags(uint16_t flags);
     GLExpected<void> ApplyFill(uint8_t fill);
     GLExpected<void> ApplyCull(uint8_t cull);
-    GLExpected<void> SetViewports(std::span<FG_Viewport> viewports);
-    GLExpected<void> SetScissors(std::span<FG_Rect> rects);
-    GLExpected<void> Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth, std::span<FG_Rect> rects);
+    GLExpected<void> SetViewports(std::span<const FG_Viewport> viewports);
+    GLExpected<void> SetScissors(std::span<const FG_Rect> rects);
+    // Clears rects, in the same bottom left origin coordinates as glScissor, or the whole render target if there are
+    // none. A handful of rects are scissored and cleared one by one, more than that are all drawn in a single pass.
+    GLExpected<void> Clear(uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil, float depth,
+                           std::span<const FG_Rect> rects);
     void ApplyWorkGroup(FG_Vec3i workgroup) { _workgroup = workgroup; }
     void ApplyDim(FG_Vec2 dim) { _dim = dim; }
     inline void ApplyIndextype(GLenum indextype) { _indextype = indextype; }
     inline void ApplyPrimitive(GLenum primitive) { _primitive = primitive; }
-    GLExpected<void> ApplyProgram(const ProgramObject& program);
+    GLExpected<void> ApplyProgram(const ProgramObject& program, UniformTable* uniforms = nullptr);
+    GLExpected<void> ApplyVertexArray(VertexArrayObject& vao);
+    // Binds buffers to the binding points of the current shared VAO, starting at 0. Bindings are part of the VAO, so
+    // these are only skipped if the same VAO is still bound.
+    GLExpected<void> ApplyVertexBuffers(std::span<const VertexBinding> bindings);
+    GLExpected<void> ApplyIndexBuffer(GLuint indices);
+    // Points the current pipeline's vertex buffer bindings, starting at first, at new buffers and offsets while keeping
+    // the strides the pipeline was created with.
+    GLExpected<void> SetVertexBuffers(uint32_t first, std::span<const FG_Resource> buffers, const uint32_t* offsets);
+    GLExpected<void> ApplyFramebuffer(GLuint framebuffer);
+    GLExpected<void> ApplyDepthFunc(GLenum func);
+    GLExpected<void> ApplyStencilOp(GLenum fail, GLenum depthfail, GLenum pass);
+    GLExpected<void> ApplyStencilMask(GLuint mask);
+    GLExpected<void> ApplyStencilFunc(GLenum func, GLint ref, GLuint mask);
+    GLExpected<void> ApplyDepthBias(float slope, float bias);
+    GLExpected<void> ApplyPipelineState(uintptr_t state);
+    // Forgets which program, VAO, framebuffer and samplers are bound, and the depth, stencil, blend and rasterizer state.
+    // Call this whenever something outside of Context may have changed or deleted those, so the next Apply* call sets
+    // them again instead of trusting the cache.
+    void InvalidateBindings() noexcept;
     GLExpected<void> FlipFlag(int diff, int flags, int flag, int option);
     static inline void ColorFloats(const FG_Color8& c, std::array<float, 4>& colors, bool linearize)
     {
@@ -141,9 +221,93 @@ namespace GL {
       GLint alphadest;
       GLint alphaop;
     } _statestore;
+
+    // Shadow copy of the stencil state, so partially specified pipelines never have to read it back from the driver.
+    struct StencilState
+    {
+      GLenum func;
+      GLint ref;
+      GLuint readmask;
+      GLuint writemask;
+      GLenum fail;
+      GLenum depthfail;
+      GLenum pass;
+    };
+
+    inline const StencilState& LastStencil() const noexcept { return _laststencil; }
+
+    // A resource some shader wrote to, and every barrier issued since then, which all of its later reads can rely on.
+    // A write stays pending from declareAccess until the next draw or dispatch actually issues it, since a barrier in
+    // between runs before the write and so can't cover it.
+    struct ShaderWrite
+    {
+      FG_Resource resource;
+      GLbitfield covered;
+      bool pending;
+    };
+
+    // The paths a shader can write through, which a later shader write to the same resource has to wait on.
+    static constexpr GLbitfield SHADER_WRITE_BARRIERS = GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+
     const ProgramObject* _program;
+    UniformTable* _uniforms; // Reflected uniforms of _program, if any
+
+    static constexpr GLsizeiptr UNIFORM_RING_SIZE = 1 << 20;
+    static constexpr GLsizeiptr UNPACK_RING_SIZE  = 1 << 24; // Fits a 1080p RGBA frame, with room to spare
+
+    friend struct QuadBatch;
 
   protected:
+    // Render state that has to be set again by the next Apply* call, whatever the cached value is.
+    static constexpr uint16_t STALE_FLAGS        = 1 << 0;
+    static constexpr uint16_t STALE_BLEND        = 1 << 1;
+    static constexpr uint16_t STALE_FACTOR       = 1 << 2;
+    static constexpr uint16_t STALE_CULL         = 1 << 3;
+    static constexpr uint16_t STALE_FILL         = 1 << 4;
+    static constexpr uint16_t STALE_DEPTH_FUNC   = 1 << 5;
+    static constexpr uint16_t STALE_STENCIL_OP   = 1 << 6;
+    static constexpr uint16_t STALE_STENCIL_MASK = 1 << 7;
+    static constexpr uint16_t STALE_STENCIL_FUNC = 1 << 8;
+    static constexpr uint16_t STALE_DEPTH_BIAS   = 1 << 9;
+    static constexpr uint16_t STALE_ALL          = (1 << 10) - 1;
+
+    // Counts a state change if it actually has to reach the driver, or a redundant one if it was filtered out.
+    inline bool _changed(bool changed) noexcept
+    {
+      ++(changed ? _stats.state_changes : _stats.redundant_state);
+      return changed;
+    }
+    inline bool _stale(uint16_t state) const noexcept { return (_stalestate & state) != 0; }
+    GLExpected<void> _setUniform(const FG_ShaderParameter& param, GLenum type, GLint location,
+                                 const FG_ShaderValue& value);
+    GLExpected<void> _setBlockMember(const UniformTable::Uniform& u, const FG_ShaderParameter& param, GLenum type,
+                                     const FG_ShaderValue& value);
+    // The barrier bits reading resource in the ways given by bits still needs, or 0 if no shader wrote it since.
+    GLbitfield _uncovered(FG_Resource resource, GLbitfield bits) const noexcept;
+    // Forgets writes to deleted resources, and writes every barrier has covered already.
+    void _pruneWrites() noexcept;
+    // Called by every draw and dispatch right before it reaches the driver, which is where pending writes happen.
+    inline void _issueWrites() noexcept
+    {
+      for(auto& write : _writes)
+        write.pending = false;
+    }
+    // Streams every modified uniform block of the current program into _uniformring, and binds them if needed.
+    GLExpected<void> _flushUniformBlocks();
+    GLExpected<void> _applyScissorArray();
+    // Puts back the scissor rects and viewports from the shadow state after something temporarily overrode them.
+    GLExpected<void> _restoreScissors();
+    GLExpected<void> _restoreViewports();
+    GLExpected<void> _applyClearValues(GLbitfield flags, const std::array<float, 4>& color, uint8_t stencil,
+                                       float depth);
+    GLExpected<void> _drawClear(GLbitfield flags, std::span<const std::array<GLint, 4>> boxes,
+                                const std::array<GLint, 4>& bounds, const std::array<float, 4>& color, uint8_t stencil,
+                                float depth);
+    // The damage as a scissor rect, with the origin at the bottom left.
+    inline FG_Rect _damageScissor() const noexcept
+    {
+      return { _damage.left, _dim.y - _damage.bottom, _damage.right, _dim.y - _damage.top };
+    }
     template<class T> inline static void _buildPosUV(T (&v)[4], const FG_Rect& area, const FG_Rect& uv, float x, float y)
     {
       v[0].posUV[0] = area.left;
@@ -167,6 +331,7 @@ namespace GL {
       v[3].posUV[3] = uv.bottom / y;
     }
 
+    std::unique_ptr<Headless> _headless; // Declared first so it outlives every GL object the context owns
     GLenum _primitive;
     GLenum _indextype;
     FG_Blend _lastblend;
@@ -177,6 +342,40 @@ namespace GL {
     FG_Vec2 _dim;
     FG_Vec3i _workgroup;
     FG_Rect _lastscissor;
+    FG_Rect _damage; // In window coordinates, only used while _damaged is set
+    bool _damaged;
+    std::vector<FG_Rect> _scissorarray; // Only set while more than one scissor rect is in use
+    FG_Rect _lastviewport;
+    std::vector<GLfloat> _viewportarray; // Only set while more than one viewport is in use
+    std::array<float, 4> _lastclearcolor;
+    float _lastcleardepth;
+    GLint _lastclearstencil;
+    GLuint _lastprogram;
+    GLuint _lastvao;
+    GLuint _lastindices;
+    std::array<VertexBinding, VertexLayoutCache::BINDINGS> _lastbindings;
+    std::array<GLsizei, VertexLayoutCache::BINDINGS> _strides; // Of the current pipeline's bindings
+    uint32_t _bindingcount; // 0 unless the current pipeline uses a shared VAO
+    GLuint _lastframebuffer;
+    GLenum _lastdepthfunc;
+    StencilState _laststencil;
+    std::array<float, 2> _lastbias;
+    uint16_t _stalestate; // STALE_* bits of the cached render state above that the driver may no longer match
+    RingBuffer _uniformring;
+    RingBuffer _unpackring; // Stages texture uploads
+    ReadbackQueue _readbacks;
+    TargetPool _targets;
+    std::vector<Atlas*> _atlases;
+    std::vector<ShaderWrite> _writes; // Resources shaders wrote to, and the barriers issued since
+    const UniformTable* _boundblocks; // Whose blocks are currently bound to the uniform buffer binding points
+    QuadBatch _quads;
+    ClearPass _clearpass;
+    SamplerBindings _samplers;
+    VertexLayoutCache _layouts;
+    FrameTimer _timer;
+    FG_FrameStats _stats;      // Counters of the frame being drawn
+    FG_FrameStats _framestats; // Counters of the last frame that ended
+    uint64_t _frame;
   };
 }
 
@@ -61,6 +61,7 @@ namespace GL {
     GL_PROXY_TEXTURE_2D_MULTISAMPLE,
     GL_RENDERBUFFER,
     GL_SHADER_STORAGE_BUFFER, // Similar to GL_UNIFORM_BUFFER but can be way bigger
+    GL_DRAW_INDIRECT_BUFFER,
   };
 
   static constinit uint16_t StencilOpMapping[] = {
@@ -71,7 +72,35 @@ namespace GL {
                                                      GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_COMPUTE_SHADER,
                                                      GL_MESH_SHADER_NV,      GL_TASK_SHADER_NV };
 
+  // Indexed by the bit position of each FG_BarrierFlags value.
+  static constinit GLbitfield BarrierMapping[] = {
+    GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT,
+    GL_ELEMENT_ARRAY_BARRIER_BIT,
+    GL_UNIFORM_BARRIER_BIT,
+    GL_TEXTURE_FETCH_BARRIER_BIT,
+    GL_TEXTURE_UPDATE_BARRIER_BIT,
+    GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,
+    GL_COMMAND_BARRIER_BIT,
+    GL_PIXEL_BUFFER_BARRIER_BIT,
+    GL_BUFFER_UPDATE_BARRIER_BIT,
+    GL_FRAMEBUFFER_BARRIER_BIT,
+    GL_SHADER_STORAGE_BARRIER_BIT,
+    GL_TRANSFORM_FEEDBACK_BARRIER_BIT,
+    GL_ATOMIC_COUNTER_BARRIER_BIT,
+  };
+
   template<class T, int SIZE> constexpr int ArraySize(T (&)[SIZE]) { return SIZE; }
+
+  inline GLbitfield BarrierBits(uint32_t barrier_flags) noexcept
+  {
+    GLbitfield bits = 0;
+    for(int i = 0; i < ArraySize(BarrierMapping); ++i)
+    {
+      if(barrier_flags & (1U << i))
+        bits |= BarrierMapping[i];
+    }
+    return bits;
+  }
 }
 
 #endif
\ No newline at end of file
@@ -202,6 +202,7 @@ Format Format::Create(unsigned char format, bool sRGB) noexcept
   case FG_PixelFormat_R8G8B8A8_UInt: return Format{ GL_RGBA8UI, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE };
   case FG_PixelFormat_R8G8B8A8_SNorm: return Format{ GL_RGBA8_SNORM, GL_RGBA, GL_BYTE };
   case FG_PixelFormat_R8G8B8A8_Int: return Format{ GL_RGBA8I, GL_RGBA_INTEGER, GL_BYTE };
+  case FG_PixelFormat_R8G8B8A8_UNorm_SRGB: return Format{ GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE };
   case FG_PixelFormat_R8G8B8X8_Typeless: return Format{ sRGB ? GL_SRGB : GL_RGB, GL_RGB, GL_UNSIGNED_BYTE };
   case FG_PixelFormat_R8G8B8X8_UNorm: return Format{ sRGB ? GL_SRGB8 : GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE };
   case FG_PixelFormat_R8G8B8X8_SNorm: return Format{ GL_RGB8_SNORM, GL_RGB, GL_BYTE };
@@ -254,6 +255,156 @@ Format Format::Create(unsigned char format, bool sRGB) noexcept
   case FG_PixelFormat_R10G10B10_XR_BIAS_A2_UNorm: return Format{ 0, 0, 0 };
   case FG_PixelFormat_B8G8R8A8_Typeless: return Format{ GL_BGRA, GL_BGRA, GL_UNSIGNED_BYTE };
   case FG_PixelFormat_B8G8R8X8_Typeless: return Format{ GL_BGR, GL_BGR, GL_UNSIGNED_BYTE };
+  case FG_PixelFormat_B8G8R8A8_UNorm_SRGB: return Format{ GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE };
+  // Block compressed formats have no client pixel layout, so only the internal format is used.
+  case FG_PixelFormat_BC1_Typeless:
+  case FG_PixelFormat_BC1_UNorm:
+    return Format{ sRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0, 0 };
+  case FG_PixelFormat_BC1_UNorm_SRGB: return Format{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 0, 0 };
+  case FG_PixelFormat_BC2_Typeless:
+  case FG_PixelFormat_BC2_UNorm:
+    return Format{ sRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT : GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 0, 0 };
+  case FG_PixelFormat_BC2_UNorm_SRGB: return Format{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 0, 0 };
+  case FG_PixelFormat_BC3_Typeless:
+  case FG_PixelFormat_BC3_UNorm:
+    return Format{ sRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0 };
+  case FG_PixelFormat_BC3_UNorm_SRGB: return Format{ GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 0, 0 };
+  case FG_PixelFormat_BC4_Typeless:
+  case FG_PixelFormat_BC4_UNorm: return Format{ GL_COMPRESSED_RED_RGTC1, 0, 0 };
+  case FG_PixelFormat_BC4_SNorm: return Format{ GL_COMPRESSED_SIGNED_RED_RGTC1, 0, 0 };
+  case FG_PixelFormat_BC5_Typeless:
+  case FG_PixelFormat_BC5_UNorm: return Format{ GL_COMPRESSED_RG_RGTC2, 0, 0 };
+  case FG_PixelFormat_BC5_SNorm: return Format{ GL_COMPRESSED_SIGNED_RG_RGTC2, 0, 0 };
+  case FG_PixelFormat_BC6H_Typeless:
+  case FG_PixelFormat_BC6H_UF16: return Format{ GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB, 0, 0 };
+  case FG_PixelFormat_BC6H_SF16: return Format{ GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB, 0, 0 };
+  case FG_PixelFormat_BC7_Typeless:
+  case FG_PixelFormat_BC7_UNorm:
+    return Format{ sRGB ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB : GL_COMPRESSED_RGBA_BPTC_UNORM_ARB, 0, 0 };
+  case FG_PixelFormat_BC7_UNorm_SRGB: return Format{ GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB, 0, 0 };
   }
   return Format{ 0, 0, 0 };
 }
+
+int Format::block_bytes() const noexcept
+{
+  switch(internalformat)
+  {
+  case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RED_RGTC1:
+  case GL_COMPRESSED_SIGNED_RED_RGTC1: return 8;
+  case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+  case GL_COMPRESSED_RG_RGTC2:
+  case GL_COMPRESSED_SIGNED_RG_RGTC2:
+  case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+  case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB:
+  case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB:
+  case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB: return 16;
+  }
+  return 0;
+}
+
+size_t Format::image_bytes(FG_Vec2i size) const noexcept
+{
+  // Partial blocks at the edges of small mips still take up a whole block.
+  if(int block = block_bytes())
+    return size_t((size.x + 3) / 4) * ((size.y + 3) / 4) * block;
+  return size_t(size.x) * size.y * bytes();
+}
+
+GLint Format::sized() const noexcept
+{
+  // Unsized formats leave the precision up to the type, so only the combinations Create() actually produces are mapped.
+  switch(internalformat)
+  {
+  case GL_RGBA:
+  case GL_BGRA:
+    switch(type)
+    {
+    case GL_UNSIGNED_BYTE: return GL_RGBA8;
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+    case GL_UNSIGNED_SHORT_1_5_5_5_REV: return GL_RGB5_A1;
+    case GL_UNSIGNED_INT_2_10_10_10_REV: return GL_RGB10_A2;
+    case GL_FLOAT: return GL_RGBA32F;
+    }
+    return 0;
+  case GL_RGB:
+  case GL_BGR:
+    switch(type)
+    {
+    case GL_UNSIGNED_BYTE: return GL_RGB8;
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_5_6_5_REV: return GL_RGB565;
+    case GL_FLOAT: return GL_RGB32F;
+    }
+    return 0;
+  case GL_RG: return type == GL_UNSIGNED_BYTE ? GL_RG8 : 0;
+  case GL_RED: return type == GL_UNSIGNED_BYTE ? GL_R8 : (type == GL_FLOAT ? GL_R32F : 0);
+  case GL_SRGB_ALPHA: return GL_SRGB8_ALPHA8;
+  case GL_SRGB: return GL_SRGB8;
+  case GL_ALPHA:
+  case GL_ALPHA8:
+  case GL_LUMINANCE:
+  case GL_LUMINANCE_ALPHA: return 0; // Legacy formats can't be allocated immutably in a core profile
+  }
+  return internalformat;
+}
+
+int Format::bytes() const noexcept
+{
+  // Packed types already describe the whole pixel.
+  switch(type)
+  {
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_5_6_5_REV:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_4_4_4_4_REV: return 2;
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_10F_11F_11F_REV:
+  case GL_UNSIGNED_INT_5_9_9_9_REV:
+  case GL_UNSIGNED_INT_24_8: return 4;
+  case GL_FLOAT_32_UNSIGNED_INT_24_8_REV: return 8;
+  }
+
+  int size = 0;
+  switch(type)
+  {
+  case GL_BYTE:
+  case GL_UNSIGNED_BYTE: size = 1; break;
+  case GL_SHORT:
+  case GL_UNSIGNED_SHORT:
+  case GL_HALF_FLOAT: size = 2; break;
+  case GL_INT:
+  case GL_UNSIGNED_INT:
+  case GL_FLOAT: size = 4; break;
+  default: return 0;
+  }
+
+  switch(components)
+  {
+  case GL_RED:
+  case GL_RED_INTEGER:
+  case GL_ALPHA:
+  case GL_LUMINANCE:
+  case GL_DEPTH_COMPONENT: return size;
+  case GL_RG:
+  case GL_RG_INTEGER:
+  case GL_LUMINANCE_ALPHA:
+  case GL_DEPTH_STENCIL: return size * 2;
+  case GL_RGB:
+  case GL_BGR:
+  case GL_RGB_INTEGER: return size * 3;
+  case GL_RGBA:
+  case GL_BGRA:
+  case GL_RGBA_INTEGER: return size * 4;
+  }
+  return 0;
+}
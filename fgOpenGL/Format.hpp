@@ -16,6 +16,16 @@ namespace GL {
     GLenum components;
     GLenum type;
 
+    // Size of one pixel in client memory, or 0 if components and type don't describe one.
+    int bytes() const noexcept;
+    // Size of one 4x4 block of a block compressed format, or 0 if the format isn't compressed.
+    int block_bytes() const noexcept;
+    inline bool compressed() const noexcept { return block_bytes() != 0; }
+    // Size of a tightly packed size.x by size.y image, counting partial blocks as whole ones.
+    size_t image_bytes(FG_Vec2i size) const noexcept;
+    // The sized internal format glTexStorage2D needs, or 0 if an unsized format has no sized equivalent.
+    GLint sized() const noexcept;
+
     static Format Map(GLint internalformat) noexcept;
     static Format Create(unsigned char format, bool sRGB) noexcept;
   };
@@ -21,6 +21,12 @@ GLExpected<Owned<Framebuffer>> Framebuffer::create(GLenum target, GLenum type, i
   RETURN_ERROR(CALLGL(glGenFramebuffers, 1, &fbgl));
   Owned<Framebuffer> fb(fbgl);
 
+  // A framebuffer is as large as its first attachment.
+  ResourceInfo info = { target, 0, { 0, 0 }, 0 };
+  if(auto tex = n_textures > 0 ? ResourceTable::find(ResourceTable::type(textures[0]), textures[0]) : std::nullopt)
+    info.size = tex->size;
+  ResourceTable::insert(REF_FRAMEBUFFER, fbgl, info);
+
   RETURN_ERROR(fb->attach(target, type, level, zoffset, textures, n_textures));
   return fb;
 }
@@ -45,6 +51,10 @@ GLExpected<void> Framebuffer::attach(GLenum target, GLenum type, int level, int
         RETURN_ERROR(CALLGL(glFramebufferTexture1D, target, GL_COLOR_ATTACHMENT0 + this->_numberOfColorAttachments,
                             GL_TEXTURE_1D, texture, level));
         break;
+      case GL_TEXTURE_2D_MULTISAMPLE:
+        RETURN_ERROR(CALLGL(glFramebufferTexture2D, target, GL_COLOR_ATTACHMENT0 + this->_numberOfColorAttachments,
+                            GL_TEXTURE_2D_MULTISAMPLE, texture, 0));
+        break;
       case GL_TEXTURE_3D:
         RETURN_ERROR(CALLGL(glFramebufferTexture3D, target, GL_COLOR_ATTACHMENT0 + this->_numberOfColorAttachments,
                             GL_TEXTURE_3D, texture, level, zoffset));
@@ -9,7 +9,10 @@
 namespace GL {
   struct Framebuffer : Ref
   {
-    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) { glDeleteFramebuffers(1, &i); };
+    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) {
+      ResourceTable::erase(REF_FRAMEBUFFER, i);
+      glDeleteFramebuffers(1, &i);
+    };
 
     explicit constexpr Framebuffer(GLuint buffer) noexcept : Ref(buffer), _numberOfColorAttachments(0) {}
     explicit constexpr Framebuffer(FG_Resource buffer) noexcept :
@@ -27,12 +30,9 @@ namespace GL {
     GLExpected<BindRef> bind(GLenum target) const noexcept;
 
     Framebuffer& operator=(const Framebuffer&) = default;
-    inline operator FG_Resource() const noexcept { return _ref | REF_FRAMEBUFFER; }
+    inline operator FG_Resource() const noexcept { return ResourceTable::handle(REF_FRAMEBUFFER, _ref); }
 
-    static bool validate(FG_Resource res) noexcept
-    {
-      return ((res & REF_FRAMEBUFFER) != 0) && (glIsFramebuffer(static_cast<GLuint>(res & REF_MASK)) == GL_TRUE);
-    }
+    static bool validate(FG_Resource res) noexcept { return ResourceTable::validate(REF_FRAMEBUFFER, res); }
     // This does not take ownership of the texture
     static GLExpected<Owned<Framebuffer>> create(GLenum target, GLenum type, int level, int zoffset, FG_Resource* textures,
                                                  uint32_t n_textures) noexcept;
@@ -0,0 +1,114 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "FrameTimer.hpp"
+#include <iterator>
+
+using namespace GL;
+
+FrameTimer::~FrameTimer()
+{
+  for(auto& frame : _frames)
+    if(frame.queries[0])
+      glDeleteQueries(static_cast<GLsizei>(std::size(frame.queries)), frame.queries);
+}
+
+GLExpected<void> FrameTimer::begin()
+{
+  if(!glQueryCounter)
+    return {};
+
+  auto& frame = _frames[_current];
+  if(!frame.queries[0])
+  {
+    RETURN_ERROR(CALLGL(glGenQueries, static_cast<GLsizei>(std::size(frame.queries)), frame.queries));
+  }
+  else if(frame.pending)
+  {
+    RETURN_ERROR(_resolve(frame));
+  }
+
+  frame.regions = 0;
+  frame.pending = false;
+  _stack.clear();
+  _active = true;
+  return CALLGL(glQueryCounter, frame.queries[0], GL_TIMESTAMP);
+}
+
+GLExpected<void> FrameTimer::end()
+{
+  if(!_active)
+    return {};
+
+  while(!_stack.empty())
+  {
+    RETURN_ERROR(pop());
+  }
+
+  auto& frame = _frames[_current];
+  _active     = false;
+  _current    = (_current + 1) % FRAMES;
+  RETURN_ERROR(CALLGL(glQueryCounter, frame.queries[1], GL_TIMESTAMP));
+  frame.pending = true;
+  return {};
+}
+
+GLExpected<void> FrameTimer::push(const char* name)
+{
+  if(!_active)
+    return {};
+
+  auto& frame = _frames[_current];
+  if(frame.regions >= MAX_REGIONS)
+  {
+    _stack.push_back(~0U);
+    return {};
+  }
+
+  auto index         = frame.regions++;
+  frame.names[index] = name;
+  _stack.push_back(index);
+  return CALLGL(glQueryCounter, frame.queries[2 + index * 2], GL_TIMESTAMP);
+}
+
+GLExpected<void> FrameTimer::pop()
+{
+  if(!_active || _stack.empty())
+    return {};
+
+  auto index = _stack.back();
+  _stack.pop_back();
+  if(index == ~0U)
+    return {};
+  return CALLGL(glQueryCounter, _frames[_current].queries[3 + index * 2], GL_TIMESTAMP);
+}
+
+GLExpected<void> FrameTimer::_resolve(Frame& frame)
+{
+  frame.pending = false;
+
+  // Queries finish in order, so once the last one is available all of them are. If it isn't, this frame's results are
+  // dropped rather than waited on.
+  GLint available = GL_FALSE;
+  RETURN_ERROR(CALLGL(glGetQueryObjectiv, frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available));
+  if(!available)
+    return {};
+
+  GLuint64 begin = 0, end = 0;
+  RETURN_ERROR(CALLGL(glGetQueryObjectui64v, frame.queries[0], GL_QUERY_RESULT, &begin));
+  RETURN_ERROR(CALLGL(glGetQueryObjectui64v, frame.queries[1], GL_QUERY_RESULT, &end));
+  _gputime = end - begin;
+
+  // The frame stats handed out at EndDraw still point at the front results, so the new ones go into the back buffer,
+  // which nothing has seen since the frame before.
+  auto& results = _results[_front ^ 1];
+  results.resize(frame.regions);
+  for(uint32_t i = 0; i < frame.regions; ++i)
+  {
+    RETURN_ERROR(CALLGL(glGetQueryObjectui64v, frame.queries[2 + i * 2], GL_QUERY_RESULT, &begin));
+    RETURN_ERROR(CALLGL(glGetQueryObjectui64v, frame.queries[3 + i * 2], GL_QUERY_RESULT, &end));
+    results[i] = { frame.names[i], end - begin };
+  }
+  _front ^= 1;
+  return {};
+}
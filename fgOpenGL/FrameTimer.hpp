@@ -0,0 +1,58 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__FRAME_TIMER_H
+#define GL__FRAME_TIMER_H
+
+#include "GLError.hpp"
+#include "feather/graphics_interface.h"
+#include <vector>
+#include <span>
+
+namespace GL {
+  // Measures how long the GPU spends on each frame, and on named regions inside of it, with GL_TIMESTAMP queries.
+  // Every frame gets its own set of queries and results are only read back FRAMES frames later, once the driver says
+  // they are available, so measuring never stalls the pipeline. Does nothing if timer queries aren't supported.
+  struct FrameTimer
+  {
+    FrameTimer() noexcept : _current(0), _active(false), _gputime(0), _front(0), _frames{} {}
+    ~FrameTimer();
+    FrameTimer(const FrameTimer&)            = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+
+    GLExpected<void> begin();
+    GLExpected<void> end();
+    // name is only referenced, so it must outlive the results it shows up in. Regions can be nested.
+    GLExpected<void> push(const char* name);
+    GLExpected<void> pop();
+
+    // Results of the most recent frame the GPU has finished, which lags behind the frames being recorded. The regions
+    // stay where they are until the second begin() after this, so they outlive the frame that reported them.
+    inline uint64_t gpu_time() const noexcept { return _gputime; }
+    inline std::span<const FG_TimingRegion> regions() const noexcept { return _results[_front]; }
+
+    static constexpr int FRAMES      = 3;
+    static constexpr int MAX_REGIONS = 64;
+
+  protected:
+    struct Frame
+    {
+      GLuint queries[2 + MAX_REGIONS * 2]; // Frame begin and end, followed by the begin and end of each region
+      const char* names[MAX_REGIONS];
+      uint32_t regions;
+      bool pending; // Queries were issued but haven't been read back yet
+    };
+
+    GLExpected<void> _resolve(Frame& frame);
+
+    int _current;
+    bool _active;
+    uint64_t _gputime;
+    std::vector<uint32_t> _stack; // Open regions, or ~0U for regions that didn't fit
+    std::vector<FG_TimingRegion> _results[2]; // Double buffered, so resolving a frame doesn't move the last one
+    int _front;
+    Frame _frames[FRAMES];
+  };
+}
+
+#endif
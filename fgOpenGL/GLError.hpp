@@ -18,6 +18,13 @@
     return __e;                                                             \
   }
 
+// Polls glGetError() once if the current ErrorCheckLevel asks for it at this granularity, instead of after every call.
+#define GL_CHECKPOINT(level, name)                                                 \
+  if(GLError __e{ level, name, __FILE__, __LINE__ }; __e.has_error()) [[unlikely]] \
+  {                                                                                \
+    return __e;                                                                    \
+  }
+
 #define CUSTOM_ERROR(error, name) GLError(error, name, __FILE__, __LINE__)
 #define CALLGL(fn, ...)                                                                                            \
   CallGL(fn, "" #fn,                                                                                               \
@@ -59,10 +66,34 @@ namespace GL {
     ERR_INVALID_ENUM,
     ERR_INVALID_REF,
     ERR_INVALID_SHADER_INDEX,
+    ERR_TIMEOUT,
+    ERR_ATLAS_FULL,
+    ERR_INVALID_FILE,
   };
 
   class Provider;
 
+  // Controls how often glGetError() is polled. Each poll is a synchronous round trip into the driver, so release builds
+  // default to checking once per executed command list and rely on the KHR_debug callback for the details. Matches
+  // FG_ErrorCheck.
+  enum class ErrorCheck : uint8_t
+  {
+    ERRORCHECK_ALWAYS = 0,     // Poll after every OpenGL call
+    ERRORCHECK_COMMAND_LIST,   // Poll once after each command list is executed
+    ERRORCHECK_DEBUG_CALLBACK, // Never poll, only report what glDebugMessageCallback gives us
+    ERRORCHECK_OFF,
+  };
+
+#ifdef _DEBUG
+  inline constexpr ErrorCheck DEFAULT_ERRORCHECK = ErrorCheck::ERRORCHECK_ALWAYS;
+#else
+  inline constexpr ErrorCheck DEFAULT_ERRORCHECK = ErrorCheck::ERRORCHECK_COMMAND_LIST;
+#endif
+
+  // The level of the provider whose context is current on this thread, since that's the context every OpenGL call
+  // goes to. Each Provider keeps its own level and puts it here whenever it loads or makes current one of its contexts.
+  inline thread_local ErrorCheck ErrorCheckLevel = DEFAULT_ERRORCHECK;
+
   // Wrapper around an openGL error code and source, with a debug checker that ensures the error was handled.
   class GLError
   {
@@ -87,10 +118,14 @@ namespace GL {
     }
 
     explicit GLError(const char* callsite, const char* file, unsigned int line) noexcept :
+      GLError(ErrorCheck::ERRORCHECK_ALWAYS, callsite, file, line)
+    {}
+    // Only calls glGetError() if ErrorCheckLevel is at least as strict as level, otherwise reports no error.
+    explicit GLError(ErrorCheck level, const char* callsite, const char* file, unsigned int line) noexcept :
 #ifdef _DEBUG
-      _error(glGetError() | UNCHECKED_FLAG),
+      _error((ErrorCheckLevel <= level ? glGetError() : GL_NO_ERROR) | UNCHECKED_FLAG),
 #else
-      _error(glGetError()),
+      _error(ErrorCheckLevel <= level ? glGetError() : GL_NO_ERROR),
 #endif
       _callsite(callsite),
       _file(file),
@@ -0,0 +1,258 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ProviderGL.hpp"
+#include "Headless.hpp"
+#include "Format.hpp"
+#include <cstring>
+#include <mutex>
+
+#ifdef FG_PLATFORM_POSIX
+  #include <dlfcn.h>
+#endif
+
+using namespace GL;
+
+namespace {
+  // Only the handful of EGL declarations we use, so building doesn't need the EGL headers.
+  typedef void* EGLDisplay;
+  typedef void* EGLContext;
+  typedef void* EGLSurface;
+  typedef void* EGLConfig;
+  typedef int32_t EGLint;
+  typedef unsigned int EGLBoolean;
+  typedef unsigned int EGLenum;
+
+  constexpr EGLint EGL_NONE                       = 0x3038;
+  constexpr EGLint EGL_EXTENSIONS                 = 0x3055;
+  constexpr EGLint EGL_SURFACE_TYPE               = 0x3033;
+  constexpr EGLint EGL_PBUFFER_BIT                = 0x0001;
+  constexpr EGLint EGL_RENDERABLE_TYPE            = 0x3040;
+  constexpr EGLint EGL_OPENGL_BIT                 = 0x0008;
+  constexpr EGLint EGL_WIDTH                      = 0x3057;
+  constexpr EGLint EGL_HEIGHT                     = 0x3056;
+  constexpr EGLint EGL_CONTEXT_MAJOR_VERSION      = 0x3098;
+  constexpr EGLint EGL_CONTEXT_MINOR_VERSION      = 0x30FB;
+  constexpr EGLenum EGL_OPENGL_API                = 0x30A2;
+  constexpr EGLenum EGL_PLATFORM_SURFACELESS_MESA = 0x31DD;
+
+  struct EGL
+  {
+    void* (*GetProcAddress)(const char*);
+    EGLDisplay (*GetDisplay)(void*);
+    EGLDisplay (*GetPlatformDisplayEXT)(EGLenum, void*, const EGLint*);
+    const char* (*QueryString)(EGLDisplay, EGLint);
+    EGLBoolean (*Initialize)(EGLDisplay, EGLint*, EGLint*);
+    EGLBoolean (*Terminate)(EGLDisplay);
+    EGLBoolean (*BindAPI)(EGLenum);
+    EGLBoolean (*ChooseConfig)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+    EGLContext (*CreateContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+    EGLBoolean (*DestroyContext)(EGLDisplay, EGLContext);
+    EGLSurface (*CreatePbufferSurface)(EGLDisplay, EGLConfig, const EGLint*);
+    EGLBoolean (*DestroySurface)(EGLDisplay, EGLSurface);
+    EGLBoolean (*MakeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+    EGLint (*GetError)();
+
+    void* library;
+    EGLDisplay display; // Shared by every headless context, because terminating it would destroy all of them
+    int refs;
+  };
+
+  EGL egl = { 0 };
+  std::mutex egllock;
+
+  bool HasExtension(const char* extensions, const char* name)
+  {
+    const size_t len = strlen(name);
+    for(auto s = extensions; s && (s = strstr(s, name)) != nullptr; s += len)
+    {
+      if((s == extensions || s[-1] == ' ') && (s[len] == ' ' || s[len] == 0))
+        return true;
+    }
+    return false;
+  }
+
+  bool LoadEGL()
+  {
+    if(egl.library)
+      return true;
+#ifdef FG_PLATFORM_POSIX
+    egl.library = dlopen("libEGL.so.1", RTLD_NOW);
+    if(!egl.library)
+      egl.library = dlopen("libEGL.so", RTLD_NOW);
+    if(!egl.library)
+      return false;
+
+    egl.GetProcAddress = reinterpret_cast<decltype(egl.GetProcAddress)>(dlsym(egl.library, "eglGetProcAddress"));
+    if(!egl.GetProcAddress)
+    {
+      dlclose(egl.library);
+      egl.library = nullptr;
+      return false;
+    }
+
+  #define LOAD_EGL(name) egl.name = reinterpret_cast<decltype(egl.name)>(egl.GetProcAddress("egl" #name))
+    LOAD_EGL(GetDisplay);
+    LOAD_EGL(GetPlatformDisplayEXT);
+    LOAD_EGL(QueryString);
+    LOAD_EGL(Initialize);
+    LOAD_EGL(Terminate);
+    LOAD_EGL(BindAPI);
+    LOAD_EGL(ChooseConfig);
+    LOAD_EGL(CreateContext);
+    LOAD_EGL(DestroyContext);
+    LOAD_EGL(CreatePbufferSurface);
+    LOAD_EGL(DestroySurface);
+    LOAD_EGL(MakeCurrent);
+    LOAD_EGL(GetError);
+  #undef LOAD_EGL
+    return egl.GetDisplay && egl.QueryString && egl.Initialize && egl.Terminate && egl.BindAPI && egl.ChooseConfig &&
+           egl.CreateContext && egl.DestroyContext && egl.CreatePbufferSurface && egl.DestroySurface && egl.MakeCurrent &&
+           egl.GetError;
+#else
+    // Windows has no EGL to fall back on, and WGL can't create a context without at least a hidden window.
+    return false;
+#endif
+  }
+
+  EGLDisplay AcquireDisplay()
+  {
+    std::lock_guard<std::mutex> guard(egllock);
+    if(!LoadEGL())
+      return nullptr;
+    if(egl.refs++ > 0)
+      return egl.display;
+
+    // The surfaceless platform works without any display server, otherwise the default display has to do.
+    auto client = egl.QueryString(nullptr, EGL_EXTENSIONS);
+    if(egl.GetPlatformDisplayEXT && HasExtension(client, "EGL_MESA_platform_surfaceless"))
+      egl.display = egl.GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+    if(!egl.display)
+      egl.display = egl.GetDisplay(nullptr);
+    if(egl.display && !egl.Initialize(egl.display, nullptr, nullptr))
+      egl.display = nullptr;
+    if(!egl.display)
+      --egl.refs;
+    return egl.display;
+  }
+
+  void ReleaseDisplay()
+  {
+    std::lock_guard<std::mutex> guard(egllock);
+    if(--egl.refs == 0)
+    {
+      egl.Terminate(egl.display);
+      egl.display = nullptr;
+    }
+  }
+
+  void* LoadProc(const char* name) { return egl.GetProcAddress(name); }
+}
+
+Headless::Headless() noexcept :
+  _backend(nullptr), _display(nullptr), _context(nullptr), _surface(nullptr), _format(GL_RGBA8), _framebuffer(0), _color(0),
+  _depthstencil(0)
+{}
+
+Headless::~Headless()
+{
+  if(!_display)
+    return;
+
+  if(_context && egl.MakeCurrent(_display, _surface, _surface, _context))
+  {
+    glDeleteFramebuffers(1, &_framebuffer);
+    glDeleteRenderbuffers(1, &_color);
+    glDeleteRenderbuffers(1, &_depthstencil);
+  }
+  egl.MakeCurrent(_display, nullptr, nullptr, nullptr);
+  if(_surface)
+    egl.DestroySurface(_display, _surface);
+  if(_context)
+    egl.DestroyContext(_display, _context);
+  ReleaseDisplay();
+}
+
+bool Headless::supported() noexcept
+{
+  std::lock_guard<std::mutex> guard(egllock);
+  return LoadEGL();
+}
+
+GLExpected<std::unique_ptr<Headless>> Headless::create(Provider* backend, FG_Vec2i size, FG_PixelFormat backbuffer)
+{
+  std::unique_ptr<Headless> headless(new Headless());
+  headless->_backend = backend;
+  headless->_display = AcquireDisplay();
+  if(!headless->_display)
+    return CUSTOM_ERROR(ERR_NOT_IMPLEMENTED, "Headless contexts need libEGL");
+
+  // The same version WindowGL asks GLFW for, so headless contexts run exactly what windows do.
+  const EGLint configattribs[]  = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+  const EGLint contextattribs[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3, EGL_NONE };
+  const EGLint pbufferattribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+  EGLConfig config;
+  EGLint count = 0;
+
+  if(!egl.BindAPI(EGL_OPENGL_API))
+    return CUSTOM_ERROR(egl.GetError(), "eglBindAPI");
+  if(!egl.ChooseConfig(headless->_display, configattribs, &config, 1, &count) || count < 1)
+    return CUSTOM_ERROR(egl.GetError(), "eglChooseConfig");
+  headless->_context = egl.CreateContext(headless->_display, config, nullptr, contextattribs);
+  if(!headless->_context)
+    return CUSTOM_ERROR(egl.GetError(), "eglCreateContext");
+
+  // Without EGL_KHR_surfaceless_context, a context can only be made current with a surface, even if it never draws to
+  // it, so a 1x1 pbuffer takes its place.
+  if(!HasExtension(egl.QueryString(headless->_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+  {
+    headless->_surface = egl.CreatePbufferSurface(headless->_display, config, pbufferattribs);
+    if(!headless->_surface)
+      return CUSTOM_ERROR(egl.GetError(), "eglCreatePbufferSurface");
+  }
+
+  RETURN_ERROR(headless->makeCurrent());
+  // The entry points are global, so LoadGL takes the provider lock, and leaves them alone if EGL gave us the same
+  // driver the windows already loaded.
+  if(backend->LoadGL(&LoadProc) != ERR_SUCCESS)
+    return CUSTOM_ERROR(ERR_MISSING_OPENGL_FUNCTION, "Failed to load OpenGL for a headless context");
+
+  if(auto format = Format::Create(backbuffer, false).sized())
+    headless->_format = format;
+  RETURN_ERROR(CALLGL(glGenFramebuffers, 1, &headless->_framebuffer));
+  RETURN_ERROR(CALLGL(glGenRenderbuffers, 1, &headless->_color));
+  RETURN_ERROR(CALLGL(glGenRenderbuffers, 1, &headless->_depthstencil));
+  RETURN_ERROR(headless->resize(size));
+  return headless;
+}
+
+GLExpected<void> Headless::makeCurrent() const
+{
+  if(!egl.MakeCurrent(_display, _surface, _surface, _context))
+    return CUSTOM_ERROR(egl.GetError(), "eglMakeCurrent");
+  if(_backend)
+    ErrorCheckLevel = _backend->GetErrorCheck();
+  return {};
+}
+
+GLExpected<void> Headless::resize(FG_Vec2i size)
+{
+  RETURN_ERROR(CALLGL(glBindRenderbuffer, GL_RENDERBUFFER, _color));
+  RETURN_ERROR(CALLGL(glRenderbufferStorage, GL_RENDERBUFFER, _format, size.x, size.y));
+  RETURN_ERROR(CALLGL(glBindRenderbuffer, GL_RENDERBUFFER, _depthstencil));
+  RETURN_ERROR(CALLGL(glRenderbufferStorage, GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y));
+  RETURN_ERROR(CALLGL(glBindRenderbuffer, GL_RENDERBUFFER, 0));
+
+  RETURN_ERROR(CALLGL(glBindFramebuffer, GL_FRAMEBUFFER, _framebuffer));
+  RETURN_ERROR(CALLGL(glFramebufferRenderbuffer, GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _color));
+  RETURN_ERROR(
+    CALLGL(glFramebufferRenderbuffer, GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthstencil));
+  auto status = CALLGL(glCheckFramebufferStatus, GL_FRAMEBUFFER);
+  if(status.has_error())
+    return std::move(status.error());
+  if(status.value() != GL_FRAMEBUFFER_COMPLETE)
+    return CUSTOM_ERROR(status.value(), "glCheckFramebufferStatus");
+
+  // Nothing sets up the viewport of a context made current without a window, so it starts out empty.
+  return CALLGL(glViewport, 0, 0, size.x, size.y);
+}
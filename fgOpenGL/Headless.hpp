@@ -0,0 +1,47 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__HEADLESS_H
+#define GL__HEADLESS_H
+
+#include "GLError.hpp"
+#include "feather/graphics_interface.h"
+#include <memory>
+
+namespace GL {
+  class Provider;
+
+  // An OpenGL context without a window, for rendering on machines that have no display server. The context comes from
+  // EGL, on a surfaceless display if the driver has one, and draws into its own framebuffer, which stands in for the
+  // default framebuffer of a window. libEGL is only loaded once the first one is created, so nothing links against it.
+  // Every headless context is independent, so a process can have as many as it has threads to make them current on.
+  struct Headless
+  {
+    ~Headless();
+    Headless(const Headless&)            = delete;
+    Headless& operator=(const Headless&) = delete;
+
+    // Creates the context, leaves it current and loads the GL entry points from it.
+    static GLExpected<std::unique_ptr<Headless>> create(Provider* backend, FG_Vec2i size, FG_PixelFormat backbuffer);
+    static bool supported() noexcept;
+    GLExpected<void> makeCurrent() const;
+    // Reallocates the backbuffer, which discards whatever was drawn to it. Has to be called with the context current.
+    GLExpected<void> resize(FG_Vec2i size);
+    inline GLuint framebuffer() const noexcept { return _framebuffer; }
+    inline Provider* backend() const noexcept { return _backend; }
+
+  protected:
+    Headless() noexcept;
+
+    Provider* _backend; // Errors that happen without a caller to return them to, like on destruction, are logged here
+    void* _display;
+    void* _context;
+    void* _surface; // Only used if the driver can't make a context current without one
+    GLint _format;
+    GLuint _framebuffer;
+    GLuint _color;
+    GLuint _depthstencil;
+  };
+}
+
+#endif
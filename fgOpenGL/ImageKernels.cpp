@@ -0,0 +1,315 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ImageKernels.hpp"
+#include <cmath>
+
+#if defined(BSS_CPU_x86_64) || defined(BSS_CPU_x86)
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+    #define FG_TARGET_AVX2
+  #else
+    #define FG_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+  #if defined(BSS_CPU_x86_64) || defined(__SSE2__)
+    #define FG_KERNELS_SSE2
+  #endif
+  #define FG_KERNELS_AVX2
+#endif
+
+using namespace GL;
+
+namespace {
+  constexpr int ENCODE_SIZE = 4096; // Enough steps that dark values still round to the right byte
+
+  struct Tables
+  {
+    // [0, 256) decodes sRGB bytes to linear floats, [256, 512) maps bytes to [0, 1] unchanged, which is what alpha uses,
+    // so a single gather with an offset on the alpha lane can load a whole pixel.
+    float decode[512];
+    uint8_t encode[ENCODE_SIZE]; // Linear values quantized to ENCODE_SIZE steps, back to sRGB bytes
+  };
+
+  const Tables& GetTables() noexcept
+  {
+    static const Tables tables = [] {
+      Tables t;
+      for(int i = 0; i < 256; ++i)
+      {
+        float c           = i / 255.0f;
+        t.decode[i]       = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        t.decode[256 + i] = c;
+      }
+      for(int i = 0; i < ENCODE_SIZE; ++i)
+      {
+        float c     = i / float(ENCODE_SIZE - 1);
+        float s     = (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+        t.encode[i] = static_cast<uint8_t>(s * 255.0f + 0.5f);
+      }
+      return t;
+    }();
+    return tables;
+  }
+
+  inline uint8_t Encode(const Tables& t, float linear) noexcept
+  {
+    int i = static_cast<int>(linear * (ENCODE_SIZE - 1) + 0.5f);
+    return t.encode[i < 0 ? 0 : (i >= ENCODE_SIZE ? ENCODE_SIZE - 1 : i)];
+  }
+
+  // Exact round(c * a / 255) without a division.
+  inline uint8_t MulAlpha(uint8_t c, uint8_t a) noexcept
+  {
+    uint32_t x = c * a + 128;
+    return static_cast<uint8_t>((x + (x >> 8)) >> 8);
+  }
+
+  void PremultiplyScalar(uint8_t* p, size_t count) noexcept
+  {
+    for(size_t i = 0; i < count; ++i, p += 4)
+    {
+      p[0] = MulAlpha(p[0], p[3]);
+      p[1] = MulAlpha(p[1], p[3]);
+      p[2] = MulAlpha(p[2], p[3]);
+    }
+  }
+
+  void PremultiplySRGBScalar(uint8_t* p, size_t count) noexcept
+  {
+    auto& t = GetTables();
+    for(size_t i = 0; i < count; ++i, p += 4)
+    {
+      float a = t.decode[256 + p[3]];
+      p[0]    = Encode(t, t.decode[p[0]] * a);
+      p[1]    = Encode(t, t.decode[p[1]] * a);
+      p[2]    = Encode(t, t.decode[p[2]] * a);
+    }
+  }
+
+  // Filters the 2x2 block starting at x in rows r0 and r1, where x1 is the second column, which is x again at an odd edge.
+  inline void BoxScalar(const uint8_t* r0, const uint8_t* r1, int x0, int x1, uint8_t* dst) noexcept
+  {
+    for(int c = 0; c < 4; ++c)
+      dst[c] = static_cast<uint8_t>((r0[x0 * 4 + c] + r0[x1 * 4 + c] + r1[x0 * 4 + c] + r1[x1 * 4 + c] + 2) >> 2);
+  }
+
+  inline void BoxSRGBScalar(const Tables& t, const uint8_t* r0, const uint8_t* r1, int x0, int x1, uint8_t* dst) noexcept
+  {
+    for(int c = 0; c < 3; ++c)
+    {
+      float sum = t.decode[r0[x0 * 4 + c]] + t.decode[r0[x1 * 4 + c]] + t.decode[r1[x0 * 4 + c]] + t.decode[r1[x1 * 4 + c]];
+      dst[c]    = Encode(t, sum * 0.25f);
+    }
+    dst[3] = static_cast<uint8_t>((r0[x0 * 4 + 3] + r0[x1 * 4 + 3] + r1[x0 * 4 + 3] + r1[x1 * 4 + 3] + 2) >> 2);
+  }
+
+  // Every SIMD path filters the bulk of a row and leaves the odd pixels at the end to this, which starts at dst column x.
+  template<bool SRGB>
+  inline void BoxRowScalar(const uint8_t* r0, const uint8_t* r1, int x, int width, int dstwidth, uint8_t* dst) noexcept
+  {
+    auto& t = GetTables();
+    for(; x < dstwidth; ++x)
+    {
+      int x0 = x * 2;
+      int x1 = (x0 + 1 < width) ? x0 + 1 : width - 1;
+      if constexpr(SRGB)
+        BoxSRGBScalar(t, r0, r1, x0, x1, dst + x * 4);
+      else
+        BoxScalar(r0, r1, x0, x1, dst + x * 4);
+    }
+  }
+
+#ifdef FG_KERNELS_SSE2
+  void PremultiplySSE2(uint8_t* p, size_t count) noexcept
+  {
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i color  = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+    const __m128i opaque = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    const __m128i half   = _mm_set1_epi16(128);
+
+    auto mul = [&](__m128i v) {
+      // Broadcast each pixel's alpha over its channels, but multiply alpha itself by 255 so it survives unchanged.
+      __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xFF), 0xFF);
+      a         = _mm_or_si128(_mm_and_si128(a, color), opaque);
+      __m128i x = _mm_add_epi16(_mm_mullo_epi16(v, a), half);
+      return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4, p += 16)
+    {
+      __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i lo = mul(_mm_unpacklo_epi8(v, zero));
+      __m128i hi = mul(_mm_unpackhi_epi8(v, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(lo, hi));
+    }
+    PremultiplyScalar(p, count - i);
+  }
+
+  void DownsampleSSE2(const uint8_t* r0, const uint8_t* r1, int width, int dstwidth, uint8_t* dst) noexcept
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two  = _mm_set1_epi16(2);
+
+    // Each step reads 4 source pixels from both rows and writes 2, so it stops before it would read past the row.
+    int x = 0;
+    for(; x + 2 <= dstwidth && x * 2 + 4 <= width; x += 2)
+    {
+      __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x * 8));
+      __m128i bot = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x * 8));
+      __m128i lo  = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bot, zero)); // pixels 0, 1
+      __m128i hi  = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bot, zero)); // pixels 2, 3
+      __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+      sum         = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(sum, zero));
+    }
+    BoxRowScalar<false>(r0, r1, x, width, dstwidth, dst);
+  }
+#endif
+
+#ifdef FG_KERNELS_AVX2
+  // Decodes the two pixels in the low 8 bytes of bytes. Lambdas don't inherit the target attribute, so this can't be one.
+  FG_TARGET_AVX2 inline __m256 GatherAVX2(const Tables& t, __m128i bytes, __m256i offset) noexcept
+  {
+    return _mm256_i32gather_ps(t.decode, _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), offset), 4);
+  }
+
+  FG_TARGET_AVX2 void PremultiplySRGBAVX2(uint8_t* p, size_t count) noexcept
+  {
+    auto& t              = GetTables();
+    const __m256i offset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+    const __m256 scale   = _mm256_setr_ps(ENCODE_SIZE - 1, ENCODE_SIZE - 1, ENCODE_SIZE - 1, 255.0f, ENCODE_SIZE - 1,
+                                        ENCODE_SIZE - 1, ENCODE_SIZE - 1, 255.0f);
+    alignas(32) int32_t out[8];
+
+    // Two pixels per gather. The table lookups afterwards are still scalar, AVX2 has no byte gather.
+    size_t i = 0;
+    for(; i + 2 <= count; i += 2, p += 8)
+    {
+      __m256 v = GatherAVX2(t, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), offset);
+      __m256 a = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+      v        = _mm256_blend_ps(_mm256_mul_ps(v, a), v, 0x88);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtps_epi32(_mm256_mul_ps(v, scale)));
+
+      p[0] = t.encode[out[0]];
+      p[1] = t.encode[out[1]];
+      p[2] = t.encode[out[2]];
+      p[4] = t.encode[out[4]];
+      p[5] = t.encode[out[5]];
+      p[6] = t.encode[out[6]];
+    }
+    PremultiplySRGBScalar(p, count - i);
+  }
+
+  FG_TARGET_AVX2 void DownsampleSRGBAVX2(const uint8_t* r0, const uint8_t* r1, int width, int dstwidth,
+                                         uint8_t* dst) noexcept
+  {
+    auto& t              = GetTables();
+    const __m256i offset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+    const __m256 scale   = _mm256_setr_ps(0.25f * (ENCODE_SIZE - 1), 0.25f * (ENCODE_SIZE - 1), 0.25f * (ENCODE_SIZE - 1),
+                                        0.25f * 255.0f, 0.25f * (ENCODE_SIZE - 1), 0.25f * (ENCODE_SIZE - 1),
+                                        0.25f * (ENCODE_SIZE - 1), 0.25f * 255.0f);
+    // Splits 4 pixels into the first and second pixel of each 2x2 block.
+    const __m128i split = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15);
+    alignas(32) int32_t out[8];
+
+    int x = 0;
+    for(; x + 2 <= dstwidth && x * 2 + 4 <= width; x += 2)
+    {
+      __m128i top = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x * 8)), split);
+      __m128i bot = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x * 8)), split);
+      __m256 sum  = _mm256_add_ps(GatherAVX2(t, top, offset), GatherAVX2(t, _mm_unpackhi_epi64(top, top), offset));
+      sum         = _mm256_add_ps(sum, GatherAVX2(t, bot, offset));
+      sum         = _mm256_add_ps(sum, GatherAVX2(t, _mm_unpackhi_epi64(bot, bot), offset));
+      _mm256_store_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtps_epi32(_mm256_mul_ps(sum, scale)));
+
+      uint8_t* d = dst + x * 4;
+      d[0]       = t.encode[out[0]];
+      d[1]       = t.encode[out[1]];
+      d[2]       = t.encode[out[2]];
+      d[3]       = static_cast<uint8_t>(out[3]);
+      d[4]       = t.encode[out[4]];
+      d[5]       = t.encode[out[5]];
+      d[6]       = t.encode[out[6]];
+      d[7]       = static_cast<uint8_t>(out[7]);
+    }
+    BoxRowScalar<true>(r0, r1, x, width, dstwidth, dst);
+  }
+
+  bool HasAVX2() noexcept
+  {
+  #ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+      return false;
+    __cpuid(info, 1);
+    // The OS also has to save the upper halves of the YMM registers on context switches.
+    if(!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+      return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+  #else
+    return __builtin_cpu_supports("avx2");
+  #endif
+  }
+#endif
+
+  bool UseAVX2() noexcept
+  {
+#ifdef FG_KERNELS_AVX2
+    static const bool avx2 = HasAVX2();
+    return avx2;
+#else
+    return false;
+#endif
+  }
+}
+
+void ImageKernels::Premultiply(uint8_t* pixels, size_t count, bool srgb) noexcept
+{
+#ifdef FG_KERNELS_AVX2
+  if(srgb && UseAVX2())
+    return PremultiplySRGBAVX2(pixels, count);
+#endif
+  if(srgb)
+    return PremultiplySRGBScalar(pixels, count);
+#ifdef FG_KERNELS_SSE2
+  PremultiplySSE2(pixels, count);
+#else
+  PremultiplyScalar(pixels, count);
+#endif
+}
+
+void ImageKernels::Downsample(const uint8_t* src, int width, int height, uint8_t* dst, bool srgb) noexcept
+{
+  const FG_Vec2i size = MipSize(FG_Vec2i{ width, height }, 1);
+  const bool avx2     = srgb && UseAVX2();
+
+  for(int y = 0; y < size.y; ++y)
+  {
+    // Odd edges reuse the last row or column instead of reading past the image.
+    const uint8_t* r0 = src + size_t(y * 2) * width * 4;
+    const uint8_t* r1 = (y * 2 + 1 < height) ? r0 + size_t(width) * 4 : r0;
+    uint8_t* row      = dst + size_t(y) * size.x * 4;
+
+#ifdef FG_KERNELS_AVX2
+    if(avx2)
+    {
+      DownsampleSRGBAVX2(r0, r1, width, size.x, row);
+      continue;
+    }
+#endif
+    if(srgb)
+      BoxRowScalar<true>(r0, r1, 0, width, size.x, row);
+    else
+    {
+#ifdef FG_KERNELS_SSE2
+      DownsampleSSE2(r0, r1, width, size.x, row);
+#else
+      BoxRowScalar<false>(r0, r1, 0, width, size.x, row);
+#endif
+    }
+  }
+}
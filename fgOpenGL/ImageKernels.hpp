@@ -0,0 +1,38 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__IMAGE_KERNELS_H
+#define GL__IMAGE_KERNELS_H
+
+#include "feather/compiler.h"
+#include "feather/graphics_interface.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace GL {
+  // CPU preprocessing of 8-bit, 4 channel images before they are uploaded. Alpha has to be the last channel, the order
+  // of the other three doesn't matter. sRGB images are blended in linear space, using lookup tables for the transfer
+  // function instead of powf. Uses AVX2 or SSE2 if the CPU supports them, and plain C++ otherwise.
+  struct ImageKernels
+  {
+    // Multiplies the color channels of count pixels by their alpha, in place.
+    static void Premultiply(uint8_t* pixels, size_t count, bool srgb) noexcept;
+    // Box filters a width x height image into the next mip level, which is MipSize(size, 1) pixels large.
+    static void Downsample(const uint8_t* src, int width, int height, uint8_t* dst, bool srgb) noexcept;
+
+    static inline FG_Vec2i MipSize(FG_Vec2i size, int level) noexcept
+    {
+      return FG_Vec2i{ (size.x >> level) > 0 ? (size.x >> level) : 1, (size.y >> level) > 0 ? (size.y >> level) : 1 };
+    }
+    // Number of levels in a full mip chain, down to and including 1x1.
+    static inline int MipLevels(FG_Vec2i size) noexcept
+    {
+      int levels = 1;
+      while((size.x >> levels) > 0 || (size.y >> levels) > 0)
+        ++levels;
+      return levels;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,211 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "PipelineCache.hpp"
+#include "khash.h"
+#include <cstring>
+
+namespace GL {
+  inline khint_t EntryHash(const PipelineCache::Entry* e) noexcept
+  {
+    return static_cast<khint_t>(e->hash >> 32 ^ e->hash);
+  }
+  inline bool EntryEqual(const PipelineCache::Entry* a, const PipelineCache::Entry* b) noexcept
+  {
+    return a->hash == b->hash && a->key == b->key;
+  }
+
+  KHASH_INIT(pipelinekeys, PipelineCache::Entry*, char, 0, EntryHash, EntryEqual)
+  KHASH_MAP_INIT_INT64(pipelinestates, PipelineCache::Entry*)
+}
+
+using namespace GL;
+
+namespace {
+  template<class T> inline void Append(std::string& key, const T& value)
+  {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  inline uint64_t Hash(const std::string& key) noexcept
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for(auto c : key)
+      hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    return hash;
+  }
+
+  inline khint64_t StateKey(PipelineState* state) noexcept
+  {
+    return static_cast<khint64_t>(reinterpret_cast<uintptr_t>(state));
+  }
+}
+
+PipelineCache::PipelineCache() noexcept : _bykey(kh_init(pipelinekeys)), _bystate(kh_init(pipelinestates)) {}
+
+PipelineCache::~PipelineCache()
+{
+  // Pipelines still belong to whoever created them, only the bookkeeping is freed here.
+  Entry* e;
+  kh_foreach_value(_bystate, e, delete e);
+  kh_destroy(pipelinekeys, _bykey);
+  kh_destroy(pipelinestates, _bystate);
+}
+
+std::string PipelineCache::key(const FG_Context* context, const FG_PipelineState& state, FG_Resource rendertarget, const FG_Blend& blend,
+                               std::span<FG_Resource> vertexbuffers, const GLsizei* strides,
+                               std::span<FG_VertexParameter> attributes, FG_Resource indexbuffer, uint8_t indexstride)
+{
+  // Fields are appended one by one so padding never ends up in the key.
+  std::string key;
+  key.reserve(256);
+  Append(key, context);
+  Append(key, state.members);
+  Append(key, state.shaders);
+  Append(key, state.blendFactor.v);
+  Append(key, state.flags);
+  Append(key, state.sampleMask);
+  Append(key, state.stencilRef);
+  Append(key, state.stencilReadMask);
+  Append(key, state.stencilWriteMask);
+  Append(key, state.stencilFailOp);
+  Append(key, state.stencilDepthFailOp);
+  Append(key, state.stencilPassOp);
+  Append(key, state.stencilFunc);
+  Append(key, state.depthFunc);
+  Append(key, state.fillMode);
+  Append(key, state.cullMode);
+  Append(key, state.primitive);
+  Append(key, state.depthBias);
+  Append(key, state.slopeScaledDepthBias);
+  Append(key, state.nodeMask);
+
+  Append(key, rendertarget);
+  Append(key, blend.src_blend);
+  Append(key, blend.dest_blend);
+  Append(key, blend.blend_op);
+  Append(key, blend.src_blend_alpha);
+  Append(key, blend.dest_blend_alpha);
+  Append(key, blend.blend_op_alpha);
+  Append(key, blend.rendertarget_write_mask);
+
+  Append(key, vertexbuffers.size());
+  for(size_t i = 0; i < vertexbuffers.size(); ++i)
+  {
+    Append(key, vertexbuffers[i]);
+    Append(key, strides[i]);
+  }
+
+  Append(key, attributes.size());
+  for(auto& attribute : attributes)
+  {
+    Append(key, attribute.offset);
+    Append(key, attribute.step);
+    Append(key, attribute.length);
+    Append(key, attribute.type);
+    Append(key, attribute.index);
+    Append(key, attribute.per_instance);
+    // The terminator keeps "ab" + "c" from matching "a" + "bc".
+    key.append(attribute.name ? attribute.name : "");
+    key.push_back(0);
+  }
+
+  Append(key, indexbuffer);
+  Append(key, indexstride);
+  return key;
+}
+
+PipelineState* PipelineCache::acquire(const std::string& key) noexcept
+{
+  Entry probe;
+  probe.key  = key;
+  probe.hash = Hash(key);
+
+  auto k = kh_get(pipelinekeys, _bykey, &probe);
+  if(k == kh_end(_bykey))
+    return nullptr;
+
+  auto e = kh_key(_bykey, k);
+  ++e->refs;
+  return e->state;
+}
+
+void PipelineCache::insert(std::string&& key, const FG_Context* context, const FG_PipelineState& desc,
+                           PipelineState* state)
+{
+  auto e = new Entry{ std::move(key), 0, {}, context, state, 1, true };
+  e->hash = Hash(e->key);
+  memcpy(e->shaders, desc.shaders, sizeof(e->shaders));
+
+  int r;
+  auto k = kh_put(pipelinestates, _bystate, StateKey(state), &r);
+  if(r < 0)
+  {
+    // Untracked pipelines are simply deleted by the first destroyPipelineState, like before there was a cache.
+    delete e;
+    return;
+  }
+  kh_val(_bystate, k) = e;
+
+  kh_put(pipelinekeys, _bykey, e, &r);
+  if(r < 0)
+    e->cached = false;
+}
+
+bool PipelineCache::release(PipelineState* state) noexcept
+{
+  auto k = kh_get(pipelinestates, _bystate, StateKey(state));
+  if(k == kh_end(_bystate))
+    return true;
+
+  auto e = kh_val(_bystate, k);
+  if(--e->refs > 0)
+    return false;
+
+  kh_del(pipelinestates, _bystate, k);
+  if(e->cached)
+  {
+    if(auto i = kh_get(pipelinekeys, _bykey, e); i != kh_end(_bykey))
+      kh_del(pipelinekeys, _bykey, i);
+  }
+  delete e;
+  return true;
+}
+
+void PipelineCache::evict(FG_Shader shader) noexcept
+{
+  if(!shader)
+    return;
+
+  // Deleting from a khash table only marks the bucket, so it's safe to do while walking it.
+  for(khint_t k = kh_begin(_bykey); k != kh_end(_bykey); ++k)
+  {
+    if(!kh_exist(_bykey, k))
+      continue;
+
+    auto e = kh_key(_bykey, k);
+    for(auto s : e->shaders)
+    {
+      if(s == shader)
+      {
+        e->cached = false;
+        kh_del(pipelinekeys, _bykey, k);
+        break;
+      }
+    }
+  }
+}
+
+void PipelineCache::evict(const FG_Context* context) noexcept
+{
+  for(khint_t k = kh_begin(_bykey); k != kh_end(_bykey); ++k)
+  {
+    if(kh_exist(_bykey, k) && kh_key(_bykey, k)->context == context)
+    {
+      kh_key(_bykey, k)->cached = false;
+      kh_del(pipelinekeys, _bykey, k);
+    }
+  }
+}
+
+size_t PipelineCache::size() const noexcept { return kh_size(_bystate); }
@@ -0,0 +1,65 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__PIPELINE_CACHE_H
+#define GL__PIPELINE_CACHE_H
+
+#include "feather/graphics_interface.h"
+#include "glad/glad.h"
+#include <span>
+#include <string>
+
+namespace GL {
+  struct PipelineState;
+  struct kh_pipelinekeys_s;
+  struct kh_pipelinestates_s;
+
+  // Hash-conses graphics pipelines on everything createPipelineState was given, so asking for a pipeline identical to
+  // a live one hands back the same object instead of linking another program and building another VAO. Entries are
+  // reference counted, and a pipeline is only deleted once every createPipelineState that returned it has been matched
+  // by a destroyPipelineState. Shader handles are GL names that can be reused, so destroying a shader stops any
+  // pipeline built from it from being handed out again, without affecting the ones already in use. Pipelines hold VAOs
+  // and framebuffers, which contexts never share, so each context only ever gets back the pipelines it created.
+  class PipelineCache
+  {
+  public:
+    PipelineCache() noexcept;
+    ~PipelineCache();
+    PipelineCache(const PipelineCache&)            = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    // Serializes a pipeline description into a cache key. Attribute names are compared by content, not by pointer.
+    static std::string key(const FG_Context* context, const FG_PipelineState& state, FG_Resource rendertarget, const FG_Blend& blend,
+                           std::span<FG_Resource> vertexbuffers, const GLsizei* strides,
+                           std::span<FG_VertexParameter> attributes, FG_Resource indexbuffer, uint8_t indexstride);
+    // Returns the pipeline matching key with one more reference, or nullptr if there isn't one.
+    PipelineState* acquire(const std::string& key) noexcept;
+    // Starts tracking a newly created pipeline with a single reference.
+    void insert(std::string&& key, const FG_Context* context, const FG_PipelineState& desc, PipelineState* state);
+    // Drops a reference and returns true if state now has to be deleted. Pipelines the cache doesn't know about, like
+    // ones that were created while the cache couldn't grow, always have to be deleted.
+    bool release(PipelineState* state) noexcept;
+    // Stops handing out pipelines that were built from shader.
+    void evict(FG_Shader shader) noexcept;
+    // Stops handing out pipelines that were created on context, since its address can be given to a new one.
+    void evict(const FG_Context* context) noexcept;
+    size_t size() const noexcept;
+
+    struct Entry
+    {
+      std::string key;
+      uint64_t hash;
+      FG_Shader shaders[FG_ShaderStage_Count];
+      const FG_Context* context;
+      PipelineState* state;
+      uint32_t refs;
+      bool cached; // False once evicted, when it can only be found by state
+    };
+
+  protected:
+    kh_pipelinekeys_s* _bykey;
+    kh_pipelinestates_s* _bystate;
+  };
+}
+
+#endif
@@ -5,16 +5,61 @@
 #include "ShaderObject.hpp"
 #include "ProviderGL.hpp"
 #include "EnumMapping.hpp"
+#include "VertexLayoutCache.hpp"
+#include <algorithm>
 #include <cassert>
-#include <malloc.h> // for _alloca on windows
 #include <unordered_set>
 
 using namespace GL;
 
+namespace {
+  GLExpected<bool> IsLinked(const ProgramObject& program) noexcept
+  {
+    GLint done = GL_FALSE;
+    RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_COMPLETION_STATUS_KHR, &done));
+    return done == GL_TRUE;
+  }
+
+  // Background compiles never report errors from CompileShader, so a failed link also logs every shader that didn't
+  // compile.
+  GLExpected<void> FinishLink(const ProgramObject& program, UniformTable& uniforms, DeferredLink& deferred) noexcept
+  {
+    GLint status = GL_FALSE;
+    RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_LINK_STATUS, &status));
+    if(status == GL_FALSE)
+    {
+      GLint count = 0;
+      GLuint shaders[FG_ShaderStage_Count];
+      RETURN_ERROR(CALLGL(glGetAttachedShaders, program, FG_ShaderStage_Count, &count, shaders));
+      for(GLint i = 0; i < count; ++i)
+      {
+        GLint compiled = GL_FALSE;
+        RETURN_ERROR(CALLGL(glGetShaderiv, shaders[i], GL_COMPILE_STATUS, &compiled));
+        if(compiled == GL_FALSE)
+        {
+          if(auto e = ShaderObject(shaders[i]).log())
+            CUSTOM_ERROR(ERR_COMPILATION_FAILURE, e.value().c_str()).log(deferred.backend);
+        }
+      }
+
+      if(auto e = program.log())
+        CUSTOM_ERROR(ERR_COMPILATION_FAILURE, e.value().c_str()).log(deferred.backend);
+      return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "glLinkProgram");
+    }
+
+    RETURN_ERROR(deferred.backend->FinishProgram(program, deferred.cachekey));
+    if(deferred.backend->GetErrorCheck() == ErrorCheck::ERRORCHECK_ALWAYS)
+    {
+      RETURN_ERROR(program.validate());
+    }
+    return uniforms.reflect(program);
+  }
+}
+
 GLExpected<PipelineState*> PipelineState::create(const FG_PipelineState& state, FG_Resource rendertarget, FG_Blend blend,
                                                  std::span<FG_Resource> vertexbuffers, GLsizei* strides,
                                                  std::span<FG_VertexParameter> attributes, FG_Resource indexbuffer,
-                                                 uint8_t indexstride) noexcept
+                                                 uint8_t indexstride, Provider* backend) noexcept
 {
   PipelineState* pipeline = new PipelineState{};
 
@@ -29,24 +74,34 @@ GLExpected<PipelineState*> PipelineState::create(const FG_PipelineState& state,
     if(shader != Provider::NULL_SHADER)
       RETURN_ERROR(pipeline->program.attach(ShaderObject(shader)));
   }
-  RETURN_ERROR(pipeline->program.link());
 
-  auto vlist = std::span(reinterpret_cast<std::pair<GLuint, GLsizei>*>(
-                           malloc(sizeof(std::pair<GLuint, GLsizei>) * vertexbuffers.size())),
-                         vertexbuffers.size());
+  std::vector<std::pair<GLuint, GLsizei>> vlist;
+  vlist.reserve(vertexbuffers.size());
+  for(size_t i = 0; i < vertexbuffers.size(); ++i)
+    vlist.push_back({ Buffer(vertexbuffers[i]), strides[i] });
 
-  for(size_t i = 0; i < vlist.size(); ++i)
+  if(backend->IsAsyncCompile())
   {
-    // Have to be careful to use placement new here to avoid UB due to alloca
-    new(&vlist[i]) std::pair<GLuint, GLsizei>{ Buffer(vertexbuffers[i]), strides[i] };
-  }
+    // Reflecting uniforms and looking up attributes would both wait for the link, so they're put off until finish().
+    pipeline->deferred = std::make_unique<DeferredLink>(DeferredLink{
+      backend, 0, { attributes.begin(), attributes.end() }, {}, std::move(vlist), Buffer(indexbuffer) });
 
-  if(auto e = VertexArrayObject::create(pipeline->program, attributes, vlist, Buffer(indexbuffer)))
-  {
-    pipeline->vao = std::move(e.value());
+    auto& deferred = *pipeline->deferred;
+    deferred.names.reserve(attributes.size());
+    for(auto& attribute : deferred.attributes)
+    {
+      deferred.names.push_back(attribute.name ? attribute.name : "");
+      attribute.name = deferred.names.back().c_str();
+    }
+
+    RETURN_ERROR(backend->LinkProgram(pipeline->program, &deferred.cachekey));
   }
   else
-    return std::move(e.error());
+  {
+    RETURN_ERROR(backend->LinkProgram(pipeline->program));
+    RETURN_ERROR(pipeline->uniforms.reflect(pipeline->program));
+    RETURN_ERROR(pipeline->_build(attributes, vlist, Buffer(indexbuffer)));
+  }
 
   pipeline->Members = state.members;
   pipeline->rt      = Framebuffer(rendertarget);
@@ -126,20 +181,132 @@ GLExpected<PipelineState*> PipelineState::create(const FG_PipelineState& state,
   return pipeline;
 }
 
+GLExpected<void> PipelineState::_build(std::span<FG_VertexParameter> attributes,
+                                       std::span<std::pair<GLuint, GLsizei>> buffers, GLuint indices) noexcept
+{
+  if(VertexLayoutCache::supported() && buffers.size() <= VertexLayoutCache::BINDINGS)
+  {
+    VertexLayout l;
+    l.divisors.resize(buffers.size(), ~0U);
+    bool shareable = true;
+    for(auto& param : attributes)
+    {
+      if(param.index >= buffers.size())
+        return CUSTOM_ERROR(ERR_INVALID_SHADER_INDEX, "Shader parameter index exceeds buffer count");
+      if(param.type >= ArraySize(ShaderTypeMapping))
+        return CUSTOM_ERROR(ERR_INVALID_ENUM, "param.type is not valid shader type");
+
+      auto loc = CALLGL(glGetAttribLocation, program, param.name);
+      if(loc.has_error())
+        return std::move(loc.error());
+      if(loc.value() < 0)
+        continue; // Attributes the shader doesn't use are optimized out of the program
+
+      // Divisors belong to bindings, so attributes sharing a buffer at different rates need a VAO of their own.
+      if(l.divisors[param.index] != ~0U && l.divisors[param.index] != param.step)
+        shareable = false;
+      l.divisors[param.index] = param.step;
+      l.formats.push_back(VertexFormat{ static_cast<GLuint>(loc.value()), param.length, ShaderTypeMapping[param.type],
+                                        param.offset, param.index });
+    }
+
+    if(shareable)
+    {
+      // Sorting makes layouts that only list their attributes in a different order share a VAO.
+      std::sort(l.formats.begin(), l.formats.end(),
+                [](const VertexFormat& a, const VertexFormat& b) { return a.location < b.location; });
+      for(auto& d : l.divisors)
+        if(d == ~0U)
+          d = 0;
+
+      layout = std::move(l);
+      bindings.clear();
+      for(auto [buffer, stride] : buffers)
+        bindings.push_back(VertexBinding{ buffer, 0, stride });
+      this->indices = indices;
+      separate      = true;
+      return {};
+    }
+  }
+
+  if(auto e = VertexArrayObject::create(program, attributes, buffers, indices))
+    vao = std::move(e.value());
+  else
+    return std::move(e.error());
+  return {};
+}
+
+GLExpected<bool> PipelineState::is_ready() noexcept
+{
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(!deferred)
+    return true;
+  if(auto e = IsLinked(program); e.has_error())
+    return std::move(e.error());
+  else if(!e.value())
+    return false;
+  RETURN_ERROR(finish());
+  return true;
+}
+
+GLExpected<void> PipelineState::finish() noexcept
+{
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(!deferred)
+    return {};
+
+  // A link that failed once fails every time, so its errors are only reported to the first caller.
+  auto e = FinishLink(program, uniforms, *deferred);
+  if(!e.has_error())
+    e = _build(deferred->attributes, deferred->buffers, deferred->indices);
+  deferred.reset();
+  if(e.has_error())
+  {
+    failed = true;
+    return std::move(e.error());
+  }
+  return {};
+}
+
 GLExpected<std::string> PipelineState::log() const noexcept { return program.log(); }
 
 GLExpected<void> PipelineState::apply(Context* ctx) noexcept
 {
-  if(program.is_valid())
+  // Using a pipeline before it's ready is allowed, it just stalls until the driver is done with it.
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(deferred)
   {
-    RETURN_ERROR(ctx->ApplyProgram(program));
+    RETURN_ERROR(finish());
   }
-  RETURN_ERROR(vao.bind());
 
-  if(auto e = rt.bind(GL_FRAMEBUFFER))
-    e.value().release();
+  // Every Apply* call below compares against the Context's shadow state, so only what differs reaches the driver.
+  if(!program.empty())
+  {
+    RETURN_ERROR(ctx->ApplyProgram(program, &uniforms));
+  }
+  if(separate)
+  {
+    if(sharedctx != ctx)
+    {
+      auto e = ctx->FindVertexLayout(layout);
+      if(e.has_error())
+        return std::move(e.error());
+      shared    = e.value();
+      sharedctx = ctx;
+    }
+
+    RETURN_ERROR(ctx->ApplyVertexArray(*shared));
+    RETURN_ERROR(ctx->ApplyVertexBuffers(bindings));
+    RETURN_ERROR(ctx->ApplyIndexBuffer(indices));
+  }
   else
-    return std::move(e.error());
+  {
+    RETURN_ERROR(ctx->ApplyVertexArray(vao));
+  }
+  RETURN_ERROR(ctx->ApplyFramebuffer(rt));
 
   if(Members & FG_Pipeline_Member_Blend_Factor)
   {
@@ -168,41 +335,28 @@ GLExpected<void> PipelineState::apply(Context* ctx) noexcept
 
   if(Members & FG_Pipeline_Member_Depth_Func)
   {
-    RETURN_ERROR(CALLGL(glDepthFunc, DepthFunc));
+    RETURN_ERROR(ctx->ApplyDepthFunc(DepthFunc));
   }
   if(Members & FG_Pipeline_Member_Stencil_OP)
   {
-    RETURN_ERROR(CALLGL(glStencilOp, StencilFailOp, StencilDepthFailOp, StencilPassOp));
+    RETURN_ERROR(ctx->ApplyStencilOp(StencilFailOp, StencilDepthFailOp, StencilPassOp));
   }
   if(Members & FG_Pipeline_Member_Stencil_Write_Mask)
   {
-    RETURN_ERROR(CALLGL(glStencilMask, StencilWriteMask));
+    RETURN_ERROR(ctx->ApplyStencilMask(StencilWriteMask));
   }
-  if(Members & (FG_Pipeline_Member_Stencil_Read_Mask || FG_Pipeline_Member_Stencil_Func || FG_Pipeline_Member_Stencil_Ref))
+  if(Members & (FG_Pipeline_Member_Stencil_Read_Mask | FG_Pipeline_Member_Stencil_Func | FG_Pipeline_Member_Stencil_Ref))
   {
-    GLint func = StencilFunc;
-    GLint ref  = StencilRef;
-    GLint mask = StencilReadMask;
-
-    if(!(Members & FG_Pipeline_Member_Stencil_Read_Mask))
-    {
-      RETURN_ERROR(CALLGL(glGetIntegerv, GL_STENCIL_VALUE_MASK, &mask));
-    }
-    if(!(Members & FG_Pipeline_Member_Stencil_Func))
-    {
-      RETURN_ERROR(CALLGL(glGetIntegerv, GL_STENCIL_FUNC, &func));
-    }
-    if(!(Members & FG_Pipeline_Member_Stencil_Ref))
-    {
-      RETURN_ERROR(CALLGL(glGetIntegerv, GL_STENCIL_REF, &ref));
-    }
-
-    RETURN_ERROR(CALLGL(glStencilFunc, func, ref, mask));
+    // glStencilFunc sets all three at once, so anything this pipeline doesn't specify keeps its current value.
+    auto& last = ctx->LastStencil();
+    RETURN_ERROR(ctx->ApplyStencilFunc((Members & FG_Pipeline_Member_Stencil_Func) ? StencilFunc : last.func,
+                                       (Members & FG_Pipeline_Member_Stencil_Ref) ? StencilRef : last.ref,
+                                       (Members & FG_Pipeline_Member_Stencil_Read_Mask) ? StencilReadMask : last.readmask));
   }
 
   if(Members & FG_Pipeline_Member_Depth_Slope_Bias)
   {
-    RETURN_ERROR(CALLGL(glPolygonOffset, SlopeScaledDepthBias, DepthBias));
+    RETURN_ERROR(ctx->ApplyDepthBias(SlopeScaledDepthBias, static_cast<float>(DepthBias)));
   }
   return {};
 }
@@ -214,7 +368,7 @@ GLExpected<void> PipelineState::current(Context* ctx) noexcept
 }
 
 GLExpected<ComputePipelineState*> ComputePipelineState::create(FG_Shader computeshader, FG_Vec3i workgroup,
-                                                               uint32_t flags) noexcept
+                                                               uint32_t flags, Provider* backend) noexcept
 {
   if(!computeshader)
     return CUSTOM_ERROR(ERR_INVALID_COMPUTE_SHADER, "Cannot create compute pipeline without compute shader!");
@@ -227,17 +381,66 @@ GLExpected<ComputePipelineState*> ComputePipelineState::create(FG_Shader compute
     return std::move(e.error());
 
   RETURN_ERROR(pipeline->program.attach(ShaderObject(computeshader)));
-  RETURN_ERROR(pipeline->program.link());
+
+  if(backend->IsAsyncCompile())
+  {
+    pipeline->deferred = std::make_unique<DeferredLink>(DeferredLink{ backend, 0 });
+    RETURN_ERROR(backend->LinkProgram(pipeline->program, &pipeline->deferred->cachekey));
+  }
+  else
+  {
+    RETURN_ERROR(backend->LinkProgram(pipeline->program));
+    RETURN_ERROR(pipeline->uniforms.reflect(pipeline->program));
+  }
 
   return pipeline;
 }
 
+GLExpected<bool> ComputePipelineState::is_ready() noexcept
+{
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(!deferred)
+    return true;
+  if(auto e = IsLinked(program); e.has_error())
+    return std::move(e.error());
+  else if(!e.value())
+    return false;
+  RETURN_ERROR(finish());
+  return true;
+}
+
+GLExpected<void> ComputePipelineState::finish() noexcept
+{
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(!deferred)
+    return {};
+
+  // A link that failed once fails every time, so its errors are only reported to the first caller.
+  auto e = FinishLink(program, uniforms, *deferred);
+  deferred.reset();
+  if(e.has_error())
+  {
+    failed = true;
+    return std::move(e.error());
+  }
+  return {};
+}
+
 GLExpected<std::string> ComputePipelineState::log() const noexcept { return program.log(); }
 
 GLExpected<void> ComputePipelineState::apply(Context* ctx) noexcept
 {
+  if(failed)
+    return CUSTOM_ERROR(ERR_COMPILATION_FAILURE, "Pipeline failed to link");
+  if(deferred)
+  {
+    RETURN_ERROR(finish());
+  }
+
   ctx->ApplyWorkGroup(workgroup);
-  RETURN_ERROR(ctx->ApplyProgram(program));
+  RETURN_ERROR(ctx->ApplyProgram(program, &uniforms));
 
   return {};
 }
@@ -12,25 +12,41 @@
 #include <string>
 #include <span>
 #include <array>
+#include <vector>
+#include <memory>
 
 namespace GL {
   struct Context;
+  class Provider;
+
+  // Everything a pipeline still has to do once the driver has finished compiling and linking its program in the
+  // background. Attribute names are copied, because the caller's only have to live until createPipelineState returns.
+  struct DeferredLink
+  {
+    Provider* backend;
+    uint64_t cachekey; // Passed to Provider::FinishProgram once linking completes
+    std::vector<FG_VertexParameter> attributes;
+    std::vector<std::string> names;
+    std::vector<std::pair<GLuint, GLsizei>> buffers;
+    GLuint indices;
+  };
 
   struct PipelineState
   {
     // This mostly inherits the standard backend pipeline state, but translates things into OpenGL equivalents
     uint64_t Members;
     Owned<ProgramObject> program;
+    UniformTable uniforms;
     std::array<float, 4> BlendFactor;
     uint32_t SampleMask;
     GLint StencilRef;
     uint8_t StencilReadMask;
     uint8_t StencilWriteMask;
-    uint8_t StencilFailOp;
-    uint8_t StencilDepthFailOp;
-    uint8_t StencilPassOp;
-    uint8_t StencilFunc;
-    uint8_t DepthFunc;
+    uint16_t StencilFailOp;
+    uint16_t StencilDepthFailOp;
+    uint16_t StencilPassOp;
+    uint16_t StencilFunc;
+    uint16_t DepthFunc;
     uint8_t FillMode;
     uint8_t CullMode;
     uint8_t Primitive;
@@ -40,10 +56,22 @@ namespace GL {
     float SlopeScaledDepthBias;
     uint32_t ForcedSampleCount;
     FG_Blend blend;
-    VertexArrayObject vao;
+    VertexArrayObject vao; // Only used if the vertex layout couldn't be shared
+    VertexLayout layout;
+    std::vector<VertexBinding> bindings;
+    GLuint indices            = 0;
+    bool separate             = false;   // True if layout is drawn through a VAO shared with other pipelines
+    VertexArrayObject* shared = nullptr; // Cached lookup of layout in the cache of sharedctx
+    const Context* sharedctx  = nullptr;
     Framebuffer rt;
+    std::unique_ptr<DeferredLink> deferred; // Only set while the program is still compiling in the background
+    bool failed = false;                    // The background link failed, which was already reported once
 
     GLExpected<void> apply(Context* ctx) noexcept;
+    // Never blocks, returns false while the program is still compiling in the background.
+    GLExpected<bool> is_ready() noexcept;
+    // Waits for a background compile to finish, then does everything create() had to put off until then.
+    GLExpected<void> finish() noexcept;
     GLExpected<std::string> log() const noexcept;
     GLExpected<void> current(Context* ctx) noexcept;
 
@@ -55,9 +83,12 @@ namespace GL {
     static GLExpected<PipelineState*> create(const FG_PipelineState& state, FG_Resource rendertarget, FG_Blend blend,
                                              std::span<FG_Resource> vertexbuffers, GLsizei* strides,
                                              std::span<FG_VertexParameter> attributes, FG_Resource indexbuffer,
-                                             uint8_t indexstride) noexcept;
+                                             uint8_t indexstride, Provider* backend) noexcept;
 
   private:
+    GLExpected<void> _build(std::span<FG_VertexParameter> attributes, std::span<std::pair<GLuint, GLsizei>> buffers,
+                            GLuint indices) noexcept;
+
 #pragma warning(push)
 #pragma warning(disable : 26495)
     PipelineState() {}
@@ -71,10 +102,16 @@ namespace GL {
     FG_Vec3i workgroup;
     uint32_t flags;
     ProgramObject program;
+    UniformTable uniforms;
+    std::unique_ptr<DeferredLink> deferred;
+    bool failed = false;
 
-    static GLExpected<ComputePipelineState*> create(FG_Shader computeshader, FG_Vec3i workgroup, uint32_t flags) noexcept;
+    static GLExpected<ComputePipelineState*> create(FG_Shader computeshader, FG_Vec3i workgroup, uint32_t flags,
+                                                    Provider* backend) noexcept;
     GLExpected<void> apply(Context* ctx) noexcept;
     GLExpected<std::string> log() const noexcept;
+    GLExpected<bool> is_ready() noexcept;
+    GLExpected<void> finish() noexcept;
   };
 }
 
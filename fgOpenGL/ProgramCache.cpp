@@ -0,0 +1,243 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ProgramCache.hpp"
+#include "ProviderGL.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+using namespace GL;
+
+namespace {
+  // 64-bit FNV-1a, which is plenty to tell a few hundred programs apart and doesn't need any dependencies.
+  constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+  constexpr uint64_t FNV_PRIME  = 1099511628211ULL;
+
+  uint64_t Hash(uint64_t hash, const void* data, size_t bytes) noexcept
+  {
+    auto p = reinterpret_cast<const unsigned char*>(data);
+    for(size_t i = 0; i < bytes; ++i)
+      hash = (hash ^ p[i]) * FNV_PRIME;
+    return hash;
+  }
+
+  uint64_t HashString(uint64_t hash, GLenum name) noexcept
+  {
+    auto s = reinterpret_cast<const char*>(glGetString(name));
+    // Hashing the terminator keeps "ab" + "c" from colliding with "a" + "bc".
+    return s ? Hash(hash, s, strlen(s) + 1) : Hash(hash, "", 1);
+  }
+}
+
+bool ProgramCache::set_directory(const char* directory)
+{
+  _directory.clear();
+  if(!directory || !directory[0])
+    return true;
+
+  std::error_code err;
+  std::filesystem::create_directories(directory, err);
+  if(err)
+    return false;
+
+  _directory = directory;
+  return true;
+}
+
+GLExpected<void> ProgramCache::link(ProgramObject& program, Provider* backend, uint64_t* deferred) noexcept
+{
+  // Validation checks the program against whatever state happens to be bound, so it's only worth doing while debugging.
+  // It also waits for the link to finish, which would defeat the point of deferring it.
+  const bool validate = backend->GetErrorCheck() == ErrorCheck::ERRORCHECK_ALWAYS && !deferred;
+  if(deferred)
+    *deferred = 0;
+
+  if(!enabled())
+    return program.link(validate);
+
+  if(!_driver)
+  {
+    RETURN_ERROR(_loadDriver());
+  }
+
+  auto key = _key(program);
+  if(key.has_error())
+    return std::move(key.error());
+
+  if(auto loaded = _load(program, key.value()); loaded.has_error())
+    return std::move(loaded.error());
+  else if(loaded.value())
+    return validate ? program.validate() : GLExpected<void>{};
+
+  // The hint has to be set before linking, otherwise the driver may not keep the binary around.
+  RETURN_ERROR(CALLGL(glProgramParameteri, program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+  RETURN_ERROR(program.link(validate));
+
+  if(deferred)
+  {
+    *deferred = key.value();
+    return {};
+  }
+  return finish(program, key.value(), backend);
+}
+
+GLExpected<void> ProgramCache::finish(const ProgramObject& program, uint64_t key, Provider* backend) noexcept
+{
+  if(!key)
+    return {};
+
+  GLint status = GL_FALSE;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_LINK_STATUS, &status));
+  if(status == GL_TRUE)
+  {
+    RETURN_ERROR(_store(program, key, backend));
+  }
+
+  return {};
+}
+
+GLExpected<void> ProgramCache::_loadDriver() noexcept
+{
+  GLint count = 0;
+  RETURN_ERROR(CALLGL(glGetIntegerv, GL_NUM_PROGRAM_BINARY_FORMATS, &count));
+  _formats.resize(count);
+  if(count > 0)
+  {
+    RETURN_ERROR(CALLGL(glGetIntegerv, GL_PROGRAM_BINARY_FORMATS, _formats.data()));
+  }
+
+  // A binary is only valid for the exact driver that produced it, so any driver update has to invalidate the cache.
+  uint64_t hash = Hash(FNV_OFFSET, &MAGIC, sizeof(MAGIC));
+  hash          = HashString(hash, GL_VENDOR);
+  hash          = HashString(hash, GL_RENDERER);
+  hash          = HashString(hash, GL_VERSION);
+  hash          = HashString(hash, GL_SHADING_LANGUAGE_VERSION);
+  GL_ERROR("glGetString");
+  _driver = hash ? hash : 1;
+  return {};
+}
+
+GLExpected<uint64_t> ProgramCache::_key(const ProgramObject& program) noexcept
+{
+  GLint count = 0;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_ATTACHED_SHADERS, &count));
+
+  std::vector<GLuint> shaders(count);
+  if(count > 0)
+  {
+    RETURN_ERROR(CALLGL(glGetAttachedShaders, program, count, &count, shaders.data()));
+  }
+
+  // glGetAttachedShaders doesn't promise any order, so sort by stage to get the same key for the same stage set.
+  std::vector<std::pair<GLint, GLuint>> stages;
+  stages.reserve(count);
+  for(GLint i = 0; i < count; ++i)
+  {
+    GLint type = 0;
+    RETURN_ERROR(CALLGL(glGetShaderiv, shaders[i], GL_SHADER_TYPE, &type));
+    stages.push_back({ type, shaders[i] });
+  }
+  std::sort(stages.begin(), stages.end());
+
+  uint64_t hash = _driver;
+  std::string source;
+  for(auto [type, shader] : stages)
+  {
+    GLint len = 0;
+    RETURN_ERROR(CALLGL(glGetShaderiv, shader, GL_SHADER_SOURCE_LENGTH, &len)); // this includes the null terminator
+    source.resize(len);
+    if(len > 0)
+    {
+      RETURN_ERROR(CALLGL(glGetShaderSource, shader, len, &len, source.data()));
+    }
+
+    hash = Hash(hash, &type, sizeof(type));
+    hash = Hash(hash, &len, sizeof(len));
+    hash = Hash(hash, source.data(), len);
+  }
+
+  return hash;
+}
+
+std::string ProgramCache::_path(uint64_t key) const
+{
+  char name[24];
+  snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  return (std::filesystem::path(_directory) / name).string();
+}
+
+GLExpected<bool> ProgramCache::_load(ProgramObject& program, uint64_t key) noexcept
+{
+  FILE* f = fopen(_path(key).c_str(), "rb");
+  if(!f)
+    return false;
+
+  Header header;
+  std::vector<std::byte> binary;
+  bool valid = fread(&header, sizeof(header), 1, f) == 1 && header.magic == MAGIC && header.key == key &&
+               std::find(_formats.begin(), _formats.end(), static_cast<GLint>(header.format)) != _formats.end();
+  // A truncated or corrupted header could claim any length, so it has to fit in what's left of the file before anything
+  // is allocated for it.
+  if(valid)
+  {
+    const long start = ftell(f);
+    const long end   = (start >= 0 && fseek(f, 0, SEEK_END) == 0) ? ftell(f) : -1;
+    valid            = start >= 0 && end >= start && header.length <= static_cast<unsigned long>(end - start) &&
+            fseek(f, start, SEEK_SET) == 0;
+  }
+  if(valid)
+  {
+    binary.resize(header.length);
+    valid = fread(binary.data(), 1, binary.size(), f) == binary.size();
+  }
+  fclose(f);
+
+  if(!valid)
+    return false;
+
+  RETURN_ERROR(CALLGL(glProgramBinary, program, header.format, binary.data(), static_cast<GLsizei>(binary.size())));
+
+  // Drivers reject binaries they no longer understand by failing the link, not by raising an error.
+  GLint status = GL_FALSE;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_LINK_STATUS, &status));
+  return status == GL_TRUE;
+}
+
+GLExpected<void> ProgramCache::_store(const ProgramObject& program, uint64_t key, Provider* backend) noexcept
+{
+  GLint len = 0;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_PROGRAM_BINARY_LENGTH, &len));
+  if(len <= 0)
+    return {};
+
+  Header header = { MAGIC, 0, key, 0 };
+  std::vector<std::byte> binary(len);
+  RETURN_ERROR(CALLGL(glGetProgramBinary, program, len, &len, &header.format, binary.data()));
+  header.length = static_cast<uint32_t>(len);
+
+  // Write to a temporary file first, so a crash or another process reading the cache never sees a partial binary.
+  auto path = _path(key);
+  auto temp = path + ".tmp";
+  FILE* f   = fopen(temp.c_str(), "wb");
+  if(!f)
+  {
+    backend->LOG(FG_Level_Warning, "Couldn't write program binary to cache: ", temp.c_str());
+    return {};
+  }
+
+  bool written = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(binary.data(), 1, header.length, f) == header.length;
+  written      = (fclose(f) == 0) && written;
+
+  std::error_code err;
+  if(written)
+    std::filesystem::rename(temp, path, err);
+  if(!written || err)
+  {
+    std::filesystem::remove(temp, err);
+    backend->LOG(FG_Level_Warning, "Couldn't write program binary to cache: ", path.c_str());
+  }
+
+  return {};
+}
@@ -0,0 +1,56 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__PROGRAM_CACHE_H
+#define GL__PROGRAM_CACHE_H
+
+#include "ProgramObject.hpp"
+#include <string>
+#include <vector>
+
+namespace GL {
+  class Provider;
+
+  // Stores linked program binaries on disk, keyed on the source and stage of every attached shader plus the driver that
+  // produced them, so later runs can load a program with glProgramBinary instead of linking it again. A binary the
+  // driver rejects is treated like a miss: the program is linked from source and the stale file is overwritten.
+  class ProgramCache
+  {
+  public:
+    ProgramCache() noexcept : _driver(0) {}
+
+    // An empty or null directory disables the cache. The directory is created if it doesn't exist yet.
+    bool set_directory(const char* directory);
+    inline bool enabled() const noexcept { return !_directory.empty() && glProgramBinary != nullptr; }
+    // Links program, which must already have all of its shaders attached, going through the cache if it's enabled. If
+    // deferred isn't null, this doesn't wait for the driver to finish linking, and instead sets *deferred to the key
+    // that has to be passed to finish() once it has, or to 0 if there is nothing left to do.
+    GLExpected<void> link(ProgramObject& program, Provider* backend, uint64_t* deferred = nullptr) noexcept;
+    // Stores the binary of a program whose link has completed, unless linking failed.
+    GLExpected<void> finish(const ProgramObject& program, uint64_t key, Provider* backend) noexcept;
+
+    static constexpr uint32_t MAGIC = 0x31425046; // "FPB1", bump this whenever the file layout changes
+
+  protected:
+    struct Header
+    {
+      uint32_t magic;
+      GLenum format;
+      uint64_t key;
+      uint32_t length;
+    };
+
+    GLExpected<void> _loadDriver() noexcept;
+    GLExpected<uint64_t> _key(const ProgramObject& program) noexcept;
+    std::string _path(uint64_t key) const;
+    // Returns false if there was no usable binary, in which case the program still has to be linked.
+    GLExpected<bool> _load(ProgramObject& program, uint64_t key) noexcept;
+    GLExpected<void> _store(const ProgramObject& program, uint64_t key, Provider* backend) noexcept;
+
+    std::string _directory;
+    uint64_t _driver;            // Hash of the vendor, renderer and version strings, 0 until the first link
+    std::vector<GLint> _formats; // Binary formats the driver accepts
+  };
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include "ShaderObject.hpp"
 #include "ProviderGL.hpp"
 #include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
 
 using namespace GL;
 
@@ -14,10 +17,19 @@ GLExpected<void> ProgramObject::attach(ShaderObject shader) noexcept
   return {};
 }
 
-GLExpected<void> ProgramObject::link() noexcept
+GLExpected<void> ProgramObject::link(bool validate) noexcept
 {
   RETURN_ERROR(CALLGL(glLinkProgram, _ref));
+  if(validate)
+    return this->validate();
+  return {};
+}
+
+GLExpected<void> ProgramObject::validate() const noexcept
+{
+#ifdef _DEBUG
   RETURN_ERROR(CALLGL(glValidateProgram, _ref));
+#endif
   return {};
 }
 
@@ -66,18 +78,12 @@ GLExpected<void> ProgramObject::set_buffer(GLuint resource, uint32_t index, uint
   return {};
 }
 
-GLExpected<void> ProgramObject::set_texture(const char* name, GLenum type, GLuint data) const noexcept
+GLExpected<void> ProgramObject::set_texture(GLint location, GLenum type, GLuint data) const noexcept
 {
   if(type >= GL_TEXTURE0 && type <= GL_TEXTURE31)
   {
-    if(name) // Names are optional for textures
-    {
-      auto loc = CALLGL(glGetUniformLocation, _ref, name);
-      if(loc.has_error())
-        return std::move(loc.error());
-      if(loc.value() > 0)
-        type = GL_TEXTURE0 + loc.value() - 1;
-    }
+    if(location > 0) // Otherwise the texture unit was given directly by type
+      type = GL_TEXTURE0 + location - 1;
 
     RETURN_ERROR(CALLGL(glActiveTexture, type));
     RETURN_ERROR(CALLGL(glBindTexture, GL_TEXTURE_2D, data));
@@ -87,16 +93,8 @@ GLExpected<void> ProgramObject::set_texture(const char* name, GLenum type, GLuin
   return {};
 }
 
-GLExpected<void> ProgramObject::set_uniform(const char* name, GLenum type, const float* data, uint32_t count) const noexcept
+GLExpected<void> ProgramObject::set_uniform(GLint loc, GLenum type, const float* data, uint32_t count) const noexcept
 {
-  if(!name)
-    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "name cannot be null");
-
-  auto r = CALLGL(glGetUniformLocation, _ref, name);
-  if(r.has_error())
-    return std::move(r.error());
-  auto loc = r.value();
-
   switch(type)
   {
   case GL_FLOAT_MAT2: RETURN_ERROR(CALLGL(glUniformMatrix2fv, loc, count, GL_FALSE, data)); break;
@@ -129,4 +127,92 @@ GLExpected<void> ProgramObject::set_uniform(const char* name, GLenum type, const
   }
 
   return {};
-}
\ No newline at end of file
+}
+
+GLExpected<void> UniformTable::reflect(const ProgramObject& program) noexcept
+{
+  GLint count  = 0;
+  GLint maxlen = 0;
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_ACTIVE_UNIFORMS, &count));
+  RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxlen)); // includes null terminator
+
+  uniforms.clear();
+  blocks.clear();
+  uniforms.reserve(count);
+  std::string name;
+
+  for(GLint i = 0; i < count; ++i)
+  {
+    GLsizei len = 0;
+    GLint size  = 0;
+    GLenum type = 0;
+    name.resize(maxlen);
+    RETURN_ERROR(CALLGL(glGetActiveUniform, program, i, maxlen, &len, &size, &type, name.data()));
+    name.resize(len);
+
+    // Arrays are reported as "name[0]", but are looked up by their base name.
+    if(name.size() > 3 && name.ends_with("[0]"))
+      name.resize(name.size() - 3);
+
+    Uniform u = { name, -1, type, size, -1, 0, 0, 0 };
+    if(glGetActiveUniformsiv)
+    {
+      GLuint index = i;
+      RETURN_ERROR(CALLGL(glGetActiveUniformsiv, program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &u.block));
+      RETURN_ERROR(CALLGL(glGetActiveUniformsiv, program, 1, &index, GL_UNIFORM_OFFSET, &u.offset));
+      RETURN_ERROR(CALLGL(glGetActiveUniformsiv, program, 1, &index, GL_UNIFORM_ARRAY_STRIDE, &u.arraystride));
+      RETURN_ERROR(CALLGL(glGetActiveUniformsiv, program, 1, &index, GL_UNIFORM_MATRIX_STRIDE, &u.matrixstride));
+    }
+
+    // Members of uniform blocks don't have a location, they are written into the block instead.
+    if(u.block < 0)
+    {
+      if(auto loc = CALLGL(glGetUniformLocation, program, name.c_str()))
+        u.location = loc.value();
+      else
+        return std::move(loc.error());
+      if(u.location < 0)
+        continue;
+    }
+
+    uniforms.push_back(std::move(u));
+  }
+
+  std::sort(uniforms.begin(), uniforms.end(), [](const Uniform& l, const Uniform& r) { return l.name < r.name; });
+
+  GLint nblocks = 0;
+  if(glGetActiveUniformBlockiv)
+  {
+    RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_ACTIVE_UNIFORM_BLOCKS, &nblocks));
+    RETURN_ERROR(CALLGL(glGetProgramiv, program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxlen));
+  }
+
+  blocks.reserve(nblocks);
+  for(GLint i = 0; i < nblocks; ++i)
+  {
+    GLint bytes = 0;
+    GLsizei len = 0;
+    name.resize(maxlen);
+    RETURN_ERROR(CALLGL(glGetActiveUniformBlockiv, program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &bytes));
+    RETURN_ERROR(CALLGL(glGetActiveUniformBlockName, program, i, maxlen, &len, name.data()));
+    name.resize(len);
+
+    // Each block gets the binding point matching its index, so a program's blocks never overlap each other.
+    RETURN_ERROR(CALLGL(glUniformBlockBinding, program, i, i));
+    blocks.push_back(Block{ name, static_cast<GLuint>(i), std::vector<std::byte>(bytes), true, 0, 0, nullptr });
+  }
+
+  return {};
+}
+
+const UniformTable::Uniform* UniformTable::find(const char* name) const noexcept
+{
+  // Arrays were stored without the "[0]" GL reports them with, but callers may still name them that way.
+  std::string_view key = name;
+  if(key.size() > 3 && key.ends_with("[0]"))
+    key.remove_suffix(3);
+
+  auto i = std::lower_bound(uniforms.begin(), uniforms.end(), key,
+                            [](const Uniform& u, std::string_view n) { return std::string_view(u.name) < n; });
+  return (i != uniforms.end() && i->name == key) ? &*i : nullptr;
+}
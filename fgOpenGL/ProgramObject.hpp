@@ -6,6 +6,7 @@
 
 #include "ShaderObject.hpp"
 #include <string>
+#include <vector>
 
 namespace GL {
   // static bool IsProgramObj(GLuint i) noexcept { return glIsProgram(i) == GL_TRUE; };
@@ -19,17 +20,76 @@ namespace GL {
     constexpr ProgramObject(const ProgramObject&) = default;
     constexpr ~ProgramObject() noexcept           = default;
     GLExpected<void> attach(ShaderObject shader) noexcept;
-    GLExpected<void> link() noexcept;
+    // Validation is only done in debug builds, and only if asked for, because it's a synchronous round trip.
+    GLExpected<void> link(bool validate = false) noexcept;
+    GLExpected<void> validate() const noexcept;
     GLExpected<bool> is_valid() const noexcept;
     GLExpected<std::string> log() const noexcept;
-    GLExpected<void> set_uniform(const char* name, GLenum type, const float* data, uint32_t count) const noexcept;
+    GLExpected<void> set_uniform(GLint location, GLenum type, const float* data, uint32_t count) const noexcept;
     GLExpected<void> set_buffer(GLuint resource, uint32_t index, uint32_t offset, uint32_t length) const noexcept;
-    GLExpected<void> set_texture(const char* name, GLenum type, GLuint data) const noexcept;
+    GLExpected<void> set_texture(GLint location, GLenum type, GLuint data) const noexcept;
 
     ProgramObject& operator=(const ProgramObject&) = default;
 
     static GLExpected<Owned<ProgramObject>> create() noexcept;
   };
+
+  // Every active uniform of a linked program, reflected once and sorted by name, so looking up a uniform never has to
+  // go through glGetUniformLocation. Uniform blocks keep a CPU copy of their contents, which the Context streams into
+  // a uniform buffer and binds once per block before drawing.
+  struct UniformTable
+  {
+    struct Uniform
+    {
+      std::string name;
+      GLint location; // -1 for members of a uniform block
+      GLenum type;
+      GLint size;
+      GLint block; // Index into blocks, or -1
+      GLint offset;
+      GLint arraystride;
+      GLint matrixstride;
+    };
+
+    struct Block
+    {
+      std::string name;
+      GLuint binding;
+      std::vector<std::byte> data;
+      bool dirty;
+      GLintptr offset;     // Where data was last written in ring
+      uint32_t generation; // ring's generation at that time
+      const void* ring;
+    };
+
+    GLExpected<void> reflect(const ProgramObject& program) noexcept;
+    // Returns nullptr if the program has no active uniform with this name.
+    const Uniform* find(const char* name) const noexcept;
+    inline GLint location(const char* name) const noexcept
+    {
+      auto u = find(name);
+      return u ? u->location : -1;
+    }
+
+    std::vector<Uniform> uniforms;
+    std::vector<Block> blocks;
+  };
+
+  // An array of FG_ShaderParameters resolved against one pipeline's UniformTable by prepareShaderParameters, so setting
+  // them is just an indexed store per uniform.
+  struct PreparedUniforms
+  {
+    struct Slot
+    {
+      FG_ShaderParameter param; // name is cleared, it doesn't have to outlive prepareShaderParameters
+      GLenum type;
+      GLint location;
+      const UniformTable::Uniform* uniform;
+    };
+
+    const UniformTable* table;
+    std::vector<Slot> slots;
+  };
 }
 
 #endif
@@ -9,10 +9,27 @@
 #include "Renderbuffer.hpp"
 #include "PipelineState.hpp"
 #include "EnumMapping.hpp"
+#include "CommandList.hpp"
+#include "Atlas.hpp"
+#include "TextureStream.hpp"
 #include <cstring>
 
 using GL::Provider;
 
+namespace {
+  std::string DriverName()
+  {
+    std::string driver;
+    for(auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+      auto str = reinterpret_cast<const char*>(glGetString(name));
+      driver.append(str ? str : "");
+      driver.push_back('\n');
+    }
+    return driver;
+  }
+}
+
 #define LOG_MISSING_GL_FUNCTION(name)                                                                    \
   LOG(FG_Level_Fatal,                                                                                    \
       "%i OpenGL function " name                                                                         \
@@ -21,10 +38,14 @@ using GL::Provider;
 
 FG_Caps Provider::GetCaps(FG_GraphicsInterface* self)
 {
-  auto backend         = static_cast<Provider*>(self);
+  auto backend = static_cast<Provider*>(self);
+  std::lock_guard lock(backend->_lock);
+  if(backend->_hascaps)
+    return backend->_caps;
+
   FG_Caps caps         = { 0 };
   caps.openGL.features = FG_Feature_API_OpenGL | FG_Feature_Immediate_Mode | FG_Feature_Background_Opacity |
-                         FG_Feature_Lines_Alpha;
+                         FG_Feature_Lines_Alpha | FG_Feature_Multithreading | FG_Feature_Command_Bundles;
   caps.openGL.version = 20;
   caps.openGL.glsl    = 110;
   if(!glGetIntegerv)
@@ -43,6 +64,10 @@ FG_Caps Provider::GetCaps(FG_GraphicsInterface* self)
   if(GLAD_GL_ARB_texture_filter_anisotropic)
     caps.openGL.features |= FG_Feature_Anisotropic_Filter;
 
+  // BC4 and BC5 are core, but BC1-3 still come from S3TC, and BC6H and BC7 from BPTC before 4.2.
+  if(GLAD_GL_EXT_texture_compression_s3tc)
+    caps.openGL.features |= FG_Feature_Block_Compression;
+
   if(GLAD_GL_ARB_half_float_pixel)
     caps.openGL.features |= FG_Feature_Half_Float;
 
@@ -67,6 +92,21 @@ FG_Caps Provider::GetCaps(FG_GraphicsInterface* self)
   if(GLAD_GL_NV_mesh_shader)
     caps.openGL.features |= FG_Feature_Mesh_Shader;
 
+  if(GLAD_GL_KHR_parallel_shader_compile)
+    caps.openGL.features |= FG_Feature_Async_Compile;
+
+  if(VertexLayoutCache::supported())
+    caps.openGL.features |= FG_Feature_Vertex_Binding;
+
+  if(GLAD_GL_ARB_draw_indirect)
+    caps.openGL.features |= FG_Feature_Draw_Indirect;
+
+  if(GLAD_GL_ARB_base_instance)
+    caps.openGL.features |= FG_Feature_Base_Instance;
+
+  if(Headless::supported())
+    caps.openGL.features |= FG_Feature_Headless;
+
   constexpr auto GetVec3i = [](GLenum e, FG_Vec3i& out) {
     glGetIntegeri_v(e, 0, &out.x);
     glGetIntegeri_v(e, 1, &out.x);
@@ -169,14 +209,37 @@ FG_Caps Provider::GetCaps(FG_GraphicsInterface* self)
     GetVec3i(GL_MAX_TASK_WORK_GROUP_SIZE_NV, caps.openGL.max_task_work_group_size);
   }
 
+  caps.openGL.max_viewports = 1;
+  if(GLAD_GL_ARB_viewport_array)
+    glGetIntegerv(GL_MAX_VIEWPORTS, &caps.openGL.max_viewports);
+
+  // ATI only reports what's free, which is the best guess there is at startup.
+  if(GLAD_GL_NVX_gpu_memory_info)
+    glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &caps.openGL.video_memory);
+  else if(GLAD_GL_ATI_meminfo)
+  {
+    GLint free[4] = { 0 };
+    glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free);
+    caps.openGL.video_memory = free[0];
+  }
+
+  // Limits belong to the driver just like the entry points, so they stay valid until LoadGL loads a different one.
+  backend->_caps    = caps;
+  backend->_hascaps = true;
   return caps;
 }
 
 FG_Context* Provider::CreateContext(FG_GraphicsInterface* self, FG_Vec2i size, enum FG_PixelFormat backbuffer)
 {
-  auto backend = static_cast<Provider*>(self);
-  backend->LOG(FG_Level_Error, "CreateContext is not implemented for fgOpenGL");
-  return nullptr;
+  auto backend  = static_cast<Provider*>(self);
+  auto headless = Headless::create(backend, size, backbuffer);
+  if(headless.has_error())
+  {
+    headless.log(backend);
+    return nullptr;
+  }
+
+  return new Context(FG_Vec2{ static_cast<float>(size.x), static_cast<float>(size.y) }, std::move(headless.value()));
 }
 int Provider::ResizeContext(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size)
 {
@@ -185,6 +248,21 @@ int Provider::ResizeContext(FG_GraphicsInterface* self, FG_Context* context, FG_
   LOG_ERROR(backend, ctx->Resize(FG_Vec2{ static_cast<float>(size.x), static_cast<float>(size.y) }));
   return ERR_SUCCESS;
 }
+int Provider::DestroyContext(FG_GraphicsInterface* self, FG_Context* context)
+{
+  if(!context)
+    return ERR_MISSING_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  {
+    std::lock_guard lock(backend->_lock);
+    backend->_pipelines.evict(context);
+  }
+
+  // A window's context has to be current already, a headless one makes itself current.
+  delete static_cast<Context*>(context);
+  return ERR_SUCCESS;
+}
 
 FG_Shader Provider::CompileShader(FG_GraphicsInterface* self, FG_Context* context, enum FG_ShaderStage stage,
                                   const char* source)
@@ -196,7 +274,7 @@ FG_Shader Provider::CompileShader(FG_GraphicsInterface* self, FG_Context* contex
   else
   {
     // Note: Can't use LOG_ERROR here because we return a value
-    if(auto r = ShaderObject::create(source, ShaderStageMapping[stage], backend))
+    if(auto r = ShaderObject::create(source, ShaderStageMapping[stage], backend, backend->IsAsyncCompile()))
       return std::move(r.value()).release();
     else
       r.error().log(backend);
@@ -214,20 +292,20 @@ int Provider::DestroyShader(FG_GraphicsInterface* self, FG_Context* context, FG_
     backend->LOG(FG_Level_Error, "Invalid shader!", s.release());
     return ERR_INVALID_PARAMETER;
   }
+
+  // The name can be reused by the next compileShader, so pipelines linked from this one mustn't match it anymore.
+  std::lock_guard lock(backend->_lock);
+  backend->_pipelines.evict(shader);
   return 0;
 }
 
 void* Provider::CreateCommandList(FG_GraphicsInterface* self, FG_Context* context, bool bundle)
 {
+  // Command lists never touch OpenGL while recording, so any number of them can be built in parallel, as long as each
+  // individual list is only used by one thread at a time. Bundles keep their commands after being executed.
   auto backend = static_cast<Provider*>(self);
-  if(backend->_insidelist)
-  {
-    backend->LOG(FG_Level_Error,
-                 "This backend can't do multiple command lists at the same time! Did you forget to free the old list?");
-    return NULL_COMMANDLIST;
-  }
-  backend->_insidelist = true;
-  return context;
+  ++backend->_commandlists;
+  return new CommandList(bundle);
 }
 
 int Provider::DestroyCommandList(FG_GraphicsInterface* self, FG_Context* context, void* commands)
@@ -238,57 +316,52 @@ int Provider::DestroyCommandList(FG_GraphicsInterface* self, FG_Context* context
     backend->LOG(FG_Level_Error, "Expected a non-null command list but got NULL instead!");
     return ERR_INVALID_PARAMETER;
   }
-  if(!backend->_insidelist)
+  uint32_t active = backend->_commandlists.load(std::memory_order_relaxed);
+  do
   {
-    backend->LOG(FG_Level_Error, "Mismatched CreateCommandList / DestroyCommandList pair !");
-    return ERR_INVALID_CALL;
-  }
+    if(!active)
+    {
+      backend->LOG(FG_Level_Error, "Mismatched CreateCommandList / DestroyCommandList pair !");
+      return ERR_INVALID_CALL;
+    }
+  } while(!backend->_commandlists.compare_exchange_weak(active, active - 1, std::memory_order_relaxed));
 
-  backend->_insidelist = false;
+  delete reinterpret_cast<CommandList*>(commands);
   return ERR_SUCCESS;
 }
 
 int Provider::Clear(FG_GraphicsInterface* self, void* commands, uint8_t clearbits, FG_Color16 RGBA, uint8_t stencil,
                     float depth, uint32_t num_rects, FG_Rect* rects)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->Clear(clearbits, RGBA, stencil, depth, std::span(rects, num_rects)));
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->Clear(clearbits, RGBA, stencil, depth, std::span(rects, num_rects));
   return ERR_SUCCESS;
 }
 int Provider::CopyResource(FG_GraphicsInterface* self, void* commands, FG_Resource src, FG_Resource dest, FG_Vec3i size,
                            int level)
 {
-  auto backend = static_cast<Provider*>(self);
-
-  if(Buffer::validate(src) && Buffer::validate(dest))
-  {
-    return CopySubresource(self, commands, src, dest, 0, 0, size.x);
-  }
-  else if((Texture::validate(src) && Texture::validate(dest)) ||
-          (Renderbuffer::validate(src) && Renderbuffer::validate(dest)))
-  {
-    return CopyResourceRegion(self, commands, src, dest, level, FG_Vec3i{ 0, 0, 0 }, FG_Vec3i{ 0, 0, 0 },
-                              FG_Vec3i{ size.x, size.y, size.z });
-  }
-  backend->LOG(FG_Level_Error, "Mismatched src / dest resources");
-  return ERR_INVALID_PARAMETER;
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  // Resource validation calls into OpenGL, so the copy kind is resolved when the list is executed.
+  reinterpret_cast<CommandList*>(commands)->CopyResource(src, dest, size, level);
+  return ERR_SUCCESS;
 }
 int Provider::CopySubresource(FG_GraphicsInterface* self, void* commands, FG_Resource src, FG_Resource dest,
                               unsigned long srcoffset, unsigned long destoffset, unsigned long bytes)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->CopySubresource(src, dest, srcoffset, destoffset, bytes));
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->CopySubresource(src, dest, srcoffset, destoffset, bytes);
   return ERR_SUCCESS;
 }
 
 int Provider::CopyResourceRegion(FG_GraphicsInterface* self, void* commands, FG_Resource src, FG_Resource dest, int level,
                                  FG_Vec3i srcoffset, FG_Vec3i destoffset, FG_Vec3i size)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->CopyResourceRegion(src, dest, level, srcoffset, destoffset, size));
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->CopyResourceRegion(src, dest, level, srcoffset, destoffset, size);
   return ERR_SUCCESS;
 }
 int Provider::DrawGL(FG_GraphicsInterface* self, void* commands, uint32_t vertexcount, uint32_t instancecount,
@@ -296,9 +369,7 @@ int Provider::DrawGL(FG_GraphicsInterface* self, void* commands, uint32_t vertex
 {
   if(!commands)
     return ERR_INVALID_PARAMETER;
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->DrawArrays(vertexcount, instancecount, startvertex, startinstance));
+  reinterpret_cast<CommandList*>(commands)->DrawArrays(vertexcount, instancecount, startvertex, startinstance);
   return 0;
 }
 int Provider::DrawIndexed(FG_GraphicsInterface* self, void* commands, uint32_t indexcount, uint32_t instancecount,
@@ -306,27 +377,76 @@ int Provider::DrawIndexed(FG_GraphicsInterface* self, void* commands, uint32_t i
 {
   if(!commands)
     return ERR_INVALID_PARAMETER;
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->DrawIndexed(indexcount, instancecount, startindex, startvertex, startinstance));
+  reinterpret_cast<CommandList*>(commands)->DrawIndexed(indexcount, instancecount, startindex, startvertex,
+                                                        startinstance);
   return 0;
 }
 int Provider::DrawMesh(FG_GraphicsInterface* self, void* commands, uint32_t first, uint32_t count)
 {
   if(!commands)
     return ERR_INVALID_PARAMETER;
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->DrawMesh(first, count));
+  reinterpret_cast<CommandList*>(commands)->DrawMesh(first, count);
+  return 0;
+}
+int Provider::DrawIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer, uint32_t offset,
+                           uint32_t drawcount, uint32_t stride)
+{
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->DrawIndirect(buffer, offset, drawcount, stride, false);
+  return 0;
+}
+int Provider::DrawIndexedIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                                  uint32_t offset, uint32_t drawcount, uint32_t stride)
+{
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->DrawIndirect(buffer, offset, drawcount, stride, true);
+  return 0;
+}
+int Provider::DrawQuads(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource texture, const FG_Quad* quads,
+                        uint32_t count)
+{
+  if(!commands || (!quads && count > 0))
+    return ERR_INVALID_PARAMETER;
+  if(count > 0)
+    reinterpret_cast<CommandList*>(commands)->DrawQuads(texture, std::span(quads, count));
   return 0;
 }
 int Provider::Dispatch(FG_GraphicsInterface* self, void* commands)
 {
   if(!commands)
     return ERR_INVALID_PARAMETER;
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  LOG_ERROR(backend, context->Dispatch());
+  reinterpret_cast<CommandList*>(commands)->Dispatch(nullptr);
+  return 0;
+}
+int Provider::DispatchGroups(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t x, uint32_t y, uint32_t z)
+{
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  // Dispatching no groups does nothing, so it isn't recorded at all.
+  if(x > 0 && y > 0 && z > 0)
+  {
+    FG_Vec3i groups = { static_cast<int>(x), static_cast<int>(y), static_cast<int>(z) };
+    reinterpret_cast<CommandList*>(commands)->Dispatch(&groups);
+  }
+  return 0;
+}
+int Provider::DispatchIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                               uint32_t offset)
+{
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->DispatchIndirect(buffer, offset);
+  return 0;
+}
+int Provider::DeclareAccess(FG_GraphicsInterface* self, FG_CommandList* commands, const FG_ResourceAccess* accesses,
+                            uint32_t count)
+{
+  if(!commands || (!accesses && count > 0))
+    return ERR_INVALID_PARAMETER;
+  if(count > 0)
+    reinterpret_cast<CommandList*>(commands)->DeclareAccess(std::span(accesses, count));
   return 0;
 }
 
@@ -334,38 +454,23 @@ int Provider::SyncPoint(FG_GraphicsInterface* self, void* commands, uint32_t bar
 {
   if(!commands)
     return ERR_INVALID_PARAMETER;
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-
-  GLbitfield flags = 0;
-  if(barrier_flags & FG_BarrierFlag_Vertex)
-    flags |= GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Element)
-    flags |= GL_ELEMENT_ARRAY_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Uniform)
-    flags |= GL_UNIFORM_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Texture_Fetch)
-    flags |= GL_TEXTURE_FETCH_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Texture_Update)
-    flags |= GL_TEXTURE_UPDATE_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Image_Access)
-    flags |= GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Command)
-    flags |= GL_COMMAND_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Pixel)
-    flags |= GL_PIXEL_BUFFER_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Buffer)
-    flags |= GL_BUFFER_UPDATE_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_RenderTarget)
-    flags |= GL_FRAMEBUFFER_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Storage_Buffer)
-    flags |= GL_SHADER_STORAGE_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Transform_Feedback)
-    flags |= GL_TRANSFORM_FEEDBACK_BARRIER_BIT;
-  if(barrier_flags & FG_BarrierFlag_Atomic_Counter)
-    flags |= GL_ATOMIC_COUNTER_BARRIER_BIT;
-
-  LOG_ERROR(backend, context->Barrier(flags));
+  reinterpret_cast<CommandList*>(commands)->Barrier(BarrierBits(barrier_flags));
+  return 0;
+}
+
+int Provider::BeginRegion(FG_GraphicsInterface* self, FG_CommandList* commands, const char* name)
+{
+  if(!commands || !name)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->BeginRegion(name);
+  return 0;
+}
+
+int Provider::EndRegion(FG_GraphicsInterface* self, FG_CommandList* commands)
+{
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->EndRegion();
   return 0;
 }
 
@@ -374,58 +479,132 @@ int Provider::SetPipelineState(FG_GraphicsInterface* self, void* commands, uintp
   if(!commands)
     return ERR_INVALID_PARAMETER;
 
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
+  // A null state is still recorded so the context forgets its current program when the list is executed.
+  reinterpret_cast<CommandList*>(commands)->SetPipelineState(state);
+  return !state ? ERR_INVALID_PARAMETER : 0;
+}
 
-  if(!state)
-  {
-    context->_program = nullptr;
+int Provider::SetVertexBuffers(FG_GraphicsInterface* self, void* commands, uint32_t first, const FG_Resource* buffers,
+                               const uint32_t* offsets, uint32_t count)
+{
+  if(!commands || (!buffers && count > 0))
     return ERR_INVALID_PARAMETER;
-  }
 
-  if(reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG)
-  {
-    LOG_ERROR(backend, reinterpret_cast<ComputePipelineState*>(state)->apply(context));
-  }
-  else
-  {
-    LOG_ERROR(backend, reinterpret_cast<PipelineState*>(state)->apply(context));
-  }
-
-  return 0;
+  reinterpret_cast<CommandList*>(commands)->SetVertexBuffers(first, { buffers, count }, offsets);
+  return ERR_SUCCESS;
 }
 
 int Provider::SetViewports(FG_GraphicsInterface* self, void* commands, FG_Viewport* viewports, uint32_t count)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  if(count > 1)
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  if(count > 1 && !glViewportArrayv)
     return ERR_NOT_IMPLEMENTED;
-  LOG_ERROR(backend, context->SetViewports({ viewports, count }));
+  reinterpret_cast<CommandList*>(commands)->SetViewports({ viewports, count });
   return ERR_SUCCESS;
 }
 
 int Provider::SetScissors(FG_GraphicsInterface* self, void* commands, FG_Rect* rects, uint32_t count)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
-  if(count > 1)
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  if(count > 1 && !glScissorArrayv)
     return ERR_NOT_IMPLEMENTED;
-  LOG_ERROR(backend, context->SetScissors({ rects, count }));
+  reinterpret_cast<CommandList*>(commands)->SetScissors({ rects, count });
   return ERR_SUCCESS;
 }
 
 int Provider::SetShaderConstants(FG_GraphicsInterface* self, void* commands, const FG_ShaderParameter* uniforms,
                                  const FG_ShaderValue* values, uint32_t count)
 {
-  auto backend = static_cast<Provider*>(self);
-  auto context = reinterpret_cast<Context*>(commands);
+  if(!commands)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->SetShaderConstants(uniforms, values, count);
+  return ERR_SUCCESS;
+}
+
+int Provider::SetPreparedShaderConstants(FG_GraphicsInterface* self, FG_CommandList* commands, uintptr_t parameters,
+                                         const FG_ShaderValue* values)
+{
+  if(!commands || !parameters || !values)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<CommandList*>(commands)->SetPreparedConstants(reinterpret_cast<PreparedUniforms*>(parameters), values);
+  return ERR_SUCCESS;
+}
 
-  LOG_ERROR(backend, context->SetShaderUniforms(uniforms, values, count));
+int Provider::Execute(FG_GraphicsInterface* self, FG_Context* context, void* commands)
+{
+  if(!context || !commands)
+    return ERR_INVALID_PARAMETER;
+  auto backend = static_cast<Provider*>(self);
+  LOG_ERROR(backend, reinterpret_cast<CommandList*>(commands)->Execute(reinterpret_cast<Context*>(context)));
   return ERR_SUCCESS;
 }
 
-int Provider::Execute(FG_GraphicsInterface* self, FG_Context* context, void* commands) { return ERR_SUCCESS; }
+FG_Fence Provider::CreateFence(FG_GraphicsInterface* self, FG_Context* context)
+{
+  auto backend = static_cast<Provider*>(self);
+  if(!context)
+    return NULL_FENCE;
+  if(!glFenceSync)
+    return backend->LOG_MISSING_GL_FUNCTION("glFenceSync"), NULL_FENCE;
+
+  auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  // Without a flush, a fence that is only ever queried might never reach the GPU.
+  glFlush();
+  if(GLError e{ "glFenceSync", __FILE__, __LINE__ }; e.has_error())
+  {
+    e.log(backend);
+    return NULL_FENCE;
+  }
+
+  return reinterpret_cast<FG_Fence>(fence);
+}
+
+int Provider::WaitFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence, uint64_t timeout)
+{
+  if(!context || !fence)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto result  = glClientWaitSync(reinterpret_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+  switch(result)
+  {
+  case GL_ALREADY_SIGNALED:
+  case GL_CONDITION_SATISFIED: return ERR_SUCCESS;
+  case GL_TIMEOUT_EXPIRED: return ERR_TIMEOUT;
+  }
+
+  if(GLError e{ "glClientWaitSync", __FILE__, __LINE__ }; e.has_error())
+    return e.log(backend);
+  return ERR_INVALID_CALL;
+}
+
+int Provider::QueryFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence)
+{
+  if(!context || !fence)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  GLint status = GL_UNSIGNALED;
+  glGetSynciv(reinterpret_cast<GLsync>(fence), GL_SYNC_STATUS, 1, nullptr, &status);
+  if(GLError e{ "glGetSynciv", __FILE__, __LINE__ }; e.has_error())
+    return e.log(backend);
+
+  return status == GL_SIGNALED ? ERR_SUCCESS : ERR_TIMEOUT;
+}
+
+int Provider::DestroyFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence)
+{
+  if(!context || !fence)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  glDeleteSync(reinterpret_cast<GLsync>(fence));
+  if(GLError e{ "glDeleteSync", __FILE__, __LINE__ }; e.has_error())
+    return e.log(backend);
+  return ERR_SUCCESS;
+}
 
 uintptr_t Provider::CreatePipelineState(FG_GraphicsInterface* self, FG_Context* context, FG_PipelineState* pipelinestate,
                                         FG_Resource rendertarget, FG_Blend* blends, FG_Resource* vertexbuffer,
@@ -438,10 +617,24 @@ uintptr_t Provider::CreatePipelineState(FG_GraphicsInterface* self, FG_Context*
   auto backend = static_cast<Provider*>(self);
   auto ctx     = reinterpret_cast<Context*>(context);
 
+  auto key = PipelineCache::key(context, *pipelinestate, rendertarget, *blends, std::span(vertexbuffer, n_buffers),
+                                strides, std::span(attributes, n_attributes), indexbuffer, indexstride);
+
+  // Held until the new pipeline is in the cache, so two threads building the same pipeline can't both insert it.
+  std::lock_guard lock(backend->_lock);
+  if(auto state = backend->_pipelines.acquire(key))
+    return reinterpret_cast<uintptr_t>(state);
+
+  // Building the VAO changes the vertex array binding behind the context's back.
+  ctx->InvalidateBindings();
+
   // Can't use LOG_ERROR here because we return a pointer.
   if(auto e = PipelineState::create(*pipelinestate, rendertarget, *blends, std::span(vertexbuffer, n_buffers), strides,
-                                    std::span(attributes, n_attributes), indexbuffer, indexstride))
+                                    std::span(attributes, n_attributes), indexbuffer, indexstride, backend))
+  {
+    backend->_pipelines.insert(std::move(key), context, *pipelinestate, e.value());
     return reinterpret_cast<uintptr_t>(e.value());
+  }
   else
     e.log(backend);
   return NULL_PIPELINE;
@@ -456,7 +649,7 @@ uintptr_t Provider::CreateComputePipeline(FG_GraphicsInterface* self, FG_Context
   auto ctx     = reinterpret_cast<Context*>(context);
 
   // Can't use LOG_ERROR here because we return a pointer.
-  if(auto e = ComputePipelineState::create(computeshader, workgroup, flags))
+  if(auto e = ComputePipelineState::create(computeshader, workgroup, flags, backend))
     return reinterpret_cast<uintptr_t>(e.value());
   else
     e.log(backend);
@@ -468,13 +661,107 @@ int Provider::DestroyPipelineState(FG_GraphicsInterface* self, FG_Context* conte
   if(!state)
     return ERR_INVALID_PARAMETER;
   auto backend = static_cast<Provider*>(self);
-  if(reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG)
+  auto compute = (reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG) != 0;
+
+  // Identical graphics pipelines share one object, which stays alive until the last of them is destroyed.
+  if(!compute)
+  {
+    std::lock_guard lock(backend->_lock);
+    if(!backend->_pipelines.release(reinterpret_cast<PipelineState*>(state)))
+      return 0;
+  }
+
+  // The deleted program or VAO IDs could be handed out again, so the context mustn't assume they're still bound.
+  if(context)
+    reinterpret_cast<Context*>(context)->InvalidateBindings();
+
+  if(compute)
     delete reinterpret_cast<ComputePipelineState*>(state);
   else
     delete reinterpret_cast<PipelineState*>(state);
   return 0;
 }
 
+int Provider::QueryPipelineState(FG_GraphicsInterface* self, FG_Context* context, uintptr_t state)
+{
+  if(!state || !context)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto ctx     = reinterpret_cast<Context*>(context);
+  GLExpected<bool> ready;
+
+  if(reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG)
+    ready = reinterpret_cast<ComputePipelineState*>(state)->is_ready();
+  else
+  {
+    // A pipeline that just became ready builds its VAO, which changes the vertex array binding. Only the call that
+    // finishes the link does that, every other one leaves the cached bindings alone.
+    auto pipeline       = reinterpret_cast<PipelineState*>(state);
+    const bool building = pipeline->deferred != nullptr;
+    ready               = pipeline->is_ready();
+    if(building && !pipeline->deferred)
+      ctx->InvalidateBindings();
+  }
+
+  if(ready.has_error())
+    return ready.log(backend);
+  return ready.value() ? ERR_SUCCESS : ERR_TIMEOUT;
+}
+
+uintptr_t Provider::PrepareShaderParameters(FG_GraphicsInterface* self, FG_Context* context, uintptr_t state,
+                                            const FG_ShaderParameter* uniforms, uint32_t count)
+{
+  if(!state || (!uniforms && count > 0))
+    return 0;
+
+  auto backend = static_cast<Provider*>(self);
+  const UniformTable* table;
+  GLExpected<void> finished;
+
+  // The uniforms of a program that's still compiling aren't known yet, so this has to wait for it.
+  if(reinterpret_cast<PipelineState*>(state)->Members & COMPUTE_PIPELINE_FLAG)
+  {
+    finished = reinterpret_cast<ComputePipelineState*>(state)->finish();
+    table    = &reinterpret_cast<ComputePipelineState*>(state)->uniforms;
+  }
+  else
+  {
+    // Same as QueryPipelineState, only finishing the link builds a VAO behind the context's back.
+    auto pipeline       = reinterpret_cast<PipelineState*>(state);
+    const bool building = pipeline->deferred != nullptr;
+    finished            = pipeline->finish();
+    table               = &pipeline->uniforms;
+    if(context && building)
+      reinterpret_cast<Context*>(context)->InvalidateBindings();
+  }
+
+  if(finished.has_error())
+  {
+    finished.log(backend);
+    return 0;
+  }
+
+  auto prepared = new PreparedUniforms{ table, {} };
+  prepared->slots.reserve(count);
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    auto u = (uniforms[i].type != FG_Shader_Type_Buffer && uniforms[i].name) ? table->find(uniforms[i].name) : nullptr;
+    prepared->slots.push_back({ uniforms[i], ShaderObject::get_type(uniforms[i]), u ? u->location : -1, u });
+    prepared->slots.back().param.name = nullptr;
+  }
+
+  return reinterpret_cast<uintptr_t>(prepared);
+}
+
+int Provider::DestroyShaderParameters(FG_GraphicsInterface* self, FG_Context* context, uintptr_t parameters)
+{
+  if(!parameters)
+    return ERR_INVALID_PARAMETER;
+  delete reinterpret_cast<PreparedUniforms*>(parameters);
+  return ERR_SUCCESS;
+}
+
 FG_Resource Provider::CreateBuffer(FG_GraphicsInterface* self, FG_Context* context, void* data, uint32_t bytes,
                                    enum FG_Usage usage)
 {
@@ -482,6 +769,10 @@ FG_Resource Provider::CreateBuffer(FG_GraphicsInterface* self, FG_Context* conte
   if(usage >= ArraySize(UsageMapping))
     return NULL_RESOURCE;
 
+  // Creating an index buffer binds it to whatever VAO is current, so the context has to rebind its own.
+  if(context)
+    reinterpret_cast<Context*>(context)->InvalidateBindings();
+
   // Can't use LOG_ERROR here because we return a pointer.
   if(auto e = Buffer::create(UsageMapping[usage], data, bytes))
     return std::move(e.value()).release();
@@ -489,8 +780,37 @@ FG_Resource Provider::CreateBuffer(FG_GraphicsInterface* self, FG_Context* conte
     e.log(backend);
   return NULL_RESOURCE;
 }
+FG_Resource Provider::CreateImmutableBuffer(FG_GraphicsInterface* self, FG_Context* context, void* data,
+                                            uint32_t bytes, enum FG_Usage usage, uint32_t access)
+{
+  auto backend = static_cast<Provider*>(self);
+  if(usage >= ArraySize(UsageMapping))
+    return NULL_RESOURCE;
+  if(!glBufferStorage)
+    return backend->LOG_MISSING_GL_FUNCTION("glBufferStorage"), NULL_RESOURCE;
+
+  // Persistent maps are always coherent, same as in getOpenGLAccessFlags, so the storage has to allow it too.
+  GLbitfield storage = 0;
+  if(access & FG_AccessFlag_Read)
+    storage |= GL_MAP_READ_BIT;
+  if(access & FG_AccessFlag_Write)
+    storage |= GL_MAP_WRITE_BIT;
+  if(access & FG_AccessFlag_Persistent)
+    storage |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  if(context)
+    reinterpret_cast<Context*>(context)->InvalidateBindings();
+
+  // Can't use LOG_ERROR here because we return a pointer.
+  if(auto e = Buffer::create(UsageMapping[usage], data, bytes, storage))
+    return std::move(e.value()).release();
+  else
+    e.log(backend);
+  return NULL_RESOURCE;
+}
 FG_Resource Provider::CreateTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size, enum FG_Usage usage,
-                                    enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount)
+                                    enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount,
+                                    uint32_t flags)
 {
   auto backend = static_cast<Provider*>(self);
   if(usage >= ArraySize(UsageMapping) || !sampler)
@@ -506,8 +826,12 @@ FG_Resource Provider::CreateTexture(FG_GraphicsInterface* self, FG_Context* cont
   }
   else
   {
-    if(auto e =
-         Texture::create2D(UsageMapping[usage], Format::Create(format, false), size, *sampler, data, MultiSampleCount))
+    // A sampler that reaches past level 0 is a request for mips, which we generate from data if it's given.
+    uint8_t preprocess = (sampler->max_lod > 0.0f) ? Texture::TEXTURE_MIPMAPS : 0;
+    if(flags & FG_TextureFlag_Premultiply)
+      preprocess |= Texture::TEXTURE_PREMULTIPLY;
+    if(auto e = Texture::create2D(UsageMapping[usage], Format::Create(format, false), size, *sampler, data,
+                                  MultiSampleCount, preprocess, &backend->_samplers))
       return std::move(e.value()).release();
     else
       e.log(backend);
@@ -520,6 +844,9 @@ FG_Resource Provider::CreateRenderTarget(FG_GraphicsInterface* self, FG_Context*
 {
   auto backend = static_cast<Provider*>(self);
 
+  if(context)
+    reinterpret_cast<Context*>(context)->InvalidateBindings();
+
   if(auto e = Framebuffer::create(GL_FRAMEBUFFER, GL_TEXTURE_2D, 0, 0, textures, n_textures))
   {
     if(auto flags = (attachments & (FG_ClearFlag_Depth | FG_ClearFlag_Stencil)))
@@ -543,13 +870,45 @@ FG_Resource Provider::CreateRenderTarget(FG_GraphicsInterface* self, FG_Context*
     e.log(backend);
   return NULL_RESOURCE;
 }
+FG_Resource Provider::AcquireRenderTarget(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size,
+                                          enum FG_PixelFormat format, int samples, int attachments, FG_Sampler* sampler,
+                                          FG_Resource* texture)
+{
+  if(!context || !sampler || !texture)
+    return NULL_RESOURCE;
+
+  auto ctx = reinterpret_cast<Context*>(context);
+  if(auto e = ctx->AcquireTarget(size, Format::Create(format, false), samples, attachments, *sampler,
+                                 &static_cast<Provider*>(self)->_samplers, *texture))
+    return e.value();
+  else
+    e.log(static_cast<Provider*>(self));
+  return NULL_RESOURCE;
+}
+
+int Provider::ReleaseRenderTarget(FG_GraphicsInterface* self, FG_Context* context, FG_Resource rendertarget)
+{
+  if(!context)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  LOG_ERROR(backend, reinterpret_cast<Context*>(context)->ReleaseTarget(rendertarget));
+  return ERR_SUCCESS;
+}
+
 int Provider::DestroyResource(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource)
 {
   auto backend = static_cast<Provider*>(self);
   if(Framebuffer::validate(resource))
+  {
+    if(context)
+      reinterpret_cast<Context*>(context)->InvalidateBindings();
     Owned<Framebuffer> b(resource);
+  }
   else if(Texture::validate(resource))
+  {
     Owned<Texture> t(resource);
+  }
   else if(Renderbuffer::validate(resource))
     Owned<Renderbuffer> t(resource);
   else if(Buffer::validate(resource))
@@ -570,8 +929,9 @@ GLenum getOpenGLAccessFlags(uint32_t flags)
     v |= GL_MAP_READ_BIT;
   if(flags & FG_AccessFlag_Write)
     v |= GL_MAP_WRITE_BIT;
-  // if(flags & FG_AccessFlag_PERSISTENT)
-  //   v |= GL_MAP_PERSISTENT_BIT;
+  // Persistent maps are always coherent, because the interface has no way to flush or fence a mapped range.
+  if(flags & FG_AccessFlag_Persistent)
+    v |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
   if(flags & FG_AccessFlag_Invalidate_Range)
     v |= GL_MAP_INVALIDATE_RANGE_BIT;
   if(flags & FG_AccessFlag_Invalidate_Buffer)
@@ -629,6 +989,27 @@ void* Provider::MapResource(FG_GraphicsInterface* self, FG_Context* context, FG_
   if(!bind)
     return nullptr;
 
+  if(access & FG_AccessFlag_Persistent)
+  {
+    // Only immutable storage can stay mapped while the GPU uses it, and createBuffer keeps buffers mutable so they
+    // can still be reallocated or orphaned, so these have to come from createImmutableBuffer.
+    GLint immutable = GL_FALSE;
+    if(glBufferStorage != nullptr && Buffer::validate(resource))
+      glGetBufferParameteriv(UsageMapping[usage], GL_BUFFER_IMMUTABLE_STORAGE, &immutable);
+    if(!immutable)
+    {
+      backend->LOG(FG_Level_Error, "Only buffers with immutable storage can be mapped persistently");
+      return nullptr;
+    }
+
+    // glMapBuffer can't map persistently, so persistent requests for the whole buffer go through glMapBufferRange.
+    if(!offset && !length)
+    {
+      if(auto info = ResourceTable::find(REF_BUFFER, resource))
+        length = static_cast<uint32_t>(info->bytes);
+    }
+  }
+
   void* v = nullptr;
   if(!offset && !length)
     v = glMapBuffer(UsageMapping[usage], getOpenGLAccessEnum(access));
@@ -685,6 +1066,222 @@ int Provider::UnmapResource(FG_GraphicsInterface* self, FG_Context* context, FG_
   return 0;
 }
 
+int Provider::UpdateTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Resource texture, int level,
+                            FG_Vec2i offset, FG_Vec2i size, enum FG_PixelFormat format, const void* data)
+{
+  if(!context)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto ctx     = reinterpret_cast<Context*>(context);
+  LOG_ERROR(backend, ctx->UpdateTexture(texture, level, offset, size, Format::Create(format, false), data));
+  return ERR_SUCCESS;
+}
+
+int Provider::ReadBuffer(FG_GraphicsInterface* self, FG_Context* context, FG_Resource buffer, uint32_t offset,
+                         uint32_t bytes, FG_ReadbackCallback callback, void* user)
+{
+  if(!context || !callback)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto ctx     = reinterpret_cast<Context*>(context);
+  LOG_ERROR(backend, ctx->ReadBuffer(buffer, offset, bytes, callback, user));
+  return ERR_SUCCESS;
+}
+
+int Provider::ReadTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, FG_Vec2i offset,
+                          FG_Vec2i size, enum FG_PixelFormat format, FG_ReadbackCallback callback, void* user)
+{
+  if(!context || !callback || size.x <= 0 || size.y <= 0)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto ctx     = reinterpret_cast<Context*>(context);
+  LOG_ERROR(backend, ctx->ReadPixels(resource, offset, size, Format::Create(format, false), callback, user));
+  return ERR_SUCCESS;
+}
+
+int Provider::FinishReadbacks(FG_GraphicsInterface* self, FG_Context* context, bool wait)
+{
+  if(!context)
+    return 0;
+
+  auto backend = static_cast<Provider*>(self);
+  auto result  = reinterpret_cast<Context*>(context)->FinishReadbacks(wait);
+  if(result.has_error())
+  {
+    result.error().log(backend);
+    return 0;
+  }
+  return result.value();
+}
+
+uintptr_t Provider::CreateAtlas(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i pagesize,
+                                enum FG_PixelFormat format, uint32_t maxpages)
+{
+  if(!context || pagesize.x <= 0 || pagesize.y <= 0)
+    return 0;
+
+  auto backend = static_cast<Provider*>(self);
+  auto f       = Format::Create(format, false);
+  if(!f.bytes())
+  {
+    CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Atlas format has no client memory layout").log(backend);
+    return 0;
+  }
+
+  // Pages are only created once something is inserted, so an unused atlas costs nothing.
+  auto atlas = new Atlas(pagesize, f, maxpages);
+  reinterpret_cast<Context*>(context)->AddAtlas(atlas);
+  return reinterpret_cast<uintptr_t>(atlas);
+}
+
+int Provider::FindAtlasRegion(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                              FG_AtlasRegion* region)
+{
+  if(!context || !atlas || !region)
+    return ERR_INVALID_PARAMETER;
+
+  auto a = reinterpret_cast<Atlas*>(atlas);
+  if(auto r = a->find(key, reinterpret_cast<Context*>(context)->Frame()))
+  {
+    *region = FG_AtlasRegion{ a->texture(r->page), r->uv };
+    return ERR_SUCCESS;
+  }
+  return ERR_INVALID_PARAMETER;
+}
+
+int Provider::InsertAtlasRegion(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                                FG_Vec2i size, const void* data, FG_AtlasRegion* region)
+{
+  if(!context || !atlas || !region)
+    return ERR_INVALID_PARAMETER;
+
+  auto backend = static_cast<Provider*>(self);
+  auto a       = reinterpret_cast<Atlas*>(atlas);
+  if(auto r = a->insert(reinterpret_cast<Context*>(context), key, size, data))
+  {
+    *region = FG_AtlasRegion{ a->texture(r.value().page), r.value().uv };
+    return ERR_SUCCESS;
+  }
+  else
+    return r.log(backend);
+}
+
+int Provider::DestroyAtlas(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas)
+{
+  if(!context || !atlas)
+    return ERR_INVALID_PARAMETER;
+  reinterpret_cast<Context*>(context)->RemoveAtlas(reinterpret_cast<Atlas*>(atlas));
+  delete reinterpret_cast<Atlas*>(atlas);
+  return ERR_SUCCESS;
+}
+
+uintptr_t Provider::OpenTextureStream(FG_GraphicsInterface* self, FG_Context* context, const char* path,
+                                      FG_Sampler* sampler, FG_Resource* texture)
+{
+  if(!context || !path || !sampler || !texture)
+    return 0;
+
+  if(auto e = TextureStream::open(path, *sampler, &static_cast<Provider*>(self)->_samplers))
+  {
+    *texture = e.value()->texture();
+    return reinterpret_cast<uintptr_t>(e.value().release());
+  }
+  else
+    e.log(static_cast<Provider*>(self));
+  return 0;
+}
+
+int Provider::StreamTexture(FG_GraphicsInterface* self, FG_Context* context, uintptr_t stream, uint64_t budget,
+                            uint32_t* remaining)
+{
+  if(!context || !stream)
+    return ERR_INVALID_PARAMETER;
+
+  auto s = reinterpret_cast<TextureStream*>(stream);
+  LOG_ERROR(static_cast<Provider*>(self), s->stream(reinterpret_cast<Context*>(context), budget));
+  if(remaining)
+    *remaining = s->remaining();
+  return ERR_SUCCESS;
+}
+
+int Provider::CloseTextureStream(FG_GraphicsInterface* self, uintptr_t stream)
+{
+  if(!stream)
+    return ERR_INVALID_PARAMETER;
+  delete reinterpret_cast<TextureStream*>(stream);
+  return ERR_SUCCESS;
+}
+
+int Provider::GetFrameStats(FG_GraphicsInterface* self, FG_Context* context, FG_FrameStats* stats)
+{
+  if(!context || !stats)
+    return ERR_INVALID_PARAMETER;
+  *stats = reinterpret_cast<Context*>(context)->GetFrameStats();
+  return ERR_SUCCESS;
+}
+
+int Provider::GetMemoryReport(FG_GraphicsInterface* self, FG_Context* context, FG_MemoryReport* report)
+{
+  if(!context || !report)
+    return ERR_INVALID_PARAMETER;
+
+  constexpr auto IsVertex = [](const ResourceInfo& info) {
+    return info.target == GL_ARRAY_BUFFER || info.target == GL_ELEMENT_ARRAY_BUFFER;
+  };
+  constexpr auto IsUniform = [](const ResourceInfo& info) {
+    return info.target == GL_UNIFORM_BUFFER || info.target == GL_SHADER_STORAGE_BUFFER;
+  };
+  constexpr auto IsCompressed = [](const ResourceInfo& info) { return Format::Map(info.format).compressed(); };
+
+  FG_MemoryReport r    = { 0 };
+  r.buffer_bytes       = ResourceTable::bytes(REF_BUFFER);
+  r.vertex_bytes       = ResourceTable::bytes(REF_BUFFER, IsVertex);
+  r.uniform_bytes      = ResourceTable::bytes(REF_BUFFER, IsUniform);
+  r.texture_bytes      = ResourceTable::bytes(REF_TEXTURE);
+  r.compressed_bytes   = ResourceTable::bytes(REF_TEXTURE, IsCompressed);
+  r.renderbuffer_bytes = ResourceTable::bytes(REF_RENDERBUFFER);
+  r.n_buffers          = ResourceTable::count(REF_BUFFER);
+  r.n_textures         = ResourceTable::count(REF_TEXTURE);
+  r.n_renderbuffers    = ResourceTable::count(REF_RENDERBUFFER);
+  r.budget             = ResourceTable::budget();
+
+  // Both extensions count in KiB, and need the context current, which it already is if it's the one being drawn to.
+  if(GLAD_GL_NVX_gpu_memory_info)
+  {
+    GLint dedicated = 0, available = 0;
+    glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated);
+    glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+    r.device_bytes    = uint64_t(dedicated) * 1024;
+    r.available_bytes = uint64_t(available) * 1024;
+  }
+  else if(GLAD_GL_ATI_meminfo)
+  {
+    GLint free[4] = { 0 };
+    glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, free);
+    r.available_bytes = uint64_t(free[0]) * 1024;
+  }
+
+  *report = r;
+  return ERR_SUCCESS;
+}
+
+int Provider::SetMemoryBudget(FG_GraphicsInterface* self, uint64_t bytes)
+{
+  ResourceTable::set_budget(bytes);
+  return ERR_SUCCESS;
+}
+
+int Provider::SetErrorCheckLevel(FG_GraphicsInterface* self, enum FG_ErrorCheck level)
+{
+  if(level < FG_ErrorCheck_Always || level > FG_ErrorCheck_Off)
+    return ERR_INVALID_PARAMETER;
+  static_cast<Provider*>(self)->SetErrorCheck(static_cast<ErrorCheck>(level));
+  return ERR_SUCCESS;
+}
+
 int Provider::BeginDraw(FG_GraphicsInterface* self, FG_Context* context, FG_Rect* area)
 {
   if(!context)
@@ -708,52 +1305,197 @@ int Provider::DestroyGL(FG_GraphicsInterface* self)
 
 int Provider::LoadGL(GLADloadproc loader)
 {
+  std::lock_guard lock(_lock);
+
+  // glGetString is dispatched through whichever context is current, so the pointer from the last load can identify
+  // the driver of the new context before anything is loaded for it.
+  std::string driver = glGetString ? DriverName() : std::string();
+
+  if(!driver.empty() && driver == _driver)
+  {
+    SetErrorCheck(_errorcheck);
+    return ERR_SUCCESS;
+  }
+
+  _hascaps = false;
+  _driver.clear();
   if(!gladLoadGLLoader(loader))
     LOG(FG_Level_Error, "gladLoadGL failed");
   else
+  {
+    // Glad only loads glGetString with everything else, so the very first context has to ask for its driver now.
+    _driver = driver.empty() ? DriverName() : std::move(driver);
+
+    // The debug callback belongs to the context, so it has to be installed again for every context we load.
+    SetErrorCheck(_errorcheck);
     return ERR_SUCCESS;
+  }
 
   return ERR_UNKNOWN;
 }
 
-Provider::Provider(void* log_context, FG_Log log) : _logctx(log_context), _log(log), _insidelist(false)
-{
-  getCaps               = &GetCaps;
-  createContext         = &CreateContext;
-  resizeContext         = &ResizeContext;
-  compileShader         = &CompileShader;
-  destroyShader         = &DestroyShader;
-  createCommandList     = &CreateCommandList;
-  destroyCommandList    = &DestroyCommandList;
-  clear                 = &Clear;
-  copyResource          = &CopyResource;
-  copySubresource       = &CopySubresource;
-  copyResourceRegion    = &CopyResourceRegion;
-  draw                  = &DrawGL;
-  drawIndexed           = &DrawIndexed;
-  drawMesh              = &DrawMesh;
-  dispatch              = &Dispatch;
-  syncPoint             = &SyncPoint;
-  setPipelineState      = &SetPipelineState;
-  setViewports          = &SetViewports;
-  setScissors           = &SetScissors;
-  setShaderConstants    = &SetShaderConstants;
-  execute               = &Execute;
-  createPipelineState   = &CreatePipelineState;
-  createComputePipeline = &CreateComputePipeline;
-  destroyPipelineState  = &DestroyPipelineState;
-  createBuffer          = &CreateBuffer;
-  createTexture         = &CreateTexture;
-  createRenderTarget    = &CreateRenderTarget;
-  destroyResource       = &DestroyResource;
-  mapResource           = &MapResource;
-  unmapResource         = &UnmapResource;
-  destroy               = &DestroyGL;
+bool Provider::SetCompileThreads(uint32_t threads)
+{
+  if(!threads)
+  {
+    _asynccompile = false;
+    return true;
+  }
+
+  if(!GLAD_GL_KHR_parallel_shader_compile || !glMaxShaderCompilerThreadsKHR)
+  {
+    LOG(FG_Level_Warning, "KHR_parallel_shader_compile is not supported, shaders will be compiled synchronously");
+    return false;
+  }
+
+  glMaxShaderCompilerThreadsKHR(threads);
+  _asynccompile = true;
+  return true;
+}
+
+bool Provider::SetProgramCache(const char* directory)
+{
+  if(_programcache.set_directory(directory))
+    return true;
+
+  LOG(FG_Level_Error, "Couldn't create program cache directory: ", directory);
+  return false;
+}
+
+void Provider::SetErrorCheck(ErrorCheck level)
+{
+  _errorcheck     = level;
+  ErrorCheckLevel = level;
+
+  if(!GLAD_GL_KHR_debug || !glDebugMessageCallback)
+  {
+    if(level == ErrorCheck::ERRORCHECK_DEBUG_CALLBACK)
+      LOG(FG_Level_Warning, "KHR_debug is not supported, OpenGL errors will not be reported");
+    return;
+  }
+
+  // With ERRORCHECK_ALWAYS every error is already caught by glGetError(), so the callback would only log it twice.
+  if(level == ErrorCheck::ERRORCHECK_COMMAND_LIST || level == ErrorCheck::ERRORCHECK_DEBUG_CALLBACK)
+  {
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(&DebugCallback, this);
+  }
+  else
+  {
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+  }
+}
+
+void APIENTRY Provider::DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                      const GLchar* message, const void* userParam)
+{
+  auto backend = const_cast<Provider*>(reinterpret_cast<const Provider*>(userParam));
+  FG_Level level;
+
+  switch(severity)
+  {
+  case GL_DEBUG_SEVERITY_HIGH: level = FG_Level_Error; break;
+  case GL_DEBUG_SEVERITY_MEDIUM: level = FG_Level_Warning; break;
+  case GL_DEBUG_SEVERITY_LOW: level = FG_Level_Notice; break;
+  default: level = FG_Level_Debug; break;
+  }
+
+  // Drivers are very chatty about performance hints, so release builds only forward errors and warnings.
+#ifndef _DEBUG
+  if(type != GL_DEBUG_TYPE_ERROR && level > FG_Level_Warning)
+    return;
+#endif
+
+  backend->LOG(level, "OpenGL Debug: ", message, id);
+}
+
+Provider::Provider(void* log_context, FG_Log log) :
+  _logctx(log_context),
+  _log(log),
+  _commandlists(0),
+  _asynccompile(false),
+  _hascaps(false),
+  _errorcheck(DEFAULT_ERRORCHECK)
+{
+  getCaps                    = &GetCaps;
+  createContext              = &CreateContext;
+  resizeContext              = &ResizeContext;
+  destroyContext             = &DestroyContext;
+  beginDraw                  = &BeginDraw;
+  endDraw                    = &EndDraw;
+  compileShader              = &CompileShader;
+  destroyShader              = &DestroyShader;
+  createCommandList          = &CreateCommandList;
+  destroyCommandList         = &DestroyCommandList;
+  clear                      = &Clear;
+  copyResource               = &CopyResource;
+  copySubresource            = &CopySubresource;
+  copyResourceRegion         = &CopyResourceRegion;
+  draw                       = &DrawGL;
+  drawIndexed                = &DrawIndexed;
+  drawMesh                   = &DrawMesh;
+  drawIndirect               = &DrawIndirect;
+  drawIndexedIndirect        = &DrawIndexedIndirect;
+  drawQuads                  = &DrawQuads;
+  dispatch                   = &Dispatch;
+  dispatchGroups             = &DispatchGroups;
+  dispatchIndirect           = &DispatchIndirect;
+  declareAccess              = &DeclareAccess;
+  syncPoint                  = &SyncPoint;
+  beginRegion                = &BeginRegion;
+  endRegion                  = &EndRegion;
+  setPipelineState           = &SetPipelineState;
+  setVertexBuffers           = &SetVertexBuffers;
+  setViewports               = &SetViewports;
+  setScissors                = &SetScissors;
+  setShaderConstants         = &SetShaderConstants;
+  setPreparedShaderConstants = &SetPreparedShaderConstants;
+  execute                    = &Execute;
+  createFence                = &CreateFence;
+  waitFence                  = &WaitFence;
+  queryFence                 = &QueryFence;
+  destroyFence               = &DestroyFence;
+  createPipelineState        = &CreatePipelineState;
+  createComputePipeline      = &CreateComputePipeline;
+  destroyPipelineState       = &DestroyPipelineState;
+  queryPipelineState         = &QueryPipelineState;
+  prepareShaderParameters    = &PrepareShaderParameters;
+  destroyShaderParameters    = &DestroyShaderParameters;
+  createBuffer               = &CreateBuffer;
+  createImmutableBuffer      = &CreateImmutableBuffer;
+  createTexture              = &CreateTexture;
+  createRenderTarget         = &CreateRenderTarget;
+  acquireRenderTarget        = &AcquireRenderTarget;
+  releaseRenderTarget        = &ReleaseRenderTarget;
+  destroyResource            = &DestroyResource;
+  mapResource                = &MapResource;
+  unmapResource              = &UnmapResource;
+  updateTexture              = &UpdateTexture;
+  readBuffer                 = &ReadBuffer;
+  readTexture                = &ReadTexture;
+  finishReadbacks            = &FinishReadbacks;
+  createAtlas                = &CreateAtlas;
+  findAtlasRegion            = &FindAtlasRegion;
+  insertAtlasRegion          = &InsertAtlasRegion;
+  destroyAtlas               = &DestroyAtlas;
+  openTextureStream          = &OpenTextureStream;
+  streamTexture              = &StreamTexture;
+  closeTextureStream         = &CloseTextureStream;
+  getFrameStats              = &GetFrameStats;
+  getMemoryReport            = &GetMemoryReport;
+  setMemoryBudget            = &SetMemoryBudget;
+  setErrorCheck              = &SetErrorCheckLevel;
+  destroy                    = &DestroyGL;
 
   this->LOG(FG_Level_Notice, "Initializing fgOpenGL...");
 }
 
-Provider::~Provider() {}
+Provider::~Provider()
+{
+  if(auto n = _commandlists.load())
+    this->LOG(FG_Level_Warning, "Command lists were never destroyed: ", n);
+}
 
 extern "C" FG_COMPILER_DLLEXPORT FG_GraphicsInterface* fgOpenGL(void* log_context, FG_Log log)
 {
@@ -18,7 +18,11 @@ limitations under the License.
 #define FG__OPENGL_H
 
 #include "Context.hpp"
+#include "ProgramCache.hpp"
+#include "PipelineCache.hpp"
 #include <vector>
+#include <atomic>
+#include <mutex>
 
 #define LOG(level, msg, ...) Log(level, __FILE__, __LINE__, msg __VA_OPT__(, ) __VA_ARGS__)
 
@@ -36,11 +40,33 @@ namespace GL {
         fgLogImpl<&FreeImpl>(_log, _logctx, level, file, line, msg, std::tuple<Args...>(std::forward<Args>(args)...),
                              std::index_sequence_for<Args...>{});
     }
+    // Entry points only depend on the driver, so they're only resolved again if the current context comes from a
+    // different one than the last context that was loaded, which also throws away the cached caps.
     FG_COMPILER_DLLEXPORT int LoadGL(GLADloadproc loader);
+    // Changes how often OpenGL errors are checked for this provider's contexts. Must be called with a context current to
+    // install the debug callback.
+    FG_COMPILER_DLLEXPORT void SetErrorCheck(ErrorCheck level);
+    inline ErrorCheck GetErrorCheck() const noexcept { return _errorcheck; }
+    // Caches linked program binaries in directory, or stops caching them if directory is empty. Returns false if the
+    // directory couldn't be created.
+    FG_COMPILER_DLLEXPORT bool SetProgramCache(const char* directory);
+    // Once threads is non-zero, shaders and pipelines are compiled in the background by up to that many driver threads,
+    // or as many as the driver wants if it's ~0U. Requires KHR_parallel_shader_compile and a current context.
+    FG_COMPILER_DLLEXPORT bool SetCompileThreads(uint32_t threads);
+    inline bool IsAsyncCompile() const noexcept { return _asynccompile; }
+    inline GLExpected<void> LinkProgram(ProgramObject& program, uint64_t* deferred = nullptr) noexcept
+    {
+      return _programcache.link(program, this, deferred);
+    }
+    inline GLExpected<void> FinishProgram(const ProgramObject& program, uint64_t key) noexcept
+    {
+      return _programcache.finish(program, key, this);
+    }
     static void FreeImpl(char* p) { free(p); }
     static FG_Caps GetCaps(FG_GraphicsInterface* self);
     static FG_Context* CreateContext(FG_GraphicsInterface* self, FG_Vec2i size, enum FG_PixelFormat backbuffer);
     static int ResizeContext(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size);
+    static int DestroyContext(FG_GraphicsInterface* self, FG_Context* context);
     static FG_Shader CompileShader(FG_GraphicsInterface* self, FG_Context* context, enum FG_ShaderStage stage,
                                    const char* source);
     static int DestroyShader(FG_GraphicsInterface* self, FG_Context* context, FG_Shader shader);
@@ -59,14 +85,35 @@ namespace GL {
     static int DrawIndexed(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t indexcount,
                            uint32_t instancecount, uint32_t startindex, int startvertex, uint32_t startinstance);
     static int DrawMesh(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t first, uint32_t count);
+    static int DrawIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer, uint32_t offset,
+                            uint32_t drawcount, uint32_t stride);
+    static int DrawIndexedIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                                   uint32_t offset, uint32_t drawcount, uint32_t stride);
+    static int DrawQuads(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource texture, const FG_Quad* quads,
+                         uint32_t count);
     static int Dispatch(FG_GraphicsInterface* self, FG_CommandList* commands);
+    static int DispatchGroups(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t x, uint32_t y, uint32_t z);
+    static int DispatchIndirect(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                                uint32_t offset);
+    static int DeclareAccess(FG_GraphicsInterface* self, FG_CommandList* commands, const FG_ResourceAccess* accesses,
+                             uint32_t count);
     static int SyncPoint(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t barrier_flags);
+    static int BeginRegion(FG_GraphicsInterface* self, FG_CommandList* commands, const char* name);
+    static int EndRegion(FG_GraphicsInterface* self, FG_CommandList* commands);
     static int SetPipelineState(FG_GraphicsInterface* self, FG_CommandList* commands, uintptr_t state);
+    static int SetVertexBuffers(FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t first,
+                                const FG_Resource* buffers, const uint32_t* offsets, uint32_t count);
     static int SetViewports(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Viewport* viewports, uint32_t count);
     static int SetScissors(FG_GraphicsInterface* self, FG_CommandList* commands, FG_Rect* rects, uint32_t count);
     static int SetShaderConstants(FG_GraphicsInterface* self, FG_CommandList* commands, const FG_ShaderParameter* uniforms,
                                   const FG_ShaderValue* values, uint32_t count);
+    static int SetPreparedShaderConstants(FG_GraphicsInterface* self, FG_CommandList* commands, uintptr_t parameters,
+                                          const FG_ShaderValue* values);
     static int Execute(FG_GraphicsInterface* self, FG_Context* context, FG_CommandList* commands);
+    static FG_Fence CreateFence(FG_GraphicsInterface* self, FG_Context* context);
+    static int WaitFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence, uint64_t timeout);
+    static int QueryFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence);
+    static int DestroyFence(FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence);
     static uintptr_t CreatePipelineState(FG_GraphicsInterface* self, FG_Context* context, FG_PipelineState* pipelinestate,
                                          FG_Resource rendertarget, FG_Blend* blends, FG_Resource* vertexbuffer,
                                          GLsizei* strides, uint32_t n_buffers, FG_VertexParameter* attributes,
@@ -74,27 +121,64 @@ namespace GL {
     static uintptr_t CreateComputePipeline(FG_GraphicsInterface* self, FG_Context* context, FG_Shader computeshader,
                                            FG_Vec3i workgroup, uint32_t flags);
     static int DestroyPipelineState(FG_GraphicsInterface* self, FG_Context* context, uintptr_t state);
+    static int QueryPipelineState(FG_GraphicsInterface* self, FG_Context* context, uintptr_t state);
+    static uintptr_t PrepareShaderParameters(FG_GraphicsInterface* self, FG_Context* context, uintptr_t state,
+                                             const FG_ShaderParameter* uniforms, uint32_t count);
+    static int DestroyShaderParameters(FG_GraphicsInterface* self, FG_Context* context, uintptr_t parameters);
     static FG_Resource CreateBuffer(FG_GraphicsInterface* self, FG_Context* context, void* data, uint32_t bytes,
                                     enum FG_Usage usage);
+    static FG_Resource CreateImmutableBuffer(FG_GraphicsInterface* self, FG_Context* context, void* data,
+                                             uint32_t bytes, enum FG_Usage usage, uint32_t access);
     static FG_Resource CreateTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size, enum FG_Usage usage,
-                                     enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount);
+                                     enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount,
+                                     uint32_t flags);
     static FG_Resource CreateRenderTarget(FG_GraphicsInterface* self, FG_Context* context, FG_Resource depthstencil,
                                           FG_Resource* textures, uint32_t n_textures, int attachments);
+    static FG_Resource AcquireRenderTarget(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size,
+                                           enum FG_PixelFormat format, int samples, int attachments,
+                                           FG_Sampler* sampler, FG_Resource* texture);
+    static int ReleaseRenderTarget(FG_GraphicsInterface* self, FG_Context* context, FG_Resource rendertarget);
     static int DestroyResource(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource);
     static void* MapResource(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, uint32_t offset,
                              uint32_t length, enum FG_Usage usage, uint32_t access);
     static int UnmapResource(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, enum FG_Usage usage);
+    static int UpdateTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Resource texture, int level,
+                             FG_Vec2i offset, FG_Vec2i size, enum FG_PixelFormat format, const void* data);
+    static int ReadBuffer(FG_GraphicsInterface* self, FG_Context* context, FG_Resource buffer, uint32_t offset,
+                          uint32_t bytes, FG_ReadbackCallback callback, void* user);
+    static int ReadTexture(FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, FG_Vec2i offset,
+                           FG_Vec2i size, enum FG_PixelFormat format, FG_ReadbackCallback callback, void* user);
+    static int FinishReadbacks(FG_GraphicsInterface* self, FG_Context* context, bool wait);
+    static uintptr_t CreateAtlas(FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i pagesize,
+                                 enum FG_PixelFormat format, uint32_t maxpages);
+    static int FindAtlasRegion(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                               FG_AtlasRegion* region);
+    static int InsertAtlasRegion(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                                 FG_Vec2i size, const void* data, FG_AtlasRegion* region);
+    static int DestroyAtlas(FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas);
+    static uintptr_t OpenTextureStream(FG_GraphicsInterface* self, FG_Context* context, const char* path,
+                                       FG_Sampler* sampler, FG_Resource* texture);
+    static int StreamTexture(FG_GraphicsInterface* self, FG_Context* context, uintptr_t stream, uint64_t budget,
+                             uint32_t* remaining);
+    static int CloseTextureStream(FG_GraphicsInterface* self, uintptr_t stream);
+    static int GetFrameStats(FG_GraphicsInterface* self, FG_Context* context, FG_FrameStats* stats);
+    static int GetMemoryReport(FG_GraphicsInterface* self, FG_Context* context, FG_MemoryReport* report);
+    static int SetMemoryBudget(FG_GraphicsInterface* self, uint64_t bytes);
+    static int SetErrorCheckLevel(FG_GraphicsInterface* self, enum FG_ErrorCheck level);
     static int BeginDraw(FG_GraphicsInterface* self, FG_Context* context, FG_Rect* area);
     static int EndDraw(FG_GraphicsInterface* self, FG_Context* context);
     static int DestroyGL(FG_GraphicsInterface* self);
 
     static void ErrorCallback(int error, const char* description);
+    static void APIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                       const GLchar* message, const void* userParam);
     static void JoystickCallback(int id, int connected);
 
     static constexpr FG_Resource NULL_RESOURCE = 0;
     static constexpr FG_Shader NULL_SHADER     = 0;
     static constexpr uintptr_t NULL_PIPELINE   = 0;
     static constexpr void* NULL_COMMANDLIST    = nullptr;
+    static constexpr FG_Fence NULL_FENCE       = 0;
 
 #ifdef AUTO_FRIEND
     friend AUTO_FRIEND;
@@ -102,8 +186,17 @@ namespace GL {
 
   protected:
     FG_Log _log;
-    bool _insidelist;
+    std::atomic<uint32_t> _commandlists; // Number of live command lists, only used to catch mismatched create/destroy
     void* _logctx;
+    ProgramCache _programcache;
+    PipelineCache _pipelines;
+    SamplerCache _samplers; // Shared by every texture this provider creates
+    bool _asynccompile;
+    std::string _driver; // Vendor, renderer and version of the loaded entry points, empty until something is loaded
+    FG_Caps _caps;
+    bool _hascaps;
+    ErrorCheck _errorcheck;
+    std::mutex _lock; // Guards the pipeline cache, the loaded driver and the caps, which the loader thread also uses
   };
 }
 
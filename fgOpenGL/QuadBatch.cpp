@@ -0,0 +1,167 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "QuadBatch.hpp"
+#include "Context.hpp"
+#include <algorithm>
+#include <cassert>
+
+using namespace GL;
+
+namespace {
+  // _buildPosUV only fills in posUV, so this is the smallest vertex type it accepts.
+  struct PosUV
+  {
+    float posUV[4];
+  };
+}
+
+QuadBatch::~QuadBatch()
+{
+  if(_indices)
+    glDeleteBuffers(1, &_indices);
+#ifndef USE_EMULATED_VAOS
+  if(_vao)
+    glDeleteVertexArrays(1, &_vao);
+#endif
+}
+
+void QuadBatch::begin(FG_Resource texture, FG_Vec2 texsize) noexcept
+{
+  assert(empty());
+  _texture = texture;
+  _texsize = { texsize.x > 0 ? texsize.x : 1, texsize.y > 0 ? texsize.y : 1 };
+}
+
+size_t QuadBatch::append(std::span<const FG_Quad> quads)
+{
+  size_t count = std::min(quads.size(), MAX_QUADS - _vertices.size() / 4);
+  size_t start = _vertices.size();
+  _vertices.resize(start + count * 4);
+
+  for(size_t i = 0; i < count; ++i)
+  {
+    PosUV v[4];
+    Context::_buildPosUV(v, quads[i].area, quads[i].uv, _texsize.x, _texsize.y);
+
+    auto& c = quads[i].color;
+    for(int j = 0; j < 4; ++j)
+    {
+      auto& vertex = _vertices[start + i * 4 + j];
+      std::copy(std::begin(v[j].posUV), std::end(v[j].posUV), vertex.posUV);
+      vertex.color[0] = c.r;
+      vertex.color[1] = c.g;
+      vertex.color[2] = c.b;
+      vertex.color[3] = c.a;
+    }
+  }
+
+  return count;
+}
+
+GLExpected<void> QuadBatch::_create()
+{
+  // Two triangles per quad, matching the vertex order of _buildPosUV: top-left, top-right, bottom-left, bottom-right.
+  std::vector<GLushort> indices(MAX_QUADS * 6);
+  for(size_t i = 0; i < MAX_QUADS; ++i)
+  {
+    auto base          = static_cast<GLushort>(i * 4);
+    indices[i * 6 + 0] = base + 0;
+    indices[i * 6 + 1] = base + 1;
+    indices[i * 6 + 2] = base + 2;
+    indices[i * 6 + 3] = base + 1;
+    indices[i * 6 + 4] = base + 3;
+    indices[i * 6 + 5] = base + 2;
+  }
+
+#ifndef USE_EMULATED_VAOS
+  RETURN_ERROR(CALLGL(glGenVertexArrays, 1, &_vao));
+  RETURN_ERROR(CALLGL(glBindVertexArray, _vao));
+#endif
+  RETURN_ERROR(CALLGL(glGenBuffers, 1, &_indices));
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, _indices));
+  RETURN_ERROR(
+    CALLGL(glBufferData, GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW));
+  return _ring.create(GL_ARRAY_BUFFER, RING_SIZE, sizeof(float));
+}
+
+GLExpected<void> QuadBatch::_bindAttributes(GLuint program, GLintptr offset)
+{
+  if(_program != program)
+  {
+    // The vertex array remembers which attributes are enabled, so turn off whatever the last program used.
+    if(_posuv >= 0)
+    {
+      RETURN_ERROR(CALLGL(glDisableVertexAttribArray, _posuv));
+    }
+    if(_color >= 0)
+    {
+      RETURN_ERROR(CALLGL(glDisableVertexAttribArray, _color));
+    }
+
+    auto posuv = CALLGL(glGetAttribLocation, program, "vPosUV");
+    if(posuv.has_error())
+      return std::move(posuv.error());
+    auto color = CALLGL(glGetAttribLocation, program, "vColor");
+    if(color.has_error())
+      return std::move(color.error());
+
+    _program = program;
+    _posuv   = posuv.value();
+    _color   = color.value();
+    if(_posuv < 0)
+      return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Quad pipelines need a vec4 vPosUV vertex attribute");
+  }
+
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_ARRAY_BUFFER, _ring.buffer()));
+  RETURN_ERROR(CALLGL(glEnableVertexAttribArray, _posuv));
+  RETURN_ERROR(CALLGL(glVertexAttribPointer, _posuv, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                      reinterpret_cast<void*>(offset + offsetof(Vertex, posUV))));
+  if(_color >= 0)
+  {
+    RETURN_ERROR(CALLGL(glEnableVertexAttribArray, _color));
+    RETURN_ERROR(CALLGL(glVertexAttribPointer, _color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                        reinterpret_cast<void*>(offset + offsetof(Vertex, color))));
+  }
+  return {};
+}
+
+GLExpected<void> QuadBatch::draw(GLuint program)
+{
+  if(_vertices.empty())
+    return {};
+
+  if(!_ring.is_valid())
+  {
+    RETURN_ERROR(_create());
+  }
+#ifndef USE_EMULATED_VAOS
+  else
+  {
+    RETURN_ERROR(CALLGL(glBindVertexArray, _vao));
+  }
+#else
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, _indices));
+#endif
+
+  auto offset = _ring.write(_vertices.data(), _vertices.size() * sizeof(Vertex));
+  if(offset.has_error())
+    return std::move(offset.error());
+
+  // The ring only hands out float aligned offsets, so each run gets its own attribute pointers instead of relying on
+  // a base vertex, which OpenGL ES 2 doesn't have.
+  RETURN_ERROR(_bindAttributes(program, offset.value()));
+  GLsizei count = static_cast<GLsizei>(_vertices.size() / 4 * 6);
+  _vertices.clear();
+  RETURN_ERROR(CALLGL(glDrawElements, GL_TRIANGLES, count, GL_UNSIGNED_SHORT, nullptr));
+
+#ifdef USE_EMULATED_VAOS
+  // Without a real vertex array, these stay enabled for whatever draws next.
+  RETURN_ERROR(CALLGL(glDisableVertexAttribArray, _posuv));
+  if(_color >= 0)
+  {
+    RETURN_ERROR(CALLGL(glDisableVertexAttribArray, _color));
+  }
+#endif
+  return {};
+}
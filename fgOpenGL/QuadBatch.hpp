@@ -0,0 +1,64 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__QUAD_BATCH_H
+#define GL__QUAD_BATCH_H
+
+#include "RingBuffer.hpp"
+#include "feather/graphics_interface.h"
+#include <vector>
+#include <span>
+
+namespace GL {
+  // Collects textured, tinted rects into one streaming vertex buffer, so a run of quads that share a texture becomes a
+  // single indexed draw. Quads are never reordered, because blending relies on painter's order, so only neighbouring
+  // quads are merged.
+  struct QuadBatch
+  {
+    struct Vertex
+    {
+      float posUV[4];
+      uint8_t color[4]; // RGBA, unlike FG_Color8
+    };
+
+    QuadBatch() noexcept :
+      _texture(0), _texsize({ 1, 1 }), _vao(0), _indices(0), _program(0), _posuv(-1), _color(-1)
+    {}
+    ~QuadBatch();
+    QuadBatch(const QuadBatch&)            = delete;
+    QuadBatch& operator=(const QuadBatch&) = delete;
+
+    // Starts a new run of quads. Must only be called while the batch is empty.
+    void begin(FG_Resource texture, FG_Vec2 texsize) noexcept;
+    // Queues as many quads as still fit, and returns how many were taken.
+    size_t append(std::span<const FG_Quad> quads);
+    // Streams every queued quad into the ring and draws them with program, then empties the batch. The batch's own
+    // vertex array is left bound.
+    GLExpected<void> draw(GLuint program);
+
+    inline bool empty() const noexcept { return _vertices.empty(); }
+    inline size_t bytes() const noexcept { return _vertices.size() * sizeof(Vertex); }
+    inline bool full() const noexcept { return _vertices.size() >= MAX_QUADS * 4; }
+    inline FG_Resource texture() const noexcept { return _texture; }
+    inline GLuint vao() const noexcept { return _vao; }
+
+    static constexpr size_t MAX_QUADS     = 4096; // Keeps every index of a batch inside a GLushort
+    static constexpr GLsizeiptr RING_SIZE = 1 << 20;
+
+  protected:
+    GLExpected<void> _create();
+    GLExpected<void> _bindAttributes(GLuint program, GLintptr offset);
+
+    std::vector<Vertex> _vertices;
+    FG_Resource _texture;
+    FG_Vec2 _texsize;
+    RingBuffer _ring;
+    GLuint _vao;
+    GLuint _indices;
+    GLuint _program; // The program that _posuv and _color were looked up in
+    GLint _posuv;
+    GLint _color;
+  };
+}
+
+#endif
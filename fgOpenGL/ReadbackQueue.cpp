@@ -0,0 +1,231 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ReadbackQueue.hpp"
+#include "Buffer.hpp"
+#include "FrameBuffer.hpp"
+#include <algorithm>
+
+using namespace GL;
+
+ReadbackQueue::~ReadbackQueue()
+{
+  // Readbacks that never finished are dropped without calling back, nothing that asked for them is left to answer.
+  for(auto& p : _pending)
+  {
+    glDeleteSync(p.fence);
+    glDeleteBuffers(1, &p.staging.buffer);
+  }
+  for(auto& s : _free)
+    glDeleteBuffers(1, &s.buffer);
+  if(_framebuffer)
+    glDeleteFramebuffers(1, &_framebuffer);
+}
+
+GLExpected<void> ReadbackQueue::read_buffer(FG_Resource buffer, GLintptr offset, GLsizeiptr bytes,
+                                            FG_ReadbackCallback callback, void* user)
+{
+  auto info = ResourceTable::find(REF_BUFFER, buffer);
+  if(!info)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Can only read back buffers");
+  if(!bytes)
+    bytes = info->bytes - offset;
+  if(offset < 0 || bytes <= 0 || offset + bytes > info->bytes)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Readback range is outside of the buffer");
+
+  auto staging = _acquire(bytes);
+  if(!staging)
+    return std::move(staging.error());
+
+  if(auto src = Buffer(buffer).bind(GL_COPY_READ_BUFFER))
+  {
+    if(auto dest = Buffer(staging.value().buffer).bind(GL_COPY_WRITE_BUFFER))
+    {
+      if(auto e = CALLGL(glCopyBufferSubData, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, 0, bytes); !e)
+      {
+        _release(staging.value());
+        return std::move(e.error());
+      }
+    }
+    else
+    {
+      _release(staging.value());
+      return std::move(dest.error());
+    }
+  }
+  else
+  {
+    _release(staging.value());
+    return std::move(src.error());
+  }
+
+  return _submit(staging.value(), bytes, callback, user);
+}
+
+GLExpected<void> ReadbackQueue::read_pixels(FG_Resource source, GLuint backbuffer, FG_Vec2i offset, FG_Vec2i size,
+                                            const Format& format, FG_ReadbackCallback callback, void* user)
+{
+  const GLsizeiptr bytes = static_cast<GLsizeiptr>(format.image_bytes(size));
+  if(bytes <= 0 || format.compressed())
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Nothing to read back, or format has no client memory layout");
+
+  GLuint framebuffer = backbuffer;
+  FG_Resource texture = 0;
+  if(Framebuffer::validate(source))
+    framebuffer = Framebuffer(source);
+  else if(Texture::validate(source))
+  {
+    if(!_framebuffer)
+    {
+      RETURN_ERROR(CALLGL(glGenFramebuffers, 1, &_framebuffer));
+    }
+    framebuffer = _framebuffer;
+    texture     = source;
+  }
+  else if(source)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Can only read back textures and render targets");
+
+  auto staging = _acquire(bytes);
+  if(!staging)
+    return std::move(staging.error());
+
+  auto e = _pack(framebuffer, texture, staging.value().buffer, offset, size, format);
+
+  // Leaving the texture attached would keep it alive and make the next framebuffer completeness check lie.
+  if(texture)
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+  if(!e)
+  {
+    _release(staging.value());
+    return std::move(e.error());
+  }
+
+  return _submit(staging.value(), bytes, callback, user);
+}
+
+GLExpected<void> ReadbackQueue::_pack(GLuint framebuffer, FG_Resource texture, GLuint staging, FG_Vec2i offset,
+                                      FG_Vec2i size, const Format& format)
+{
+  RETURN_ERROR(CALLGL(glBindFramebuffer, GL_READ_FRAMEBUFFER, framebuffer));
+  if(texture)
+  {
+    RETURN_ERROR(CALLGL(glFramebufferTexture2D, GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                        Texture(texture), 0));
+  }
+  // The default framebuffer of a window reads from its back buffer already, and has no color attachments to pick.
+  if(framebuffer != 0)
+  {
+    RETURN_ERROR(CALLGL(glReadBuffer, GL_COLOR_ATTACHMENT0));
+  }
+
+  // With a pack buffer bound, glReadPixels only queues the copy and returns, instead of waiting to hand the pixels over.
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_PIXEL_PACK_BUFFER, staging));
+  RETURN_ERROR(CALLGL(glPixelStorei, GL_PACK_ALIGNMENT, 1)); // Rows are tightly packed
+  auto e = CALLGL(glReadPixels, offset.x, offset.y, size.x, size.y, format.components, format.type, nullptr);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if(!e)
+    return std::move(e.error());
+  return {};
+}
+
+GLExpected<int> ReadbackQueue::finish(bool wait)
+{
+  size_t ready = 0;
+  for(; ready < _pending.size(); ++ready)
+  {
+    auto result = glClientWaitSync(_pending[ready].fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? ~0ULL : 0);
+    if(result == GL_WAIT_FAILED)
+    {
+      GL_ERROR("glClientWaitSync");
+      return CUSTOM_ERROR(ERR_INVALID_CALL, "glClientWaitSync");
+    }
+    if(result == GL_TIMEOUT_EXPIRED)
+      break;
+  }
+
+  // Callbacks may issue more readbacks, so the finished ones are taken out of the queue before any of them run.
+  std::vector<Pending> finished(_pending.begin(), _pending.begin() + ready);
+  _pending.erase(_pending.begin(), _pending.begin() + ready);
+
+  for(auto& p : finished)
+  {
+    glDeleteSync(p.fence);
+    glBindBuffer(GL_COPY_READ_BUFFER, p.staging.buffer);
+    auto data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, p.bytes, GL_MAP_READ_BIT);
+
+    // A readback that can't be mapped still calls back, with nothing, so whatever waits on it isn't left hanging.
+    (*p.callback)(p.user, data, data ? static_cast<uint32_t>(p.bytes) : 0);
+    if(data)
+    {
+      // The callback may have bound something else, so the staging buffer has to be bound again to unmap it.
+      glBindBuffer(GL_COPY_READ_BUFFER, p.staging.buffer);
+      glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    _release(p.staging);
+  }
+
+  return static_cast<int>(finished.size());
+}
+
+GLExpected<ReadbackQueue::Staging> ReadbackQueue::_acquire(GLsizeiptr bytes)
+{
+  // The smallest free buffer big enough is reused, so one large readback doesn't grab the buffer every small one needs.
+  auto best = _free.end();
+  for(auto i = _free.begin(); i != _free.end(); ++i)
+  {
+    if(i->capacity >= bytes && (best == _free.end() || i->capacity < best->capacity))
+      best = i;
+  }
+
+  if(best != _free.end())
+  {
+    auto staging = *best;
+    _free.erase(best);
+    return staging;
+  }
+
+  Staging staging = { 0, bytes };
+  RETURN_ERROR(CALLGL(glGenBuffers, 1, &staging.buffer));
+  RETURN_ERROR(CALLGL(glBindBuffer, GL_COPY_WRITE_BUFFER, staging.buffer));
+  // GL_STREAM_READ tells the driver to put the buffer in memory the CPU can read quickly, instead of VRAM.
+  auto e = CALLGL(glBufferData, GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STREAM_READ);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  if(!e)
+  {
+    glDeleteBuffers(1, &staging.buffer);
+    return std::move(e.error());
+  }
+  return staging;
+}
+
+void ReadbackQueue::_release(Staging staging) noexcept
+{
+  if(_free.size() < MAX_FREE)
+    _free.push_back(staging);
+  else
+  {
+    // Keeps the largest buffers, which are the most expensive to allocate again.
+    auto smallest = std::min_element(_free.begin(), _free.end(),
+                                     [](const Staging& l, const Staging& r) { return l.capacity < r.capacity; });
+    if(smallest->capacity < staging.capacity)
+      std::swap(*smallest, staging);
+    glDeleteBuffers(1, &staging.buffer);
+  }
+}
+
+GLExpected<void> ReadbackQueue::_submit(Staging staging, GLsizeiptr bytes, FG_ReadbackCallback callback, void* user)
+{
+  auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  // Without a flush, a fence that is only ever polled might never reach the GPU.
+  glFlush();
+  if(GLError e{ "glFenceSync", __FILE__, __LINE__ }; e.has_error())
+  {
+    _release(staging);
+    return e;
+  }
+
+  _pending.push_back(Pending{ staging, bytes, fence, callback, user });
+  return {};
+}
@@ -0,0 +1,67 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__READBACK_QUEUE_H
+#define GL__READBACK_QUEUE_H
+
+#include "GLError.hpp"
+#include "Format.hpp"
+#include "feather/graphics_interface.h"
+#include <vector>
+
+namespace GL {
+  // Copies buffers and framebuffer regions into staging buffers on the GPU, and only maps them once a fence says the
+  // copy is done, so reading results back never waits for the GPU to catch up with the frame that asked for them.
+  // Staging buffers are kept around after their readback finishes, because screenshots and picking tend to read back
+  // the same amount every frame.
+  struct ReadbackQueue
+  {
+    ReadbackQueue() noexcept : _framebuffer(0) {}
+    ~ReadbackQueue();
+    ReadbackQueue(const ReadbackQueue&)            = delete;
+    ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+    GLExpected<void> read_buffer(FG_Resource buffer, GLintptr offset, GLsizeiptr bytes, FG_ReadbackCallback callback,
+                                 void* user);
+    // Reads a region of the first color attachment of a render target or texture, or of backbuffer if source is 0, as
+    // tightly packed pixels of format. Like glReadPixels, offset is from the bottom left and rows arrive bottom first.
+    GLExpected<void> read_pixels(FG_Resource source, GLuint backbuffer, FG_Vec2i offset, FG_Vec2i size,
+                                 const Format& format, FG_ReadbackCallback callback, void* user);
+    // Calls the callback of every readback the GPU has finished, in the order they were issued, or waits for all of them
+    // if wait is set. Returns how many callbacks were called.
+    GLExpected<int> finish(bool wait);
+    inline size_t pending() const noexcept { return _pending.size(); }
+
+    static constexpr size_t MAX_FREE = 4; // Staging buffers kept for reuse, the rest are deleted once they're read
+
+  protected:
+    struct Staging
+    {
+      GLuint buffer;
+      GLsizeiptr capacity;
+    };
+
+    struct Pending
+    {
+      Staging staging;
+      GLsizeiptr bytes;
+      GLsync fence;
+      FG_ReadbackCallback callback;
+      void* user;
+    };
+
+    GLExpected<Staging> _acquire(GLsizeiptr bytes);
+    void _release(Staging staging) noexcept;
+    // Queues the copy of a framebuffer region into the staging buffer. If texture is set, it is attached to
+    // framebuffer first, and stays attached even if this fails.
+    GLExpected<void> _pack(GLuint framebuffer, FG_Resource texture, GLuint staging, FG_Vec2i offset, FG_Vec2i size,
+                           const Format& format);
+    GLExpected<void> _submit(Staging staging, GLsizeiptr bytes, FG_ReadbackCallback callback, void* user);
+
+    std::vector<Pending> _pending; // Fences signal in order, so only the front ever has to be checked
+    std::vector<Staging> _free;
+    GLuint _framebuffer; // Textures are attached to this to read them with glReadPixels
+  };
+}
+
+#endif
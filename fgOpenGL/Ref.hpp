@@ -16,6 +16,7 @@ namespace GL {
     REF_RENDERBUFFER = ((FG_Resource)4 << (sizeof(FG_Resource) * 8 - 3)),
     REF_SAMPLER      = ((FG_Resource)5 << (sizeof(FG_Resource) * 8 - 3)),
     REF_MASK         = ~((FG_Resource)0b111 << (sizeof(FG_Resource) * 8 - 3)),
+    REF_TYPE_MASK    = ((FG_Resource)0b111 << (sizeof(FG_Resource) * 8 - 3)),
   };
 
   struct BindRef
@@ -111,7 +112,7 @@ namespace GL {
     }
     GLExpected<void> constexpr reset() noexcept
     {
-      if(T::empty())
+      if(!T::empty())
       {
         (*T::DESTROY)(T::get());
         T::operator=(T());
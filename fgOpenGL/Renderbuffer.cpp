@@ -3,6 +3,7 @@
 
 #include "ProviderGL.hpp"
 #include "Renderbuffer.hpp"
+#include <algorithm>
 
 using namespace GL;
 
@@ -17,6 +18,9 @@ GLExpected<Owned<Renderbuffer>> Renderbuffer::create(GLenum target, Format forma
   GLuint rbgl;
   RETURN_ERROR(CALLGL(glGenRenderbuffers, 1, &rbgl));
   Owned<Renderbuffer> rb(rbgl);
+  // Like textures, the size is only an estimate of what the driver allocates.
+  const auto bytes = static_cast<GLsizeiptr>(format.image_bytes(size) * std::max(samples, 1));
+  ResourceTable::insert(REF_RENDERBUFFER, rbgl, ResourceInfo{ target, format.internalformat, size, bytes });
   if(auto bind = rb.bind(target))
   {
     RETURN_ERROR(CALLGL(glRenderbufferStorageMultisample, target, samples, format.internalformat, size.x, size.y));
@@ -9,7 +9,10 @@
 namespace GL {
   struct Renderbuffer : Ref
   {
-    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) { glDeleteRenderbuffers(1, &i); };
+    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) {
+      ResourceTable::erase(REF_RENDERBUFFER, i);
+      glDeleteRenderbuffers(1, &i);
+    };
 
     explicit constexpr Renderbuffer(GLuint buffer) noexcept : Ref(buffer) {}
     explicit constexpr Renderbuffer(FG_Resource buffer) noexcept : Ref(static_cast<GLuint>(buffer & REF_MASK))
@@ -24,13 +27,10 @@ namespace GL {
     constexpr ~Renderbuffer() noexcept          = default;
     GLExpected<BindRef> bind(GLenum target) const noexcept;
 
-    inline operator FG_Resource() const noexcept { return _ref | REF_RENDERBUFFER; }
+    inline operator FG_Resource() const noexcept { return ResourceTable::handle(REF_RENDERBUFFER, _ref); }
     Renderbuffer& operator=(const Renderbuffer&) = default;
 
-    static bool validate(FG_Resource res) noexcept
-    {
-      return ((res & REF_RENDERBUFFER) != 0) && (glIsRenderbuffer(static_cast<GLuint>(res & REF_MASK)) == GL_TRUE);
-    }
+    static bool validate(FG_Resource res) noexcept { return ResourceTable::validate(REF_RENDERBUFFER, res); }
     static GLExpected<Owned<Renderbuffer>> create(GLenum target, Format format, FG_Vec2i size, int samples = 0);
   };
 }
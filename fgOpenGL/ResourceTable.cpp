@@ -0,0 +1,163 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ResourceTable.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+
+using namespace GL;
+
+namespace {
+  struct Slot
+  {
+    FG_Resource generation;
+    bool live;
+    ResourceInfo info;
+  };
+
+  constexpr int TYPE_SHIFT = sizeof(FG_Resource) * 8 - 3;
+  // 64-bit handles keep the GL name in the low 32 bits and the generation between it and the type. 32-bit handles
+  // only have room for the name.
+  constexpr int GENERATION_SHIFT = sizeof(FG_Resource) > sizeof(GLuint) ? sizeof(GLuint) * 8 : 0;
+  constexpr FG_Resource GENERATION_MASK =
+    GENERATION_SHIFT ? (static_cast<FG_Resource>(REF_MASK) >> GENERATION_SHIFT) : 0;
+  constexpr FG_Resource NAME_MASK = GENERATION_SHIFT ? static_cast<GLuint>(~0U) : static_cast<FG_Resource>(REF_MASK);
+
+  // Indexed by the type bits of a handle, so slot 0 is never used. The loader thread creates resources while the
+  // main thread does, so everything here is behind one lock.
+  std::deque<Slot> Slots[8];
+  uint64_t Bytes[8]  = {};
+  uint32_t Counts[8] = {};
+  uint64_t Budget    = 0;
+  std::shared_mutex Lock;
+
+  inline FG_Resource Encode(RefType type, GLuint name, FG_Resource generation) noexcept
+  {
+    FG_Resource res = type | (name & NAME_MASK);
+    if constexpr(GENERATION_SHIFT != 0)
+      res |= (generation & GENERATION_MASK) << GENERATION_SHIFT;
+    return res;
+  }
+
+  inline Slot* Lookup(RefType type, GLuint name) noexcept
+  {
+    auto& slots = Slots[type >> TYPE_SHIFT];
+    return (name != 0 && name < slots.size()) ? &slots[name] : nullptr;
+  }
+}
+
+FG_Resource ResourceTable::insert(RefType type, GLuint name, const ResourceInfo& info) noexcept
+{
+  std::unique_lock lock(Lock);
+  auto& slots = Slots[type >> TYPE_SHIFT];
+  if(name >= slots.size())
+    slots.resize(name + 1, Slot{ 0, false, {} });
+
+  auto& slot = slots[name];
+  if(slot.live) // Tracking the same name twice replaces what it was created with, instead of counting it twice.
+  {
+    Bytes[type >> TYPE_SHIFT] -= slot.info.bytes;
+    --Counts[type >> TYPE_SHIFT];
+  }
+  slot.live = true;
+  slot.info = info;
+  Bytes[type >> TYPE_SHIFT] += info.bytes;
+  ++Counts[type >> TYPE_SHIFT];
+  return Encode(type, name, slot.generation);
+}
+
+void ResourceTable::erase(RefType type, GLuint name) noexcept
+{
+  std::unique_lock lock(Lock);
+  if(auto slot = Lookup(type, name); slot && slot->live)
+  {
+    slot->live = false;
+    ++slot->generation;
+    Bytes[type >> TYPE_SHIFT] -= slot->info.bytes;
+    --Counts[type >> TYPE_SHIFT];
+  }
+}
+
+FG_Resource ResourceTable::handle(RefType type, GLuint name) noexcept
+{
+  std::shared_lock lock(Lock);
+  if(auto slot = Lookup(type, name); slot && slot->live)
+    return Encode(type, name, slot->generation);
+  return type | name;
+}
+
+std::optional<ResourceInfo> ResourceTable::find(RefType type, FG_Resource res) noexcept
+{
+  if(ResourceTable::type(res) != type)
+    return std::nullopt;
+
+  std::shared_lock lock(Lock);
+  auto slot = Lookup(type, static_cast<GLuint>(res & NAME_MASK));
+  if(!slot || !slot->live)
+    return std::nullopt;
+  if constexpr(GENERATION_SHIFT != 0)
+  {
+    if(((res & REF_MASK) >> GENERATION_SHIFT) != (slot->generation & GENERATION_MASK))
+      return std::nullopt;
+  }
+  return slot->info;
+}
+
+void ResourceTable::set_sampler(GLuint texture, GLuint sampler) noexcept
+{
+  std::unique_lock lock(Lock);
+  if(auto slot = Lookup(REF_TEXTURE, texture); slot && slot->live)
+    slot->info.sampler = sampler;
+}
+GLuint ResourceTable::sampler(GLuint texture) noexcept
+{
+  std::shared_lock lock(Lock);
+  auto slot = Lookup(REF_TEXTURE, texture);
+  return (slot && slot->live) ? slot->info.sampler : 0;
+}
+
+uint64_t ResourceTable::bytes(RefType type) noexcept
+{
+  std::shared_lock lock(Lock);
+  return Bytes[type >> TYPE_SHIFT];
+}
+uint32_t ResourceTable::count(RefType type) noexcept
+{
+  std::shared_lock lock(Lock);
+  return Counts[type >> TYPE_SHIFT];
+}
+
+uint64_t ResourceTable::bytes(RefType type, bool (*filter)(const ResourceInfo&)) noexcept
+{
+  std::shared_lock lock(Lock);
+  uint64_t total = 0;
+  for(auto& slot : Slots[type >> TYPE_SHIFT])
+  {
+    if(slot.live && filter(slot.info))
+      total += slot.info.bytes;
+  }
+  return total;
+}
+
+uint64_t ResourceTable::budget() noexcept
+{
+  std::shared_lock lock(Lock);
+  return Budget;
+}
+void ResourceTable::set_budget(uint64_t bytes) noexcept
+{
+  std::unique_lock lock(Lock);
+  Budget = bytes;
+}
+
+bool ResourceTable::over_budget(uint64_t extra) noexcept
+{
+  std::shared_lock lock(Lock);
+  if(!Budget)
+    return false;
+  uint64_t total = extra;
+  for(auto b : Bytes)
+    total += b;
+  return total > Budget;
+}
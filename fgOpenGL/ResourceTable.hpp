@@ -0,0 +1,58 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__RESOURCE_TABLE_H
+#define GL__RESOURCE_TABLE_H
+
+#include "Ref.hpp"
+#include <optional>
+
+namespace GL {
+  // What a resource was created with, kept on the CPU so it never has to be queried back from the driver.
+  struct ResourceInfo
+  {
+    GLenum target; // Like GL_TEXTURE_2D or GL_ARRAY_BUFFER
+    GLint format;  // Internal format of textures and renderbuffers
+    FG_Vec2i size;
+    GLsizeiptr bytes; // Length of buffers, or an estimate of the storage of textures and renderbuffers
+    GLuint sampler;   // Sampler object bound along with a texture, or 0 if it uses its own parameters
+  };
+
+  // Generational slot map of every texture, buffer, renderbuffer and framebuffer handed out through the interface. Each
+  // GL name is a slot whose generation is bumped when the name is deleted, and handles carry the generation they were
+  // created with, so validating a handle is a bounds check and a compare instead of a glIs* round trip, and a handle
+  // to a deleted object stays invalid after GL reuses its name. Handles don't say which provider made them, so there's
+  // one table for the whole process, which assumes every context shares its objects. 32-bit handles have no room for a
+  // generation, so they only catch use-after-free until the name is reused.
+  struct ResourceTable
+  {
+    // Starts tracking name and returns its handle.
+    static FG_Resource insert(RefType type, GLuint name, const ResourceInfo& info) noexcept;
+    // Called whenever a tracked name is deleted. Untracked names are ignored.
+    static void erase(RefType type, GLuint name) noexcept;
+    // The current handle of name, or one that won't validate if name isn't tracked.
+    static FG_Resource handle(RefType type, GLuint name) noexcept;
+    // Returns nothing unless res is a live handle of the given type. The info is copied out under the lock, because
+    // another thread may delete the resource or reuse its slot as soon as it's released.
+    static std::optional<ResourceInfo> find(RefType type, FG_Resource res) noexcept;
+    static inline bool validate(RefType type, FG_Resource res) noexcept { return find(type, res).has_value(); }
+    static inline RefType type(FG_Resource res) noexcept { return static_cast<RefType>(res & REF_TYPE_MASK); }
+    // The sampler object assigned to a live texture name, or 0. Textures are bound by name, so these skip the handle.
+    static void set_sampler(GLuint texture, GLuint sampler) noexcept;
+    static GLuint sampler(GLuint texture) noexcept;
+
+    // Running totals of the bytes and objects of each type that are currently live.
+    static uint64_t bytes(RefType type) noexcept;
+    static uint32_t count(RefType type) noexcept;
+    // Adds up the bytes of every live object of the given type that filter accepts. Walks the whole table, so it's only
+    // meant for reports.
+    static uint64_t bytes(RefType type, bool (*filter)(const ResourceInfo&)) noexcept;
+    // Nothing stops allocations past the budget, but caches check it and give memory back instead of growing. A budget
+    // of 0 means there isn't one.
+    static uint64_t budget() noexcept;
+    static void set_budget(uint64_t bytes) noexcept;
+    static bool over_budget(uint64_t extra = 0) noexcept;
+  };
+}
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "RingBuffer.hpp"
+#include <cstring>
+
+using namespace GL;
+
+RingBuffer::~RingBuffer()
+{
+  for(auto& fence : _fences)
+    if(fence)
+      glDeleteSync(fence);
+
+  // Deleting the buffer also releases a persistent mapping.
+  if(_buffer)
+    glDeleteBuffers(1, &_buffer);
+}
+
+GLExpected<void> RingBuffer::create(GLenum target, GLsizeiptr capacity, GLint alignment) noexcept
+{
+  RETURN_ERROR(CALLGL(glGenBuffers, 1, &_buffer));
+  RETURN_ERROR(CALLGL(glBindBuffer, target, _buffer));
+  _target    = target;
+  _capacity  = capacity;
+  _head      = 0;
+  _alignment = alignment > 0 ? alignment : 1;
+  _region    = 0;
+
+  if(glBufferStorage != nullptr)
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    RETURN_ERROR(CALLGL(glBufferStorage, target, capacity, nullptr, flags));
+    auto map = CALLGL(glMapBufferRange, target, 0, capacity, flags);
+    if(map.has_error())
+      return std::move(map.error());
+    if(!map.value())
+      return CUSTOM_ERROR(ERR_NULL, "glMapBufferRange returned NULL");
+    _mapped = reinterpret_cast<std::byte*>(map.value());
+    return {};
+  }
+
+  RETURN_ERROR(CALLGL(glBufferData, target, capacity, nullptr, GL_STREAM_DRAW));
+  return {};
+}
+
+GLExpected<GLintptr> RingBuffer::write(const void* data, GLsizeiptr bytes) noexcept
+{
+  if(bytes > _capacity)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Write is larger than the entire ring buffer");
+
+  GLintptr offset = ((_head + _alignment - 1) / _alignment) * _alignment;
+  bool wrap       = offset + bytes > _capacity;
+  if(wrap)
+    offset = 0;
+
+  if(_mapped)
+  {
+    if(wrap)
+    {
+      // Everything that reads the rest of the buffer has been issued by now, so all of it can be fenced before
+      // starting back at the first region.
+      RETURN_ERROR(_advance(_capacity, _capacity));
+      _region = 0;
+      ++_generation;
+    }
+    RETURN_ERROR(_advance(offset, offset + bytes));
+    memcpy(_mapped + offset, data, bytes);
+    _head = offset + bytes;
+    return offset;
+  }
+
+  RETURN_ERROR(CALLGL(glBindBuffer, _target, _buffer));
+
+  if(wrap)
+  {
+    // Orphan the old storage instead of waiting for the GPU to finish reading it.
+    RETURN_ERROR(CALLGL(glBufferData, _target, _capacity, nullptr, GL_STREAM_DRAW));
+    ++_generation;
+  }
+
+  auto map = CALLGL(glMapBufferRange, _target, offset, bytes,
+                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  if(map.has_error())
+    return std::move(map.error());
+  if(!map.value())
+    return CUSTOM_ERROR(ERR_NULL, "glMapBufferRange returned NULL");
+
+  memcpy(map.value(), data, bytes);
+  RETURN_ERROR(CALLGL(glUnmapBuffer, _target));
+  _head = offset + bytes;
+  return offset;
+}
+
+GLExpected<void> RingBuffer::_advance(GLintptr start, GLintptr end) noexcept
+{
+  // The commands reading a write are only issued after it returns, so a region can't be fenced while the head is still
+  // in it. It is fenced by the first write that starts past it instead.
+  const int first = static_cast<int>((start * REGIONS) / _capacity);
+  for(; _region < first && _region < REGIONS; ++_region)
+  {
+    auto fence = CALLGL(glFenceSync, GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if(fence.has_error())
+      return std::move(fence.error());
+    // A region the head skipped over was never written this lap, so nothing has to wait for its old fence.
+    if(_fences[_region])
+      glDeleteSync(_fences[_region]);
+    _fences[_region] = fence.value();
+  }
+
+  // end is exclusive, so a write that ends exactly on a region boundary stays in the region it started in. Every
+  // region the write touches may still be read by the GPU from the last lap.
+  const int last = end > start ? static_cast<int>(((end - 1) * REGIONS) / _capacity) : first - 1;
+  for(int r = first; r <= last && r < REGIONS; ++r)
+  {
+    RETURN_ERROR(_wait(_fences[r]));
+    _fences[r] = nullptr;
+  }
+  return {};
+}
+
+GLExpected<void> RingBuffer::_wait(GLsync fence) noexcept
+{
+  if(!fence)
+    return {};
+
+  // Only flush on the first attempt, after that the fence is guaranteed to be on its way to the GPU.
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  for(;;)
+  {
+    auto result = CALLGL(glClientWaitSync, fence, flags, 1000000);
+    if(result.has_error() || result.value() != GL_TIMEOUT_EXPIRED)
+    {
+      glDeleteSync(fence);
+      if(result.has_error())
+        return std::move(result.error());
+      if(result.value() == GL_WAIT_FAILED)
+        return CUSTOM_ERROR(ERR_INVALID_CALL, "glClientWaitSync failed");
+      return {};
+    }
+    flags = 0;
+  }
+}
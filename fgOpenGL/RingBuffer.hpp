@@ -0,0 +1,56 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__RING_BUFFER_H
+#define GL__RING_BUFFER_H
+
+#include "GLError.hpp"
+#include <cstddef>
+
+namespace GL {
+  // One large buffer that transient data, like uniform blocks or dynamic vertices, is streamed through. If
+  // glBufferStorage is available, the buffer is mapped once with persistent, coherent storage and writes are plain
+  // memcpys. The ring is split into regions that are fenced once the head has left them, so a write only ever waits on
+  // the GPU if it laps a region that is still being read. Otherwise each write goes through an unsynchronized map of a
+  // fresh range, and the whole buffer is orphaned when it wraps.
+  struct RingBuffer
+  {
+    RingBuffer() noexcept :
+      _buffer(0), _target(0), _capacity(0), _head(0), _alignment(1), _generation(0), _mapped(nullptr), _region(0), _fences{}
+    {}
+    ~RingBuffer();
+    RingBuffer(const RingBuffer&)            = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    GLExpected<void> create(GLenum target, GLsizeiptr capacity, GLint alignment) noexcept;
+    // Copies bytes into the ring and returns the offset they were written at. The unsynchronized fallback leaves the
+    // buffer bound to its target, the persistent path doesn't touch any bindings.
+    GLExpected<GLintptr> write(const void* data, GLsizeiptr bytes) noexcept;
+
+    inline bool is_valid() const noexcept { return _buffer != 0; }
+    inline bool is_persistent() const noexcept { return _mapped != nullptr; }
+    inline GLuint buffer() const noexcept { return _buffer; }
+    inline GLenum target() const noexcept { return _target; }
+    // Incremented whenever the ring wraps, which invalidates every offset handed out before.
+    inline uint32_t generation() const noexcept { return _generation; }
+
+    static constexpr int REGIONS = 4;
+
+  protected:
+    // Fences every region that ends before start, then waits on every region between start and end.
+    GLExpected<void> _advance(GLintptr start, GLintptr end) noexcept;
+    static GLExpected<void> _wait(GLsync fence) noexcept;
+
+    GLuint _buffer;
+    GLenum _target;
+    GLsizeiptr _capacity;
+    GLintptr _head;
+    GLint _alignment;
+    uint32_t _generation;
+    std::byte* _mapped;
+    int _region;
+    GLsync _fences[REGIONS];
+  };
+}
+
+#endif
@@ -0,0 +1,131 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "SamplerCache.hpp"
+#include "ProviderGL.hpp"
+#include "Texture.hpp"
+#include "EnumMapping.hpp"
+#include "ResourceTable.hpp"
+#include <cstring>
+
+using namespace GL;
+
+SamplerCache::~SamplerCache()
+{
+  // The provider can outlive its last context, and then these calls do nothing, since the samplers went with it.
+  if(glDeleteSamplers)
+  {
+    for(auto [key, sampler] : _samplers)
+      glDeleteSamplers(1, &sampler);
+  }
+}
+
+bool SamplerCache::Key::operator==(const Key& right) const noexcept
+{
+  return border == right.border && !memcmp(floats, right.floats, sizeof(floats)) &&
+         !memcmp(bytes, right.bytes, sizeof(bytes));
+}
+
+size_t SamplerCache::KeyHash::operator()(const Key& key) const noexcept
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix      = [&hash](uint64_t v) { hash = (hash ^ v) * 1099511628211ULL; };
+  mix(key.border);
+  for(auto f : key.floats)
+    mix(f);
+  for(auto b : key.bytes)
+    mix(b);
+  return static_cast<size_t>(hash);
+}
+
+SamplerCache::Key SamplerCache::_key(const FG_Sampler& sampler) noexcept
+{
+  Key key;
+  key.border = sampler.border_color.v;
+  memcpy(&key.floats[0], &sampler.mip_bias, sizeof(float));
+  memcpy(&key.floats[1], &sampler.min_lod, sizeof(float));
+  memcpy(&key.floats[2], &sampler.max_lod, sizeof(float));
+  key.bytes[0] = sampler.filter;
+  key.bytes[1] = sampler.addressing[0];
+  key.bytes[2] = sampler.addressing[1];
+  key.bytes[3] = sampler.addressing[2];
+  key.bytes[4] = sampler.max_anisotropy;
+  key.bytes[5] = sampler.comparison;
+  return key;
+}
+
+GLExpected<GLuint> SamplerCache::get(const FG_Sampler& sampler) noexcept
+{
+  auto key = _key(sampler);
+  std::lock_guard lock(_lock);
+  if(auto i = _samplers.find(key); i != _samplers.end())
+    return i->second;
+
+  auto e = _create(sampler);
+  if(e.has_error())
+    return std::move(e.error());
+
+  _samplers[key] = e.value();
+  return e.value();
+}
+
+GLExpected<void> SamplerCache::assign(GLuint texture, const FG_Sampler& sampler) noexcept
+{
+  auto e = get(sampler);
+  if(e.has_error())
+    return std::move(e.error());
+
+  ResourceTable::set_sampler(texture, e.value());
+  return {};
+}
+
+GLExpected<void> SamplerBindings::bind(GLuint unit, GLuint texture) noexcept
+{
+  if(!SamplerCache::supported() || unit >= UNITS)
+    return {};
+
+  GLuint sampler = ResourceTable::sampler(texture);
+  if(_bound[unit] != sampler)
+  {
+    RETURN_ERROR(CALLGL(glBindSampler, unit, sampler));
+    _bound[unit] = sampler;
+  }
+  return {};
+}
+
+GLExpected<GLuint> SamplerCache::_create(const FG_Sampler& sampler) noexcept
+{
+  GLuint s;
+  RETURN_ERROR(CALLGL(glGenSamplers, 1, &s));
+
+  Filter f;
+  f.value = sampler.filter;
+
+  // Textures always have their level range set to the levels they actually have, so the mipmapped minification filter
+  // can't make a texture without mips incomplete.
+  RETURN_ERROR(CALLGL(glSamplerParameteri, s, GL_TEXTURE_MAG_FILTER, f.mag_filter ? GL_LINEAR : GL_NEAREST));
+  RETURN_ERROR(CALLGL(glSamplerParameteri, s, GL_TEXTURE_MIN_FILTER, Filter::GLFilter(f.mip_filter, f.min_filter)));
+
+  RETURN_ERROR(CALLGL(glSamplerParameterf, s, GL_TEXTURE_MAX_LOD, sampler.max_lod));
+  RETURN_ERROR(CALLGL(glSamplerParameterf, s, GL_TEXTURE_MIN_LOD, sampler.min_lod));
+  RETURN_ERROR(CALLGL(glSamplerParameterf, s, GL_TEXTURE_LOD_BIAS, sampler.mip_bias));
+
+  if(f.anisotropic)
+  {
+    RETURN_ERROR(CALLGL(glSamplerParameterf, s, GL_TEXTURE_MAX_ANISOTROPY, sampler.max_anisotropy));
+  }
+
+  if(sampler.comparison != FG_Comparison_Disabled && f.comparison)
+  {
+    if(sampler.comparison >= ArraySize(ComparisonMapping))
+    {
+      glDeleteSamplers(1, &s);
+      return CUSTOM_ERROR(ERR_INVALID_ENUM, "Comparison enum outside of bounds");
+    }
+
+    RETURN_ERROR(CALLGL(glSamplerParameteri, s, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE));
+    RETURN_ERROR(CALLGL(glSamplerParameteri, s, GL_TEXTURE_COMPARE_FUNC, ComparisonMapping[sampler.comparison]));
+  }
+
+  return s;
+}
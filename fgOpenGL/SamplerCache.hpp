@@ -0,0 +1,75 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__SAMPLER_CACHE_H
+#define GL__SAMPLER_CACHE_H
+
+#include "Ref.hpp"
+#include <mutex>
+#include <unordered_map>
+
+namespace GL {
+  // Deduplicates sampler objects by the contents of FG_Sampler, so every texture created with the same sampler state
+  // shares one GL sampler. There's one per provider, since sampler objects are shared the same way the textures
+  // using them are. Which sampler a texture was assigned is kept in the ResourceTable, so it's forgotten along with
+  // the texture, and a new texture that gets the same name starts out with none.
+  class SamplerCache
+  {
+  public:
+    SamplerCache() noexcept = default;
+    ~SamplerCache();
+    SamplerCache(const SamplerCache&)            = delete;
+    SamplerCache& operator=(const SamplerCache&) = delete;
+
+    static inline bool supported() noexcept { return glGenSamplers != nullptr; }
+    // Returns the sampler object for this state, creating it the first time it's seen.
+    GLExpected<GLuint> get(const FG_Sampler& sampler) noexcept;
+    // Makes texture use the sampler for this state whenever it's bound through SamplerBindings.
+    GLExpected<void> assign(GLuint texture, const FG_Sampler& sampler) noexcept;
+
+  protected:
+    // FG_Sampler has padding between its bytes and floats, so it's copied into this before it's hashed or compared.
+    // The floats are kept as bit patterns, so equal keys always hash the same.
+    struct Key
+    {
+      uint64_t border;
+      uint32_t floats[3];
+      uint8_t bytes[6];
+
+      bool operator==(const Key& right) const noexcept;
+    };
+    struct KeyHash
+    {
+      size_t operator()(const Key& key) const noexcept;
+    };
+
+    static Key _key(const FG_Sampler& sampler) noexcept;
+    static GLExpected<GLuint> _create(const FG_Sampler& sampler) noexcept;
+
+    std::unordered_map<Key, GLuint, KeyHash> _samplers;
+    std::mutex _lock; // The loader thread creates textures while the main thread does
+  };
+
+  // The sampler each texture unit of one context has bound. Textures that weren't assigned a sampler get sampler 0,
+  // which falls back to the parameters set on the texture itself.
+  class SamplerBindings
+  {
+  public:
+    SamplerBindings() noexcept { invalidate(); }
+    // Binds whichever sampler texture was assigned to unit, skipping the call if it's already bound there.
+    GLExpected<void> bind(GLuint unit, GLuint texture) noexcept;
+    // Forgets what is bound to each unit, for when something outside the cache may have changed it.
+    inline void invalidate() noexcept
+    {
+      for(auto& b : _bound)
+        b = ~0U;
+    }
+
+    static constexpr GLuint UNITS = 32;
+
+  protected:
+    GLuint _bound[UNITS];
+  };
+}
+
+#endif
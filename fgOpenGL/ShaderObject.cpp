@@ -35,7 +35,7 @@ GLExpected<std::string> ShaderObject::log() const noexcept
   return GLExpected<std::string>(log);
 }
 
-GLExpected<Owned<ShaderObject>> ShaderObject::create(const char* src, int type, Provider* backend) noexcept
+GLExpected<Owned<ShaderObject>> ShaderObject::create(const char* src, int type, Provider* backend, bool async) noexcept
 {
   auto shader = glCreateShader(type);
   GL_ERROR("glCreateShader");
@@ -43,6 +43,10 @@ GLExpected<Owned<ShaderObject>> ShaderObject::create(const char* src, int type,
   RETURN_ERROR(CALLGL(glShaderSource, shader, 1, &src, nullptr));
   RETURN_ERROR(CALLGL(glCompileShader, shader));
 
+  // Asking for GL_COMPILE_STATUS waits for the compile to finish, so async compiles leave it to the program's link.
+  if(async)
+    return obj;
+
   GLint status;
   RETURN_ERROR(CALLGL(glGetShaderiv, shader, GL_COMPILE_STATUS, &status));
   if(status == GL_FALSE)
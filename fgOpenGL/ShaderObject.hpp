@@ -32,7 +32,10 @@ namespace GL {
 
     ShaderObject& operator=(const ShaderObject&) noexcept = default;
 
-    static GLExpected<Owned<ShaderObject>> create(const char* src, int type, Provider* backend) noexcept;
+    // If async is true, this returns as soon as the source is handed to the driver, and compile errors are only reported
+    // once a program using the shader is linked.
+    static GLExpected<Owned<ShaderObject>> create(const char* src, int type, Provider* backend,
+                                                  bool async = false) noexcept;
     static GLenum get_type(const FG_ShaderParameter__& param);
   };
 }
@@ -0,0 +1,104 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "ProviderGL.hpp"
+#include "TargetPool.hpp"
+#include <algorithm>
+
+using namespace GL;
+
+GLExpected<FG_Resource> TargetPool::acquire(FG_Vec2i size, const Format& format, int samples, int attachments,
+                                            const FG_Sampler& sampler, uint64_t frame, SamplerCache* samplers,
+                                            FG_Resource& texture)
+{
+  if(size.x <= 0 || size.y <= 0)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Render target must not be empty");
+
+  attachments &= (FG_ClearFlag_Depth | FG_ClearFlag_Stencil);
+  for(auto& t : _targets)
+  {
+    if(!t.inuse && t.size.x == size.x && t.size.y == size.y && t.internalformat == format.internalformat &&
+       t.samples == samples && t.attachments == attachments)
+    {
+      t.inuse    = true;
+      t.lastused = frame;
+      texture    = t.color;
+      return static_cast<FG_Resource>(t.framebuffer);
+    }
+  }
+
+  Target t = { Owned<Framebuffer>(), Owned<Texture>(), Owned<Renderbuffer>(), size, format.internalformat, samples,
+               attachments, frame, true };
+  const GLenum type = samples > 0 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+  if(auto color = Texture::create2D(type, format, size, sampler, nullptr, samples, 0, samplers))
+    t.color = std::move(color.value());
+  else
+    return std::move(color.error());
+
+  FG_Resource colors[1] = { t.color };
+  if(auto fb = Framebuffer::create(GL_FRAMEBUFFER, type, 0, 0, colors, 1))
+    t.framebuffer = std::move(fb.value());
+  else
+    return std::move(fb.error());
+
+  if(attachments)
+  {
+    // Depth and stencil are never read once the pass is over, so a renderbuffer is enough, and the combined format is
+    // the one every driver supports, even if only one of them was asked for.
+    const Format depthstencil = { GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 };
+    if(auto rb = Renderbuffer::create(GL_RENDERBUFFER, depthstencil, size, samples))
+      t.depthstencil = std::move(rb.value());
+    else
+      return std::move(rb.error());
+
+    GLenum attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+    if(attachments == FG_ClearFlag_Depth)
+      attachment = GL_DEPTH_ATTACHMENT;
+    else if(attachments == FG_ClearFlag_Stencil)
+      attachment = GL_STENCIL_ATTACHMENT;
+    RETURN_ERROR(CALLGL(glBindFramebuffer, GL_FRAMEBUFFER, t.framebuffer));
+    RETURN_ERROR(CALLGL(glFramebufferRenderbuffer, GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, t.depthstencil));
+    auto status = CALLGL(glCheckFramebufferStatus, GL_FRAMEBUFFER);
+    if(status.has_error())
+      return std::move(status.error());
+    if(status.value() != GL_FRAMEBUFFER_COMPLETE)
+      return CUSTOM_ERROR(status.value(), "glCheckFramebufferStatus");
+  }
+
+  texture = t.color;
+  FG_Resource handle = t.framebuffer;
+  _targets.push_back(std::move(t));
+  return handle;
+}
+
+GLExpected<void> TargetPool::release(FG_Resource framebuffer)
+{
+  auto t = std::find_if(_targets.begin(), _targets.end(),
+                        [framebuffer](const Target& t) { return static_cast<FG_Resource>(t.framebuffer) == framebuffer; });
+  if(t == _targets.end() || !t->inuse)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Render target wasn't acquired from the pool");
+
+  t->inuse = false;
+  // Without GL_ARB_invalidate_subdata the target is still reused, a tiled GPU just stores it for nothing.
+  if(!glInvalidateFramebuffer)
+    return {};
+
+  GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_NONE };
+  GLsizei count         = 1;
+  if(t->attachments == FG_ClearFlag_Depth)
+    attachments[count++] = GL_DEPTH_ATTACHMENT;
+  else if(t->attachments == FG_ClearFlag_Stencil)
+    attachments[count++] = GL_STENCIL_ATTACHMENT;
+  else if(t->attachments)
+    attachments[count++] = GL_DEPTH_STENCIL_ATTACHMENT;
+
+  RETURN_ERROR(CALLGL(glBindFramebuffer, GL_FRAMEBUFFER, t->framebuffer));
+  return CALLGL(glInvalidateFramebuffer, GL_FRAMEBUFFER, count, attachments);
+}
+
+void TargetPool::trim(uint64_t frame) noexcept
+{
+  // Over the memory budget, keeping a target around for the next frame isn't worth it.
+  const uint64_t keep = ResourceTable::over_budget() ? 0 : KEEP_FRAMES;
+  std::erase_if(_targets, [frame, keep](const Target& t) { return !t.inuse && t.lastused + keep < frame; });
+}
@@ -0,0 +1,58 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__TARGET_POOL_H
+#define GL__TARGET_POOL_H
+
+#include "FrameBuffer.hpp"
+#include "Renderbuffer.hpp"
+#include "Format.hpp"
+#include "SamplerCache.hpp"
+#include <vector>
+
+namespace GL {
+  // Keeps the render targets of transient passes, like blurs and shadow maps, around between frames. Releasing a target
+  // hands it back to the pool with its contents invalidated, so a later pass of the same frame that asks for the same
+  // size and format reuses it, just as the next frame does, and two passes that don't overlap share the same memory.
+  // Each target has one color texture, and a depth-stencil renderbuffer if it asked for one, which only the pool can
+  // reach, so it is never read after the pass and never needs to be stored.
+  struct TargetPool
+  {
+    TargetPool() noexcept = default;
+    TargetPool(const TargetPool&)            = delete;
+    TargetPool& operator=(const TargetPool&) = delete;
+
+    // Returns a render target with a color texture of format and size, which is also written to texture. A samples
+    // count above 0 makes the texture multisampled. attachments takes FG_ClearFlag_Depth and FG_ClearFlag_Stencil.
+    GLExpected<FG_Resource> acquire(FG_Vec2i size, const Format& format, int samples, int attachments,
+                                    const FG_Sampler& sampler, uint64_t frame, SamplerCache* samplers,
+                                    FG_Resource& texture);
+    // Invalidates every attachment of framebuffer, which must have come from acquire, so a tiled GPU never writes them
+    // back to memory, and makes it available again. Nothing may read its texture afterwards.
+    GLExpected<void> release(FG_Resource framebuffer);
+    // Deletes targets that haven't been acquired in the last KEEP_FRAMES frames, or any that aren't in use if the
+    // memory budget is exceeded.
+    void trim(uint64_t frame) noexcept;
+    inline size_t size() const noexcept { return _targets.size(); }
+
+    static constexpr uint64_t KEEP_FRAMES = 3; // Passes that only run every other frame still find their target
+
+  protected:
+    struct Target
+    {
+      Owned<Framebuffer> framebuffer;
+      Owned<Texture> color;
+      Owned<Renderbuffer> depthstencil;
+      FG_Vec2i size;
+      GLint internalformat;
+      int samples;
+      int attachments;
+      uint64_t lastused;
+      bool inuse;
+    };
+
+    std::vector<Target> _targets;
+  };
+}
+
+#endif
@@ -4,12 +4,17 @@
 #include "ProviderGL.hpp"
 #include "Texture.hpp"
 #include "EnumMapping.hpp"
+#include "ImageKernels.hpp"
+#include "SamplerCache.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace GL;
 
-static GLenum GLFilter(bool mip, bool other)
+GLenum Filter::GLFilter(bool mip, bool other)
 {
   if(mip && other)
     return GL_LINEAR_MIPMAP_LINEAR;
@@ -20,20 +25,73 @@ static GLenum GLFilter(bool mip, bool other)
   return GL_NEAREST_MIPMAP_NEAREST;
 }
 
+// Allocates every level at once with immutable storage if the driver can, which lets it skip the completeness checks
+// it would otherwise redo on each draw. Returns false if the texture has to be allocated level by level instead.
+static GLExpected<bool> TexStorage(GLenum target, const Format& format, FG_Vec2i size, GLsizei levels)
+{
+  GLint sized = format.sized();
+  if(!glTexStorage2D || !sized || target == GL_PROXY_TEXTURE_2D)
+    return false;
+  RETURN_ERROR(CALLGL(glTexStorage2D, target, levels, sized, size.x, size.y));
+  return true;
+}
+
+// What the driver has to set aside for every level, which is only an estimate, since drivers pad and tile textures as
+// they see fit.
+static GLsizeiptr StorageBytes(const Format& format, FG_Vec2i size, int levels, int samples)
+{
+  size_t total = 0;
+  for(int i = 0; i < levels; ++i)
+    total += format.image_bytes(ImageKernels::MipSize(size, i));
+  return static_cast<GLsizeiptr>(total * std::max(samples, 1));
+}
+
+// Uploads one level, allocating it first unless immutable storage already did. Compressed data has to be allocated
+// with glCompressedTexImage2D before glCompressedTexSubImage2D can be used.
+static GLExpected<void> TexImage(GLenum target, GLint level, const Format& format, FG_Vec2i size, const void* data,
+                                 bool immutable)
+{
+  if(immutable)
+  {
+    if(!data)
+      return {};
+    if(format.compressed())
+      return CALLGL(glCompressedTexSubImage2D, target, level, 0, 0, size.x, size.y, format.internalformat,
+                    static_cast<GLsizei>(format.image_bytes(size)), data);
+    return CALLGL(glTexSubImage2D, target, level, 0, 0, size.x, size.y, format.components, format.type, data);
+  }
+  if(format.compressed())
+    return CALLGL(glCompressedTexImage2D, target, level, format.internalformat, size.x, size.y, 0,
+                  static_cast<GLsizei>(format.image_bytes(size)), data);
+  return CALLGL(glTexImage2D, target, level, format.internalformat, size.x, size.y, 0, format.components, format.type,
+                data);
+}
+
+// A shared sampler object overrides the texture's own parameters whenever it's bound, so they're only set when there's
+// no sampler object for the texture.
+static GLExpected<void> ApplySampler(Texture::TextureBindRef& bind, GLuint texture, const FG_Sampler& sampler,
+                                     bool mipmapped, SamplerCache* samplers)
+{
+  if(samplers && SamplerCache::supported())
+    return samplers->assign(texture, sampler);
+  return bind.apply_sampler(sampler, mipmapped);
+}
+
 GLExpected<Texture::TextureBindRef> Texture::bind(GLenum target) const noexcept
 {
   RETURN_ERROR(CALLGL(glBindTexture, target, _ref));
   return Texture::TextureBindRef{ target, [](GLenum target) { glBindTexture(target, 0); } };
 }
 
-GLExpected<void> Texture::apply_sampler(GLenum target, const FG_Sampler& sampler)
+GLExpected<void> Texture::apply_sampler(GLenum target, const FG_Sampler& sampler, bool mipmapped)
 {
   Filter f;
   f.value = sampler.filter;
 
-  // TODO: figure out when the texture has a mipmap
+  // A mipmapped minification filter on a texture without mips leaves it incomplete, and it samples as black.
   RETURN_ERROR(CALLGL(glTexParameteri, target, GL_TEXTURE_MAG_FILTER, f.mag_filter ? GL_LINEAR : GL_NEAREST));
-  RETURN_ERROR(CALLGL(glTexParameteri, target, GL_TEXTURE_MIN_FILTER, f.min_filter ? GL_LINEAR : GL_NEAREST));
+  RETURN_ERROR(CALLGL(glTexParameteri, target, GL_TEXTURE_MIN_FILTER,
+                      mipmapped ? Filter::GLFilter(f.mip_filter, f.min_filter) : (f.min_filter ? GL_LINEAR : GL_NEAREST)));
 
   RETURN_ERROR(CALLGL(glTexParameterf, target, GL_TEXTURE_MAX_LOD, sampler.max_lod));
   RETURN_ERROR(CALLGL(glTexParameterf, target, GL_TEXTURE_MIN_LOD, sampler.min_lod));
@@ -57,28 +115,135 @@ GLExpected<void> Texture::apply_sampler(GLenum target, const FG_Sampler& sampler
 }
 
 GLExpected<Owned<Texture>> Texture::create2D(GLenum target, Format format, FG_Vec2i size, const FG_Sampler& sampler,
-                                             void* data, int levelorsamples)
+                                             void* data, int levelorsamples, uint8_t flags, SamplerCache* samplers)
 {
+  // Preprocessing is only done for plain 8-bit RGBA or BGRA images, anything else is uploaded as-is.
+  const bool preprocess = (flags & (TEXTURE_MIPMAPS | TEXTURE_PREMULTIPLY)) && data && target == GL_TEXTURE_2D &&
+                          levelorsamples == 0 && format.type == GL_UNSIGNED_BYTE &&
+                          (format.components == GL_RGBA || format.components == GL_BGRA);
+  const bool srgb       = format.internalformat == GL_SRGB8_ALPHA8 || format.internalformat == GL_SRGB_ALPHA;
+
+  int levels = 1;
+  if(preprocess && (flags & TEXTURE_MIPMAPS))
+  {
+    levels = ImageKernels::MipLevels(size);
+    if(sampler.max_lod >= 0.0f && sampler.max_lod + 1.0f < levels)
+      levels = static_cast<int>(sampler.max_lod) + 1;
+  }
+
+  // Every level is generated up front into one buffer, each from the one before it. If the image isn't premultiplied,
+  // level 0 is uploaded straight from data and only the smaller levels are stored here.
+  std::vector<uint8_t> chain;
+  std::vector<size_t> offsets(levels, 0);
+  if(preprocess)
+  {
+    const bool premultiply = (flags & TEXTURE_PREMULTIPLY) != 0;
+    size_t total           = 0;
+    for(int i = premultiply ? 0 : 1; i < levels; ++i)
+    {
+      auto mip   = ImageKernels::MipSize(size, i);
+      offsets[i] = total;
+      total += size_t(mip.x) * mip.y * 4;
+    }
+    chain.resize(total);
+
+    const uint8_t* prev = reinterpret_cast<const uint8_t*>(data);
+    if(premultiply)
+    {
+      memcpy(chain.data(), data, size_t(size.x) * size.y * 4);
+      ImageKernels::Premultiply(chain.data(), size_t(size.x) * size.y, srgb);
+      prev = chain.data();
+      data = chain.data();
+    }
+
+    // Filtering premultiplied texels keeps transparent neighbours from bleeding their color into the smaller levels.
+    for(int i = 1; i < levels; ++i)
+    {
+      auto prevsize = ImageKernels::MipSize(size, i - 1);
+      ImageKernels::Downsample(prev, prevsize.x, prevsize.y, chain.data() + offsets[i], srgb);
+      prev = chain.data() + offsets[i];
+    }
+  }
+
   GLuint texgl;
   RETURN_ERROR(CALLGL(glGenTextures, 1, &texgl));
   Owned<Texture> tex(texgl);
+  const bool multisample = target == GL_TEXTURE_2D_MULTISAMPLE || target == GL_PROXY_TEXTURE_2D_MULTISAMPLE;
+  const GLsizeiptr bytes = StorageBytes(format, size, levels, multisample ? levelorsamples : 1);
+  ResourceTable::insert(REF_TEXTURE, texgl, ResourceInfo{ target, format.internalformat, size, bytes });
   if(auto bind = tex.bind(target))
   {
-    if(target == GL_TEXTURE_2D_MULTISAMPLE || target == GL_PROXY_TEXTURE_2D_MULTISAMPLE)
+    if(multisample)
     {
       RETURN_ERROR(
         CALLGL(glTexImage2DMultisample, target, levelorsamples, format.internalformat, size.x, size.y, GL_FALSE));
     }
     else
     {
-      RETURN_ERROR(CALLGL(glTexImage2D, target, levelorsamples, format.internalformat, size.x, size.y, 0, format.components,
-                          format.type, data));
+      // Uploading straight to a level other than 0 only makes sense for a mutable texture, so that stays as it was.
+      GLExpected<bool> immutable = false;
+      if(levelorsamples == 0)
+        immutable = TexStorage(target, format, size, levels);
+      if(immutable.has_error())
+        return std::move(immutable.error());
+
+      RETURN_ERROR(TexImage(target, levelorsamples, format, size, data, immutable.value()));
+      for(int i = 1; i < levels; ++i)
+      {
+        RETURN_ERROR(
+          TexImage(target, i, format, ImageKernels::MipSize(size, i), chain.data() + offsets[i], immutable.value()));
+      }
+
+      // Sampler objects always use a mipmapped minification filter, which only works if the level range is exact.
+      if(levelorsamples == 0)
+      {
+        RETURN_ERROR(CALLGL(glTexParameteri, target, GL_TEXTURE_MAX_LEVEL, levels - 1));
+      }
+    }
+
+    // Multisampled textures can only be fetched from texel by texel, so they have no sampler state at all, and setting
+    // any of it is an error.
+    if(!multisample)
+    {
+      RETURN_ERROR(ApplySampler(bind.value(), texgl, sampler, levels > 1, samplers));
+    }
+  }
+  else
+    return std::move(bind.error());
+
+  return tex;
+}
+
+GLExpected<Owned<Texture>> Texture::createMips(GLenum target, Format format, FG_Vec2i size, const FG_Sampler& sampler,
+                                               const void* const* levels, int count, SamplerCache* samplers)
+{
+  if(count < 1 || count > ImageKernels::MipLevels(size))
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "A texture needs at least one level and can't have more than a full chain");
+
+  GLuint texgl;
+  RETURN_ERROR(CALLGL(glGenTextures, 1, &texgl));
+  Owned<Texture> tex(texgl);
+  ResourceTable::insert(REF_TEXTURE, texgl,
+                        ResourceInfo{ target, format.internalformat, size, StorageBytes(format, size, count, 1) });
+  if(auto bind = tex.bind(target))
+  {
+    auto immutable = TexStorage(target, format, size, count);
+    if(immutable.has_error())
+      return std::move(immutable.error());
+
+    RETURN_ERROR(CALLGL(glPixelStorei, GL_UNPACK_ALIGNMENT, 1)); // Rows are tightly packed
+    for(int i = 0; i < count; ++i)
+    {
+      RETURN_ERROR(
+        TexImage(target, i, format, ImageKernels::MipSize(size, i), levels ? levels[i] : nullptr, immutable.value()));
     }
+    RETURN_ERROR(CALLGL(glPixelStorei, GL_UNPACK_ALIGNMENT, 4));
 
-    RETURN_ERROR(bind.value().apply_sampler(sampler));
+    RETURN_ERROR(CALLGL(glTexParameteri, target, GL_TEXTURE_MAX_LEVEL, count - 1));
+    RETURN_ERROR(ApplySampler(bind.value(), texgl, sampler, count > 1, samplers));
   }
   else
     return std::move(bind.error());
 
   return tex;
-}
\ No newline at end of file
+}
@@ -6,8 +6,11 @@
 
 #include "Ref.hpp"
 #include "Format.hpp"
+#include "ResourceTable.hpp"
 
 namespace GL {
+  class SamplerCache;
+
   union Filter
   {
     struct
@@ -27,7 +30,10 @@ namespace GL {
 
   struct Texture : Ref
   {
-    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) { glDeleteTextures(1, &i); };
+    static constexpr DESTROY_FUNC DESTROY = [](GLuint i) {
+      ResourceTable::erase(REF_TEXTURE, i);
+      glDeleteTextures(1, &i);
+    };
 
     struct TextureBindRef : BindRef
     {
@@ -76,7 +82,10 @@ namespace GL {
         }
       }
 
-      GLExpected<void> apply_sampler(const FG_Sampler& sampler) { return Texture::apply_sampler(_target, sampler); }
+      GLExpected<void> apply_sampler(const FG_Sampler& sampler, bool mipmapped) noexcept
+      {
+        return Texture::apply_sampler(_target, sampler, mipmapped);
+      }
     };
 
     explicit constexpr Texture(GLuint tex) noexcept : Ref(tex) {}
@@ -93,17 +102,28 @@ namespace GL {
     GLExpected<TextureBindRef> bind(GLenum target) const noexcept;
 
     Texture& operator=(const Texture&) noexcept = default;
-    inline operator FG_Resource() const noexcept { return _ref | REF_TEXTURE; }
+    inline operator FG_Resource() const noexcept { return ResourceTable::handle(REF_TEXTURE, _ref); }
 
-    static bool validate(FG_Resource res) noexcept
+    enum TextureFlags : uint8_t
     {
-      return ((res & REF_TEXTURE) != 0) && (glIsTexture(static_cast<GLuint>(res & REF_MASK)) == GL_TRUE);
-    }
+      TEXTURE_MIPMAPS     = 1, // Generate mips on the CPU, down to 1x1 or the sampler's max_lod
+      TEXTURE_PREMULTIPLY = 2, // Multiply the color channels by alpha before uploading
+    };
+
+    static bool validate(FG_Resource res) noexcept { return ResourceTable::validate(REF_TEXTURE, res); }
+    // If samplers is given and the driver has sampler objects, the texture is assigned a shared sampler object from it
+    // instead of having the sampler baked into its own parameters, and has to be bound through SamplerBindings.
     static GLExpected<Owned<Texture>> create2D(GLenum target, Format format, FG_Vec2i size, const FG_Sampler& sampler,
-                                               void* data = nullptr, int levelorsamples = 0);
+                                               void* data = nullptr, int levelorsamples = 0, uint8_t flags = 0,
+                                               SamplerCache* samplers = nullptr);
+    // Creates the first count levels of a mip chain from levels[i], which has to be tightly packed or, for compressed
+    // formats, exactly Format::image_bytes() large. A null levels array, or a null entry, only allocates that level.
+    static GLExpected<Owned<Texture>> createMips(GLenum target, Format format, FG_Vec2i size, const FG_Sampler& sampler,
+                                                 const void* const* levels, int count,
+                                                 SamplerCache* samplers = nullptr);
 
   private:
-    static GLExpected<void> apply_sampler(GLenum target, const FG_Sampler& sampler);
+    static GLExpected<void> apply_sampler(GLenum target, const FG_Sampler& sampler, bool mipmapped);
   };
 }
 
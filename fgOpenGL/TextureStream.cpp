@@ -0,0 +1,369 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "TextureStream.hpp"
+#include "ProviderGL.hpp"
+#include "ImageKernels.hpp"
+#include <cstring>
+#include <limits>
+
+using namespace GL;
+
+namespace {
+  constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+  struct KTX2Header
+  {
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+  };
+
+  struct KTX2Level
+  {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+  };
+
+  static_assert(sizeof(KTX2Header) == 80, "KTX2Header must match the file layout!");
+  static_assert(sizeof(KTX2Level) == 24, "KTX2Level must match the file layout!");
+
+  struct DDSPixelFormat
+  {
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourcc;
+    uint32_t rgbBitCount;
+    uint32_t rMask;
+    uint32_t gMask;
+    uint32_t bMask;
+    uint32_t aMask;
+  };
+
+  struct DDSHeader
+  {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DDSPixelFormat format;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+  };
+
+  struct DDSHeaderDX10
+  {
+    uint32_t dxgiFormat;
+    uint32_t resourceDimension;
+    uint32_t miscFlag;
+    uint32_t arraySize;
+    uint32_t miscFlags2;
+  };
+
+  static_assert(sizeof(DDSHeader) == 128, "DDSHeader must match the file layout!");
+  static_assert(sizeof(DDSHeaderDX10) == 20, "DDSHeaderDX10 must match the file layout!");
+
+  constexpr uint32_t FourCC(char a, char b, char c, char d)
+  {
+    return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+  }
+
+  constexpr uint32_t DDPF_FOURCC         = 0x4;
+  constexpr uint32_t DDPF_RGB            = 0x40;
+  constexpr uint32_t DDSCAPS2_CUBEMAP    = 0x200;
+  constexpr uint32_t DDS_DIMENSION_TEX2D = 3;
+
+  FG_PixelFormat FromVkFormat(uint32_t format)
+  {
+    switch(format)
+    {
+    case 37: return FG_PixelFormat_R8G8B8A8_UNorm;
+    case 43: return FG_PixelFormat_R8G8B8A8_UNorm_SRGB;
+    case 44: return FG_PixelFormat_B8G8R8A8_UNorm;
+    case 50: return FG_PixelFormat_B8G8R8A8_UNorm_SRGB;
+    case 131: // BC1_RGB_UNORM, which decodes the same as RGBA with the alpha bit ignored
+    case 133: return FG_PixelFormat_BC1_UNorm;
+    case 132:
+    case 134: return FG_PixelFormat_BC1_UNorm_SRGB;
+    case 135: return FG_PixelFormat_BC2_UNorm;
+    case 136: return FG_PixelFormat_BC2_UNorm_SRGB;
+    case 137: return FG_PixelFormat_BC3_UNorm;
+    case 138: return FG_PixelFormat_BC3_UNorm_SRGB;
+    case 139: return FG_PixelFormat_BC4_UNorm;
+    case 140: return FG_PixelFormat_BC4_SNorm;
+    case 141: return FG_PixelFormat_BC5_UNorm;
+    case 142: return FG_PixelFormat_BC5_SNorm;
+    case 143: return FG_PixelFormat_BC6H_UF16;
+    case 144: return FG_PixelFormat_BC6H_SF16;
+    case 145: return FG_PixelFormat_BC7_UNorm;
+    case 146: return FG_PixelFormat_BC7_UNorm_SRGB;
+    }
+    return FG_PixelFormat_Unknown;
+  }
+
+  FG_PixelFormat FromDXGIFormat(uint32_t format)
+  {
+    switch(format)
+    {
+    case 28: return FG_PixelFormat_R8G8B8A8_UNorm;
+    case 29: return FG_PixelFormat_R8G8B8A8_UNorm_SRGB;
+    case 71: return FG_PixelFormat_BC1_UNorm;
+    case 72: return FG_PixelFormat_BC1_UNorm_SRGB;
+    case 74: return FG_PixelFormat_BC2_UNorm;
+    case 75: return FG_PixelFormat_BC2_UNorm_SRGB;
+    case 77: return FG_PixelFormat_BC3_UNorm;
+    case 78: return FG_PixelFormat_BC3_UNorm_SRGB;
+    case 80: return FG_PixelFormat_BC4_UNorm;
+    case 81: return FG_PixelFormat_BC4_SNorm;
+    case 83: return FG_PixelFormat_BC5_UNorm;
+    case 84: return FG_PixelFormat_BC5_SNorm;
+    case 95: return FG_PixelFormat_BC6H_UF16;
+    case 96: return FG_PixelFormat_BC6H_SF16;
+    case 98: return FG_PixelFormat_BC7_UNorm;
+    case 99: return FG_PixelFormat_BC7_UNorm_SRGB;
+    case 87: return FG_PixelFormat_B8G8R8A8_UNorm;
+    case 91: return FG_PixelFormat_B8G8R8A8_UNorm_SRGB;
+    }
+    return FG_PixelFormat_Unknown;
+  }
+
+  // Formats written before DX10 headers existed are only described by a FourCC code or by channel masks.
+  FG_PixelFormat FromDDSPixelFormat(const DDSPixelFormat& format)
+  {
+    if(format.flags & DDPF_FOURCC)
+    {
+      switch(format.fourcc)
+      {
+      case FourCC('D', 'X', 'T', '1'): return FG_PixelFormat_BC1_UNorm;
+      case FourCC('D', 'X', 'T', '2'):
+      case FourCC('D', 'X', 'T', '3'): return FG_PixelFormat_BC2_UNorm;
+      case FourCC('D', 'X', 'T', '4'):
+      case FourCC('D', 'X', 'T', '5'): return FG_PixelFormat_BC3_UNorm;
+      case FourCC('A', 'T', 'I', '1'):
+      case FourCC('B', 'C', '4', 'U'): return FG_PixelFormat_BC4_UNorm;
+      case FourCC('B', 'C', '4', 'S'): return FG_PixelFormat_BC4_SNorm;
+      case FourCC('A', 'T', 'I', '2'):
+      case FourCC('B', 'C', '5', 'U'): return FG_PixelFormat_BC5_UNorm;
+      case FourCC('B', 'C', '5', 'S'): return FG_PixelFormat_BC5_SNorm;
+      }
+    }
+    else if((format.flags & DDPF_RGB) && format.rgbBitCount == 32 && format.aMask == 0xFF000000)
+    {
+      if(format.rMask == 0x000000FF && format.gMask == 0x0000FF00 && format.bMask == 0x00FF0000)
+        return FG_PixelFormat_R8G8B8A8_UNorm;
+      if(format.rMask == 0x00FF0000 && format.gMask == 0x0000FF00 && format.bMask == 0x000000FF)
+        return FG_PixelFormat_B8G8R8A8_UNorm;
+    }
+    return FG_PixelFormat_Unknown;
+  }
+
+  // Dimensions come straight from the file, so before anything is sized from them they have to fit in an int, and in
+  // what the driver can allocate at all.
+  GLExpected<FG_Vec2i> CheckSize(uint32_t width, uint32_t height)
+  {
+    GLint max = 0;
+    RETURN_ERROR(CALLGL(glGetIntegerv, GL_MAX_TEXTURE_SIZE, &max));
+    const uint32_t limit = max > 0 ? static_cast<uint32_t>(max) : static_cast<uint32_t>(std::numeric_limits<int>::max());
+    if(width > limit || height > limit)
+      return CUSTOM_ERROR(ERR_INVALID_FILE, "Texture file is larger than the driver's maximum texture size");
+    return FG_Vec2i{ static_cast<int>(width), static_cast<int>(height) };
+  }
+
+  bool Seek(FILE* f, uint64_t offset)
+  {
+#ifdef FG_PLATFORM_WIN32
+    return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+  }
+}
+
+TextureStream::~TextureStream()
+{
+  if(_file)
+    fclose(_file);
+}
+
+GLExpected<std::unique_ptr<TextureStream>> TextureStream::open(const char* path, const FG_Sampler& sampler,
+                                                                  SamplerCache* samplers) noexcept
+{
+  FILE* f = path ? fopen(path, "rb") : nullptr;
+  if(!f)
+    return CUSTOM_ERROR(ERR_INVALID_PARAMETER, "Couldn't open texture file");
+
+  std::unique_ptr<TextureStream> stream(new TextureStream(f));
+  uint8_t magic[4];
+  if(fread(magic, 1, sizeof(magic), f) != sizeof(magic) || !Seek(f, 0))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Texture file is too short");
+
+  if(!memcmp(magic, KTX2_IDENTIFIER, sizeof(magic)))
+  {
+    RETURN_ERROR(stream->_readKTX2());
+  }
+  else if(!memcmp(magic, "DDS ", sizeof(magic)))
+  {
+    RETURN_ERROR(stream->_readDDS());
+  }
+  else
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Texture file is neither KTX2 nor DDS");
+
+  const int count = static_cast<int>(stream->_levels.size());
+  auto tex = Texture::createMips(GL_TEXTURE_2D, stream->_format, stream->_size, sampler, nullptr, count, samplers);
+  if(tex.has_error())
+    return std::move(tex.error());
+
+  // Nothing has been uploaded yet, so start out pointing at the level that will arrive first.
+  if(auto bind = tex.value().bind(GL_TEXTURE_2D))
+  {
+    RETURN_ERROR(CALLGL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, count - 1));
+  }
+  else
+    return std::move(bind.error());
+
+  stream->_texture = Texture(tex.value().release());
+  stream->_next    = count - 1;
+  return stream;
+}
+
+GLExpected<bool> TextureStream::stream(Context* ctx, uint64_t budget) noexcept
+{
+  uint64_t uploaded = 0;
+  while(_next >= 0 && (uploaded == 0 || uploaded < budget))
+  {
+    const Level& level = _levels[_next];
+    _staging.resize(level.bytes);
+    if(!Seek(_file, level.offset) || fread(_staging.data(), 1, _staging.size(), _file) != _staging.size())
+      return CUSTOM_ERROR(ERR_INVALID_FILE, "Texture file ended before all of its mip levels");
+
+    RETURN_ERROR(
+      ctx->UpdateTexture(_texture, _next, FG_Vec2i{ 0, 0 }, ImageKernels::MipSize(_size, _next), _format, _staging.data()));
+    if(auto bind = _texture.bind(GL_TEXTURE_2D))
+    {
+      RETURN_ERROR(CALLGL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, _next));
+    }
+    else
+      return std::move(bind.error());
+
+    uploaded += level.bytes;
+    --_next;
+  }
+
+  if(_next >= 0)
+    return false;
+
+  if(_file)
+  {
+    fclose(_file);
+    _file = nullptr;
+  }
+  _staging = std::vector<std::byte>();
+  return true;
+}
+
+GLExpected<void> TextureStream::_readKTX2() noexcept
+{
+  KTX2Header header;
+  if(fread(&header, sizeof(header), 1, _file) != 1 || memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Invalid KTX2 header");
+  if(header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || !header.pixelWidth || !header.pixelHeight)
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Only single 2D KTX2 textures are supported");
+  if(header.supercompressionScheme != 0)
+    return CUSTOM_ERROR(ERR_NOT_IMPLEMENTED, "KTX2 supercompression isn't supported");
+
+  auto size = CheckSize(header.pixelWidth, header.pixelHeight);
+  if(size.has_error())
+    return std::move(size.error());
+
+  _format = Format::Create(FromVkFormat(header.vkFormat), false);
+  _size   = size.value();
+  if(!_format.internalformat)
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Unsupported KTX2 format");
+
+  // A level count of 0 asks the loader to generate mips, which we leave to the sampler's LOD clamp instead.
+  const uint32_t count = header.levelCount ? header.levelCount : 1;
+  if(count > static_cast<uint32_t>(ImageKernels::MipLevels(_size)))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "KTX2 file has more levels than its size allows");
+
+  std::vector<KTX2Level> index(count);
+  if(fread(index.data(), sizeof(KTX2Level), count, _file) != count)
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Truncated KTX2 level index");
+
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    if(index[i].byteLength != _format.image_bytes(ImageKernels::MipSize(_size, i)))
+      return CUSTOM_ERROR(ERR_INVALID_FILE, "KTX2 level size doesn't match its format");
+    _levels.push_back(Level{ index[i].byteOffset, index[i].byteLength });
+  }
+
+  return {};
+}
+
+GLExpected<void> TextureStream::_readDDS() noexcept
+{
+  DDSHeader header;
+  if(fread(&header, sizeof(header), 1, _file) != 1 || header.size != sizeof(DDSHeader) - sizeof(uint32_t))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Invalid DDS header");
+  if((header.caps2 & DDSCAPS2_CUBEMAP) || header.depth > 1 || !header.width || !header.height)
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Only single 2D DDS textures are supported");
+
+  uint64_t offset       = sizeof(DDSHeader);
+  FG_PixelFormat format = FromDDSPixelFormat(header.format);
+  if((header.format.flags & DDPF_FOURCC) && header.format.fourcc == FourCC('D', 'X', '1', '0'))
+  {
+    DDSHeaderDX10 dx10;
+    if(fread(&dx10, sizeof(dx10), 1, _file) != 1)
+      return CUSTOM_ERROR(ERR_INVALID_FILE, "Truncated DDS DX10 header");
+    if(dx10.resourceDimension != DDS_DIMENSION_TEX2D || dx10.arraySize > 1)
+      return CUSTOM_ERROR(ERR_INVALID_FILE, "Only single 2D DDS textures are supported");
+    format = FromDXGIFormat(dx10.dxgiFormat);
+    offset += sizeof(dx10);
+  }
+
+  auto size = CheckSize(header.width, header.height);
+  if(size.has_error())
+    return std::move(size.error());
+
+  _format = Format::Create(format, false);
+  _size   = size.value();
+  if(!_format.internalformat)
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "Unsupported DDS format");
+
+  if(header.mipMapCount > static_cast<uint32_t>(ImageKernels::MipLevels(_size)))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "DDS file has more levels than its size allows");
+  const int count = header.mipMapCount ? static_cast<int>(header.mipMapCount) : 1;
+  if(count > ImageKernels::MipLevels(_size))
+    return CUSTOM_ERROR(ERR_INVALID_FILE, "DDS file has more levels than its size allows");
+
+  // DDS stores levels back to back, largest first, with nothing in between.
+  for(int i = 0; i < count; ++i)
+  {
+    const uint64_t bytes = _format.image_bytes(ImageKernels::MipSize(_size, i));
+    _levels.push_back(Level{ offset, bytes });
+    offset += bytes;
+  }
+
+  return {};
+}
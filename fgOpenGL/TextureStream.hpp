@@ -0,0 +1,58 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__TEXTURE_STREAM_H
+#define GL__TEXTURE_STREAM_H
+
+#include "Texture.hpp"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace GL {
+  struct Context;
+
+  // Streams the mip chain of a KTX2 or DDS file into a texture one level at a time, smallest first. The whole chain is
+  // allocated up front, and GL_TEXTURE_BASE_LEVEL is lowered as each level arrives, so the texture can be drawn with
+  // a blurry version of the image right away and sharpens over the next few frames instead of stalling the first one.
+  // Only uncompressed 8-bit RGBA/BGRA and the BC formats are understood, and KTX2 supercompression isn't supported.
+  struct TextureStream
+  {
+    ~TextureStream();
+    TextureStream(const TextureStream&)            = delete;
+    TextureStream& operator=(const TextureStream&) = delete;
+
+    // Reads the header of path and creates the texture. No pixel data is read until stream() is called. The texture
+    // belongs to the caller, and has to outlive the stream until it's done.
+    static GLExpected<std::unique_ptr<TextureStream>> open(const char* path, const FG_Sampler& sampler,
+                                                           SamplerCache* samplers = nullptr) noexcept;
+    // Uploads levels through ctx until at least budget bytes have been copied, or at least one level if budget is 0.
+    // Returns true once every level has been uploaded, after which the file is closed.
+    GLExpected<bool> stream(Context* ctx, uint64_t budget) noexcept;
+
+    inline FG_Resource texture() const noexcept { return _texture; }
+    inline bool done() const noexcept { return _next < 0; }
+    inline uint32_t remaining() const noexcept { return static_cast<uint32_t>(_next + 1); }
+
+  protected:
+    struct Level
+    {
+      uint64_t offset;
+      uint64_t bytes;
+    };
+
+    explicit TextureStream(FILE* file) noexcept : _file(file), _format{ 0, 0, 0 }, _size{ 0, 0 }, _next(-1) {}
+    GLExpected<void> _readKTX2() noexcept;
+    GLExpected<void> _readDDS() noexcept;
+
+    FILE* _file;
+    Format _format;
+    FG_Vec2i _size;
+    std::vector<Level> _levels; // Level 0 is the largest, like GL
+    int _next;                  // The next level to upload, counting down to 0, or -1 once everything is uploaded
+    Texture _texture;
+    std::vector<std::byte> _staging;
+  };
+}
+
+#endif
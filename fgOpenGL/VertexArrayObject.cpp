@@ -58,9 +58,31 @@ GLExpected<VertexArrayObject> VertexArrayObject::create(GLuint program, std::spa
   else
     return std::move(e.error());
 
-  if(indices)
-    RETURN_ERROR(CALLGL(glBindBuffer, GL_ELEMENT_ARRAY_BUFFER, 0));
+  // The element array binding is part of the VAO, so the VAO must be unbound first or we'd detach the index buffer.
+  RETURN_ERROR(vao.unbind());
+  return vao;
+}
 
+GLExpected<VertexArrayObject> VertexArrayObject::createLayout(const VertexLayout& layout) noexcept
+{
+  GLuint id;
+  RETURN_ERROR(CALLGL(glGenVertexArrays, 1, &id));
+
+  VertexArrayObject vao(id);
+  RETURN_ERROR(vao.bind());
+  for(auto& format : layout.formats)
+  {
+    RETURN_ERROR(CALLGL(glEnableVertexAttribArray, format.location));
+    RETURN_ERROR(CALLGL(glVertexAttribFormat, format.location, format.length, format.type, GL_FALSE, format.offset));
+    RETURN_ERROR(CALLGL(glVertexAttribBinding, format.location, format.binding));
+  }
+
+  for(size_t i = 0; i < layout.divisors.size(); ++i)
+  {
+    RETURN_ERROR(CALLGL(glVertexBindingDivisor, static_cast<GLuint>(i), layout.divisors[i]));
+  }
+
+  RETURN_ERROR(vao.unbind());
   return vao;
 }
 
@@ -114,6 +136,11 @@ GLExpected<VertexArrayObject> VertexArrayObject::create(GLuint program, std::spa
   return {};
 }
 
+GLExpected<VertexArrayObject> VertexArrayObject::createLayout(const VertexLayout& layout) noexcept
+{
+  return CUSTOM_ERROR(ERR_NOT_IMPLEMENTED, "Emulated VAOs can't be shared between pipelines");
+}
+
 VertexArrayObject::~VertexArrayObject() {}
 
 GLExpected<void> VertexArrayObject::bind()
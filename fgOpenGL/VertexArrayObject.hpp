@@ -7,11 +7,43 @@
 #include "feather/compiler.h"
 #include "feather/graphics_interface.h"
 #include "glad/glad.h"
+#include "GLError.hpp"
 #include <span>
 #include <vector>
 #include <utility>
 
 namespace GL {
+  // One attribute of a vertex layout. Its buffer is only named by binding index, so any number of pipelines with the
+  // same layout can share one VAO and still draw from different buffers.
+  struct VertexFormat
+  {
+    GLuint location;
+    GLint length;
+    GLenum type;
+    GLuint offset;
+    GLuint binding;
+
+    bool operator==(const VertexFormat&) const noexcept = default;
+  };
+
+  struct VertexLayout
+  {
+    std::vector<VertexFormat> formats;
+    std::vector<GLuint> divisors; // Instancing divisor of each binding
+
+    bool operator==(const VertexLayout&) const noexcept = default;
+  };
+
+  // What is bound to one vertex buffer binding point.
+  struct VertexBinding
+  {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizei stride;
+
+    bool operator==(const VertexBinding&) const noexcept = default;
+  };
+
   class VertexArrayObject
   {
   public:
@@ -27,6 +59,7 @@ namespace GL {
       return *this;
     }
     VertexArrayObject& operator=(const VertexArrayObject&) noexcept = delete;
+    inline GLuint id() const noexcept { return _vaoID; }
 
   private:
     VertexArrayObject(GLuint id) : _vaoID(id) {}
@@ -85,6 +118,9 @@ namespace GL {
 
     static GLExpected<VertexArrayObject> create(GLuint program, std::span<FG_VertexParameter> parameters,
                                                 std::span<std::pair<GLuint, GLsizei>> vbuffers, GLuint indices) noexcept;
+    // Builds a VAO that only holds attribute formats, using ARB_vertex_attrib_binding. Buffers are bound to it later
+    // with glBindVertexBuffer. Emulated VAOs can't do this, so there it always fails.
+    static GLExpected<VertexArrayObject> createLayout(const VertexLayout& layout) noexcept;
   };
 }
 
@@ -0,0 +1,35 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#include "VertexLayoutCache.hpp"
+#include "ProviderGL.hpp"
+
+using namespace GL;
+
+size_t VertexLayoutCache::LayoutHash::operator()(const VertexLayout& layout) const noexcept
+{
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix      = [&hash](uint64_t v) { hash = (hash ^ v) * 1099511628211ULL; };
+  for(auto& f : layout.formats)
+  {
+    mix(f.location);
+    mix(f.length);
+    mix(f.type);
+    mix(f.offset);
+    mix(f.binding);
+  }
+  for(auto d : layout.divisors)
+    mix(d);
+  return static_cast<size_t>(hash);
+}
+
+GLExpected<VertexArrayObject*> VertexLayoutCache::get(const VertexLayout& layout) noexcept
+{
+  if(auto i = _vaos.find(layout); i != _vaos.end())
+    return &i->second;
+
+  auto e = VertexArrayObject::createLayout(layout);
+  if(e.has_error())
+    return std::move(e.error());
+  return &_vaos.emplace(layout, std::move(e.value())).first->second;
+}
@@ -0,0 +1,46 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "ProviderGL.hpp"
+
+#ifndef GL__VERTEX_LAYOUT_CACHE_H
+#define GL__VERTEX_LAYOUT_CACHE_H
+
+#include "VertexArrayObject.hpp"
+#include <unordered_map>
+
+namespace GL {
+  // Owns one VAO per distinct vertex layout, so pipelines that only differ in which buffers they read from share a
+  // VAO and switching between them doesn't touch the vertex array binding at all. VAOs can't be shared between
+  // contexts, so every context has its own cache.
+  class VertexLayoutCache
+  {
+  public:
+    VertexLayoutCache() noexcept                           = default;
+    VertexLayoutCache(const VertexLayoutCache&)            = delete;
+    VertexLayoutCache& operator=(const VertexLayoutCache&) = delete;
+
+    static inline bool supported() noexcept
+    {
+#ifdef USE_EMULATED_VAOS
+      return false;
+#else
+      return glBindVertexBuffer != nullptr && glVertexAttribFormat != nullptr;
+#endif
+    }
+    // Returns the VAO for layout, creating it the first time it's seen. The pointer stays valid until the cache is
+    // destroyed.
+    GLExpected<VertexArrayObject*> get(const VertexLayout& layout) noexcept;
+    inline size_t size() const noexcept { return _vaos.size(); }
+
+    static constexpr GLuint BINDINGS = 16; // The minimum GL_MAX_VERTEX_ATTRIB_BINDINGS
+
+  protected:
+    struct LayoutHash
+    {
+      size_t operator()(const VertexLayout& layout) const noexcept;
+    };
+
+    std::unordered_map<VertexLayout, VertexArrayObject, LayoutHash> _vaos;
+  };
+}
+
+#endif
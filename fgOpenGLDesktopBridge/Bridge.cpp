@@ -14,6 +14,7 @@ using FG::Bridge;
 int Bridge::_refcount      = 0;
 Bridge* Bridge::_singleton = nullptr;
 void* Bridge::_library     = nullptr;
+void (*Bridge::_glFinish)() = nullptr;
 
 #ifdef FG_PLATFORM_WIN32
 decltype(Bridge::_wglGetProcAddress) Bridge::_wglGetProcAddress = nullptr;
@@ -36,6 +37,7 @@ int Bridge::EmplaceContext(struct FG_GraphicsDesktopBridge* self, FG_Window* win
     return b->LOG(FG_Level_Fatal, "Failed to load OpenGL calls! THIS OPENGL CONTEXT IS UNUSABLE!"), e;
   auto dim        = w->GetSize();
   window->context = new GL::Context(FG_Vec2{ static_cast<float>(dim.x), static_cast<float>(dim.y) });
+  b->_pacers.insert_or_assign(window, FramePacer(w->GetWindow()));
   return 0;
 }
 int Bridge::AttachContext(struct FG_GraphicsDesktopBridge* self, FG_Context* context, FG_Window* window) { return -1; }
@@ -45,6 +47,12 @@ int Bridge::BeginDraw(struct FG_GraphicsDesktopBridge* self, FG_Window* window,
   auto w = static_cast<GLFW::WindowGL*>(window);
   if(auto e = w->MakeCurrent())
     return e;
+  b->_pacer(window).BeginFrame();
+
+  // Scissoring to the damage only works if the rest of the backbuffer survives the last swap. Partial presents copy
+  // straight to the front buffer without waiting for vblank, so they're only used when swaps don't either.
+  if(!w->PartialPresent() || b->_pacer(window).VSync())
+    area = nullptr;
   if(auto e = static_cast<GL::Context*>(window->context)->BeginDraw(area); !e)
   {
     e.log(b->_provider);
@@ -52,16 +60,112 @@ int Bridge::BeginDraw(struct FG_GraphicsDesktopBridge* self, FG_Window* window,
   return GL::ERR_SUCCESS;
 }
 int Bridge::EndDraw(struct FG_GraphicsDesktopBridge* self, FG_Window* window)
+{
+  auto b   = static_cast<Bridge*>(self);
+  auto w   = static_cast<GLFW::WindowGL*>(window);
+  auto ctx = static_cast<GL::Context*>(window->context);
+
+  // A frame that was scissored to its damage only has to present that much. This has to happen before EndDraw, which
+  // forgets the damage.
+  w->SwapBuffers(ctx->Damage());
+  auto& pacer = b->_pacer(window);
+  if(pacer.Synced() && _glFinish)
+    _glFinish();
+  pacer.Presented();
+
+  if(auto e = ctx->EndDraw(); !e)
+  {
+    e.log(b->_provider);
+  }
+  return GL::ERR_SUCCESS;
+}
+int Bridge::SetFramePacing(struct FG_GraphicsDesktopBridge* self, FG_Window* window, int interval, bool render_late)
+{
+  auto b = static_cast<Bridge*>(self);
+  auto w = static_cast<GLFW::WindowGL*>(window);
+  if(!w)
+    return GL::ERR_MISSING_PARAMETER;
+  if(auto e = w->MakeCurrent())
+    return e;
+
+  // glFinish is the only portable way to find out when a synced swap actually happened.
+  if(render_late && !_glFinish)
+    _glFinish = reinterpret_cast<void (*)()>(ctxLoadProc("glFinish"));
+  if(b->_pacer(window).SetInterval(interval, render_late) != interval)
+    b->LOG(FG_Level_Notice, "Adaptive vsync isn't supported, falling back to swap interval: ", -interval);
+  return GL::ERR_SUCCESS;
+}
+int Bridge::WaitForFrame(struct FG_GraphicsDesktopBridge* self, FG_Window* window)
+{
+  if(!window)
+    return GL::ERR_MISSING_PARAMETER;
+  static_cast<Bridge*>(self)->_pacer(window).Wait();
+  return GL::ERR_SUCCESS;
+}
+int Bridge::GetPresentTiming(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_PresentTiming* timing)
+{
+  if(!window || !timing)
+    return GL::ERR_MISSING_PARAMETER;
+  *timing = static_cast<Bridge*>(self)->_pacer(window).GetTiming();
+  return GL::ERR_SUCCESS;
+}
+int Bridge::QueueLoad(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_LoadTask load, FG_LoadTask done,
+                      void* user)
 {
   auto b = static_cast<Bridge*>(self);
   auto w = static_cast<GLFW::WindowGL*>(window);
-  w->SwapBuffers();
-  if(auto e = static_cast<GL::Context*>(window->context)->EndDraw(); !e)
+  if(!w || !load)
+    return GL::ERR_MISSING_PARAMETER;
+
+  if(!b->_loader)
   {
-    e.log(b->_provider);
+    b->_loader = std::make_unique<Loader>(b->_provider, w->GetWindow());
+    if(!b->_loader->Valid())
+    {
+      b->_loader.reset();
+      return b->LOG(FG_Level_Error, "Failed to create a shared context for loading!"), GL::ERR_INVALID_CALL;
+    }
   }
+
+  b->_loader->Queue(load, done, user);
   return GL::ERR_SUCCESS;
 }
+int Bridge::FinishLoads(struct FG_GraphicsDesktopBridge* self, FG_Window* window)
+{
+  auto b = static_cast<Bridge*>(self);
+  auto w = static_cast<GLFW::WindowGL*>(window);
+  if(!w)
+    return GL::ERR_MISSING_PARAMETER;
+  if(!b->_loader)
+    return 0;
+  if(auto e = w->MakeCurrent())
+    return e;
+  return b->_loader->Finish(window->context);
+}
+int Bridge::DestroyContext(struct FG_GraphicsDesktopBridge* self, FG_Window* window)
+{
+  auto b = static_cast<Bridge*>(self);
+  auto w = static_cast<GLFW::WindowGL*>(window);
+  if(!w)
+    return GL::ERR_MISSING_PARAMETER;
+
+  // The pacer is keyed by the window pointer, which the next window could be given again.
+  b->_pacers.erase(window);
+  if(window->context)
+  {
+    if(auto e = w->MakeCurrent())
+      return b->LOG(FG_Level_Error, "Failed to make window context current!"), e;
+    // Goes through the provider so it also forgets the pipelines cached for this context.
+    auto r          = (*b->_provider->destroyContext)(b->_provider, window->context);
+    window->context = nullptr;
+    return r;
+  }
+  return GL::ERR_SUCCESS;
+}
+FG::FramePacer& Bridge::_pacer(FG_Window* window)
+{
+  return _pacers.try_emplace(window, static_cast<GLFW::WindowGL*>(window)->GetWindow()).first->second;
+}
 int Bridge::DestroyImpl(struct FG_GraphicsDesktopBridge* self)
 {
   if(!self)
@@ -168,11 +272,17 @@ long long GetRegistryValueW(HKEY__* hKeyRoot, const wchar_t* szKey, const wchar_
 
 Bridge::Bridge(GL::Provider* provider, void* logctx, FG_Log log) : _logctx(logctx), _log(log), _provider(provider)
 {
-  emplaceContext = &EmplaceContext;
-  attachContext  = &AttachContext;
-  beginDraw      = &BeginDraw;
-  endDraw        = &EndDraw;
-  destroy        = &DestroyImpl;
+  emplaceContext   = &EmplaceContext;
+  attachContext    = &AttachContext;
+  beginDraw        = &BeginDraw;
+  endDraw          = &EndDraw;
+  destroy          = &DestroyImpl;
+  setFramePacing   = &SetFramePacing;
+  waitForFrame     = &WaitForFrame;
+  getPresentTiming = &GetPresentTiming;
+  queueLoad        = &QueueLoad;
+  finishLoads      = &FinishLoads;
+  destroyContext   = &DestroyContext;
 
   this->LOG(FG_Level_Notice, "Initializing fgOpenGL Desktop Bridge...");
   _singleton = this;
@@ -25,6 +25,10 @@ namespace FG {
 #define AUTO_FRIEND FG::Bridge
 #include "ProviderGL.hpp"
 #include "ProviderGLFW.hpp"
+#include "FramePacer.hpp"
+#include "Loader.hpp"
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #define LOG(level, msg, ...) Log(level, __FILE__, __LINE__, msg __VA_OPT__(, ) __VA_ARGS__)
@@ -52,6 +56,13 @@ namespace FG {
     static int BeginDraw(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_Rect* area);
     static int EndDraw(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
     static int DestroyImpl(struct FG_GraphicsDesktopBridge* self);
+    static int SetFramePacing(struct FG_GraphicsDesktopBridge* self, FG_Window* window, int interval, bool render_late);
+    static int WaitForFrame(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
+    static int GetPresentTiming(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_PresentTiming* timing);
+    static int QueueLoad(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_LoadTask load, FG_LoadTask done,
+                         void* user);
+    static int FinishLoads(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
+    static int DestroyContext(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
     static void* ctxLoadProc(const char* name);
     static void* LoadProc(void* library, const char* name);
 
@@ -68,10 +79,15 @@ namespace FG {
     static Bridge* _singleton;
     static void* _library;
     static int _refcount;
+    static void (*_glFinish)();
 
   protected:
+    FramePacer& _pacer(FG_Window* window);
+
     FG_Log _log;
     GL::Provider* _provider;
+    std::unordered_map<FG_Window*, FramePacer> _pacers; // Reset by emplaceContext, erased by destroyContext
+    std::unique_ptr<Loader> _loader; // Every window of the GLFW backend is in one share group, so one loader serves all
   };
 }
 
@@ -0,0 +1,123 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "Bridge.hpp"
+
+#include "FramePacer.hpp"
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+using FG::FramePacer;
+
+FramePacer::FramePacer(GLFWwindow* window) noexcept :
+  _refresh(1.0 / 60.0),
+  _average(0),
+  _last(0),
+  _lastpresent(0),
+  _drawtime(0),
+  _framestart(0),
+  _interval(0),
+  _renderlate(false)
+{
+  auto monitor = glfwGetWindowMonitor(window);
+  if(!monitor)
+    monitor = glfwGetPrimaryMonitor();
+  if(auto mode = monitor ? glfwGetVideoMode(monitor) : nullptr; mode && mode->refreshRate > 0)
+    _refresh = 1.0 / mode->refreshRate;
+}
+
+int FramePacer::SetInterval(int interval, bool renderlate)
+{
+  // Adaptive vsync is a negative interval, which drivers without EXT_swap_control_tear treat as an error.
+  if(interval < 0 && !glfwExtensionSupported("GLX_EXT_swap_control_tear") &&
+     !glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+    interval = -interval;
+
+  glfwSwapInterval(interval);
+  _interval   = interval;
+  _renderlate = renderlate;
+  return interval;
+}
+
+double FramePacer::_nextVBlank(double now) const
+{
+  const double period = _refresh * std::abs(_interval);
+  if(_lastpresent == 0 || period <= 0)
+    return now;
+
+  // After an idle stretch the last present is several vblanks ago, so skip ahead to the next one still coming.
+  double next = _lastpresent + period;
+  if(next < now)
+    next += std::ceil((now - next) / _refresh) * _refresh;
+  return next;
+}
+
+void FramePacer::Wait()
+{
+  double now = glfwGetTime();
+  if(Synced())
+  {
+    const double deadline = _nextVBlank(now) - _drawtime - MARGIN;
+    if(deadline - now > SPIN)
+      std::this_thread::sleep_for(std::chrono::duration<double>(deadline - now - SPIN));
+    while((now = glfwGetTime()) < deadline)
+      std::this_thread::yield();
+  }
+
+  _framestart = now;
+}
+
+void FramePacer::BeginFrame()
+{
+  // If Wait was called, the frame started there, before input was sampled.
+  if(_framestart == 0)
+    _framestart = glfwGetTime();
+}
+
+void FramePacer::Presented()
+{
+  const double now = glfwGetTime();
+  if(_framestart != 0)
+  {
+    const double draw = now - _framestart;
+    _drawtime         = draw > _drawtime ? draw : _drawtime + (draw - _drawtime) * DECAY;
+  }
+
+  if(_lastpresent != 0)
+  {
+    _last    = now - _lastpresent;
+    _average = _average == 0 ? _last : _average + (_last - _average) * DECAY;
+
+    // Only a swap that was waited on lands on a vblank, and a missed one shows up as a multiple of the interval.
+    if(Synced())
+    {
+      const double vblanks = std::round(_last / _refresh);
+      if(vblanks >= 1)
+      {
+        const double measured = _last / vblanks;
+        if(std::abs(measured - _refresh) < _refresh * 0.25)
+          _refresh += (measured - _refresh) * DECAY;
+      }
+    }
+  }
+
+  _lastpresent = now;
+  _framestart  = 0;
+}
+
+FG_PresentTiming FramePacer::GetTiming() const
+{
+  FG_PresentTiming timing;
+  timing.refresh_interval = _refresh;
+  timing.present_interval = _average;
+  timing.last_interval    = _last;
+  timing.draw_time        = _drawtime;
+  timing.until_vblank     = 0;
+  timing.swap_interval    = _interval;
+  timing.render_late      = _renderlate;
+  if(Synced())
+  {
+    const double now    = glfwGetTime();
+    timing.until_vblank = _nextVBlank(now) - now;
+  }
+  return timing;
+}
@@ -0,0 +1,51 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "Bridge.hpp"
+
+#ifndef FG__FRAME_PACER_H
+#define FG__FRAME_PACER_H
+
+#include "feather/graphics_desktop_bridge.h"
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+namespace FG {
+  // Tracks when a window presents and predicts its next vblank. The refresh interval starts out as whatever the
+  // monitor reports and is then refined from present-to-present intervals, but only while swaps block until vblank,
+  // because otherwise they only measure how fast frames are drawn. Estimated draw times rise right away and decay
+  // slowly, so a single fast frame doesn't make render-late miss the next vblank.
+  class FramePacer
+  {
+  public:
+    explicit FramePacer(GLFWwindow* window) noexcept;
+    // Has to be called with the window's context current. Returns the interval that was actually set.
+    int SetInterval(int interval, bool renderlate);
+    // Sleeps until the predicted vblank, minus the estimated draw time, if render-late is on.
+    void Wait();
+    void BeginFrame();
+    // Call right after the swap, and after waiting for it to finish if Synced() is true.
+    void Presented();
+    // Whether swaps have to be waited on to find out when they actually hit the screen.
+    inline bool Synced() const noexcept { return _renderlate && _interval != 0; }
+    // Whether swaps wait for vblank at all, so presenting by copying to the front buffer instead would tear.
+    inline bool VSync() const noexcept { return _interval != 0; }
+    FG_PresentTiming GetTiming() const;
+
+    static constexpr double MARGIN = 0.001; // Slack left before the vblank for the compositor and the swap itself
+    static constexpr double SPIN   = 0.002; // Sleep only gets this close to a deadline, the rest is spent yielding
+    static constexpr double DECAY  = 0.1;
+
+  protected:
+    double _nextVBlank(double now) const;
+
+    double _refresh;
+    double _average;
+    double _last;
+    double _lastpresent; // 0 until the first present
+    double _drawtime;
+    double _framestart; // 0 if no frame has been started since the last present
+    int _interval;
+    bool _renderlate;
+  };
+}
+
+#endif
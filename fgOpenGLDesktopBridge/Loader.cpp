@@ -0,0 +1,121 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "Bridge.hpp"
+
+#include "platform.hpp"
+#include "Bridge.hpp"
+
+using FG::Loader;
+
+Loader::Loader(FG_GraphicsInterface* graphics, GLFWwindow* share) :
+  _graphics(graphics), _window(nullptr), _context(nullptr), _quit(false)
+{
+  // The hidden window asks for the same context as WindowGL does, or the driver might refuse to share with it.
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  _window = glfwCreateWindow(1, 1, "", nullptr, share);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+  if(_window)
+    _thread = std::thread(&Loader::_run, this);
+}
+
+Loader::~Loader()
+{
+  if(_thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _quit = true;
+    }
+    _signal.notify_one();
+    _thread.join();
+  }
+
+  if(_window)
+    glfwDestroyWindow(_window);
+}
+
+void Loader::Queue(FG_LoadTask load, FG_LoadTask done, void* user)
+{
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _pending.push_back(Task{ load, done, user, GL::Provider::NULL_FENCE });
+  }
+  _signal.notify_one();
+}
+
+int Loader::Finish(FG_Context* context)
+{
+  std::vector<Task> finished;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    for(size_t i = 0; i < _loaded.size();)
+    {
+      // Fences belong to the share group, so the window's context can ask about the loader's.
+      auto& task = _loaded[i];
+      if(task.fence && (*_graphics->queryFence)(_graphics, context, task.fence) != 0)
+      {
+        ++i;
+        continue;
+      }
+
+      finished.push_back(task);
+      task = _loaded.back();
+      _loaded.pop_back();
+    }
+  }
+
+  // Callbacks run without the lock held, so they can queue more loads.
+  for(auto& task : finished)
+  {
+    if(task.fence)
+      (*_graphics->destroyFence)(_graphics, context, task.fence);
+    if(task.done)
+      (*task.done)(task.user, context);
+  }
+
+  return static_cast<int>(finished.size());
+}
+
+void Loader::_run()
+{
+  glfwMakeContextCurrent(_window);
+  _context = new GL::Context(FG_Vec2{ 1, 1 });
+
+  std::unique_lock<std::mutex> guard(_lock);
+  for(;;)
+  {
+    _signal.wait(guard, [this] { return _quit || !_pending.empty(); });
+    if(_quit)
+      break;
+
+    auto task = _pending.front();
+    _pending.pop_front();
+    guard.unlock();
+
+    // The error check level is kept per thread, so this thread follows whatever the provider was last set to.
+    GL::ErrorCheckLevel = static_cast<GL::Provider*>(_graphics)->GetErrorCheck();
+
+    if(task.load)
+      (*task.load)(task.user, _context);
+    // createFence also flushes, which is what makes the load visible to the other contexts at all.
+    task.fence = (*_graphics->createFence)(_graphics, _context);
+
+    guard.lock();
+    _loaded.push_back(task);
+    glfwPostEmptyEvent();
+  }
+
+  // Loads that were never finished are dropped along with their fences, nobody is left to hand them to.
+  for(auto& task : _loaded)
+  {
+    if(task.fence)
+      (*_graphics->destroyFence)(_graphics, _context, task.fence);
+  }
+  _loaded.clear();
+  guard.unlock();
+
+  (*_graphics->destroyContext)(_graphics, _context);
+  glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,57 @@
+// Copyright (c)2022 Fundament Software
+// For conditions of distribution and use, see copyright notice in "Bridge.hpp"
+
+#ifndef FG__LOADER_H
+#define FG__LOADER_H
+
+#include "feather/graphics_desktop_bridge.h"
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FG {
+  // Owns a hidden window whose context shares objects with a group of windows, and a worker thread that keeps it
+  // current and runs load tasks on it. Every task is followed by a fence, so its completion callback only runs once
+  // the GPU is done with it and never has to wait. GLFW only lets windows be created and destroyed on the main thread,
+  // so the loader has to be created and destroyed there too.
+  class Loader
+  {
+  public:
+    Loader(FG_GraphicsInterface* graphics, GLFWwindow* share);
+    ~Loader();
+    Loader(const Loader&)            = delete;
+    Loader& operator=(const Loader&) = delete;
+
+    inline bool Valid() const noexcept { return _window != nullptr; }
+    void Queue(FG_LoadTask load, FG_LoadTask done, void* user);
+    // Has to be called with context current. Returns how many completion callbacks were called.
+    int Finish(FG_Context* context);
+
+  protected:
+    struct Task
+    {
+      FG_LoadTask load;
+      FG_LoadTask done;
+      void* user;
+      FG_Fence fence;
+    };
+
+    void _run();
+
+    FG_GraphicsInterface* _graphics;
+    GLFWwindow* _window;
+    FG_Context* _context; // Only touched by the worker thread
+    std::mutex _lock;
+    std::condition_variable _signal;
+    std::deque<Task> _pending;
+    std::vector<Task> _loaded; // Submitted to the GPU, but maybe not finished yet
+    bool _quit;
+    std::thread _thread;
+  };
+}
+
+#endif
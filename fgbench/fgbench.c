@@ -0,0 +1,443 @@
+/* fgbench - Micro-benchmarks of feather GUI graphics backends
+Copyright (c)2022 Fundament Software
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "feather/graphics_desktop_bridge.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BACKEND fgOpenGL
+#define BRIDGE  fgOpenGLDesktopBridge
+
+extern struct FG_GraphicsInterface* BACKEND(void* root, FG_Log log);
+extern struct FG_DesktopInterface* fgGLFW(void* root, FG_Log log, FG_Behavior behavior);
+extern struct FG_GraphicsDesktopBridge* BRIDGE(struct FG_GraphicsInterface*, void*, FG_Log);
+
+const char* LEVELS[] = { "FATAL: ", "ERROR: ", "WARNING: ", "NOTICE: ", "DEBUG: " };
+
+// Only problems are logged, and to stderr, so they never end up in the results.
+void BenchLog(void* _, enum FG_Level level, const char* file, int line, const char* msg, const FG_LogValue* values,
+              int n_values, void (*free)(char*))
+{
+  if(level >= 0 && level <= FG_Level_Warning)
+    fprintf(stderr, "%s [%s:%i] %s\n", LEVELS[level], file, line, msg);
+
+  for(int i = 0; i < n_values; ++i)
+  {
+    if(values[i].type == FG_LogType_OwnedString)
+      free(values[i].owned);
+  }
+}
+
+FG_Result behavior(FG_Window* w, FG_Msg* msg, void* ui_context, uintptr_t window_id)
+{
+  FG_Result r = { 0 };
+  return r;
+}
+
+typedef struct Result__
+{
+  const char* name;
+  const char* unit; // What count counts, the rate is always per second
+  double count;
+  double seconds;
+} Result;
+
+typedef struct Bench__
+{
+  struct FG_GraphicsInterface* b;
+  FG_Context* ctx;
+  uintptr_t pipelines[2];
+  FG_Shader shaders[3];
+  FG_Resource vertices;
+  uint32_t iterations;
+  Result results[16];
+  uint32_t n_results;
+} Bench;
+
+double now()
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Every measurement ends by waiting for the GPU, so it covers the work and not just queueing it.
+void finish(Bench* bench)
+{
+  FG_Fence fence = (*bench->b->createFence)(bench->b, bench->ctx);
+  if(fence)
+  {
+    (*bench->b->waitFence)(bench->b, bench->ctx, fence, ~0ULL);
+    (*bench->b->destroyFence)(bench->b, bench->ctx, fence);
+  }
+}
+
+void report(Bench* bench, const char* name, const char* unit, double count, double start)
+{
+  if(bench->n_results < sizeof(bench->results) / sizeof(Result))
+  {
+    Result r                           = { name, unit, count, now() - start };
+    bench->results[bench->n_results++] = r;
+  }
+}
+
+const char* shader_vs = "#version 110\n"
+                        "uniform vec4 offset;\n"
+                        "attribute vec2 vPos;\n"
+                        "void main() { gl_Position = vec4(vPos.xy + offset.xy, 0.0, 1.0); }";
+
+const char* shader_fs[2] = { "#version 110\n"
+                             "uniform vec4 color;\n"
+                             "void main() { gl_FragColor = color; }",
+                             "#version 110\n"
+                             "uniform vec4 color;\n"
+                             "void main() { gl_FragColor = color.bgra * 0.5; }" };
+
+FG_Blend Replace_Blend = {
+  FG_Blend_Operand_One, FG_Blend_Operand_Zero, FG_Blend_Op_Add, FG_Blend_Operand_One, FG_Blend_Operand_Zero,
+  FG_Blend_Op_Add,      0xF,
+};
+
+FG_VertexParameter vertparams[] = { { "vPos", 0, 0, 2, FG_Shader_Type_Float } };
+
+FG_ShaderParameter params[] = { { "color", 4, 1, 0, FG_Shader_Type_Float },
+                                { "offset", 4, 1, 0, FG_Shader_Type_Float } };
+
+uintptr_t create_pipeline(Bench* bench, FG_Shader vs, FG_Shader fs)
+{
+  int stride                = sizeof(float) * 2;
+  FG_PipelineState pipeline = { 0 };
+  pipeline.members          = FG_Pipeline_Member_PS | FG_Pipeline_Member_VS | FG_Pipeline_Member_Fill |
+                     FG_Pipeline_Member_Cull | FG_Pipeline_Member_Primitive;
+  pipeline.shaders[FG_ShaderStage_Pixel]  = fs;
+  pipeline.shaders[FG_ShaderStage_Vertex] = vs;
+  pipeline.fillMode                       = FG_Fill_Mode_Fill;
+  pipeline.cullMode                       = FG_Cull_Mode_None;
+  pipeline.primitive                      = FG_Primitive_Triangle;
+  return (*bench->b->createPipelineState)(bench->b, bench->ctx, &pipeline, 0, &Replace_Blend, &bench->vertices,
+                                          &stride, 1, vertparams, 1, 0, 0);
+}
+
+void set_constants(Bench* bench, FG_CommandList* commands, uint32_t i)
+{
+  float color[4]       = { (i & 0xFF) / 255.0f, 0.5f, 0.25f, 1.0f };
+  float offset[4]      = { 0 };
+  FG_ShaderValue vs[2] = { 0 };
+  vs[0].pf32           = color;
+  vs[1].pf32           = offset;
+  (*bench->b->setShaderConstants)(bench->b, commands, params, vs, 2);
+}
+
+void bench_draws(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  double start                   = now();
+  FG_CommandList* commands       = (*b->createCommandList)(b, bench->ctx, false);
+  (*b->setPipelineState)(b, commands, bench->pipelines[0]);
+  set_constants(bench, commands, 0);
+  for(uint32_t i = 0; i < bench->iterations; ++i)
+    (*b->draw)(b, commands, 3, 1, 0, 0);
+  (*b->execute)(b, bench->ctx, commands);
+  finish(bench);
+  (*b->destroyCommandList)(b, bench->ctx, commands);
+  report(bench, "draws", "draws", bench->iterations, start);
+}
+
+void bench_pipeline_switches(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  double start                   = now();
+  FG_CommandList* commands       = (*b->createCommandList)(b, bench->ctx, false);
+  for(uint32_t i = 0; i < bench->iterations; ++i)
+  {
+    (*b->setPipelineState)(b, commands, bench->pipelines[i & 1]);
+    set_constants(bench, commands, i);
+    (*b->draw)(b, commands, 3, 1, 0, 0);
+  }
+  (*b->execute)(b, bench->ctx, commands);
+  finish(bench);
+  (*b->destroyCommandList)(b, bench->ctx, commands);
+  report(bench, "pipeline_switches", "switches", bench->iterations, start);
+}
+
+void bench_uniform_updates(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  double start                   = now();
+  FG_CommandList* commands       = (*b->createCommandList)(b, bench->ctx, false);
+  (*b->setPipelineState)(b, commands, bench->pipelines[0]);
+  for(uint32_t i = 0; i < bench->iterations; ++i)
+  {
+    set_constants(bench, commands, i);
+    (*b->draw)(b, commands, 3, 1, 0, 0);
+  }
+  (*b->execute)(b, bench->ctx, commands);
+  finish(bench);
+  (*b->destroyCommandList)(b, bench->ctx, commands);
+  report(bench, "uniform_updates", "updates", bench->iterations, start);
+}
+
+// Recording is measured on its own, replaying a bundle measures only what execute costs.
+void bench_command_lists(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  const uint32_t REPLAYS         = 16;
+  double start                   = now();
+  FG_CommandList* bundle         = (*b->createCommandList)(b, bench->ctx, true);
+  for(uint32_t i = 0; i < bench->iterations; ++i)
+  {
+    (*b->setPipelineState)(b, bundle, bench->pipelines[i & 1]);
+    set_constants(bench, bundle, i);
+    (*b->draw)(b, bundle, 3, 1, 0, 0);
+  }
+  report(bench, "command_record", "commands", bench->iterations * 3.0, start);
+
+  start = now();
+  for(uint32_t i = 0; i < REPLAYS; ++i)
+    (*b->execute)(b, bench->ctx, bundle);
+  finish(bench);
+  report(bench, "command_replay", "commands", bench->iterations * 3.0 * REPLAYS, start);
+  (*b->destroyCommandList)(b, bench->ctx, bundle);
+}
+
+void bench_buffer_upload(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  const uint32_t BYTES           = 1 << 22;
+  const uint32_t UPLOADS         = 64;
+  void* data                     = malloc(BYTES);
+  memset(data, 0x5A, BYTES);
+  FG_Resource buffer = (*b->createBuffer)(b, bench->ctx, NULL, BYTES, FG_Usage_Vertex_Data);
+
+  double start = now();
+  for(uint32_t i = 0; i < UPLOADS; ++i)
+  {
+    void* p = (*b->mapResource)(b, bench->ctx, buffer, 0, BYTES, FG_Usage_Vertex_Data,
+                                FG_AccessFlag_Write | FG_AccessFlag_Invalidate_Buffer);
+    if(!p)
+      break;
+    memcpy(p, data, BYTES);
+    (*b->unmapResource)(b, bench->ctx, buffer, FG_Usage_Vertex_Data);
+  }
+  finish(bench);
+  report(bench, "buffer_upload", "bytes", (double)BYTES * UPLOADS, start);
+
+  (*b->destroyResource)(b, bench->ctx, buffer);
+  free(data);
+}
+
+void bench_texture_upload(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  const uint32_t UPLOADS         = 32;
+  FG_Vec2i size                  = { 1024, 1024 };
+  FG_Vec2i origin                = { 0, 0 };
+  size_t bytes                   = size.x * (size_t)size.y * 4;
+  void* data                     = malloc(bytes);
+  memset(data, 0xA5, bytes);
+  FG_Sampler sampler  = { FG_Filter_Min_Mag_Mip_Point };
+  FG_Resource texture = (*b->createTexture)(b, bench->ctx, size, FG_Usage_Texture2D, FG_PixelFormat_R8G8B8A8_Typeless,
+                                            &sampler, NULL, 0, 0);
+
+  double start = now();
+  for(uint32_t i = 0; i < UPLOADS; ++i)
+    (*b->updateTexture)(b, bench->ctx, texture, 0, origin, size, FG_PixelFormat_R8G8B8A8_Typeless, data);
+  finish(bench);
+  report(bench, "texture_upload", "bytes", (double)bytes * UPLOADS, start);
+
+  (*b->destroyResource)(b, bench->ctx, texture);
+  free(data);
+}
+
+// Every source is made unique, or the pipeline cache would hand back the first pipeline every time.
+void bench_compile(Bench* bench)
+{
+  struct FG_GraphicsInterface* b = bench->b;
+  const uint32_t PROGRAMS        = 16;
+  char vs[512];
+  char fs[512];
+  double compile = 0;
+  double link    = 0;
+
+  for(uint32_t i = 0; i < PROGRAMS; ++i)
+  {
+    snprintf(vs, sizeof(vs), "%s\n// %u", shader_vs, i);
+    snprintf(fs, sizeof(fs), "%s\n// %u", shader_fs[0], i);
+
+    double start        = now();
+    FG_Shader shaders[] = { (*b->compileShader)(b, bench->ctx, FG_ShaderStage_Vertex, vs),
+                            (*b->compileShader)(b, bench->ctx, FG_ShaderStage_Pixel, fs) };
+    compile += now() - start;
+
+    // Background compiles finish whenever they finish, so linking is only done once the pipeline is usable. A failed
+    // link never becomes usable, so the wait gives up eventually instead of hanging.
+    start              = now();
+    uintptr_t pipeline = create_pipeline(bench, shaders[0], shaders[1]);
+    while(pipeline && (*b->queryPipelineState)(b, bench->ctx, pipeline) != 0 && now() - start < 10.0)
+      ;
+    link += now() - start;
+
+    (*b->destroyPipelineState)(b, bench->ctx, pipeline);
+    (*b->destroyShader)(b, bench->ctx, shaders[0]);
+    (*b->destroyShader)(b, bench->ctx, shaders[1]);
+  }
+
+  if(bench->n_results + 2 <= sizeof(bench->results) / sizeof(Result))
+  {
+    Result c                           = { "shader_compile", "shaders", PROGRAMS * 2.0, compile };
+    Result l                           = { "program_link", "programs", PROGRAMS, link };
+    bench->results[bench->n_results++] = c;
+    bench->results[bench->n_results++] = l;
+  }
+}
+
+void write_results(FILE* out, const Bench* bench, int json)
+{
+  if(json)
+    fprintf(out, "[\n");
+  else
+    fprintf(out, "name,count,unit,seconds,per_second\n");
+
+  for(uint32_t i = 0; i < bench->n_results; ++i)
+  {
+    const Result* r = &bench->results[i];
+    double rate     = r->seconds > 0 ? r->count / r->seconds : 0;
+    if(json)
+      fprintf(out, "  { \"name\": \"%s\", \"count\": %.0f, \"unit\": \"%s\", \"seconds\": %.9f, \"per_second\": %.3f }%s\n",
+              r->name, r->count, r->unit, r->seconds, rate, i + 1 < bench->n_results ? "," : "");
+    else
+      fprintf(out, "%s,%.0f,%s,%.9f,%.3f\n", r->name, r->count, r->unit, r->seconds, rate);
+  }
+
+  if(json)
+    fprintf(out, "]\n");
+}
+
+int main(int argc, char* argv[])
+{
+  int json         = 0;
+  int windowed     = 0;
+  const char* path = NULL;
+  Bench bench      = { 0 };
+  bench.iterations = 10000;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    if(!strcmp(argv[i], "--json"))
+      json = 1;
+    else if(!strcmp(argv[i], "--window"))
+      windowed = 1;
+    else if(!strcmp(argv[i], "--iterations") && i + 1 < argc)
+      bench.iterations = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if(!strcmp(argv[i], "--out") && i + 1 < argc)
+      path = argv[++i];
+    else
+    {
+      fprintf(stderr, "usage: fgbench [--json] [--window] [--iterations N] [--out FILE]\n");
+      return -1;
+    }
+  }
+
+  struct FG_GraphicsInterface* b = BACKEND(NULL, BenchLog);
+  if(!b)
+  {
+    fprintf(stderr, "Failed to load backend!\n");
+    return -1;
+  }
+  bench.b = b;
+
+  // Headless runs don't depend on a display server or the compositor, so they're the default whenever they work.
+  FG_Vec2i dim                            = { 800, 600 };
+  struct FG_DesktopInterface* desktop     = NULL;
+  struct FG_GraphicsDesktopBridge* bridge = NULL;
+  FG_Window* w                            = NULL;
+  if(!windowed && ((*b->getCaps)(b).features & FG_Feature_Headless))
+    bench.ctx = (*b->createContext)(b, dim, FG_PixelFormat_R8G8B8A8_Typeless);
+
+  if(!bench.ctx)
+  {
+    FG_Vec2 pos  = { 0.f, 0.f };
+    FG_Vec2 size = { (float)dim.x, (float)dim.y };
+    desktop      = fgGLFW(NULL, BenchLog, behavior);
+    bridge       = BRIDGE(b, NULL, BenchLog);
+    w            = (*desktop->createWindow)(desktop, 0, NULL, &pos, &size, "fgbench", 0);
+    if(!w || (*bridge->emplaceContext)(bridge, w, FG_PixelFormat_R8G8B8A8_Typeless) != 0)
+    {
+      fprintf(stderr, "Failed to create a context!\n");
+      return -1;
+    }
+    bench.ctx = w->context;
+    // Nothing is presented until the end, but vsync must not throttle the one swap that is.
+    (*bridge->setFramePacing)(bridge, w, 0, false);
+    (*bridge->beginDraw)(bridge, w, NULL);
+  }
+  else
+    (*b->beginDraw)(b, bench.ctx, NULL);
+
+  float verts[]      = { -0.01f, -0.01f, 0.01f, -0.01f, 0.0f, 0.01f };
+  bench.vertices     = (*b->createBuffer)(b, bench.ctx, verts, sizeof(verts), FG_Usage_Vertex_Data);
+  bench.shaders[0]   = (*b->compileShader)(b, bench.ctx, FG_ShaderStage_Vertex, shader_vs);
+  bench.shaders[1]   = (*b->compileShader)(b, bench.ctx, FG_ShaderStage_Pixel, shader_fs[0]);
+  bench.shaders[2]   = (*b->compileShader)(b, bench.ctx, FG_ShaderStage_Pixel, shader_fs[1]);
+  bench.pipelines[0] = create_pipeline(&bench, bench.shaders[0], bench.shaders[1]);
+  bench.pipelines[1] = create_pipeline(&bench, bench.shaders[0], bench.shaders[2]);
+  if(!bench.pipelines[0] || !bench.pipelines[1])
+  {
+    fprintf(stderr, "Failed to create pipelines!\n");
+    return -1;
+  }
+
+  bench_compile(&bench);
+  bench_draws(&bench);
+  bench_pipeline_switches(&bench);
+  bench_uniform_updates(&bench);
+  bench_command_lists(&bench);
+  bench_buffer_upload(&bench);
+  bench_texture_upload(&bench);
+
+  FILE* out = path ? fopen(path, "w") : stdout;
+  if(!out)
+  {
+    fprintf(stderr, "Couldn't open %s!\n", path);
+    return -1;
+  }
+  write_results(out, &bench, json);
+  if(out != stdout)
+    fclose(out);
+
+  (*b->destroyPipelineState)(b, bench.ctx, bench.pipelines[0]);
+  (*b->destroyPipelineState)(b, bench.ctx, bench.pipelines[1]);
+  for(int i = 0; i < 3; ++i)
+    (*b->destroyShader)(b, bench.ctx, bench.shaders[i]);
+  (*b->destroyResource)(b, bench.ctx, bench.vertices);
+
+  if(w)
+  {
+    (*bridge->endDraw)(bridge, w);
+    (*desktop->destroyWindow)(desktop, w);
+    (*bridge->destroy)(bridge);
+    (*desktop->destroy)(desktop);
+  }
+  else
+  {
+    (*b->endDraw)(b, bench.ctx);
+    (*b->destroyContext)(b, bench.ctx);
+  }
+  (*b->destroy)(b);
+  return 0;
+}
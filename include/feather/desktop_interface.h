@@ -587,7 +587,20 @@ struct FG_DesktopInterface
   bool (*checkClipboard)(struct FG_DesktopInterface* self, FG_Window* window, enum FG_Clipboard kind);
   int (*clearClipboard)(struct FG_DesktopInterface* self, FG_Window* window, enum FG_Clipboard kind);
   int (*processMessages)(struct FG_DesktopInterface* self, FG_Window* window, void* ui_state);
+  // Like processMessages, but first blocks until there is something to process, wakeMessages is called, or timeout
+  // seconds have passed. A negative timeout waits for as long as it takes.
+  int (*waitMessages)(struct FG_DesktopInterface* self, FG_Window* window, void* ui_state, double timeout);
+  // Makes a blocked waitMessages return, or the next one return immediately. Safe to call from any thread.
+  int (*wakeMessages)(struct FG_DesktopInterface* self);
+  // Returns a file descriptor that becomes readable when there are messages to process, so an event loop can wait on it
+  // together with its own I/O and call processMessages once it's ready.
   int (*getMessageSyncObject)(struct FG_DesktopInterface* self, FG_Window* window);
+  // While enabled, input for window is queued during processMessages and delivered in order once the OS queue is
+  // drained, with runs of consecutive MouseMove, MouseScroll or JoyAxis events merged into one message each.
+  int (*setInputCoalescing)(struct FG_DesktopInterface* self, FG_Window* window, bool enable);
+  // While a merged message is being delivered, copies up to count of the events it was merged from, oldest first, into
+  // target and returns how many there are. Returns 0 while delivering anything else.
+  uint32_t (*getCoalescedEvents)(struct FG_DesktopInterface* self, FG_Window* window, FG_Msg* target, uint32_t count);
   int (*setCursor)(struct FG_DesktopInterface* self, FG_Window* window, enum FG_Cursor cursor);
   int (*getDisplayIndex)(struct FG_DesktopInterface* self, unsigned int index, FG_Display* out);
   int (*getDisplay)(struct FG_DesktopInterface* self, uintptr_t handle, FG_Display* out);
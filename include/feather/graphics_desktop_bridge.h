@@ -20,13 +20,51 @@ limitations under the License.
 #include "desktop_interface.h"
 #include "graphics_interface.h"
 
+// Present timing of a window, in seconds. Intervals are measured after each swap returns, so they only reflect the
+// display when the swap is synced to it.
+typedef struct FG_PresentTiming__
+{
+  double refresh_interval; // Predicted time between vblanks, from the monitor's refresh rate refined by measurements
+  double present_interval; // Average time between presents
+  double last_interval;    // Time between the last two presents
+  double draw_time;        // Estimated time from starting a frame to its swap returning
+  double until_vblank;     // Time left until the predicted vblank, or 0 if the last swap wasn't synced
+  int swap_interval;       // As set by setFramePacing, or 1 if adaptive vsync was asked for but isn't supported
+  bool render_late;
+} FG_PresentTiming;
+
+// Load tasks are given the loader's context, and completion callbacks the context of the window that finished them.
+typedef void (*FG_LoadTask)(void* user, FG_Context* context);
+
 struct FG_GraphicsDesktopBridge
 {
   int (*emplaceContext)(struct FG_GraphicsDesktopBridge* self, FG_Window* window, enum FG_PixelFormat backbuffer);
   int (*attachContext)(struct FG_GraphicsDesktopBridge* self, FG_Context* context, FG_Window* window);
+  // If area is given, usually the one from the Draw message, drawing is scissored to it and only that part of the window
+  // is presented by endDraw where the platform supports it. Null redraws and presents the whole window.
   int (*beginDraw)(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_Rect* area);
   int (*endDraw)(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
   int (*destroy)(struct FG_GraphicsDesktopBridge* self);
+  // interval is how many vblanks each swap waits for, where 0 presents right away and -1 asks for adaptive vsync,
+  // which only tears frames that are already late. With render_late, waitForFrame sleeps until just before the
+  // predicted vblank, so input is sampled and drawn as late as possible. This makes every synced swap wait for the
+  // GPU to finish, so the driver can't queue frames ahead.
+  int (*setFramePacing)(struct FG_GraphicsDesktopBridge* self, FG_Window* window, int interval, bool render_late);
+  // Call before sampling input for a new frame. Returns right away unless render_late is set.
+  int (*waitForFrame)(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
+  int (*getPresentTiming)(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_PresentTiming* timing);
+  // Runs load on a worker thread, which has a hidden context current that shares objects with window and every other
+  // window of its desktop. Buffers, textures and shaders created there can be used by any of them once done has been
+  // called, which only happens in finishLoads, after the GPU has finished the load. Only those calls are safe to make
+  // from load, and pipelines hold vertex arrays, which contexts don't share, so they still have to be created on the
+  // context that draws with them. Every finished load wakes up waitMessages.
+  int (*queueLoad)(struct FG_GraphicsDesktopBridge* self, FG_Window* window, FG_LoadTask load, FG_LoadTask done,
+                   void* user);
+  // Calls done, on the calling thread, for every load the GPU has finished, and returns how many there were.
+  int (*finishLoads)(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
+  // Deletes the context emplaceContext created for window, along with everything else the bridge keeps for it. Call it
+  // before the window is destroyed.
+  int (*destroyContext)(struct FG_GraphicsDesktopBridge* self, FG_Window* window);
 };
 
 typedef struct FG_GraphicsDesktopBridge* (*FG_InitGraphicsDesktopBridge)(struct FG_GraphicsInterface*, void*, FG_Log);
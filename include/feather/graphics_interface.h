@@ -178,6 +178,7 @@ enum FG_Usage
   FG_Usage_Texture2D_Multisample_Proxy,
   FG_Usage_Renderbuffer,
   FG_Usage_Storage_Buffer,
+  FG_Usage_Indirect_Buffer, // Draw records for drawIndirect and drawIndexedIndirect
 };
 
 enum FG_ShaderStage
@@ -219,6 +220,11 @@ enum FG_Feature
   FG_Feature_Tesselation_Shader = (1 << 20),
   FG_Feature_Mesh_Shader        = (1 << 21),
   FG_Feature_Headless           = (1 << 22),
+  FG_Feature_Async_Compile      = (1 << 23),
+  FG_Feature_Block_Compression  = (1 << 24),
+  FG_Feature_Vertex_Binding     = (1 << 25),
+  FG_Feature_Draw_Indirect      = (1 << 26),
+  FG_Feature_Base_Instance      = (1 << 27),
 };
 
 // This can hold caps for either OpenGL or OpenGL ES. These have different version numbers.
@@ -319,6 +325,8 @@ typedef struct FG_OpenGL_Caps__
   int max_mesh_views;
   FG_Vec3i max_mesh_work_group_size;
   FG_Vec3i max_task_work_group_size;
+  int max_viewports; // How many viewports and scissor rects can be set at once, selected with gl_ViewportIndex
+  int video_memory;  // Dedicated video memory in KiB, or 0 if the driver doesn't say
 } FG_OpenGL_Caps;
 
 typedef struct FG_DirectX_Caps__
@@ -340,6 +348,7 @@ typedef union FG_Caps__
 
 typedef uintptr_t FG_Resource;
 typedef uintptr_t FG_Shader;
+typedef uintptr_t FG_Fence;
 
 enum FG_Primitive
 {
@@ -593,6 +602,96 @@ typedef struct FG_Viewport__
   FG_Vec3 dim;
 } FG_Viewport;
 
+typedef struct FG_TimingRegion__
+{
+  const char* name;
+  uint64_t nanoseconds;
+} FG_TimingRegion;
+
+// Counters always describe the last frame that ended, but GPU times lag a few frames behind, so reading them never
+// has to wait on the GPU.
+typedef struct FG_FrameStats__
+{
+  uint64_t gpu_time; // Nanoseconds the GPU spent on the frame, or 0 if timer queries aren't supported
+  uint64_t bytes_uploaded;
+  uint32_t draws;
+  uint32_t state_changes;
+  uint32_t redundant_state; // State changes that were skipped because the state was already set
+  uint32_t uniform_uploads;
+  uint32_t n_regions;
+  const FG_TimingRegion* regions; // Owned by the context and only valid until the next frame ends
+} FG_FrameStats;
+
+// Sizes of textures and renderbuffers are estimates, since drivers are free to pad them. Every context shares the same
+// objects, so the totals cover all of them.
+typedef struct FG_MemoryReport__
+{
+  uint64_t buffer_bytes;
+  uint64_t vertex_bytes;     // Part of buffer_bytes that holds vertices or indices
+  uint64_t uniform_bytes;    // Part of buffer_bytes that holds uniform or storage blocks
+  uint64_t texture_bytes;    // Including every mip level and sample
+  uint64_t compressed_bytes; // Part of texture_bytes in block compressed formats
+  uint64_t renderbuffer_bytes;
+  uint32_t n_buffers;
+  uint32_t n_textures;
+  uint32_t n_renderbuffers;
+  uint64_t budget;          // 0 if there is no budget
+  uint64_t device_bytes;    // Dedicated video memory, or 0 if the driver doesn't say
+  uint64_t available_bytes; // Video memory the driver says is still free, or 0 if it doesn't say
+} FG_MemoryReport;
+
+typedef struct FG_Quad__
+{
+  FG_Rect area;
+  FG_Rect uv; // In texels of the texture the quad is drawn with
+  FG_Color8 color;
+} FG_Quad;
+
+// Array. Layout of the draw records read by drawIndirect, matching what OpenGL, Direct3D and Vulkan all expect.
+typedef struct FG_DrawIndirectArgs__
+{
+  uint32_t vertexcount;
+  uint32_t instancecount;
+  uint32_t startvertex;
+  uint32_t startinstance; // Must be 0 without FG_Feature_Base_Instance
+} FG_DrawIndirectArgs;
+
+// Array. Layout of the draw records read by drawIndexedIndirect.
+typedef struct FG_DrawIndexedIndirectArgs__
+{
+  uint32_t indexcount;
+  uint32_t instancecount;
+  uint32_t startindex;
+  int32_t startvertex;
+  uint32_t startinstance; // Must be 0 without FG_Feature_Base_Instance
+} FG_DrawIndexedIndirectArgs;
+
+// Layout of the work group counts read by dispatchIndirect.
+typedef struct FG_DispatchIndirectArgs__
+{
+  uint32_t x;
+  uint32_t y;
+  uint32_t z;
+} FG_DispatchIndirectArgs;
+
+// Array. How the commands recorded after declareAccess use a resource.
+typedef struct FG_ResourceAccess__
+{
+  FG_Resource resource;
+  uint32_t flags; // FG_BarrierFlags for each way it's read, like FG_BarrierFlag_Storage_Buffer or FG_BarrierFlag_Command
+  bool write;     // Set if shaders also write to it, through a storage buffer or an image
+} FG_ResourceAccess;
+
+typedef struct FG_AtlasRegion__
+{
+  FG_Resource texture; // The atlas page the region was packed into
+  FG_Rect uv;          // In texels, so it can be used as FG_Quad::uv as is
+} FG_AtlasRegion;
+
+// Receives the data of a readback once the GPU has written it. data is only valid until the callback returns, and is
+// NULL with bytes set to 0 if the staging buffer couldn't be mapped.
+typedef void (*FG_ReadbackCallback)(void* user, const void* data, uint32_t bytes);
+
 enum FG_Vertex_Type
 {
   FG_Vertex_Type_Half = 0,
@@ -668,6 +767,11 @@ enum FG_AccessFlag
   FG_AccessFlag_Unsynchronized    = (1 << 5),
 };
 
+enum FG_TextureFlag
+{
+  FG_TextureFlag_Premultiply = (1 << 0), // Multiply the color channels of data by alpha, in linear space for sRGB formats
+};
+
 enum FG_BarrierFlags
 {
   FG_BarrierFlag_Vertex             = (1 << 0),
@@ -693,11 +797,27 @@ enum FG_ClearFlag
   FG_ClearFlag_Accumulator = (1 << 3),
 };
 
+// How often the backend asks the driver for errors. Every check waits for the driver, so checking less often is
+// faster, but errors are reported further away from the call that caused them.
+enum FG_ErrorCheck
+{
+  FG_ErrorCheck_Always = 0,     // After every call into the driver
+  FG_ErrorCheck_Command_List,   // Once after each executed command list
+  FG_ErrorCheck_Debug_Callback, // Never, only errors the driver reports on its own are logged
+  FG_ErrorCheck_Off,
+};
+
 struct FG_GraphicsInterface
 {
   FG_Caps (*getCaps)(struct FG_GraphicsInterface* self);
+  // Creates a context that isn't attached to any window and draws into a backbuffer of its own, if the backend has
+  // FG_Feature_Headless. beginDraw makes it current on the calling thread.
   FG_Context* (*createContext)(struct FG_GraphicsInterface* self, FG_Vec2i size, enum FG_PixelFormat backbuffer);
   int (*resizeContext)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size);
+  int (*destroyContext)(struct FG_GraphicsInterface* self, FG_Context* context);
+  // Brackets a frame drawn to a context no bridge manages, which is how a headless context is drawn to.
+  int (*beginDraw)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Rect* area);
+  int (*endDraw)(struct FG_GraphicsInterface* self, FG_Context* context);
   FG_Shader (*compileShader)(struct FG_GraphicsInterface* self, FG_Context* context, enum FG_ShaderStage stage,
                              const char* source);
   int (*destroyShader)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Shader shader);
@@ -711,19 +831,68 @@ struct FG_GraphicsInterface
                          unsigned long srcoffset, unsigned long destoffset, unsigned long bytes);
   int (*copyResourceRegion)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource src, FG_Resource dest,
                             int level, FG_Vec3i srcoffset, FG_Vec3i destoffset, FG_Vec3i size);
+  // startvertex and startindex select where a mesh begins inside its buffers, and startvertex is also added to every
+  // index, so many meshes can be suballocated from one vertex and index buffer and share a pipeline. A non-zero
+  // startinstance needs FG_Feature_Base_Instance.
   int (*draw)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t vertexcount, uint32_t instancecount,
               uint32_t startvertex, uint32_t startinstance);
   int (*drawIndexed)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t indexcount,
                      uint32_t instancecount, uint32_t startindex, int startvertex, uint32_t startinstance);
   int (*drawMesh)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t first, uint32_t count);
+  // Issues drawcount draws whose parameters are read by the GPU from FG_DrawIndirectArgs records in buffer, starting at
+  // offset and stride bytes apart, or tightly packed if stride is 0. The records can be written by a compute shader, so
+  // a whole frame can be culled and drawn without its draw counts ever coming back to the CPU. Needs
+  // FG_Feature_Draw_Indirect.
+  int (*drawIndirect)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer, uint32_t offset,
+                      uint32_t drawcount, uint32_t stride);
+  // Like drawIndirect, but reads FG_DrawIndexedIndirectArgs records and draws with the pipeline's index buffer.
+  int (*drawIndexedIndirect)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                             uint32_t offset, uint32_t drawcount, uint32_t stride);
+  // Draws textured, tinted rects with the current pipeline state, whose vertex shader must take a vec4 vPosUV and may
+  // take a vec4 vColor. texture is bound to unit 0 unless it is 0. Consecutive calls with the same texture are merged
+  // into a single draw call.
+  int (*drawQuads)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource texture, const FG_Quad* quads,
+                   uint32_t count);
   int (*dispatch)(struct FG_GraphicsInterface* self, FG_CommandList* commands);
+  // Dispatches x by y by z work groups of the current compute pipeline, instead of the count it was created with.
+  int (*dispatchGroups)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t x, uint32_t y, uint32_t z);
+  // Reads the work group counts from an FG_DispatchIndirectArgs record at offset in buffer, which an earlier dispatch
+  // can write, so a chain of compute passes never has to wait on the CPU to size the next one.
+  int (*dispatchIndirect)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Resource buffer,
+                          uint32_t offset);
+  // Declares what the following commands read and write, instead of picking syncPoint flags by hand. The backend
+  // remembers which resources shaders wrote, and only issues a barrier when something written since is read in a way
+  // no barrier has covered yet. dispatchIndirect, drawIndirect and drawIndexedIndirect declare their own buffer.
+  int (*declareAccess)(struct FG_GraphicsInterface* self, FG_CommandList* commands, const FG_ResourceAccess* accesses,
+                       uint32_t count);
   int (*syncPoint)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t barrier_flags);
+  // Times everything recorded between the two, which shows up in FG_FrameStats::regions under name once the GPU is done
+  // with the frame. Regions can be nested, and name is only referenced, so it must stay valid until then.
+  int (*beginRegion)(struct FG_GraphicsInterface* self, FG_CommandList* commands, const char* name);
+  int (*endRegion)(struct FG_GraphicsInterface* self, FG_CommandList* commands);
   int (*setPipelineState)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uintptr_t state);
+  // Rebinds count vertex buffers of the current pipeline state, starting at binding first, to read from offsets[i] bytes
+  // into buffers[i] with the strides the pipeline was created with. offsets may be null. This lets many meshes
+  // suballocated from one large buffer share a pipeline, and lasts until the next setPipelineState. Needs
+  // FG_Feature_Vertex_Binding.
+  int (*setVertexBuffers)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uint32_t first,
+                          const FG_Resource* buffers, const uint32_t* offsets, uint32_t count);
+  // More than one viewport or scissor rect needs max_viewports > 1. Each primitive then picks one by writing
+  // gl_ViewportIndex, so several panes can be drawn in a single instanced pass.
   int (*setViewports)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Viewport* viewports, uint32_t count);
   int (*setScissors)(struct FG_GraphicsInterface* self, FG_CommandList* commands, FG_Rect* rects, uint32_t count);
   int (*setShaderConstants)(struct FG_GraphicsInterface* self, FG_CommandList* commands, const FG_ShaderParameter* uniforms,
                             const FG_ShaderValue* values, uint32_t count);
+  int (*setPreparedShaderConstants)(struct FG_GraphicsInterface* self, FG_CommandList* commands, uintptr_t parameters,
+                                    const FG_ShaderValue* values);
   int (*execute)(struct FG_GraphicsInterface* self, FG_Context* context, FG_CommandList* commands);
+  // Inserts a fence after every command the context has executed so far. waitFence blocks until the GPU has passed it
+  // or timeout nanoseconds have elapsed, and queryFence never blocks. Both return 0 once the fence has signaled.
+  FG_Fence (*createFence)(struct FG_GraphicsInterface* self, FG_Context* context);
+  int (*waitFence)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence, uint64_t timeout);
+  int (*queryFence)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence);
+  int (*destroyFence)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Fence fence);
+  // Identical requests return the same pipeline, so every call has to be matched by its own destroyPipelineState.
   uintptr_t (*createPipelineState)(struct FG_GraphicsInterface* self, FG_Context* context, FG_PipelineState* pipelinestate,
                                    FG_Resource rendertarget, FG_Blend* blends, FG_Resource* vertexbuffer, int* strides,
                                    uint32_t n_buffers, FG_VertexParameter* attributes, uint32_t n_attributes,
@@ -731,16 +900,88 @@ struct FG_GraphicsInterface
   uintptr_t (*createComputePipeline)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Shader computeshader,
                                      FG_Vec3i workgroup, uint32_t flags);
   int (*destroyPipelineState)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t state);
+  // Never blocks. Returns 0 once state can be used without waiting for its shaders to compile, and non-zero while they
+  // are still compiling in the background or if they failed, so a placeholder pipeline can be used in the meantime.
+  int (*queryPipelineState)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t state);
+  // Resolves uniforms against the program of state once, so setPreparedShaderConstants can skip all name lookups. The
+  // returned handle is only valid with this pipeline state, and must be destroyed before it.
+  uintptr_t (*prepareShaderParameters)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t state,
+                                       const FG_ShaderParameter* uniforms, uint32_t count);
+  int (*destroyShaderParameters)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t parameters);
   FG_Resource (*createBuffer)(struct FG_GraphicsInterface* self, FG_Context* context, void* data, uint32_t bytes,
                               enum FG_Usage usage);
+  // Like createBuffer, but the buffer can never be reallocated, which is what lets mapResource keep it mapped with
+  // FG_AccessFlag_Persistent while the GPU uses it. access is every FG_AccessFlag_Read, FG_AccessFlag_Write and
+  // FG_AccessFlag_Persistent bit the buffer will ever be mapped with. Fails if the driver has no immutable storage.
+  FG_Resource (*createImmutableBuffer)(struct FG_GraphicsInterface* self, FG_Context* context, void* data,
+                                       uint32_t bytes, enum FG_Usage usage, uint32_t access);
+  // A sampler with a max_lod above 0 also gets a mip chain, which is generated from data if it's given. flags are
+  // FG_TextureFlag bits, which, like generated mips, only apply to 8-bit RGBA or BGRA data.
   FG_Resource (*createTexture)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size, enum FG_Usage usage,
-                               enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount);
+                               enum FG_PixelFormat format, FG_Sampler* sampler, void* data, int MultiSampleCount,
+                               uint32_t flags);
   FG_Resource (*createRenderTarget)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource depthstencil,
                                     FG_Resource* textures, uint32_t n_textures, int attachments);
+  // Render targets for passes whose results only live until a later pass of the same frame has read them, like blurs
+  // and shadow maps, come from a pool, which hands back one it already has if it matches. Depth and stencil, requested
+  // with FG_ClearFlag_Depth and FG_ClearFlag_Stencil, are only visible to the render target, and texture receives its
+  // color texture, which must not be destroyed. Releasing the render target discards its contents, which saves
+  // tiled GPUs from writing them back to memory, and lets a later pass or frame reuse it.
+  FG_Resource (*acquireRenderTarget)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i size,
+                                     enum FG_PixelFormat format, int samples, int attachments, FG_Sampler* sampler,
+                                     FG_Resource* texture);
+  int (*releaseRenderTarget)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource rendertarget);
   int (*destroyResource)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource);
   void* (*mapResource)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, uint32_t offset,
                        uint32_t length, enum FG_Usage usage, uint32_t access);
   int (*unmapResource)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, enum FG_Usage usage);
+  // Copies tightly packed pixels of the given format into a region of a mip level of texture. data is staged before this
+  // returns, so it can be reused right away while the GPU performs the upload in the background.
+  int (*updateTexture)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource texture, int level,
+                       FG_Vec2i offset, FG_Vec2i size, enum FG_PixelFormat format, const void* data);
+  // Readbacks copy into a staging buffer on the GPU and return right away, so they never stall the frame. Once the copy
+  // is done, finishReadbacks hands the data to callback, on the thread that calls it. bytes of 0 reads the rest of the
+  // buffer. readTexture reads a region of the first color attachment of a texture or render target, or of the
+  // context's backbuffer if resource is 0, as tightly packed pixels of format. The origin is at the bottom left, and rows
+  // arrive bottom row first. Readbacks still pending when the context is destroyed are dropped without calling back.
+  int (*readBuffer)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource buffer, uint32_t offset,
+                    uint32_t bytes, FG_ReadbackCallback callback, void* user);
+  int (*readTexture)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Resource resource, FG_Vec2i offset,
+                     FG_Vec2i size, enum FG_PixelFormat format, FG_ReadbackCallback callback, void* user);
+  // Calls back every readback of context the GPU has finished, in the order they were issued, and never blocks unless
+  // wait is set, in which case it waits for all of them. Returns how many callbacks were called.
+  int (*finishReadbacks)(struct FG_GraphicsInterface* self, FG_Context* context, bool wait);
+  // Atlases pack many small images into a few shared texture pages, so quads drawn from them can be batched. Once all
+  // maxpages are full, the least recently used page is emptied, which forgets every region on it, so regions should be
+  // looked up with findAtlasRegion every frame and inserted again if that fails. Both return 0 on success. An atlas has
+  // to be destroyed with the same context it was created with, before that context is.
+  uintptr_t (*createAtlas)(struct FG_GraphicsInterface* self, FG_Context* context, FG_Vec2i pagesize,
+                           enum FG_PixelFormat format, uint32_t maxpages);
+  int (*findAtlasRegion)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                         FG_AtlasRegion* region);
+  int (*insertAtlasRegion)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas, uint64_t key,
+                           FG_Vec2i size, const void* data, FG_AtlasRegion* region);
+  int (*destroyAtlas)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t atlas);
+  // Opens a KTX2 or DDS file and creates a texture for its whole mip chain without reading any pixels. Each call to
+  // streamTexture then uploads the smallest levels that haven't been uploaded yet, until at least budget bytes have been
+  // copied, and sets *remaining to the number of levels still missing. The texture can be drawn with right away, it just
+  // gets sharper as more levels arrive. The texture belongs to the caller and is destroyed with destroyResource, but it
+  // has to outlive the stream.
+  uintptr_t (*openTextureStream)(struct FG_GraphicsInterface* self, FG_Context* context, const char* path,
+                                 FG_Sampler* sampler, FG_Resource* texture);
+  int (*streamTexture)(struct FG_GraphicsInterface* self, FG_Context* context, uintptr_t stream, uint64_t budget,
+                       uint32_t* remaining);
+  int (*closeTextureStream)(struct FG_GraphicsInterface* self, uintptr_t stream);
+  int (*getFrameStats)(struct FG_GraphicsInterface* self, FG_Context* context, FG_FrameStats* stats);
+  int (*getMemoryReport)(struct FG_GraphicsInterface* self, FG_Context* context, FG_MemoryReport* report);
+  // Nothing ever fails for going over the budget, but once it's exceeded, caches give memory back instead of growing:
+  // atlases reuse their least recently used page instead of adding one, and release pages that weren't used this frame
+  // when it ends, which forgets their regions just like any other eviction, and pooled render targets that weren't
+  // used this frame are deleted. A budget of 0 turns this off.
+  int (*setMemoryBudget)(struct FG_GraphicsInterface* self, uint64_t bytes);
+  // Only changes this backend, other backends keep their own level. Call it with one of the backend's contexts current,
+  // which is where driver reported errors are hooked up, and every context made current later picks it up as well.
+  int (*setErrorCheck)(struct FG_GraphicsInterface* self, enum FG_ErrorCheck level);
   int (*destroy)(struct FG_GraphicsInterface* self);
 };
 